@@ -109,3 +109,14 @@ if(MSVC AND NOT HAVE_TBB AND NOT HAVE_CSTRIPES AND NOT HAVE_OPENMP)
 else()
   set(HAVE_CONCURRENCY 0)
 endif()
+
+# --- pthreads ---
+if(WITH_PTHREADS_PF AND NOT HAVE_TBB AND NOT HAVE_CSTRIPES AND NOT HAVE_OPENMP AND NOT HAVE_GCD AND NOT HAVE_CONCURRENCY)
+  if(HAVE_LIBPTHREAD)
+    set(HAVE_PTHREADS_PF 1)
+  else()
+    set(HAVE_PTHREADS_PF 0)
+  endif()
+else()
+  set(HAVE_PTHREADS_PF 0)
+endif()
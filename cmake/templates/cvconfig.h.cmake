@@ -169,6 +169,9 @@
 /* C= */
 #cmakedefine  HAVE_CSTRIPES
 
+/* Built-in pthreads-based parallel_for_ backend */
+#cmakedefine  HAVE_PTHREADS_PF
+
 /* Eigen Matrix & Linear Algebra Library */
 #cmakedefine  HAVE_EIGEN
 
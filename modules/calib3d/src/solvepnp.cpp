@@ -115,31 +115,6 @@ namespace cv
             transform(points, modif_points, transformation);
         }
 
-        class Mutex
-        {
-        public:
-            Mutex() {
-            }
-            void lock()
-            {
-#ifdef HAVE_TBB
-                resultsMutex.lock();
-#endif
-            }
-
-            void unlock()
-            {
-#ifdef HAVE_TBB
-                resultsMutex.unlock();
-#endif
-            }
-
-        private:
-#ifdef HAVE_TBB
-            tbb::mutex resultsMutex;
-#endif
-        };
-
         struct CameraParameters
         {
             void init(Mat _intrinsics, Mat _distCoeffs)
@@ -217,17 +192,14 @@ namespace cv
                 }
             }
 
+            AutoLock lock(resultsMutex);
             if (localInliers.size() > inliers.size())
             {
-                resultsMutex.lock();
-
                 inliers.clear();
                 inliers.resize(localInliers.size());
                 memcpy(&inliers[0], &localInliers[0], sizeof(int) * localInliers.size());
                 localRvec.copyTo(rvec);
                 localTvec.copyTo(tvec);
-
-                resultsMutex.unlock();
             }
         }
 
@@ -243,7 +215,7 @@ namespace cv
                     generateVar(pointsMask);
                     pnpTask(pointsMask, objectPoints, imagePoints, parameters,
                             inliers, rvec, tvec, initRvec, initTvec, syncMutex);
-                    if ((int)inliers.size() >= parameters.minInliersCount)
+                    if (enoughInliers())
                     {
 #ifdef HAVE_TBB
                         tbb::task::self().cancel_group_execution();
@@ -276,8 +248,16 @@ namespace cv
             static RNG generator;
             static Mutex syncMutex;
 
+            bool enoughInliers() const
+            {
+                AutoLock lock(syncMutex);
+                return (int)inliers.size() >= parameters.minInliersCount;
+            }
+
             void generateVar(std::vector<char>& mask) const
             {
+                // the generator is shared by all the stripes
+                AutoLock lock(syncMutex);
                 int size = (int)mask.size();
                 for (int i = 0; i < size; i++)
                 {
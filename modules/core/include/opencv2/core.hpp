@@ -263,6 +263,8 @@ CV_EXPORTS_W int64 getCPUTickCount();
   - CV_CPU_SSE4_2 - SSE 4.2
   - CV_CPU_POPCNT - POPCOUNT
   - CV_CPU_AVX - AVX
+  - CV_CPU_AVX2 - AVX 2
+  - CV_CPU_FMA3 - FMA 3
 
   \note {Note that the function output is not static. Once you called cv::useOptimized(false),
   most of the hardware acceleration is disabled and thus the function will returns false,
@@ -293,6 +295,36 @@ CV_EXPORTS void* fastMalloc(size_t bufSize);
 */
 CV_EXPORTS void fastFree(void* ptr);
 
+/*!
+  Turns on/off the pooled implementation of cv::fastMalloc() and cv::fastFree()
+
+  When the pool is on, the freed buffers are kept in per-thread and global caches, grouped by
+  size classes, and reused by the subsequent allocations of a similar size instead of going
+  to the system allocator. This helps the processing loops that allocate the same temporary
+  buffers again and again. The function can be called at any time; the buffers allocated
+  in one mode can be released in the other one. Turning the pool off releases the cached memory.
+*/
+CV_EXPORTS void setUsePooledMalloc(bool onoff);
+
+//! returns true if cv::fastMalloc() uses the memory pool
+CV_EXPORTS bool usePooledMalloc();
+
+//! the memory pool usage statistics
+struct CV_EXPORTS MallocStatistics
+{
+    MallocStatistics();
+
+    int64 hits;         //!< the number of allocations served from the pool
+    int64 misses;       //!< the number of pooled allocations that went to the system allocator
+    size_t cachedBytes; //!< the amount of memory kept in the pool
+};
+
+//! returns the memory pool statistics accumulated since the start of the program
+CV_EXPORTS MallocStatistics getMallocStatistics();
+
+//! returns all the memory cached by the pool to the system
+CV_EXPORTS void trimMallocPool();
+
 template<typename _Tp> static inline _Tp* allocate(size_t n)
 {
     return new _Tp[n];
@@ -1440,6 +1472,86 @@ public:
     virtual void deallocate(int* refcount, uchar* datastart, uchar* data) = 0;
 };
 
+//! returns the allocator set for the current thread by MatAllocatorScope, or NULL
+CV_EXPORTS MatAllocator* getDefaultMatAllocator();
+
+/*!
+   Sets the default allocator of the current thread
+
+   While the object is alive, every matrix created by the current thread that does not have its
+   own allocator (this includes the temporary matrices created inside OpenCV functions and the
+   results of Mat::create(), OutputArray::create() and Mat::clone()) takes its memory from
+   the specified allocator. Such a matrix keeps using the allocator until the memory is released;
+   when it is re-allocated later, the default allocator of that moment is used.
+   Scopes can be nested; passing NULL restores the regular cv::fastMalloc() based allocation.
+*/
+class CV_EXPORTS MatAllocatorScope
+{
+public:
+    explicit MatAllocatorScope(MatAllocator* allocator);
+    ~MatAllocatorScope();
+
+protected:
+    MatAllocator* prevAllocator;
+
+private:
+    MatAllocatorScope(const MatAllocatorScope&);
+    MatAllocatorScope& operator = (const MatAllocatorScope&);
+};
+
+/*!
+   Bump-pointer matrix allocator
+
+   The arena hands out memory sequentially from a list of large blocks and frees it all at once
+   in reset(). Use it together with MatAllocatorScope for the per-frame temporary matrices:
+
+   \code
+   MatArena arena;
+   for(;;)
+   {
+       cap >> frame;
+       {
+           MatAllocatorScope scope(&arena);
+           process(frame, result); // result must be allocated outside of the scope
+       }
+       arena.reset();
+   }
+   \endcode
+
+   After the first frames the arena keeps a single block big enough for the whole frame,
+   so the processing does not touch the heap anymore. All the matrices allocated from the arena
+   must be released before reset() is called.
+*/
+class CV_EXPORTS MatArena : public MatAllocator
+{
+public:
+    //! blockSize is the minimal size of the memory blocks requested from the system
+    explicit MatArena(size_t blockSize=(size_t)1 << 24);
+    virtual ~MatArena();
+
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step);
+    void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    //! makes the whole arena memory available again
+    void reset();
+    //! frees all the memory blocks
+    void release();
+
+    //! returns the number of bytes handed out since the last reset
+    size_t allocatedBytes() const;
+    //! returns the total size of the memory blocks owned by the arena
+    size_t capacity() const;
+
+    struct Impl;
+protected:
+    Impl* impl;
+
+private:
+    MatArena(const MatArena&);
+    MatArena& operator = (const MatArena&);
+};
+
 /*!
    The n-dimensional matrix class.
 
@@ -1914,7 +2026,8 @@ public:
     template<typename _Tp> MatConstIterator_<_Tp> begin() const;
     template<typename _Tp> MatConstIterator_<_Tp> end() const;
 
-    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG };
+    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG,
+           DEFAULT_ALLOCATOR_FLAG=1 << 13 /* the allocator was taken from MatAllocatorScope */ };
 
     /*! includes several bit-fields:
          - the magic signature
@@ -4011,6 +4124,13 @@ class CV_EXPORTS FileNode;
  for(int k = 0; k < 8; k++, ++it)
     lbp_val |= ((int)*it) << k;
  \endcode
+
+ Large models can be stored in the binary format (FileStorage::WRITE + FileStorage::FORMAT_BINARY).
+ Such a file is memory-mapped when it is opened for reading, and the matrices read from it
+ with operator >> point directly into the mapping instead of being parsed and copied.
+ The mapping is shared by all such matrices and stays alive until the last of them is released.
+ The mapping is private, so modifying such a matrix does not change the file, but it does change
+ what the subsequent reads of the same node return; use Mat::clone() if that is not desired.
 */
 class CV_EXPORTS_W FileStorage
 {
@@ -4025,7 +4145,8 @@ public:
         FORMAT_MASK=(7<<3),
         FORMAT_AUTO=0,
         FORMAT_XML=(1<<3),
-        FORMAT_YAML=(2<<3)
+        FORMAT_YAML=(2<<3),
+        FORMAT_BINARY=(3<<3) //! memory-mapped binary format; the matrices read from it share memory with the file
     };
     enum
     {
@@ -4688,6 +4809,28 @@ public:
 
 CV_EXPORTS void parallel_for_(const Range& range, const ParallelLoopBody& body, double nstripes=-1.);
 
+/*!
+  Limits the number of threads used by parallel_for_ calls made from the current thread
+  while the object is alive. nthreads == 0 or 1 runs the loops sequentially, a negative value
+  keeps the limit of the enclosing scope (if any). Nested scopes can only make the limit tighter.
+
+  Independently of any scope, parallel_for_ called from inside a parallel loop body
+  is executed in the calling thread.
+*/
+class CV_EXPORTS ParallelScope
+{
+public:
+    explicit ParallelScope(int nthreads);
+    ~ParallelScope();
+
+protected:
+    int prevThreads;
+
+private:
+    ParallelScope(const ParallelScope&);
+    ParallelScope& operator = (const ParallelScope&);
+};
+
 /////////////////////////// Synchronization Primitives ///////////////////////////////
 
 class CV_EXPORTS Mutex
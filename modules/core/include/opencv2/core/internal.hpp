@@ -131,6 +131,22 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 #      define __xgetbv() 0
 #    endif
 #  endif
+// AVX2/FMA kernels are built next to the baseline code and selected at runtime with
+// checkHardwareSupport(CV_CPU_AVX2); functions using AVX2 intrinsics are marked CV_AVX2_TARGET
+#  if defined __AVX2__ && defined __FMA__
+#    include <immintrin.h>
+#    define CV_AVX2_DISPATCH 1
+#    define CV_AVX2_TARGET
+#  elif (defined __GNUC__ && !defined __clang__ && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || \
+        (defined __clang__ && !defined __APPLE__ && (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8)))
+#    include <immintrin.h>
+#    define CV_AVX2_DISPATCH 1
+#    define CV_AVX2_TARGET __attribute__((target("avx2,fma")))
+#  elif defined _MSC_VER && _MSC_VER >= 1800
+#    include <immintrin.h>
+#    define CV_AVX2_DISPATCH 1
+#    define CV_AVX2_TARGET
+#  endif
 #endif
 
 #ifdef __ARM_NEON__
@@ -160,6 +176,9 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 #ifndef CV_AVX
 #  define CV_AVX 0
 #endif
+#ifndef CV_AVX2_DISPATCH
+#  define CV_AVX2_DISPATCH 0
+#endif
 #ifndef CV_NEON
 #  define CV_NEON 0
 #endif
@@ -228,27 +247,124 @@ namespace cv
         int _begin, _end, _grainsize;
     };
 
+    // The TBB-style loops below run on top of parallel_for_, so they are executed in parallel
+    // with whichever framework parallel_for_ uses (pthreads, OpenMP, GCD, Concurrency, C=).
+    // The ranges are never split finer than their grain size.
+    template<typename Body> class ParallelForBody_ : public ParallelLoopBody
+    {
+    public:
+        ParallelForBody_( const Body& _body, int _grainsize ) : body(_body), grainsize(_grainsize) {}
+        void operator()( const Range& r ) const { body(BlockedRange(r.start, r.end, grainsize)); }
+
+    private:
+        ParallelForBody_& operator=( const ParallelForBody_& );
+
+        const Body& body;
+        int grainsize;
+    };
+
+    static inline int parallelNumStripes_( const BlockedRange& range, int maxStripes )
+    {
+        int len = range.end() - range.begin();
+        return std::max(std::min(len / std::max(range.grainsize(), 1), maxStripes), 1);
+    }
+
     template<typename Body> static inline
     void parallel_for( const BlockedRange& range, const Body& body )
     {
-        body(range);
+        // a few stripes per thread, so that the threads stay busy when the iterations are uneven
+        int nstripes = parallelNumStripes_(range, getNumThreads()*4);
+        if( nstripes > 1 )
+            parallel_for_(Range(range.begin(), range.end()),
+                          ParallelForBody_<Body>(body, range.grainsize()), nstripes);
+        else
+            body(range);
     }
     typedef std::vector<Rect> ConcurrentRectVector;
     typedef std::vector<double> ConcurrentDoubleVector;
 
+    template<typename Iterator, typename Body> class ParallelDoBody_ : public ParallelLoopBody
+    {
+    public:
+        ParallelDoBody_( const std::vector<Iterator>& _items, const Body& _body ) : items(_items), body(_body) {}
+        void operator()( const Range& r ) const
+        {
+            for( int i = r.start; i < r.end; i++ )
+                body(*items[i]);
+        }
+
+    private:
+        ParallelDoBody_& operator=( const ParallelDoBody_& );
+
+        const std::vector<Iterator>& items;
+        const Body& body;
+    };
+
     template<typename Iterator, typename Body> static inline
     void parallel_do( Iterator first, Iterator last, const Body& body )
     {
+        std::vector<Iterator> items;
         for( ; first != last; ++first )
-            body(*first);
+            items.push_back(first);
+        parallel_for_(Range(0, (int)items.size()), ParallelDoBody_<Iterator, Body>(items, body));
     }
 
     class Split {};
 
+    template<typename Body> class ParallelReduceBody_ : public ParallelLoopBody
+    {
+    public:
+        ParallelReduceBody_( const BlockedRange& _range, const std::vector<Body*>& _bodies )
+            : range(_range), bodies(_bodies) {}
+        void operator()( const Range& r ) const
+        {
+            int len = range.end() - range.begin(), nstripes = (int)bodies.size();
+            for( int k = r.start; k < r.end; k++ )
+            {
+                int start = range.begin() + (int)((int64)k*len/nstripes);
+                int end = range.begin() + (int)((int64)(k + 1)*len/nstripes);
+                (*bodies[k])(BlockedRange(start, end, range.grainsize()));
+            }
+        }
+
+    private:
+        ParallelReduceBody_& operator=( const ParallelReduceBody_& );
+
+        BlockedRange range;
+        const std::vector<Body*>& bodies;
+    };
+
+    // Splits the range into one stripe per thread. The first stripe is processed by the passed body,
+    // the others by its split copies, which are joined back in the stripe order,
+    // so the reduction is deterministic for a given number of threads.
     template<typename Body> static inline
     void parallel_reduce( const BlockedRange& range, Body& body )
     {
-        body(range);
+        int nstripes = parallelNumStripes_(range, getNumThreads());
+        if( nstripes <= 1 )
+        {
+            body(range);
+            return;
+        }
+
+        std::vector<Body*> bodies(nstripes, (Body*)0);
+        try
+        {
+            bodies[0] = &body;
+            for( int k = 1; k < nstripes; k++ )
+                bodies[k] = new Body(body, Split());
+            parallel_for_(Range(0, nstripes), ParallelReduceBody_<Body>(range, bodies), nstripes);
+            for( int k = 1; k < nstripes; k++ )
+                body.join(*bodies[k]);
+        }
+        catch(...)
+        {
+            for( int k = 1; k < nstripes; k++ )
+                delete bodies[k];
+            throw;
+        }
+        for( int k = 1; k < nstripes; k++ )
+            delete bodies[k];
     }
 #endif
 } //namespace cv
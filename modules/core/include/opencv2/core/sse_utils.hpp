@@ -0,0 +1,219 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/* The header is for internal use and it is likely to change.
+   It contains SSE2 helpers that convert between interleaved (packed) pixels
+   and separate channel planes held in registers.
+*/
+#ifndef __OPENCV_CORE_SSE_UTILS_HPP__
+#define __OPENCV_CORE_SSE_UTILS_HPP__
+
+#include "opencv2/core/internal.hpp"
+
+#if CV_SSE2
+
+// Every step below interleaves the first half of the register sequence with the second one
+// (a perfect shuffle). Five such steps transpose 32 pixels of 3 or 4 8-bit channels,
+// three steps transpose 8 pixels of 3 or 4 float channels.
+
+// On input v_r0 ... v_b1 hold 32 consecutive 3-channel pixels, as loaded from memory;
+// on output v_r0, v_r1 hold the first channel of the pixels, v_g0, v_g1 the second and so on.
+inline void _mm_deinterleave_epi8(__m128i & v_r0, __m128i & v_r1, __m128i & v_g0,
+                                  __m128i & v_g1, __m128i & v_b0, __m128i & v_b1)
+{
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_unpacklo_epi8(v_r0, v_g1);
+        __m128i t1 = _mm_unpackhi_epi8(v_r0, v_g1);
+        __m128i t2 = _mm_unpacklo_epi8(v_r1, v_b0);
+        __m128i t3 = _mm_unpackhi_epi8(v_r1, v_b0);
+        __m128i t4 = _mm_unpacklo_epi8(v_g0, v_b1);
+        __m128i t5 = _mm_unpackhi_epi8(v_g0, v_b1);
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2;
+        v_g1 = t3; v_b0 = t4; v_b1 = t5;
+    }
+}
+
+// the same for 32 4-channel pixels
+inline void _mm_deinterleave_epi8(__m128i & v_r0, __m128i & v_r1, __m128i & v_g0, __m128i & v_g1,
+                                  __m128i & v_b0, __m128i & v_b1, __m128i & v_a0, __m128i & v_a1)
+{
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_unpacklo_epi8(v_r0, v_b0);
+        __m128i t1 = _mm_unpackhi_epi8(v_r0, v_b0);
+        __m128i t2 = _mm_unpacklo_epi8(v_r1, v_b1);
+        __m128i t3 = _mm_unpackhi_epi8(v_r1, v_b1);
+        __m128i t4 = _mm_unpacklo_epi8(v_g0, v_a0);
+        __m128i t5 = _mm_unpackhi_epi8(v_g0, v_a0);
+        __m128i t6 = _mm_unpacklo_epi8(v_g1, v_a1);
+        __m128i t7 = _mm_unpackhi_epi8(v_g1, v_a1);
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2; v_g1 = t3;
+        v_b0 = t4; v_b1 = t5; v_a0 = t6; v_a1 = t7;
+    }
+}
+
+// the inverse of _mm_deinterleave_epi8: takes 32 pixels as channel planes
+// and returns them as 96 bytes of packed 3-channel pixels, ready to be stored
+inline void _mm_interleave_epi8(__m128i & v_r0, __m128i & v_r1, __m128i & v_g0,
+                                __m128i & v_g1, __m128i & v_b0, __m128i & v_b1)
+{
+    const __m128i v_mask = _mm_set1_epi16(0x00ff);
+
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_packus_epi16(_mm_and_si128(v_r0, v_mask), _mm_and_si128(v_r1, v_mask));
+        __m128i t1 = _mm_packus_epi16(_mm_and_si128(v_g0, v_mask), _mm_and_si128(v_g1, v_mask));
+        __m128i t2 = _mm_packus_epi16(_mm_and_si128(v_b0, v_mask), _mm_and_si128(v_b1, v_mask));
+        __m128i t3 = _mm_packus_epi16(_mm_srli_epi16(v_r0, 8), _mm_srli_epi16(v_r1, 8));
+        __m128i t4 = _mm_packus_epi16(_mm_srli_epi16(v_g0, 8), _mm_srli_epi16(v_g1, 8));
+        __m128i t5 = _mm_packus_epi16(_mm_srli_epi16(v_b0, 8), _mm_srli_epi16(v_b1, 8));
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2;
+        v_g1 = t3; v_b0 = t4; v_b1 = t5;
+    }
+}
+
+// the same for 32 4-channel pixels
+inline void _mm_interleave_epi8(__m128i & v_r0, __m128i & v_r1, __m128i & v_g0, __m128i & v_g1,
+                                __m128i & v_b0, __m128i & v_b1, __m128i & v_a0, __m128i & v_a1)
+{
+    const __m128i v_mask = _mm_set1_epi16(0x00ff);
+
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_packus_epi16(_mm_and_si128(v_r0, v_mask), _mm_and_si128(v_r1, v_mask));
+        __m128i t1 = _mm_packus_epi16(_mm_and_si128(v_g0, v_mask), _mm_and_si128(v_g1, v_mask));
+        __m128i t2 = _mm_packus_epi16(_mm_and_si128(v_b0, v_mask), _mm_and_si128(v_b1, v_mask));
+        __m128i t3 = _mm_packus_epi16(_mm_and_si128(v_a0, v_mask), _mm_and_si128(v_a1, v_mask));
+        __m128i t4 = _mm_packus_epi16(_mm_srli_epi16(v_r0, 8), _mm_srli_epi16(v_r1, 8));
+        __m128i t5 = _mm_packus_epi16(_mm_srli_epi16(v_g0, 8), _mm_srli_epi16(v_g1, 8));
+        __m128i t6 = _mm_packus_epi16(_mm_srli_epi16(v_b0, 8), _mm_srli_epi16(v_b1, 8));
+        __m128i t7 = _mm_packus_epi16(_mm_srli_epi16(v_a0, 8), _mm_srli_epi16(v_a1, 8));
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2; v_g1 = t3;
+        v_b0 = t4; v_b1 = t5; v_a0 = t6; v_a1 = t7;
+    }
+}
+
+// On input v_r0 ... v_b1 hold 8 consecutive 3-channel float pixels;
+// on output v_r0, v_r1 hold the first channel of the pixels, v_g0, v_g1 the second and so on.
+inline void _mm_deinterleave_ps(__m128 & v_r0, __m128 & v_r1, __m128 & v_g0,
+                                __m128 & v_g1, __m128 & v_b0, __m128 & v_b1)
+{
+    for( int k = 0; k < 3; k++ )
+    {
+        __m128 t0 = _mm_unpacklo_ps(v_r0, v_g1);
+        __m128 t1 = _mm_unpackhi_ps(v_r0, v_g1);
+        __m128 t2 = _mm_unpacklo_ps(v_r1, v_b0);
+        __m128 t3 = _mm_unpackhi_ps(v_r1, v_b0);
+        __m128 t4 = _mm_unpacklo_ps(v_g0, v_b1);
+        __m128 t5 = _mm_unpackhi_ps(v_g0, v_b1);
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2;
+        v_g1 = t3; v_b0 = t4; v_b1 = t5;
+    }
+}
+
+// the same for 8 4-channel float pixels
+inline void _mm_deinterleave_ps(__m128 & v_r0, __m128 & v_r1, __m128 & v_g0, __m128 & v_g1,
+                                __m128 & v_b0, __m128 & v_b1, __m128 & v_a0, __m128 & v_a1)
+{
+    for( int k = 0; k < 3; k++ )
+    {
+        __m128 t0 = _mm_unpacklo_ps(v_r0, v_b0);
+        __m128 t1 = _mm_unpackhi_ps(v_r0, v_b0);
+        __m128 t2 = _mm_unpacklo_ps(v_r1, v_b1);
+        __m128 t3 = _mm_unpackhi_ps(v_r1, v_b1);
+        __m128 t4 = _mm_unpacklo_ps(v_g0, v_a0);
+        __m128 t5 = _mm_unpackhi_ps(v_g0, v_a0);
+        __m128 t6 = _mm_unpacklo_ps(v_g1, v_a1);
+        __m128 t7 = _mm_unpackhi_ps(v_g1, v_a1);
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2; v_g1 = t3;
+        v_b0 = t4; v_b1 = t5; v_a0 = t6; v_a1 = t7;
+    }
+}
+
+// the inverse of _mm_deinterleave_ps for 8 3-channel float pixels
+inline void _mm_interleave_ps(__m128 & v_r0, __m128 & v_r1, __m128 & v_g0,
+                              __m128 & v_g1, __m128 & v_b0, __m128 & v_b1)
+{
+    for( int k = 0; k < 3; k++ )
+    {
+        __m128 t0 = _mm_shuffle_ps(v_r0, v_r1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 t1 = _mm_shuffle_ps(v_g0, v_g1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 t2 = _mm_shuffle_ps(v_b0, v_b1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 t3 = _mm_shuffle_ps(v_r0, v_r1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 t4 = _mm_shuffle_ps(v_g0, v_g1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 t5 = _mm_shuffle_ps(v_b0, v_b1, _MM_SHUFFLE(3, 1, 3, 1));
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2;
+        v_g1 = t3; v_b0 = t4; v_b1 = t5;
+    }
+}
+
+// the same for 8 4-channel float pixels
+inline void _mm_interleave_ps(__m128 & v_r0, __m128 & v_r1, __m128 & v_g0, __m128 & v_g1,
+                              __m128 & v_b0, __m128 & v_b1, __m128 & v_a0, __m128 & v_a1)
+{
+    for( int k = 0; k < 3; k++ )
+    {
+        __m128 t0 = _mm_shuffle_ps(v_r0, v_r1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 t1 = _mm_shuffle_ps(v_g0, v_g1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 t2 = _mm_shuffle_ps(v_b0, v_b1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 t3 = _mm_shuffle_ps(v_a0, v_a1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 t4 = _mm_shuffle_ps(v_r0, v_r1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 t5 = _mm_shuffle_ps(v_g0, v_g1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 t6 = _mm_shuffle_ps(v_b0, v_b1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 t7 = _mm_shuffle_ps(v_a0, v_a1, _MM_SHUFFLE(3, 1, 3, 1));
+
+        v_r0 = t0; v_r1 = t1; v_g0 = t2; v_g1 = t3;
+        v_b0 = t4; v_b1 = t5; v_a0 = t6; v_a1 = t7;
+    }
+}
+
+#endif // CV_SSE2
+
+#endif // __OPENCV_CORE_SSE_UTILS_HPP__
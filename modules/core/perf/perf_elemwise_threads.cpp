@@ -0,0 +1,78 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// Runs the element-wise functions on 4K images with a limited number of threads,
+// so the report shows how they scale with the number of cores.
+
+enum { ELEMWISE_ADD, ELEMWISE_MULTIPLY, ELEMWISE_COMPARE, ELEMWISE_CONVERTTO,
+       ELEMWISE_LUT, ELEMWISE_SPLIT, ELEMWISE_MERGE, ELEMWISE_MIXCHANNELS };
+CV_ENUM(ElemwiseOp, ELEMWISE_ADD, ELEMWISE_MULTIPLY, ELEMWISE_COMPARE, ELEMWISE_CONVERTTO,
+        ELEMWISE_LUT, ELEMWISE_SPLIT, ELEMWISE_MERGE, ELEMWISE_MIXCHANNELS)
+
+typedef std::tr1::tuple<ElemwiseOp, int> ElemwiseOp_Threads_t;
+typedef perf::TestBaseWithParam<ElemwiseOp_Threads_t> ElemwiseOp_Threads;
+
+PERF_TEST_P(ElemwiseOp_Threads, elemwise,
+            testing::Combine(
+                testing::ValuesIn(ElemwiseOp::all()),
+                testing::Values(1, 2, 4, 8, 16, 32)
+            )
+           )
+{
+    int op = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    Mat a(sz2160p, CV_8UC3), b(sz2160p, CV_8UC3), c;
+    Mat lut(1, 256, CV_8U);
+    vector<Mat> planes(3);
+    declare.in(a, b, WARMUP_RNG).in(lut, WARMUP_RNG);
+
+    if( op == ELEMWISE_MERGE )
+        split(a, planes);
+
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE()
+    {
+        switch( op )
+        {
+        case ELEMWISE_ADD:
+            add(a, b, c);
+            break;
+        case ELEMWISE_MULTIPLY:
+            multiply(a, b, c, 1./255);
+            break;
+        case ELEMWISE_COMPARE:
+            compare(a, b, c, CMP_GT);
+            break;
+        case ELEMWISE_CONVERTTO:
+            a.convertTo(c, CV_32F, 1./255);
+            break;
+        case ELEMWISE_LUT:
+            LUT(a, lut, c);
+            break;
+        case ELEMWISE_SPLIT:
+            split(a, planes);
+            break;
+        case ELEMWISE_MERGE:
+            merge(planes, c);
+            break;
+        default:
+            {
+                c.create(a.size(), a.type());
+                int fromTo[] = { 0, 2, 1, 1, 2, 0 };
+                mixChannels(&a, 1, &c, 1, fromTo, 3);
+            }
+        }
+    }
+
+    if( op == ELEMWISE_SPLIT )
+        merge(planes, c);
+
+    SANITY_CHECK(c, 1e-6);
+}
@@ -0,0 +1,34 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_FLAGS(GemmFlag, 0, GEMM_1_T, GEMM_2_T)
+
+typedef std::tr1::tuple<int, MatDepth, GemmFlag> Size_Depth_GemmFlag_t;
+typedef perf::TestBaseWithParam<Size_Depth_GemmFlag_t> Size_Depth_GemmFlag;
+
+PERF_TEST_P(Size_Depth_GemmFlag, gemm,
+            testing::Combine(
+                testing::Values(128, 256, 512, 1024),
+                testing::Values(CV_32F, CV_64F),
+                testing::Values(0, (int)GEMM_1_T, (int)GEMM_2_T)
+            )
+           )
+{
+    int n = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+    int flags = get<2>(GetParam());
+
+    Mat a(n, n, depth), b(n, n, depth), c(n, n, depth), d(n, n, depth);
+    declare.in(a, b, c, WARMUP_RNG).out(d);
+    if( n >= 1024 )
+        declare.time(100);
+
+    TEST_CYCLE() gemm(a, b, 0.5, c, 2, d, flags);
+
+    SANITY_CHECK(d, 1e-2, ERROR_RELATIVE);
+}
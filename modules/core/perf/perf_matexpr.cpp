@@ -0,0 +1,45 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef perf::TestBaseWithParam<Size_MatType_t> Size_MatType_MatExpr;
+
+PERF_TEST_P(Size_MatType_MatExpr, addWeighted3,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC3, CV_32FC1)
+            )
+           )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(sz, type), b(sz, type), c(sz, type), dst(sz, type);
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() dst = a*0.5 + b*0.25 - c;
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_MatType_MatExpr, mulAdd,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC3, CV_32FC1)
+            )
+           )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(sz, type), b(sz, type), c(sz, type), dst(sz, type);
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() dst = (a - b)*2 + c.mul(a, 1./255);
+
+    SANITY_CHECK(dst, 1);
+}
@@ -0,0 +1,124 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// Every test runs twice: with the optimized code paths (AVX2 or SSE2, whichever the CPU has)
+// and with setUseOptimized(false), so the report shows the speedup for each op and depth.
+
+enum { OP_ADD, OP_SUB, OP_ABSDIFF };
+CV_ENUM(ArithmOp, OP_ADD, OP_SUB, OP_ABSDIFF)
+
+enum { FUNC_EXP, FUNC_LOG, FUNC_MAGNITUDE, FUNC_PHASE };
+CV_ENUM(MathFunc, FUNC_EXP, FUNC_LOG, FUNC_MAGNITUDE, FUNC_PHASE)
+
+typedef std::tr1::tuple<ArithmOp, MatDepth, bool> ArithmOp_Depth_Optimized_t;
+typedef perf::TestBaseWithParam<ArithmOp_Depth_Optimized_t> ArithmOp_Depth_Optimized;
+
+typedef std::tr1::tuple<MathFunc, MatDepth, bool> MathFunc_Depth_Optimized_t;
+typedef perf::TestBaseWithParam<MathFunc_Depth_Optimized_t> MathFunc_Depth_Optimized;
+
+typedef std::tr1::tuple<MatDepth, MatDepth, bool> DepthSrc_DepthDst_Optimized_t;
+typedef perf::TestBaseWithParam<DepthSrc_DepthDst_Optimized_t> DepthSrc_DepthDst_Optimized;
+
+PERF_TEST_P(ArithmOp_Depth_Optimized, arithm,
+            testing::Combine(
+                testing::ValuesIn(ArithmOp::all()),
+                testing::Values(CV_8U, CV_8S, CV_16U, CV_16S, CV_32S, CV_32F, CV_64F),
+                testing::Bool()
+            )
+           )
+{
+    int op = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+    bool optimized = get<2>(GetParam());
+
+    Mat a(sz1080p, depth), b(sz1080p, depth), c(sz1080p, depth);
+    declare.in(a, b, WARMUP_RNG).out(c);
+
+    bool prevOptimized = useOptimized();
+    setUseOptimized(optimized);
+
+    TEST_CYCLE()
+    {
+        if( op == OP_ADD )
+            add(a, b, c);
+        else if( op == OP_SUB )
+            subtract(a, b, c);
+        else
+            absdiff(a, b, c);
+    }
+
+    setUseOptimized(prevOptimized);
+
+    SANITY_CHECK(c, 1e-8);
+}
+
+PERF_TEST_P(MathFunc_Depth_Optimized, mathfuncs,
+            testing::Combine(
+                testing::ValuesIn(MathFunc::all()),
+                testing::Values(CV_32F, CV_64F),
+                testing::Bool()
+            )
+           )
+{
+    int func = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+    bool optimized = get<2>(GetParam());
+
+    Mat x(sz1080p, depth), y(sz1080p, depth), dst(sz1080p, depth);
+    if( func == FUNC_LOG )
+        randu(x, 0.01, 100);
+    else
+        randu(x, -10, 10);
+    randu(y, -10, 10);
+    declare.in(x, y).out(dst);
+
+    bool prevOptimized = useOptimized();
+    setUseOptimized(optimized);
+
+    TEST_CYCLE()
+    {
+        if( func == FUNC_EXP )
+            exp(x, dst);
+        else if( func == FUNC_LOG )
+            log(x, dst);
+        else if( func == FUNC_MAGNITUDE )
+            magnitude(x, y, dst);
+        else
+            phase(x, y, dst, true);
+    }
+
+    setUseOptimized(prevOptimized);
+
+    SANITY_CHECK(dst, 1e-3, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(DepthSrc_DepthDst_Optimized, convertTo,
+            testing::Combine(
+                testing::Values(CV_8U, CV_16S, CV_32F),
+                testing::Values(CV_8U, CV_16S, CV_32F),
+                testing::Bool()
+            )
+           )
+{
+    int depthSrc = get<0>(GetParam());
+    int depthDst = get<1>(GetParam());
+    bool optimized = get<2>(GetParam());
+
+    Mat src(sz1080p, depthSrc), dst(sz1080p, depthDst);
+    randu(src, 0, 255);
+    declare.in(src).out(dst);
+
+    bool prevOptimized = useOptimized();
+    setUseOptimized(optimized);
+
+    TEST_CYCLE() src.convertTo(dst, depthDst, 0.5, 1);
+
+    setUseOptimized(prevOptimized);
+
+    SANITY_CHECK(dst, 1e-7);
+}
@@ -0,0 +1,34 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+enum { STORAGE_XML, STORAGE_YAML, STORAGE_BINARY };
+CV_ENUM(StorageFormat, STORAGE_XML, STORAGE_YAML, STORAGE_BINARY)
+
+typedef perf::TestBaseWithParam<StorageFormat> StorageFormat_Load;
+
+PERF_TEST_P(StorageFormat_Load, loadMat, testing::ValuesIn(StorageFormat::all()))
+{
+    int format = GetParam();
+    string fname = cv::tempfile(format == STORAGE_XML ? ".xml" : format == STORAGE_YAML ? ".yml" : ".bin");
+
+    Mat src(1000, 1000, CV_32F), dst;
+    declare.in(src, WARMUP_RNG);
+
+    {
+        FileStorage fs(fname, FileStorage::WRITE + (format == STORAGE_BINARY ? FileStorage::FORMAT_BINARY : 0));
+        fs << "m" << src;
+    }
+
+    TEST_CYCLE()
+    {
+        FileStorage fs(fname, FileStorage::READ);
+        fs["m"] >> dst;
+    }
+
+    remove(fname.c_str());
+
+    SANITY_CHECK(dst, 1e-6);
+}
@@ -40,9 +40,30 @@
 //
 //M*/
 
+
 #include "precomp.hpp"
 
-#define CV_USE_SYSTEM_MALLOC 1
+#if defined WIN32 || defined WINCE
+    #include <windows.h>
+    #undef small
+    #undef min
+    #undef max
+    #undef abs
+#else
+    #include <pthread.h>
+#endif
+
+/*
+   Every buffer returned by fastMalloc() is preceded by a two-word header:
+   adata[-1] points to the block returned by malloc(), adata[-2] is the size class of the block,
+   or NO_CLASS when the block bypasses the pool. Because the header is always there, fastFree()
+   can release any buffer correctly, no matter whether the pool was on when it was allocated.
+
+   When the pool is on, the block sizes are rounded up to one of the size classes
+   (4 classes per power of two, i.e. at most 25% overhead) and the released blocks are put
+   into a per-thread cache. Large blocks, and blocks that do not fit into the thread cache,
+   go to the global cache shared by all the threads.
+*/
 
 namespace cv
 {
@@ -53,633 +74,591 @@ static void* OutOfMemoryError(size_t size)
     return 0;
 }
 
-#if CV_USE_SYSTEM_MALLOC
+enum
+{
+    HEADER_SIZE = 2*sizeof(void*),
+    NO_CLASS = -1,
+    MIN_CLASS_LOG = 6,
+    MAX_CLASS_LOG = 30,
+    CLASS_SUBSTEPS_LOG = 2,
+    NCLASSES = ((MAX_CLASS_LOG - MIN_CLASS_LOG) << CLASS_SUBSTEPS_LOG) + 1,
+    // blocks up to this size are cached per thread
+    MAX_THREAD_BLOCK_SIZE = 1 << 20,
+    // small blocks are moved from the global cache to a thread cache in batches
+    MAX_BATCH_BLOCK_SIZE = 1 << 12,
+    BATCH_SIZE = 16
+};
 
-#if defined WIN32 || defined _WIN32
-void deleteThreadAllocData() {}
-#endif
+static const size_t MAX_THREAD_CACHE_SIZE = (size_t)8 << 20;
+static const size_t MAX_GLOBAL_CACHE_SIZE = (size_t)256 << 20;
 
-void* fastMalloc( size_t size )
+static volatile bool usePool = false;
+
+static inline int sizeToClass(size_t size)
 {
-    uchar* udata = (uchar*)malloc(size + sizeof(void*) + CV_MALLOC_ALIGN);
-    if(!udata)
-        return OutOfMemoryError(size);
-    uchar** adata = alignPtr((uchar**)udata + 1, CV_MALLOC_ALIGN);
-    adata[-1] = udata;
-    return adata;
+    if( size <= ((size_t)1 << MIN_CLASS_LOG) )
+        return 0;
+    if( size > ((size_t)1 << MAX_CLASS_LOG) )
+        return NO_CLASS;
+
+    // find p such that 2^p < size <= 2^(p+1)
+#if defined __GNUC__
+    int p = (int)(sizeof(unsigned long)*8) - 1 - __builtin_clzl((unsigned long)(size - 1));
+#else
+    int p = MIN_CLASS_LOG;
+    while( ((size_t)1 << (p + 1)) < size )
+        p++;
+#endif
+    int shift = p - CLASS_SUBSTEPS_LOG;
+    int k = (int)((size - ((size_t)1 << p) + ((size_t)1 << shift) - 1) >> shift);
+    return ((p - MIN_CLASS_LOG) << CLASS_SUBSTEPS_LOG) + k;
 }
 
-void fastFree(void* ptr)
+static inline size_t classToSize(int idx)
 {
-    if(ptr)
-    {
-        uchar* udata = ((uchar**)ptr)[-1];
-        CV_DbgAssert(udata < (uchar*)ptr &&
-               ((uchar*)ptr - udata) <= (ptrdiff_t)(sizeof(void*)+CV_MALLOC_ALIGN));
-        free(udata);
-    }
+    if( idx == 0 )
+        return (size_t)1 << MIN_CLASS_LOG;
+    int p = ((idx - 1) >> CLASS_SUBSTEPS_LOG) + MIN_CLASS_LOG;
+    int k = ((idx - 1) & ((1 << CLASS_SUBSTEPS_LOG) - 1)) + 1;
+    return ((size_t)1 << p) + ((size_t)k << (p - CLASS_SUBSTEPS_LOG));
 }
 
-#else //CV_USE_SYSTEM_MALLOC
-
-#if 0
-#define SANITY_CHECK(block) \
-    CV_Assert(((size_t)(block) & (MEM_BLOCK_SIZE-1)) == 0 && \
-        (unsigned)(block)->binIdx <= (unsigned)MAX_BIN && \
-        (block)->signature == MEM_BLOCK_SIGNATURE)
-#else
-#define SANITY_CHECK(block)
-#endif
+// free blocks are linked through their first word
+struct FreeList
+{
+    FreeList() : head(0), count(0) {}
 
-#define STAT(stmt)
+    void push(void* block)
+    {
+        *(void**)block = head;
+        head = block;
+        count++;
+    }
 
-#ifdef WIN32
-struct CriticalSection
-{
-    CriticalSection() { InitializeCriticalSection(&cs); }
-    ~CriticalSection() { DeleteCriticalSection(&cs); }
-    void lock() { EnterCriticalSection(&cs); }
-    void unlock() { LeaveCriticalSection(&cs); }
-    bool trylock() { return TryEnterCriticalSection(&cs) != 0; }
+    void* pop()
+    {
+        void* block = head;
+        if( block )
+        {
+            head = *(void**)block;
+            count--;
+        }
+        return block;
+    }
 
-    CRITICAL_SECTION cs;
+    void* head;
+    int count;
 };
 
-void* SystemAlloc(size_t size)
+struct ThreadCache
 {
-    void* ptr = malloc(size);
-    return ptr ? ptr : OutOfMemoryError(size);
-}
-
-void SystemFree(void* ptr, size_t)
-{
-    free(ptr);
-}
-#else //WIN32
-
-#include <sys/mman.h>
+    ThreadCache() : bytes(0), hits(0), misses(0), prev(0), next(0) {}
+
+    // taken by the owner thread and, rarely, by trimMallocPool() and getMallocStatistics()
+    Mutex mutex;
+    FreeList lists[NCLASSES];
+    size_t bytes;
+    int64 hits, misses;
+    ThreadCache* prev;
+    ThreadCache* next;
+};
 
-struct CriticalSection
+struct MallocPool
 {
-    CriticalSection() { pthread_mutex_init(&mutex, 0); }
-    ~CriticalSection() { pthread_mutex_destroy(&mutex); }
-    void lock() { pthread_mutex_lock(&mutex); }
-    void unlock() { pthread_mutex_unlock(&mutex); }
-    bool trylock() { return pthread_mutex_trylock(&mutex) == 0; }
-
-    pthread_mutex_t mutex;
+    MallocPool() : bytes(0), hits(0), misses(0), threads(0) {}
+
+    // protects the global cache and the list of thread caches;
+    // when both locks are needed, this one is taken first
+    Mutex mutex;
+    FreeList lists[NCLASSES];
+    size_t bytes;
+    int64 hits, misses;
+    ThreadCache* threads;
 };
 
-void* SystemAlloc(size_t size)
+static MallocPool& getMallocPool()
 {
-    #ifndef MAP_ANONYMOUS
-    #define MAP_ANONYMOUS MAP_ANON
-    #endif
-    void* ptr = 0;
-    ptr = mmap(ptr, size, (PROT_READ | PROT_WRITE), MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
-    return ptr != MAP_FAILED ? ptr : OutOfMemoryError(size);
+    // never destroyed: fastFree() can be called from static destructors
+    static MallocPool* pool = new MallocPool;
+    return *pool;
 }
 
-void SystemFree(void* ptr, size_t size)
+static void releaseList(FreeList& list)
 {
-    munmap(ptr, size);
+    while( void* block = list.pop() )
+        free(block);
 }
-#endif //WIN32
 
-struct AutoLock
+// moves the cached blocks and the statistics of a finished thread to the global cache
+static void releaseThreadCache(ThreadCache* tc)
 {
-    AutoLock(CriticalSection& _cs) : cs(&_cs) { cs->lock(); }
-    ~AutoLock() { cs->unlock(); }
-    CriticalSection* cs;
-};
-
-const size_t MEM_BLOCK_SIGNATURE = 0x01234567;
-const int MEM_BLOCK_SHIFT = 14;
-const size_t MEM_BLOCK_SIZE = 1 << MEM_BLOCK_SHIFT;
-const size_t HDR_SIZE = 128;
-const size_t MAX_BLOCK_SIZE = MEM_BLOCK_SIZE - HDR_SIZE;
-const int MAX_BIN = 28;
-
-static const int binSizeTab[MAX_BIN+1] =
-{ 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 128, 160, 192, 256, 320, 384, 480, 544, 672, 768,
-896, 1056, 1328, 1600, 2688, 4048, 5408, 8128, 16256 };
+    if( !tc )
+        return;
 
-struct MallocTables
-{
-    void initBinTab()
+    MallocPool& pool = getMallocPool();
     {
-        int i, j = 0, n;
-        for( i = 0; i <= MAX_BIN; i++ )
+    AutoLock lock(pool.mutex);
+    for( int idx = 0; idx < NCLASSES; idx++ )
+    {
+        size_t size = classToSize(idx);
+        while( void* block = tc->lists[idx].pop() )
         {
-            n = binSizeTab[i]>>3;
-            for( ; j <= n; j++ )
-                binIdx[j] = (uchar)i;
+            if( pool.bytes + size <= MAX_GLOBAL_CACHE_SIZE )
+            {
+                pool.lists[idx].push(block);
+                pool.bytes += size;
+            }
+            else
+                free(block);
         }
     }
-    int bin(size_t size)
-    {
-        assert( size <= MAX_BLOCK_SIZE );
-        return binIdx[(size + 7)>>3];
-    }
+    pool.hits += tc->hits;
+    pool.misses += tc->misses;
 
-    MallocTables()
-    {
-        initBinTab();
+    if( tc->prev )
+        tc->prev->next = tc->next;
+    else
+        pool.threads = tc->next;
+    if( tc->next )
+        tc->next->prev = tc->prev;
     }
 
-    uchar binIdx[MAX_BLOCK_SIZE/8+1];
-};
-
-MallocTables mallocTables;
+    delete tc;
+}
 
-struct Node
+static ThreadCache* createThreadCache()
 {
-    Node* next;
-};
+    ThreadCache* tc = new ThreadCache;
+    MallocPool& pool = getMallocPool();
+    AutoLock lock(pool.mutex);
+    tc->next = pool.threads;
+    if( pool.threads )
+        pool.threads->prev = tc;
+    pool.threads = tc;
+    return tc;
+}
 
-struct ThreadData;
+#if defined WIN32 || defined _WIN32
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+static DWORD tlsCacheKey = TLS_OUT_OF_INDEXES;
 
-struct Block
+void deleteThreadAllocData()
 {
-    Block(Block* _next)
+    if( tlsCacheKey != TLS_OUT_OF_INDEXES )
     {
-        signature = MEM_BLOCK_SIGNATURE;
-        prev = 0;
-        next = _next;
-        privateFreeList = publicFreeList = 0;
-        bumpPtr = endPtr = 0;
-        objSize = 0;
-        threadData = 0;
-        data = (uchar*)this + HDR_SIZE;
+        releaseThreadCache((ThreadCache*)TlsGetValue( tlsCacheKey ));
+        TlsSetValue( tlsCacheKey, 0 );
     }
+}
 
-    ~Block() {}
-
-    void init(Block* _prev, Block* _next, int _objSize, ThreadData* _threadData)
-    {
-        prev = _prev;
-        if(prev)
-            prev->next = this;
-        next = _next;
-        if(next)
-            next->prev = this;
-        objSize = _objSize;
-        binIdx = mallocTables.bin(objSize);
-        threadData = _threadData;
-        privateFreeList = publicFreeList = 0;
-        bumpPtr = data;
-        int nobjects = MAX_BLOCK_SIZE/objSize;
-        endPtr = bumpPtr + nobjects*objSize;
-        almostEmptyThreshold = (nobjects + 1)/2;
-        allocated = 0;
-    }
-
-    bool isFilled() const { return allocated > almostEmptyThreshold; }
-
-    size_t signature;
-    Block* prev;
-    Block* next;
-    Node* privateFreeList;
-    Node* publicFreeList;
-    uchar* bumpPtr;
-    uchar* endPtr;
-    uchar* data;
-    ThreadData* threadData;
-    int objSize;
-    int binIdx;
-    int allocated;
-    int almostEmptyThreshold;
-    CriticalSection cs;
-};
-
-struct BigBlock
+static ThreadCache* getThreadCache()
 {
-    BigBlock(int bigBlockSize, BigBlock* _next)
+    if( tlsCacheKey == TLS_OUT_OF_INDEXES )
     {
-        first = alignPtr((Block*)(this+1), MEM_BLOCK_SIZE);
-        next = _next;
-        nblocks = (int)(((char*)this + bigBlockSize - (char*)first)/MEM_BLOCK_SIZE);
-        Block* p = 0;
-        for( int i = nblocks-1; i >= 0; i-- )
-            p = ::new((uchar*)first + i*MEM_BLOCK_SIZE) Block(p);
+        tlsCacheKey = TlsAlloc();
+        CV_Assert(tlsCacheKey != TLS_OUT_OF_INDEXES);
     }
-
-    ~BigBlock()
+    ThreadCache* tc = (ThreadCache*)TlsGetValue( tlsCacheKey );
+    if( !tc )
     {
-        for( int i = nblocks-1; i >= 0; i-- )
-            ((Block*)((uchar*)first+i*MEM_BLOCK_SIZE))->~Block();
+        tc = createThreadCache();
+        TlsSetValue( tlsCacheKey, tc );
     }
+    return tc;
+}
+#else
+static pthread_key_t tlsCacheKey = 0;
+static pthread_once_t tlsCacheKeyOnce = PTHREAD_ONCE_INIT;
 
-    BigBlock* next;
-    Block* first;
-    int nblocks;
-};
+static void deleteThreadCache(void* data)
+{
+    releaseThreadCache((ThreadCache*)data);
+}
+
+static void makeCacheKey()
+{
+    int errcode = pthread_key_create(&tlsCacheKey, deleteThreadCache);
+    CV_Assert(errcode == 0);
+}
 
-struct BlockPool
+static ThreadCache* getThreadCache()
 {
-    BlockPool(int _bigBlockSize=1<<20) : pool(0), bigBlockSize(_bigBlockSize)
+    pthread_once(&tlsCacheKeyOnce, makeCacheKey);
+    ThreadCache* tc = (ThreadCache*)pthread_getspecific(tlsCacheKey);
+    if( !tc )
     {
+        tc = createThreadCache();
+        pthread_setspecific(tlsCacheKey, tc);
     }
+    return tc;
+}
+#endif
 
-    ~BlockPool()
+static void* poolAlloc(int idx)
+{
+    size_t size = classToSize(idx);
+    ThreadCache* tc = 0;
+    void* block;
+
+    if( size <= MAX_THREAD_BLOCK_SIZE )
     {
-        AutoLock lock(cs);
-        while( pool )
+        tc = getThreadCache();
+        AutoLock lock(tc->mutex);
+        block = tc->lists[idx].pop();
+        if( block )
         {
-            BigBlock* nextBlock = pool->next;
-            pool->~BigBlock();
-            SystemFree(pool, bigBlockSize);
-            pool = nextBlock;
+            tc->bytes -= size;
+            tc->hits++;
+            return block;
         }
     }
 
-    Block* alloc()
     {
-        AutoLock lock(cs);
-        Block* block;
-        if( !freeBlocks )
+    MallocPool& pool = getMallocPool();
+    AutoLock lock(pool.mutex);
+    block = pool.lists[idx].pop();
+    if( block )
+    {
+        pool.bytes -= size;
+        pool.hits++;
+
+        // take a few more small blocks, so that the next allocations do not need the global lock
+        if( tc && size <= MAX_BATCH_BLOCK_SIZE && pool.lists[idx].count > 0 )
         {
-            BigBlock* bblock = ::new(SystemAlloc(bigBlockSize)) BigBlock(bigBlockSize, pool);
-            assert( bblock != 0 );
-            freeBlocks = bblock->first;
-            pool = bblock;
+            AutoLock tlock(tc->mutex);
+            for( int i = 1; i < BATCH_SIZE && tc->bytes + size <= MAX_THREAD_CACHE_SIZE; i++ )
+            {
+                void* extra = pool.lists[idx].pop();
+                if( !extra )
+                    break;
+                pool.bytes -= size;
+                tc->lists[idx].push(extra);
+                tc->bytes += size;
+            }
         }
-        block = freeBlocks;
-        freeBlocks = freeBlocks->next;
-        if( freeBlocks )
-            freeBlocks->prev = 0;
-        STAT(stat.bruttoBytes += MEM_BLOCK_SIZE);
         return block;
     }
+    if( !tc )
+        pool.misses++;
+    }
 
-    void free(Block* block)
+    if( tc )
     {
-        AutoLock lock(cs);
-        block->prev = 0;
-        block->next = freeBlocks;
-        freeBlocks = block;
-        STAT(stat.bruttoBytes -= MEM_BLOCK_SIZE);
+        AutoLock lock(tc->mutex);
+        tc->misses++;
     }
+    return malloc(size);
+}
 
-    CriticalSection cs;
-    Block* freeBlocks;
-    BigBlock* pool;
-    int bigBlockSize;
-    int blocksPerBigBlock;
-};
-
-BlockPool mallocPool;
-
-enum { START=0, FREE=1, GC=2 };
-
-struct ThreadData
+static void poolFree(void* block, int idx)
 {
-    ThreadData() { for(int i = 0; i <= MAX_BIN; i++) bins[i][START] = bins[i][FREE] = bins[i][GC] = 0; }
-    ~ThreadData()
+    if( !usePool )
     {
-        // mark all the thread blocks as abandoned or even release them
-        for( int i = 0; i <= MAX_BIN; i++ )
-        {
-            Block *bin = bins[i][START], *block = bin;
-            bins[i][START] = bins[i][FREE] = bins[i][GC] = 0;
-            if( block )
-            {
-                do
-                {
-                    Block* next = block->next;
-                    int allocated = block->allocated;
-                    {
-                    AutoLock lock(block->cs);
-                    block->next = block->prev = 0;
-                    block->threadData = 0;
-                    Node *node = block->publicFreeList;
-                    for( ; node != 0; node = node->next )
-                        allocated--;
-                    }
-                    if( allocated == 0 )
-                        mallocPool.free(block);
-                    block = next;
-                }
-                while( block != bin );
-            }
-        }
+        free(block);
+        return;
     }
 
-    void moveBlockToFreeList( Block* block )
+    size_t size = classToSize(idx);
+
+    if( size <= MAX_THREAD_BLOCK_SIZE )
     {
-        int i = block->binIdx;
-        Block*& freePtr = bins[i][FREE];
-        CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-        if( block != freePtr )
+        ThreadCache* tc = getThreadCache();
+        AutoLock lock(tc->mutex);
+        if( tc->bytes + size <= MAX_THREAD_CACHE_SIZE )
         {
-            Block*& gcPtr = bins[i][GC];
-            if( gcPtr == block )
-                gcPtr = block->next;
-            if( block->next != block )
-            {
-                block->prev->next = block->next;
-                block->next->prev = block->prev;
-            }
-            block->next = freePtr->next;
-            block->prev = freePtr;
-            freePtr = block->next->prev = block->prev->next = block;
+            tc->lists[idx].push(block);
+            tc->bytes += size;
+            return;
         }
     }
 
-    Block* bins[MAX_BIN+1][3];
-
-#ifdef WIN32
-#ifdef WINCE
-#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
-#endif //WINCE
-
-    static DWORD tlsKey;
-    static ThreadData* get()
     {
-        ThreadData* data;
-        if( tlsKey == TLS_OUT_OF_INDEXES )
-            tlsKey = TlsAlloc();
-        data = (ThreadData*)TlsGetValue(tlsKey);
-        if( !data )
-        {
-            data = new ThreadData;
-            TlsSetValue(tlsKey, data);
-        }
-        return data;
-    }
-#else //WIN32
-    static void deleteData(void* data)
+    MallocPool& pool = getMallocPool();
+    AutoLock lock(pool.mutex);
+    if( pool.bytes + size <= MAX_GLOBAL_CACHE_SIZE )
     {
-        delete (ThreadData*)data;
+        pool.lists[idx].push(block);
+        pool.bytes += size;
+        return;
+    }
     }
 
-    static pthread_key_t tlsKey;
-    static ThreadData* get()
+    free(block);
+}
+
+void* fastMalloc( size_t size )
+{
+    size_t total = size + HEADER_SIZE + CV_MALLOC_ALIGN;
+    int idx = usePool ? sizeToClass(total) : (int)NO_CLASS;
+    uchar* udata = (uchar*)(idx != NO_CLASS ? poolAlloc(idx) : malloc(total));
+    if(!udata)
+        return OutOfMemoryError(size);
+    uchar** adata = alignPtr((uchar**)(udata + HEADER_SIZE), CV_MALLOC_ALIGN);
+    adata[-1] = udata;
+    adata[-2] = (uchar*)(ptrdiff_t)idx;
+    return adata;
+}
+
+void fastFree(void* ptr)
+{
+    if(ptr)
     {
-        ThreadData* data;
-        if( !tlsKey )
-            pthread_key_create(&tlsKey, deleteData);
-        data = (ThreadData*)pthread_getspecific(tlsKey);
-        if( !data )
-        {
-            data = new ThreadData;
-            pthread_setspecific(tlsKey, data);
-        }
-        return data;
+        uchar* udata = ((uchar**)ptr)[-1];
+        int idx = (int)(ptrdiff_t)((uchar**)ptr)[-2];
+        CV_DbgAssert(udata < (uchar*)ptr &&
+               ((uchar*)ptr - udata) <= (ptrdiff_t)(HEADER_SIZE+CV_MALLOC_ALIGN));
+        if( idx != NO_CLASS )
+            poolFree(udata, idx);
+        else
+            free(udata);
     }
-#endif //WIN32
-};
+}
 
-#ifdef WIN32
-DWORD ThreadData::tlsKey = TLS_OUT_OF_INDEXES;
+MallocStatistics::MallocStatistics() : hits(0), misses(0), cachedBytes(0) {}
 
-void deleteThreadAllocData()
+void setUsePooledMalloc(bool onoff)
 {
-    if( ThreadData::tlsKey != TLS_OUT_OF_INDEXES )
-        delete (ThreadData*)TlsGetValue( ThreadData::tlsKey );
+    usePool = onoff;
+    if( !onoff )
+        trimMallocPool();
 }
 
-#else //WIN32
-pthread_key_t ThreadData::tlsKey = 0;
-#endif //WIN32
+bool usePooledMalloc()
+{
+    return usePool;
+}
 
-#if 0
-static void checkList(ThreadData* tls, int idx)
+MallocStatistics getMallocStatistics()
 {
-    Block* block = tls->bins[idx][START];
-    if( !block )
+    MallocStatistics stat;
+    MallocPool& pool = getMallocPool();
+    AutoLock lock(pool.mutex);
+
+    stat.hits = pool.hits;
+    stat.misses = pool.misses;
+    stat.cachedBytes = pool.bytes;
+    for( ThreadCache* tc = pool.threads; tc != 0; tc = tc->next )
     {
-        CV_DbgAssert( tls->bins[idx][FREE] == 0 && tls->bins[idx][GC] == 0 );
+        AutoLock tlock(tc->mutex);
+        stat.hits += tc->hits;
+        stat.misses += tc->misses;
+        stat.cachedBytes += tc->bytes;
     }
-    else
+    return stat;
+}
+
+void trimMallocPool()
+{
+    MallocPool& pool = getMallocPool();
+    AutoLock lock(pool.mutex);
+
+    for( int idx = 0; idx < NCLASSES; idx++ )
+        releaseList(pool.lists[idx]);
+    pool.bytes = 0;
+
+    for( ThreadCache* tc = pool.threads; tc != 0; tc = tc->next )
     {
-        bool gcInside = false;
-        bool freeInside = false;
-        do
-        {
-            if( tls->bins[idx][FREE] == block )
-                freeInside = true;
-            if( tls->bins[idx][GC] == block )
-                gcInside = true;
-            block = block->next;
-        }
-        while( block != tls->bins[idx][START] );
-        CV_DbgAssert( gcInside && freeInside );
+        AutoLock tlock(tc->mutex);
+        for( int idx = 0; idx < NCLASSES; idx++ )
+            releaseList(tc->lists[idx]);
+        tc->bytes = 0;
     }
 }
-#else
-#define checkList(tls, idx)
-#endif
 
-void* fastMalloc( size_t size )
+
+////////////////////////////////// default matrix allocator //////////////////////////////////
+
+#if defined WIN32 || defined _WIN32
+static DWORD tlsMatAllocatorKey = TLS_OUT_OF_INDEXES;
+
+MatAllocator* getDefaultMatAllocator()
 {
-    if( size > MAX_BLOCK_SIZE )
+    if( tlsMatAllocatorKey == TLS_OUT_OF_INDEXES )
+        return 0;
+    return (MatAllocator*)TlsGetValue( tlsMatAllocatorKey );
+}
+
+static void setDefaultMatAllocator(MatAllocator* allocator)
+{
+    if( tlsMatAllocatorKey == TLS_OUT_OF_INDEXES )
     {
-        size_t size1 = size + sizeof(uchar*)*2 + MEM_BLOCK_SIZE;
-        uchar* udata = (uchar*)SystemAlloc(size1);
-        uchar** adata = alignPtr((uchar**)udata + 2, MEM_BLOCK_SIZE);
-        adata[-1] = udata;
-        adata[-2] = (uchar*)size1;
-        return adata;
+        tlsMatAllocatorKey = TlsAlloc();
+        CV_Assert(tlsMatAllocatorKey != TLS_OUT_OF_INDEXES);
     }
+    TlsSetValue( tlsMatAllocatorKey, allocator );
+}
+#else
+static pthread_key_t tlsMatAllocatorKey = 0;
+static pthread_once_t tlsMatAllocatorKeyOnce = PTHREAD_ONCE_INIT;
 
-    {
-    ThreadData* tls = ThreadData::get();
-    int idx = mallocTables.bin(size);
-    Block*& startPtr = tls->bins[idx][START];
-    Block*& gcPtr = tls->bins[idx][GC];
-    Block*& freePtr = tls->bins[idx][FREE], *block = freePtr;
-    checkList(tls, idx);
-    size = binSizeTab[idx];
-    STAT(
-        stat.nettoBytes += size;
-        stat.mallocCalls++;
-        );
-    uchar* data = 0;
-
-    for(;;)
-    {
-        if( block )
-        {
-            // try to find non-full block
-            for(;;)
-            {
-                CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-                if( block->bumpPtr )
-                {
-                    data = block->bumpPtr;
-                    if( (block->bumpPtr += size) >= block->endPtr )
-                        block->bumpPtr = 0;
-                    break;
-                }
+static void makeMatAllocatorKey()
+{
+    int errcode = pthread_key_create(&tlsMatAllocatorKey, 0);
+    CV_Assert(errcode == 0);
+}
 
-                if( block->privateFreeList )
-                {
-                    data = (uchar*)block->privateFreeList;
-                    block->privateFreeList = block->privateFreeList->next;
-                    break;
-                }
+MatAllocator* getDefaultMatAllocator()
+{
+    pthread_once(&tlsMatAllocatorKeyOnce, makeMatAllocatorKey);
+    return (MatAllocator*)pthread_getspecific(tlsMatAllocatorKey);
+}
 
-                if( block == startPtr )
-                    break;
-                block = block->next;
-            }
-#if 0
-            avg_k += _k;
-            avg_nk++;
-            if( avg_nk == 1000 )
-            {
-                printf("avg search iters per 1e3 allocs = %g\n", (double)avg_k/avg_nk );
-                avg_k = avg_nk = 0;
-            }
+static void setDefaultMatAllocator(MatAllocator* allocator)
+{
+    pthread_once(&tlsMatAllocatorKeyOnce, makeMatAllocatorKey);
+    pthread_setspecific(tlsMatAllocatorKey, allocator);
+}
 #endif
 
-            freePtr = block;
-            if( !data )
-            {
-                block = gcPtr;
-                for( int k = 0; k < 2; k++ )
-                {
-                    SANITY_CHECK(block);
-                    CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-                    if( block->publicFreeList )
-                    {
-                        {
-                        AutoLock lock(block->cs);
-                        block->privateFreeList = block->publicFreeList;
-                        block->publicFreeList = 0;
-                        }
-                        Node* node = block->privateFreeList;
-                        for(;node != 0; node = node->next)
-                            --block->allocated;
-                        data = (uchar*)block->privateFreeList;
-                        block->privateFreeList = block->privateFreeList->next;
-                        gcPtr = block->next;
-                        if( block->allocated+1 <= block->almostEmptyThreshold )
-                            tls->moveBlockToFreeList(block);
-                        break;
-                    }
-                    block = block->next;
-                }
-                if( !data )
-                    gcPtr = block;
-            }
-        }
-
-        if( data )
-            break;
-        block = mallocPool.alloc();
-        block->init(startPtr ? startPtr->prev : block, startPtr ? startPtr : block, (int)size, tls);
-        if( !startPtr )
-            startPtr = gcPtr = freePtr = block;
-        checkList(tls, block->binIdx);
-        SANITY_CHECK(block);
-    }
+MatAllocatorScope::MatAllocatorScope(MatAllocator* allocator)
+{
+    prevAllocator = getDefaultMatAllocator();
+    setDefaultMatAllocator(allocator);
+}
 
-    ++block->allocated;
-    return data;
-    }
+MatAllocatorScope::~MatAllocatorScope()
+{
+    setDefaultMatAllocator(prevAllocator);
 }
 
-void fastFree( void* ptr )
+
+struct MatArena::Impl
 {
-    if( ((size_t)ptr & (MEM_BLOCK_SIZE-1)) == 0 )
+    struct Block
     {
-        if( ptr != 0 )
+        uchar* data;
+        size_t size;
+    };
+
+    Impl(size_t _blockSize) : blockSize(_blockSize), current(0), offset(0), used(0), liveCount(0) {}
+    ~Impl() { freeBlocks(); }
+
+    uchar* alloc(size_t size)
+    {
+        size = alignSize(size, CV_MALLOC_ALIGN);
+        AutoLock lock(mutex);
+
+        for( ; current < blocks.size(); current++, offset = 0 )
+            if( offset + size <= blocks[current].size )
+                break;
+
+        if( current == blocks.size() )
         {
-            void* origPtr = ((void**)ptr)[-1];
-            size_t sz = (size_t)((void**)ptr)[-2];
-            SystemFree( origPtr, sz );
+            Block b;
+            b.size = std::max(blockSize, size);
+            b.data = (uchar*)fastMalloc(b.size);
+            blocks.push_back(b);
         }
-        return;
+
+        uchar* ptr = blocks[current].data + offset;
+        offset += size;
+        used += size;
+        liveCount++;
+        return ptr;
     }
 
+    size_t capacity() const
     {
-    ThreadData* tls = ThreadData::get();
-    Node* node = (Node*)ptr;
-    Block* block = (Block*)((size_t)ptr & -(int)MEM_BLOCK_SIZE);
-    assert( block->signature == MEM_BLOCK_SIGNATURE );
+        size_t total = 0;
+        for( size_t i = 0; i < blocks.size(); i++ )
+            total += blocks[i].size;
+        return total;
+    }
 
-    if( block->threadData == tls )
+    void freeBlocks()
     {
-        STAT(
-        stat.nettoBytes -= block->objSize;
-        stat.freeCalls++;
-        float ratio = (float)stat.nettoBytes/stat.bruttoBytes;
-        if( stat.minUsageRatio > ratio )
-            stat.minUsageRatio = ratio;
-        );
-
-        SANITY_CHECK(block);
-
-        bool prevFilled = block->isFilled();
-        --block->allocated;
-        if( !block->isFilled() && (block->allocated == 0 || prevFilled) )
-        {
-            if( block->allocated == 0 )
-            {
-                int idx = block->binIdx;
-                Block*& startPtr = tls->bins[idx][START];
-                Block*& freePtr = tls->bins[idx][FREE];
-                Block*& gcPtr = tls->bins[idx][GC];
-
-                if( block == block->next )
-                {
-                    CV_DbgAssert( startPtr == block && freePtr == block && gcPtr == block );
-                    startPtr = freePtr = gcPtr = 0;
-                }
-                else
-                {
-                    if( freePtr == block )
-                        freePtr = block->next;
-                    if( gcPtr == block )
-                        gcPtr = block->next;
-                    if( startPtr == block )
-                        startPtr = block->next;
-                    block->prev->next = block->next;
-                    block->next->prev = block->prev;
-                }
-                mallocPool.free(block);
-                checkList(tls, idx);
-                return;
-            }
-
-            tls->moveBlockToFreeList(block);
-        }
-        node->next = block->privateFreeList;
-        block->privateFreeList = node;
+        for( size_t i = 0; i < blocks.size(); i++ )
+            fastFree(blocks[i].data);
+        blocks.clear();
+        current = offset = used = 0;
     }
-    else
+
+    void checkReleased() const
     {
-        AutoLock lock(block->cs);
-        SANITY_CHECK(block);
+        if( liveCount != 0 )
+            CV_Error_(CV_StsError, ("%d matrices allocated from the arena are still in use", liveCount));
+    }
 
-        node->next = block->publicFreeList;
-        block->publicFreeList = node;
-        if( block->threadData == 0 )
-        {
-            // take ownership of the abandoned block.
-            // note that it can happen at the same time as
-            // ThreadData::deleteData() marks the blocks as abandoned,
-            // so this part of the algorithm needs to be checked for data races
-            int idx = block->binIdx;
-            block->threadData = tls;
-            Block*& startPtr = tls->bins[idx][START];
-
-            if( startPtr )
-            {
-                block->next = startPtr;
-                block->prev = startPtr->prev;
-                block->next->prev = block->prev->next = block;
-            }
-            else
-                startPtr = tls->bins[idx][FREE] = tls->bins[idx][GC] = block;
-        }
+    Mutex mutex;
+    std::vector<Block> blocks;
+    size_t blockSize;
+    size_t current, offset;
+    size_t used;
+    int liveCount;
+};
+
+MatArena::MatArena(size_t blockSize)
+{
+    impl = new Impl(std::max(blockSize, (size_t)CV_MALLOC_ALIGN));
+}
+
+MatArena::~MatArena()
+{
+    delete impl;
+}
+
+void MatArena::allocate(int dims, const int* sizes, int type, int*& refcount,
+                        uchar*& datastart, uchar*& data, size_t* step)
+{
+    size_t total = CV_ELEM_SIZE(type);
+    for( int i = dims-1; i >= 0; i-- )
+    {
+        step[i] = total;
+        total *= sizes[i];
     }
+
+    size_t totalsize = alignSize(total, (int)sizeof(*refcount));
+    datastart = data = impl->alloc(totalsize + sizeof(*refcount));
+    refcount = (int*)(data + totalsize);
+    *refcount = 1;
+}
+
+void MatArena::deallocate(int*, uchar*, uchar*)
+{
+    // the memory is reclaimed by reset()
+    AutoLock lock(impl->mutex);
+    impl->liveCount--;
+}
+
+void MatArena::reset()
+{
+    AutoLock lock(impl->mutex);
+    impl->checkReleased();
+
+    // the last cycle did not fit into one block; allocate a single block of the total size,
+    // so that the next cycles do not need to go to the heap
+    if( impl->blocks.size() > 1 )
+    {
+        size_t total = impl->capacity();
+        impl->freeBlocks();
+        Impl::Block b;
+        b.size = total;
+        b.data = (uchar*)fastMalloc(total);
+        impl->blocks.push_back(b);
     }
+    impl->current = impl->offset = impl->used = 0;
+}
+
+void MatArena::release()
+{
+    AutoLock lock(impl->mutex);
+    impl->checkReleased();
+    impl->freeBlocks();
 }
 
-#endif //CV_USE_SYSTEM_MALLOC
+size_t MatArena::allocatedBytes() const
+{
+    AutoLock lock(impl->mutex);
+    return impl->used;
+}
+
+size_t MatArena::capacity() const
+{
+    AutoLock lock(impl->mutex);
+    return impl->capacity();
+}
 
 }
 
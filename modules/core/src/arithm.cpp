@@ -63,8 +63,119 @@ struct IPPArithmInitializer
 IPPArithmInitializer ippArithmInitializer;
 #endif
 
+int getElemwiseNStripes(size_t size)
+{
+    if( size < (size_t)ELEMWISE_PARALLEL_MIN_SIZE )
+        return 1;
+    int nthreads = getNumThreads();
+    if( nthreads <= 1 )
+        return 1;
+    return (int)std::min(size/ELEMWISE_PARALLEL_STRIPE_SIZE, (size_t)nthreads*4);
+}
+
+class BinaryFuncInvoker : public ParallelLoopBody
+{
+public:
+    // columns of single-row regions are handed out in groups of BLOCK_COLS
+    // to keep the stripe boundaries aligned
+    enum { BLOCK_COLS = 64 };
+
+    BinaryFuncInvoker(BinaryFunc _func, const uchar* _src1, size_t _step1, size_t _esz1,
+                      const uchar* _src2, size_t _step2, size_t _esz2,
+                      uchar* _dst, size_t _step, size_t _esz, Size _sz, void* _usrdata) :
+        func(_func), src1(_src1), step1(_step1), esz1(_esz1), src2(_src2), step2(_step2), esz2(_esz2),
+        dst(_dst), step(_step), esz(_esz), sz(_sz), usrdata(_usrdata)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        if( sz.height > 1 )
+        {
+            int y = range.start;
+            func(src1 + step1*y, step1, src2 ? src2 + step2*y : 0, step2,
+                 dst + step*y, step, Size(sz.width, range.end - range.start), usrdata);
+        }
+        else
+        {
+            int x = range.start*BLOCK_COLS, x1 = std::min(range.end*BLOCK_COLS, sz.width);
+            func(src1 + esz1*x, step1, src2 ? src2 + esz2*x : 0, step2,
+                 dst + esz*x, step, Size(x1 - x, 1), usrdata);
+        }
+    }
+
+    int total() const { return sz.height > 1 ? sz.height : (sz.width + BLOCK_COLS - 1)/BLOCK_COLS; }
+
+private:
+    BinaryFunc func;
+    const uchar* src1;
+    size_t step1, esz1;
+    const uchar* src2;
+    size_t step2, esz2;
+    uchar* dst;
+    size_t step, esz;
+    Size sz;
+    void* usrdata;
+};
+
+void parallelBinaryFunc(BinaryFunc func, const uchar* src1, size_t step1, size_t esz1,
+                        const uchar* src2, size_t step2, size_t esz2,
+                        uchar* dst, size_t step, size_t esz, Size sz, void* usrdata)
+{
+    int nstripes = getElemwiseNStripes((size_t)sz.width*sz.height*(esz1 + (src2 ? esz2 : 0) + esz));
+    if( nstripes > 1 )
+    {
+        BinaryFuncInvoker invoker(func, src1, step1, esz1, src2, step2, esz2, dst, step, esz, sz, usrdata);
+        parallel_for_(Range(0, invoker.total()), invoker, nstripes);
+    }
+    else
+        func(src1, step1, src2, step2, dst, step, sz, usrdata);
+}
+
 struct NOP {};
 
+#if CV_AVX2_DISPATCH
+
+// maps the SSE2 functors below to their 256-bit counterparts; NOP means there is no AVX2 variant
+template<class VOp> struct VAVX2Op { typedef NOP type; };
+
+template<typename T> static inline CV_AVX2_TARGET __m256i v256_load(const T* p)
+{ return _mm256_loadu_si256((const __m256i*)p); }
+static inline CV_AVX2_TARGET __m256 v256_load(const float* p) { return _mm256_loadu_ps(p); }
+static inline CV_AVX2_TARGET __m256d v256_load(const double* p) { return _mm256_loadu_pd(p); }
+
+template<typename T> static inline CV_AVX2_TARGET void v256_store(T* p, const __m256i& v)
+{ _mm256_storeu_si256((__m256i*)p, v); }
+static inline CV_AVX2_TARGET void v256_store(float* p, const __m256& v) { _mm256_storeu_ps(p, v); }
+static inline CV_AVX2_TARGET void v256_store(double* p, const __m256d& v) { _mm256_storeu_pd(p, v); }
+
+// processes the longest prefix of the row that fits into 256-bit registers, returns its length
+template<typename T, class VOp256> struct VBinOpRowAVX2
+{
+    CV_AVX2_TARGET int operator()(const T* src1, const T* src2, T* dst, int width) const
+    {
+        const int N = (int)(32/sizeof(T));
+        VOp256 op;
+        int x = 0;
+
+        for( ; x <= width - N*2; x += N*2 )
+        {
+            v256_store(dst + x, op(v256_load(src1 + x), v256_load(src2 + x)));
+            v256_store(dst + x + N, op(v256_load(src1 + x + N), v256_load(src2 + x + N)));
+        }
+        for( ; x <= width - N; x += N )
+            v256_store(dst + x, op(v256_load(src1 + x), v256_load(src2 + x)));
+        return x;
+    }
+};
+
+template<typename T> struct VBinOpRowAVX2<T, NOP>
+{
+    int operator()(const T*, const T*, T*, int) const { return 0; }
+};
+
+#endif
+
 template<typename T, class Op, class Op8>
 void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, size_t step, Size sz)
 {
@@ -72,6 +183,10 @@ void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, s
     Op8 op8;
 #endif
     Op op;
+#if CV_AVX2_DISPATCH
+    VBinOpRowAVX2<T, typename VAVX2Op<Op8>::type> opAVX2;
+    bool useAVX2 = USE_AVX2;
+#endif
 
     for( ; sz.height--; src1 += step1/sizeof(src1[0]),
                         src2 += step2/sizeof(src2[0]),
@@ -79,6 +194,11 @@ void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, s
     {
         int x = 0;
 
+    #if CV_AVX2_DISPATCH
+        if( useAVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -123,6 +243,10 @@ void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
     Op16 op16;
 #endif
     Op op;
+#if CV_AVX2_DISPATCH
+    VBinOpRowAVX2<T, typename VAVX2Op<Op16>::type> opAVX2;
+    bool useAVX2 = USE_AVX2;
+#endif
 
     for( ; sz.height--; src1 += step1/sizeof(src1[0]),
         src2 += step2/sizeof(src2[0]),
@@ -130,6 +254,11 @@ void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
     {
         int x = 0;
 
+    #if CV_AVX2_DISPATCH
+        if( useAVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -176,6 +305,10 @@ void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
     Op32 op32;
 #endif
     Op op;
+#if CV_AVX2_DISPATCH
+    VBinOpRowAVX2<int, typename VAVX2Op<Op32>::type> opAVX2;
+    bool useAVX2 = USE_AVX2;
+#endif
 
     for( ; sz.height--; src1 += step1/sizeof(src1[0]),
         src2 += step2/sizeof(src2[0]),
@@ -183,6 +316,11 @@ void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
     {
         int x = 0;
 
+    #if CV_AVX2_DISPATCH
+        if( useAVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
 #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -233,6 +371,10 @@ void vBinOp32f(const float* src1, size_t step1, const float* src2, size_t step2,
     Op32 op32;
 #endif
     Op op;
+#if CV_AVX2_DISPATCH
+    VBinOpRowAVX2<float, typename VAVX2Op<Op32>::type> opAVX2;
+    bool useAVX2 = USE_AVX2;
+#endif
 
     for( ; sz.height--; src1 += step1/sizeof(src1[0]),
         src2 += step2/sizeof(src2[0]),
@@ -240,6 +382,11 @@ void vBinOp32f(const float* src1, size_t step1, const float* src2, size_t step2,
     {
         int x = 0;
 
+    #if CV_AVX2_DISPATCH
+        if( useAVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -289,6 +436,10 @@ void vBinOp64f(const double* src1, size_t step1, const double* src2, size_t step
     Op64 op64;
 #endif
     Op op;
+#if CV_AVX2_DISPATCH
+    VBinOpRowAVX2<double, typename VAVX2Op<Op64>::type> opAVX2;
+    bool useAVX2 = USE_AVX2;
+#endif
 
     for( ; sz.height--; src1 += step1/sizeof(src1[0]),
         src2 += step2/sizeof(src2[0]),
@@ -296,6 +447,11 @@ void vBinOp64f(const double* src1, size_t step1, const double* src2, size_t step
     {
         int x = 0;
 
+    #if CV_AVX2_DISPATCH
+        if( useAVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 && (((size_t)src1|(size_t)src2|(size_t)dst)&15) == 0 )
             for( ; x <= sz.width - 4; x += 4 )
@@ -457,6 +613,80 @@ struct _VNot8u { __m128i operator()(const __m128i& a, const __m128i&) const { re
 
 #endif
 
+#if CV_AVX2_DISPATCH
+
+#define CV_DEF_AVX2_OP(name, expr) \
+struct _V##name##_AVX2 \
+{ \
+    CV_AVX2_TARGET __m256i operator()(const __m256i& a, const __m256i& b) const { return expr; } \
+}; \
+template<> struct VAVX2Op<_V##name> { typedef _V##name##_AVX2 type; }
+
+#define CV_DEF_AVX2_FP_OP(name, vtype, expr) \
+struct _V##name##_AVX2 \
+{ \
+    CV_AVX2_TARGET vtype operator()(const vtype& a, const vtype& b) const { return expr; } \
+}; \
+template<> struct VAVX2Op<_V##name> { typedef _V##name##_AVX2 type; }
+
+CV_DEF_AVX2_OP(Add8u, _mm256_adds_epu8(a, b));
+CV_DEF_AVX2_OP(Sub8u, _mm256_subs_epu8(a, b));
+CV_DEF_AVX2_OP(Min8u, _mm256_min_epu8(a, b));
+CV_DEF_AVX2_OP(Max8u, _mm256_max_epu8(a, b));
+CV_DEF_AVX2_OP(AbsDiff8u, _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)));
+
+CV_DEF_AVX2_OP(Add8s, _mm256_adds_epi8(a, b));
+CV_DEF_AVX2_OP(Sub8s, _mm256_subs_epi8(a, b));
+CV_DEF_AVX2_OP(Min8s, _mm256_min_epi8(a, b));
+CV_DEF_AVX2_OP(Max8s, _mm256_max_epi8(a, b));
+CV_DEF_AVX2_OP(AbsDiff8s, _mm256_subs_epi8(_mm256_xor_si256(_mm256_subs_epi8(a, b), _mm256_cmpgt_epi8(b, a)),
+                                           _mm256_cmpgt_epi8(b, a)));
+
+CV_DEF_AVX2_OP(Add16u, _mm256_adds_epu16(a, b));
+CV_DEF_AVX2_OP(Sub16u, _mm256_subs_epu16(a, b));
+CV_DEF_AVX2_OP(Min16u, _mm256_min_epu16(a, b));
+CV_DEF_AVX2_OP(Max16u, _mm256_max_epu16(a, b));
+CV_DEF_AVX2_OP(AbsDiff16u, _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a)));
+
+CV_DEF_AVX2_OP(Add16s, _mm256_adds_epi16(a, b));
+CV_DEF_AVX2_OP(Sub16s, _mm256_subs_epi16(a, b));
+CV_DEF_AVX2_OP(Min16s, _mm256_min_epi16(a, b));
+CV_DEF_AVX2_OP(Max16s, _mm256_max_epi16(a, b));
+CV_DEF_AVX2_OP(AbsDiff16s, _mm256_subs_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b)));
+
+CV_DEF_AVX2_OP(Add32s, _mm256_add_epi32(a, b));
+CV_DEF_AVX2_OP(Sub32s, _mm256_sub_epi32(a, b));
+CV_DEF_AVX2_OP(Min32s, _mm256_min_epi32(a, b));
+CV_DEF_AVX2_OP(Max32s, _mm256_max_epi32(a, b));
+CV_DEF_AVX2_OP(AbsDiff32s, _mm256_sub_epi32(_mm256_max_epi32(a, b), _mm256_min_epi32(a, b)));
+
+CV_DEF_AVX2_FP_OP(Add32f, __m256, _mm256_add_ps(a, b));
+CV_DEF_AVX2_FP_OP(Sub32f, __m256, _mm256_sub_ps(a, b));
+CV_DEF_AVX2_FP_OP(Min32f, __m256, _mm256_min_ps(a, b));
+CV_DEF_AVX2_FP_OP(Max32f, __m256, _mm256_max_ps(a, b));
+CV_DEF_AVX2_FP_OP(AbsDiff32f, __m256, _mm256_andnot_ps(_mm256_set1_ps(-0.f), _mm256_sub_ps(a, b)));
+
+CV_DEF_AVX2_FP_OP(Add64f, __m256d, _mm256_add_pd(a, b));
+CV_DEF_AVX2_FP_OP(Sub64f, __m256d, _mm256_sub_pd(a, b));
+CV_DEF_AVX2_FP_OP(Min64f, __m256d, _mm256_min_pd(a, b));
+CV_DEF_AVX2_FP_OP(Max64f, __m256d, _mm256_max_pd(a, b));
+CV_DEF_AVX2_FP_OP(AbsDiff64f, __m256d, _mm256_andnot_pd(_mm256_set1_pd(-0.), _mm256_sub_pd(a, b)));
+
+CV_DEF_AVX2_OP(And8u, _mm256_and_si256(a, b));
+CV_DEF_AVX2_OP(Or8u, _mm256_or_si256(a, b));
+CV_DEF_AVX2_OP(Xor8u, _mm256_xor_si256(a, b));
+struct _VNot8u_AVX2
+{
+    CV_AVX2_TARGET __m256i operator()(const __m256i& a, const __m256i&) const
+    { return _mm256_xor_si256(_mm256_set1_epi32(-1), a); }
+};
+template<> struct VAVX2Op<_VNot8u> { typedef _VNot8u_AVX2 type; };
+
+#undef CV_DEF_AVX2_OP
+#undef CV_DEF_AVX2_FP_OP
+
+#endif
+
 #if CV_SSE2
 #define IF_SIMD(op) op
 #else
@@ -1003,8 +1233,10 @@ static void binary_op(InputArray _src1, InputArray _src2, OutputArray _dst,
         size_t len = sz.width*(size_t)c;
         if( len == (size_t)(int)len )
         {
+            size_t esz = bitwise ? 1 : src1.elemSize1();
             sz.width = (int)len;
-            func(src1.data, src1.step, src2.data, src2.step, dst.data, dst.step, sz, 0);
+            parallelBinaryFunc(func, src1.data, src1.step, esz, src2.data, src2.step, esz,
+                               dst.data, dst.step, esz, sz, 0);
             return;
         }
     }
@@ -1255,7 +1487,9 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
         _dst.create(src1.size(), src1.type());
         Mat dst = _dst.getMat();
         Size sz = getContinuousSize(src1, src2, dst, src1.channels());
-        tab[src1.depth()](src1.data, src1.step, src2.data, src2.step, dst.data, dst.step, sz, usrdata);
+        size_t esz = src1.elemSize1();
+        parallelBinaryFunc(tab[src1.depth()], src1.data, src1.step, esz, src2.data, src2.step, esz,
+                           dst.data, dst.step, esz, sz, usrdata);
         return;
     }
 
@@ -2348,7 +2582,9 @@ void cv::compare(InputArray _src1, InputArray _src2, OutputArray _dst, int op)
         _dst.create(src1.size(), CV_8UC(cn));
         Mat dst = _dst.getMat();
         Size sz = getContinuousSize(src1, src2, dst, src1.channels());
-        cmpTab[src1.depth()](src1.data, src1.step, src2.data, src2.step, dst.data, dst.step, sz, &op);
+        size_t esz = src1.elemSize1();
+        parallelBinaryFunc(cmpTab[src1.depth()], src1.data, src1.step, esz, src2.data, src2.step, esz,
+                           dst.data, dst.step, 1, sz, &op);
         return;
     }
 
@@ -208,15 +208,13 @@ static MergeFunc mergeTab[] =
 
 }
 
-void cv::split(const Mat& src, Mat* mv)
+namespace cv
 {
-    int k, depth = src.depth(), cn = src.channels();
-    if( cn == 1 )
-    {
-        src.copyTo(mv[0]);
-        return;
-    }
 
+// mv[k] must be already allocated
+static void splitImpl(const Mat& src, Mat* mv)
+{
+    int k, depth = src.depth(), cn = src.channels();
     SplitFunc func = splitTab[depth];
     CV_Assert( func != 0 );
 
@@ -228,10 +226,7 @@ void cv::split(const Mat& src, Mat* mv)
 
     arrays[0] = &src;
     for( k = 0; k < cn; k++ )
-    {
-        mv[k].create(src.dims, src.size, depth);
         arrays[k+1] = &mv[k];
-    }
 
     NAryMatIterator it(arrays, ptrs, cn+1);
     int total = (int)it.size, blocksize = cn <= 4 ? total : std::min(total, blocksize0);
@@ -253,6 +248,46 @@ void cv::split(const Mat& src, Mat* mv)
     }
 }
 
+class SplitInvoker : public ParallelLoopBody
+{
+public:
+    SplitInvoker(const Mat& _src, Mat* _mv) : src(_src), mv(_mv) {}
+
+    void operator()(const Range& range) const
+    {
+        int cn = src.channels();
+        AutoBuffer<Mat> dst(cn);
+        for( int k = 0; k < cn; k++ )
+            dst[k] = getElemwiseStripe(mv[k], range);
+        splitImpl(getElemwiseStripe(src, range), dst);
+    }
+
+private:
+    Mat src;
+    Mat* mv;
+};
+
+}
+
+void cv::split(const Mat& src, Mat* mv)
+{
+    int k, depth = src.depth(), cn = src.channels();
+    if( cn == 1 )
+    {
+        src.copyTo(mv[0]);
+        return;
+    }
+
+    for( k = 0; k < cn; k++ )
+        mv[k].create(src.dims, src.size, depth);
+
+    int nstripes = src.dims <= 2 ? getElemwiseNStripes(src.total()*src.elemSize()*2) : 1;
+    if( nstripes > 1 )
+        parallel_for_(Range(0, getElemwiseRange(src)), SplitInvoker(src, mv), nstripes);
+    else
+        splitImpl(src, mv);
+}
+
 void cv::split(InputArray _m, OutputArrayOfArrays _mv)
 {
     Mat m = _m.getMat();
@@ -267,6 +302,66 @@ void cv::split(InputArray _m, OutputArrayOfArrays _mv)
     split(m, dst);
 }
 
+namespace cv
+{
+
+// mv[] are single-channel arrays, one per channel of dst
+static void mergeImpl(const Mat* mv, Mat& dst)
+{
+    int k, cn = dst.channels();
+    size_t esz = dst.elemSize(), esz1 = dst.elemSize1();
+    int blocksize0 = (int)((BLOCK_SIZE + esz-1)/esz);
+    AutoBuffer<uchar> _buf((cn+1)*(sizeof(Mat*) + sizeof(uchar*)) + 16);
+    const Mat** arrays = (const Mat**)(uchar*)_buf;
+    uchar** ptrs = (uchar**)alignPtr(arrays + cn + 1, 16);
+
+    arrays[0] = &dst;
+    for( k = 0; k < cn; k++ )
+        arrays[k+1] = &mv[k];
+
+    NAryMatIterator it(arrays, ptrs, cn+1);
+    int total = (int)it.size, blocksize = cn <= 4 ? total : std::min(total, blocksize0);
+    MergeFunc func = mergeTab[dst.depth()];
+
+    for( size_t i = 0; i < it.nplanes; i++, ++it )
+    {
+        for( int j = 0; j < total; j += blocksize )
+        {
+            int bsz = std::min(total - j, blocksize);
+            func( (const uchar**)&ptrs[1], ptrs[0], bsz, cn );
+
+            if( j + blocksize < total )
+            {
+                ptrs[0] += bsz*esz;
+                for( int t = 0; t < cn; t++ )
+                    ptrs[t+1] += bsz*esz1;
+            }
+        }
+    }
+}
+
+class MergeInvoker : public ParallelLoopBody
+{
+public:
+    MergeInvoker(const Mat* _mv, const Mat& _dst) : mv(_mv), dst(_dst) {}
+
+    void operator()(const Range& range) const
+    {
+        int cn = dst.channels();
+        AutoBuffer<Mat> src(cn);
+        for( int k = 0; k < cn; k++ )
+            src[k] = getElemwiseStripe(mv[k], range);
+        Mat dstripe = getElemwiseStripe(dst, range);
+        mergeImpl(src, dstripe);
+    }
+
+private:
+    const Mat* mv;
+    Mat dst;
+};
+
+}
+
 void cv::merge(const Mat* mv, size_t n, OutputArray _dst)
 {
     CV_Assert( mv && n > 0 );
@@ -311,35 +406,11 @@ void cv::merge(const Mat* mv, size_t n, OutputArray _dst)
         return;
     }
 
-    size_t esz = dst.elemSize(), esz1 = dst.elemSize1();
-    int blocksize0 = (int)((BLOCK_SIZE + esz-1)/esz);
-    AutoBuffer<uchar> _buf((cn+1)*(sizeof(Mat*) + sizeof(uchar*)) + 16);
-    const Mat** arrays = (const Mat**)(uchar*)_buf;
-    uchar** ptrs = (uchar**)alignPtr(arrays + cn + 1, 16);
-
-    arrays[0] = &dst;
-    for( k = 0; k < cn; k++ )
-        arrays[k+1] = &mv[k];
-
-    NAryMatIterator it(arrays, ptrs, cn+1);
-    int total = (int)it.size, blocksize = cn <= 4 ? total : std::min(total, blocksize0);
-    MergeFunc func = mergeTab[depth];
-
-    for( i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( int j = 0; j < total; j += blocksize )
-        {
-            int bsz = std::min(total - j, blocksize);
-            func( (const uchar**)&ptrs[1], ptrs[0], bsz, cn );
-
-            if( j + blocksize < total )
-            {
-                ptrs[0] += bsz*esz;
-                for( int t = 0; t < cn; t++ )
-                    ptrs[t+1] += bsz*esz1;
-            }
-        }
-    }
+    int nstripes = dst.dims <= 2 ? getElemwiseNStripes(dst.total()*dst.elemSize()*2) : 1;
+    if( nstripes > 1 )
+        parallel_for_(Range(0, getElemwiseRange(dst)), MergeInvoker(mv, dst), nstripes);
+    else
+        mergeImpl(mv, dst);
 }
 
 void cv::merge(InputArrayOfArrays _mv, OutputArray _dst)
@@ -428,12 +499,11 @@ static MixChannelsFunc mixchTab[] =
 
 }
 
-void cv::mixChannels( const Mat* src, size_t nsrcs, Mat* dst, size_t ndsts, const int* fromTo, size_t npairs )
+namespace cv
 {
-    if( npairs == 0 )
-        return;
-    CV_Assert( src && nsrcs > 0 && dst && ndsts > 0 && fromTo && npairs > 0 );
 
+static void mixChannelsImpl( const Mat* src, size_t nsrcs, Mat* dst, size_t ndsts, const int* fromTo, size_t npairs )
+{
     size_t i, j, k, esz1 = dst[0].elemSize1();
     int depth = dst[0].depth();
 
@@ -504,6 +574,59 @@ void cv::mixChannels( const Mat* src, size_t nsrcs, Mat* dst, size_t ndsts, cons
     }
 }
 
+class MixChannelsInvoker : public ParallelLoopBody
+{
+public:
+    MixChannelsInvoker(const Mat* _src, size_t _nsrcs, Mat* _dst, size_t _ndsts, const int* _fromTo, size_t _npairs) :
+        src(_src), nsrcs(_nsrcs), dst(_dst), ndsts(_ndsts), fromTo(_fromTo), npairs(_npairs)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        AutoBuffer<Mat> buf(nsrcs + ndsts);
+        size_t i;
+        for( i = 0; i < nsrcs; i++ )
+            buf[i] = getElemwiseStripe(src[i], range);
+        for( i = 0; i < ndsts; i++ )
+            buf[nsrcs + i] = getElemwiseStripe(dst[i], range);
+        mixChannelsImpl(buf, nsrcs, buf + nsrcs, ndsts, fromTo, npairs);
+    }
+
+private:
+    const Mat* src;
+    size_t nsrcs;
+    Mat* dst;
+    size_t ndsts;
+    const int* fromTo;
+    size_t npairs;
+};
+
+}
+
+void cv::mixChannels( const Mat* src, size_t nsrcs, Mat* dst, size_t ndsts, const int* fromTo, size_t npairs )
+{
+    if( npairs == 0 )
+        return;
+    CV_Assert( src && nsrcs > 0 && dst && ndsts > 0 && fromTo && npairs > 0 );
+
+    bool is2d = true;
+    size_t i;
+    for( i = 0; i < nsrcs; i++ )
+        is2d = is2d && src[i].dims <= 2 && src[i].size() == dst[0].size();
+    for( i = 0; i < ndsts; i++ )
+        is2d = is2d && dst[i].dims <= 2 && dst[i].size() == dst[0].size();
+
+    // every pair reads and writes one channel of each pixel
+    size_t total = dst[0].total()*dst[0].elemSize1()*npairs*2;
+    int nstripes = is2d ? getElemwiseNStripes(total) : 1;
+    if( nstripes > 1 )
+        parallel_for_(Range(0, getElemwiseRange(dst[0])),
+                      MixChannelsInvoker(src, nsrcs, dst, ndsts, fromTo, npairs), nstripes);
+    else
+        mixChannelsImpl(src, nsrcs, dst, ndsts, fromTo, npairs);
+}
+
 
 void cv::mixChannels(const std::vector<Mat>& src, std::vector<Mat>& dst,
                  const int* fromTo, size_t npairs)
@@ -561,6 +684,135 @@ void cv::insertChannel(InputArray _src, InputOutputArray _dst, int coi)
 namespace cv
 {
 
+#if CV_AVX2_DISPATCH
+
+// GCC contracts a*b + c into an FMA instruction inside the avx2,fma target functions; the product
+// would not be rounded then, and the result would differ from the scalar code
+#if defined __GNUC__ && !defined __clang__
+#pragma GCC push_options
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+// loads 8 elements as floats / stores 8 floats with rounding and saturation
+template<typename T> struct VCvtAVX2
+{
+    enum { supported = 0, exact = 0 };
+    static CV_AVX2_TARGET __m256 load(const T*) { return _mm256_setzero_ps(); }
+    static CV_AVX2_TARGET void store(T*, const __m256&) {}
+};
+
+template<> struct VCvtAVX2<uchar>
+{
+    enum { supported = 1, exact = 1 };
+    static CV_AVX2_TARGET __m256 load(const uchar* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+    static CV_AVX2_TARGET void store(uchar* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+        _mm_storel_epi64((__m128i*)p, _mm_packus_epi16(w, w));
+    }
+};
+
+template<> struct VCvtAVX2<schar>
+{
+    enum { supported = 1, exact = 1 };
+    static CV_AVX2_TARGET __m256 load(const schar* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)p))); }
+    static CV_AVX2_TARGET void store(schar* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+        _mm_storel_epi64((__m128i*)p, _mm_packs_epi16(w, w));
+    }
+};
+
+template<> struct VCvtAVX2<ushort>
+{
+    enum { supported = 1, exact = 1 };
+    static CV_AVX2_TARGET __m256 load(const ushort* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+    static CV_AVX2_TARGET void store(ushort* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        _mm_storeu_si128((__m128i*)p, _mm_packus_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+    }
+};
+
+template<> struct VCvtAVX2<short>
+{
+    enum { supported = 1, exact = 1 };
+    static CV_AVX2_TARGET __m256 load(const short* p)
+    { return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)p))); }
+    static CV_AVX2_TARGET void store(short* p, const __m256& v)
+    {
+        __m256i i = _mm256_cvtps_epi32(v);
+        _mm_storeu_si128((__m128i*)p, _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+    }
+};
+
+// int -> float is not exact for large values, so plain conversions from 32s stay scalar
+template<> struct VCvtAVX2<int>
+{
+    enum { supported = 1, exact = 0 };
+    static CV_AVX2_TARGET __m256 load(const int* p)
+    { return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p)); }
+    static CV_AVX2_TARGET void store(int* p, const __m256& v)
+    { _mm256_storeu_si256((__m256i*)p, _mm256_cvtps_epi32(v)); }
+};
+
+template<> struct VCvtAVX2<float>
+{
+    enum { supported = 1, exact = 1 };
+    static CV_AVX2_TARGET __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+    static CV_AVX2_TARGET void store(float* p, const __m256& v) { _mm256_storeu_ps(p, v); }
+};
+
+// dst[x] = saturate_cast<DT>(src[x]*scale + shift) for the longest prefix of the row
+// that is a multiple of 8; the result matches the scalar code bit by bit
+template<typename T, typename DT, typename WT> struct VCvtScaleAVX2
+{
+    int operator()(const T*, DT*, int, WT, WT) const { return 0; }
+};
+
+template<typename T, typename DT> struct VCvtScaleAVX2<T, DT, float>
+{
+    CV_AVX2_TARGET int operator()(const T* src, DT* dst, int width, float scale, float shift) const
+    {
+        int x = 0;
+        if( !VCvtAVX2<T>::supported || !VCvtAVX2<DT>::supported )
+            return x;
+
+        __m256 vscale = _mm256_set1_ps(scale), vshift = _mm256_set1_ps(shift);
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m256 v = _mm256_add_ps(_mm256_mul_ps(VCvtAVX2<T>::load(src + x), vscale), vshift);
+            VCvtAVX2<DT>::store(dst + x, v);
+        }
+        return x;
+    }
+};
+
+template<typename T, typename DT> struct VCvtAVX2Row
+{
+    CV_AVX2_TARGET int operator()(const T* src, DT* dst, int width) const
+    {
+        int x = 0;
+        if( !VCvtAVX2<T>::exact || !VCvtAVX2<DT>::supported )
+            return x;
+
+        for( ; x <= width - 8; x += 8 )
+            VCvtAVX2<DT>::store(dst + x, VCvtAVX2<T>::load(src + x));
+        return x;
+    }
+};
+
+#if defined __GNUC__ && !defined __clang__
+#pragma GCC pop_options
+#endif
+
+#endif
+
 template<typename T, typename DT, typename WT> static void
 cvtScaleAbs_( const T* src, size_t sstep,
               DT* dst, size_t dstep, Size size,
@@ -598,9 +850,18 @@ cvtScale_( const T* src, size_t sstep,
     sstep /= sizeof(src[0]);
     dstep /= sizeof(dst[0]);
 
+#if CV_AVX2_DISPATCH
+    VCvtScaleAVX2<T, DT, WT> vop;
+    bool useAVX2 = USE_AVX2;
+#endif
+
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #if CV_AVX2_DISPATCH
+        if( useAVX2 )
+            x = vop(src, dst, size.width, scale, shift);
+        #endif
         #if CV_ENABLE_UNROLLED
         for( ; x <= size.width - 4; x += 4 )
         {
@@ -631,6 +892,10 @@ cvtScale_<short, short, float>( const short* src, size_t sstep,
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #if CV_AVX2_DISPATCH
+            if(USE_AVX2)
+                x = VCvtScaleAVX2<short, short, float>()(src, dst, size.width, scale, shift);
+        #endif
         #if CV_SSE2
             if(USE_SSE2)
             {
@@ -669,6 +934,10 @@ cvtScale_<short, int, float>( const short* src, size_t sstep,
     {
         int x = 0;
 
+        #if CV_AVX2_DISPATCH
+            if(USE_AVX2)
+                x = VCvtScaleAVX2<short, int, float>()(src, dst, size.width, scale, shift);
+        #endif
          #if CV_SSE2
             if(USE_SSE2)//~5X
             {
@@ -691,23 +960,6 @@ cvtScale_<short, int, float>( const short* src, size_t sstep,
             }
         #endif
 
-        //We will wait Haswell
-        /*
-        #if CV_AVX
-            if(USE_AVX)//2X - bad variant
-            {
-                ////TODO:AVX implementation (optimization?) required
-                __m256 scale256 = _mm256_set1_ps (scale);
-                __m256 shift256 = _mm256_set1_ps (shift);
-                for(; x <= size.width - 8; x += 8 )
-                {
-                    __m256i buf = _mm256_set_epi32((int)(*(src+x+7)),(int)(*(src+x+6)),(int)(*(src+x+5)),(int)(*(src+x+4)),(int)(*(src+x+3)),(int)(*(src+x+2)),(int)(*(src+x+1)),(int)(*(src+x)));
-                    __m256 r0 = _mm256_add_ps( _mm256_mul_ps(_mm256_cvtepi32_ps (buf), scale256), shift256);
-                    __m256i res = _mm256_cvtps_epi32(r0);
-                    _mm256_storeu_si256 ((__m256i*)(dst+x), res);
-                }
-            }
-        #endif*/
 
         for(; x < size.width; x++ )
             dst[x] = saturate_cast<int>(src[x]*scale + shift);
@@ -721,9 +973,18 @@ cvt_( const T* src, size_t sstep,
     sstep /= sizeof(src[0]);
     dstep /= sizeof(dst[0]);
 
+#if CV_AVX2_DISPATCH
+    VCvtAVX2Row<T, DT> vop;
+    bool useAVX2 = USE_AVX2;
+#endif
+
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #if CV_AVX2_DISPATCH
+        if( useAVX2 )
+            x = vop(src, dst, size.width);
+        #endif
         #if CV_ENABLE_UNROLLED
         for( ; x <= size.width - 4; x += 4 )
         {
@@ -752,6 +1013,10 @@ cvt_<float, short>( const float* src, size_t sstep,
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #if CV_AVX2_DISPATCH
+        if(USE_AVX2)
+            x = VCvtAVX2Row<float, short>()(src, dst, size.width);
+        #endif
         #if   CV_SSE2
         if(USE_SSE2){
               for( ; x <= size.width - 8; x += 8 )
@@ -1047,7 +1312,8 @@ void cv::convertScaleAbs( InputArray _src, OutputArray _dst, double alpha, doubl
     if( src.dims <= 2 )
     {
         Size sz = getContinuousSize(src, dst, cn);
-        func( src.data, src.step, 0, 0, dst.data, dst.step, sz, scale );
+        parallelBinaryFunc(func, src.data, src.step, src.elemSize1(), 0, 0, 0,
+                           dst.data, dst.step, dst.elemSize1(), sz, scale);
     }
     else
     {
@@ -1089,7 +1355,8 @@ void cv::Mat::convertTo(OutputArray _dst, int _type, double alpha, double beta)
         _dst.create( size(), _type );
         Mat dst = _dst.getMat();
         Size sz = getContinuousSize(src, dst, cn);
-        func( src.data, src.step, 0, 0, dst.data, dst.step, sz, scale );
+        parallelBinaryFunc(func, src.data, src.step, src.elemSize1(), 0, 0, 0,
+                           dst.data, dst.step, dst.elemSize1(), sz, scale);
     }
     else
     {
@@ -1173,6 +1440,41 @@ static LUTFunc lutTab[] =
 
 }
 
+namespace cv
+{
+
+static void LUTImpl( LUTFunc func, const Mat& src, const Mat& lut, Mat& dst )
+{
+    const Mat* arrays[] = {&src, &dst, 0};
+    uchar* ptrs[2];
+    NAryMatIterator it(arrays, ptrs);
+    int len = (int)it.size;
+
+    for( size_t i = 0; i < it.nplanes; i++, ++it )
+        func(ptrs[0], lut.data, ptrs[1], len, src.channels(), lut.channels());
+}
+
+class LUTInvoker : public ParallelLoopBody
+{
+public:
+    LUTInvoker(LUTFunc _func, const Mat& _src, const Mat& _lut, const Mat& _dst) :
+        func(_func), src(_src), lut(_lut), dst(_dst)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        Mat dstripe = getElemwiseStripe(dst, range);
+        LUTImpl(func, getElemwiseStripe(src, range), lut, dstripe);
+    }
+
+private:
+    LUTFunc func;
+    Mat src, lut, dst;
+};
+
+}
+
 void cv::LUT( InputArray _src, InputArray _lut, OutputArray _dst, int interpolation )
 {
     Mat src = _src.getMat(), lut = _lut.getMat();
@@ -1189,13 +1491,11 @@ void cv::LUT( InputArray _src, InputArray _lut, OutputArray _dst, int interpolat
     LUTFunc func = lutTab[lut.depth()];
     CV_Assert( func != 0 );
 
-    const Mat* arrays[] = {&src, &dst, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-    int len = (int)it.size;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        func(ptrs[0], lut.data, ptrs[1], len, cn, lutcn);
+    int nstripes = src.dims <= 2 ? getElemwiseNStripes(src.total()*(src.elemSize() + dst.elemSize())) : 1;
+    if( nstripes > 1 )
+        parallel_for_(Range(0, getElemwiseRange(src)), LUTInvoker(func, src, lut, dst), nstripes);
+    else
+        LUTImpl(func, src, lut, dst);
 }
 
 
@@ -367,6 +367,12 @@ template<typename T> struct DFT_VecR4
     int operator()(Complex<T>*, int, int, int&, const Complex<T>*) const { return 1; }
 };
 
+// the last radix-2 step of the power-2 transforms; returns false if it is not vectorized
+template<typename T> struct DFT_VecR2
+{
+    bool operator()(Complex<T>*, int, int, int, const Complex<T>*) const { return false; }
+};
+
 #if CV_SSE3
 
 // optimized radix-4 transform
@@ -455,6 +461,97 @@ template<> struct DFT_VecR4<float>
 
 #endif
 
+#if CV_SSE2
+
+// -i*x for a complex double
+static inline __m128d v_mul_neg_i( const __m128d& x, const __m128d& neg1_mask )
+{
+    return _mm_xor_pd(_mm_shuffle_pd(x, x, 1), neg1_mask);
+}
+
+// x*w for complex doubles
+static inline __m128d v_cmul( const __m128d& x, const __m128d& w, const __m128d& neg0_mask )
+{
+    __m128d t0 = _mm_mul_pd(_mm_unpacklo_pd(x, x), w);
+    __m128d t1 = _mm_mul_pd(_mm_unpackhi_pd(x, x), _mm_shuffle_pd(w, w, 1));
+    return _mm_add_pd(t0, _mm_xor_pd(t1, neg0_mask));
+}
+
+// radix-4 transform for double precision; one complex number per register
+template<> struct DFT_VecR4<double>
+{
+    int operator()(Complex<double>* dst, int N, int n0, int& _dw0, const Complex<double>* wave) const
+    {
+        int n = 1, i, j, nx, dw, dw0 = _dw0;
+        const __m128d neg0_mask = _mm_castsi128_pd(_mm_set_epi32(0, 0, (int)0x80000000, 0));
+        const __m128d neg1_mask = _mm_castsi128_pd(_mm_set_epi32((int)0x80000000, 0, 0, 0));
+        double* d = (double*)dst;
+        const double* w = (const double*)wave;
+
+        for( ; n*4 <= N; )
+        {
+            nx = n;
+            n *= 4;
+            dw0 /= 4;
+
+            for( i = 0; i < n0; i += n )
+            {
+                for( j = 0, dw = 0; j < nx; j++, dw += dw0 )
+                {
+                    double* v0 = d + (i + j)*2;
+                    double* v1 = v0 + nx*4;
+                    __m128d x0 = _mm_loadu_pd(v0), x1 = _mm_loadu_pd(v0 + nx*2);
+                    __m128d x2 = _mm_loadu_pd(v1), x3 = _mm_loadu_pd(v1 + nx*2);
+
+                    if( j > 0 )
+                    {
+                        x1 = v_cmul(x1, _mm_loadu_pd(w + dw*4), neg0_mask);
+                        x2 = v_cmul(x2, _mm_loadu_pd(w + dw*2), neg0_mask);
+                        x3 = v_cmul(x3, _mm_loadu_pd(w + dw*6), neg0_mask);
+                    }
+
+                    __m128d s0 = _mm_add_pd(x0, x1), s1 = _mm_sub_pd(x0, x1);
+                    __m128d t0 = _mm_add_pd(x2, x3), t1 = v_mul_neg_i(_mm_sub_pd(x2, x3), neg1_mask);
+
+                    _mm_storeu_pd(v0, _mm_add_pd(s0, t0));
+                    _mm_storeu_pd(v1, _mm_sub_pd(s0, t0));
+                    _mm_storeu_pd(v0 + nx*2, _mm_add_pd(s1, t1));
+                    _mm_storeu_pd(v1 + nx*2, _mm_sub_pd(s1, t1));
+                }
+            }
+        }
+
+        _dw0 = dw0;
+        return n;
+    }
+};
+
+template<> struct DFT_VecR2<double>
+{
+    bool operator()(Complex<double>* dst, int nx, int n0, int dw0, const Complex<double>* wave) const
+    {
+        const __m128d neg0_mask = _mm_castsi128_pd(_mm_set_epi32(0, 0, (int)0x80000000, 0));
+        double* d = (double*)dst;
+        const double* w = (const double*)wave;
+
+        for( int i = 0; i < n0; i += nx*2 )
+        {
+            for( int j = 0, dw = 0; j < nx; j++, dw += dw0 )
+            {
+                double* v = d + (i + j)*2;
+                __m128d x0 = _mm_loadu_pd(v), x1 = _mm_loadu_pd(v + nx*2);
+                if( j > 0 )
+                    x1 = v_cmul(x1, _mm_loadu_pd(w + dw*2), neg0_mask);
+                _mm_storeu_pd(v, _mm_add_pd(x0, x1));
+                _mm_storeu_pd(v + nx*2, _mm_sub_pd(x0, x1));
+            }
+        }
+        return true;
+    }
+};
+
+#endif
+
 #ifdef HAVE_IPP
 static void ippsDFTFwd_CToC( const Complex<float>* src, Complex<float>* dst,
                              const void* spec, uchar* buf)
@@ -714,6 +811,13 @@ DFT( const Complex<T>* src, Complex<T>* dst, int n,
             n *= 2;
             dw0 /= 2;
 
+            if( checkHardwareSupport(CV_CPU_SSE3) )
+            {
+                DFT_VecR2<T> vr2;
+                if( vr2(dst, nx, n0, dw0, wave) )
+                    continue;
+            }
+
             for( i = 0; i < n0; i += n )
             {
                 Complex<T>* v = dst + i;
@@ -1456,6 +1560,207 @@ static void CCSIDFT_64f( const double* src, double* dst, int n, int nf, int* fac
     CCSIDFT( src, dst, n, nf, factors, itab, wave, tab_size, spec, buf, flags, scale);
 }
 
+
+// the factorization, the permutation table and the twiddle factors of a 1D transform;
+// they depend only on the length, the depth and the kind of the permutation, so the
+// recently used plans are kept in a small cache shared by all the threads.
+// The plans are read-only; the users copy the factors before passing them to RealDFT()
+struct DFTPlan
+{
+    int len, elem_size, inv_itab, nf;
+    int factors[34];
+    Mat itab, wave;
+};
+
+enum { DFT_PLAN_CACHE_SIZE = 16, DFT_PLAN_CACHE_MAX_LEN = 1 << 16 };
+
+struct DFTPlanCache
+{
+    Mutex mutex;
+    std::vector<Ptr<DFTPlan> > plans; // the most recently used first
+};
+
+static DFTPlanCache& getDFTPlanCache()
+{
+    static DFTPlanCache* cache = new DFTPlanCache;
+    return *cache;
+}
+
+static Ptr<DFTPlan> getDFTPlan( int len, int elem_size, int inv_itab )
+{
+    DFTPlanCache& cache = getDFTPlanCache();
+    Ptr<DFTPlan> plan;
+    int factors[34];
+    int nf = DFTFactorize( len, factors );
+
+    // the permutation table differs only for the not in-place transforms
+    inv_itab = inv_itab && factors[0] != factors[nf-1];
+
+    if( len <= DFT_PLAN_CACHE_MAX_LEN )
+    {
+        AutoLock lock(cache.mutex);
+        for( size_t i = 0; i < cache.plans.size(); i++ )
+        {
+            const DFTPlan& p = *cache.plans[i];
+            if( p.len == len && p.elem_size == elem_size && p.inv_itab == inv_itab )
+            {
+                plan = cache.plans[i];
+                cache.plans.erase(cache.plans.begin() + i);
+                cache.plans.insert(cache.plans.begin(), plan);
+                return plan;
+            }
+        }
+    }
+
+    plan = new DFTPlan;
+    plan->len = len;
+    plan->elem_size = elem_size;
+    plan->inv_itab = inv_itab;
+    plan->nf = nf;
+    memcpy( plan->factors, factors, sizeof(factors) );
+    plan->itab.create( 1, len, CV_32S );
+    plan->wave.create( 1, len, elem_size == (int)sizeof(Complexd) ? CV_64FC2 : CV_32FC2 );
+    DFTInit( len, nf, plan->factors, (int*)plan->itab.data, elem_size, plan->wave.data, inv_itab );
+
+    if( len <= DFT_PLAN_CACHE_MAX_LEN )
+    {
+        AutoLock lock(cache.mutex);
+        cache.plans.insert(cache.plans.begin(), plan);
+        if( cache.plans.size() > DFT_PLAN_CACHE_SIZE )
+            cache.plans.pop_back();
+    }
+    return plan;
+}
+
+// the transforms of at least that many elements in total run the 1D transforms in parallel
+enum { DFT_PARALLEL_MIN_SIZE = 1 << 14 };
+
+static int getDFTNStripes( int len, int count )
+{
+    int nthreads = getNumThreads();
+    if( nthreads <= 1 || count < 2 || (double)len*count < DFT_PARALLEL_MIN_SIZE )
+        return 1;
+    return std::min(count, nthreads*4);
+}
+
+// the parameters of the 1D transforms done on one stage of cv::dft
+struct DFTStage
+{
+    DFTFunc func;
+    int len, nf;
+    const int* factors;
+    const int* itab;
+    const void* wave;
+    const void* spec;
+    int flags;
+    double scale;
+    int complex_elem_size;
+    bool use_buf;
+    size_t buf_size; // the scratch memory needed by one thread
+};
+
+// transforms the rows of src into the rows of dst
+class DFTRowsInvoker : public ParallelLoopBody
+{
+public:
+    DFTRowsInvoker( const Mat& _src, const Mat& _dst, const DFTStage& _st,
+                    int _dptr_offset, int _dst_full_len )
+        : src(&_src), dst(&_dst), st(&_st), dptr_offset(_dptr_offset), dst_full_len(_dst_full_len) {}
+
+    void operator()( const Range& range ) const
+    {
+        AutoBuffer<uchar> buf(st->buf_size + 32);
+        uchar* ptr = alignPtr((uchar*)buf, 16);
+        uchar* tmp_buf = 0;
+        int factors[34];
+        // RealDFT() and CCSIDFT() modify the factors temporarily
+        memcpy( factors, st->factors, st->nf*sizeof(factors[0]) );
+
+        if( st->use_buf )
+        {
+            tmp_buf = ptr;
+            ptr += st->len*st->complex_elem_size;
+        }
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const uchar* sptr = src->data + i*src->step;
+            uchar* dptr0 = dst->data + i*dst->step;
+            uchar* dptr = tmp_buf ? tmp_buf : dptr0;
+
+            st->func( sptr, dptr, st->len, st->nf, factors, st->itab, st->wave, st->len,
+                      st->spec, ptr, st->flags, st->scale );
+            if( dptr != dptr0 )
+                memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+        }
+    }
+
+private:
+    const Mat* src;
+    const Mat* dst;
+    const DFTStage* st;
+    int dptr_offset, dst_full_len;
+};
+
+// transforms the pairs of complex columns starting at sptr0 into the columns starting at dptr0;
+// the last column of an odd count is transformed alone
+class DFTColumnsInvoker : public ParallelLoopBody
+{
+public:
+    DFTColumnsInvoker( const uchar* _sptr0, size_t _sstep, uchar* _dptr0, size_t _dstep,
+                       int _count, const DFTStage& _st )
+        : sptr0(_sptr0), sstep(_sstep), dptr0(_dptr0), dstep(_dstep), count(_count), st(&_st) {}
+
+    void operator()( const Range& range ) const
+    {
+        int len = st->len, esz = st->complex_elem_size;
+        AutoBuffer<uchar> buf(st->buf_size + 32);
+        uchar* ptr = alignPtr((uchar*)buf, 16);
+        uchar *buf0 = ptr, *buf1 = ptr + len*esz, *dbuf0 = buf0, *dbuf1 = buf1;
+        ptr += 2*len*esz;
+        int factors[34];
+        memcpy( factors, st->factors, st->nf*sizeof(factors[0]) );
+
+        if( st->use_buf )
+        {
+            dbuf1 = ptr;
+            dbuf0 = buf1;
+            ptr += len*esz;
+        }
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            const uchar* sptr = sptr0 + k*2*esz;
+            uchar* dptr = dptr0 + k*2*esz;
+
+            if( k*2 + 1 < count )
+            {
+                CopyFrom2Columns( sptr, sstep, buf0, buf1, len, esz );
+                st->func( buf1, dbuf1, len, st->nf, factors, st->itab,
+                          st->wave, len, st->spec, ptr, st->flags, st->scale );
+            }
+            else
+                CopyColumn( sptr, sstep, buf0, esz, len, esz );
+
+            st->func( buf0, dbuf0, len, st->nf, factors, st->itab,
+                      st->wave, len, st->spec, ptr, st->flags, st->scale );
+
+            if( k*2 + 1 < count )
+                CopyTo2Columns( dbuf0, dbuf1, dptr, dstep, len, esz );
+            else
+                CopyColumn( dbuf0, esz, dptr, dstep, len, esz );
+        }
+    }
+
+private:
+    const uchar* sptr0;
+    size_t sstep;
+    uchar* dptr0;
+    size_t dstep;
+    int count;
+    const DFTStage* st;
+};
+
 }
 
 
@@ -1475,12 +1780,11 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     void *spec = 0;
 
     Mat src0 = _src0.getMat(), src = src0;
-    int prev_len = 0, stage = 0;
+    int stage = 0;
     bool inv = (flags & DFT_INVERSE) != 0;
-    int nf = 0, real_transform = src.channels() == 1 || (inv && (flags & DFT_REAL_OUTPUT)!=0);
+    int real_transform = src.channels() == 1 || (inv && (flags & DFT_REAL_OUTPUT)!=0);
     int type = src.type(), depth = src.depth();
     int elem_size = (int)src.elemSize1(), complex_elem_size = elem_size*2;
-    int factors[34];
     bool inplace_transform = false;
 #ifdef HAVE_IPP
     void *spec_r = 0, *spec_c = 0;
@@ -1516,12 +1820,11 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     for(;;)
     {
         double scale = 1;
-        uchar* wave = 0;
-        int* itab = 0;
-        uchar* ptr;
+        Ptr<DFTPlan> plan;
+        DFTStage st;
         int i, len, count, sz = 0;
         int use_buf = 0, odd_real = 0;
-        DFTFunc dft_func;
+        uchar* ptr;
 
         if( stage == 0 ) // row-wise transform
         {
@@ -1542,6 +1845,10 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         }
 
         spec = 0;
+        st.nf = 0;
+        st.factors = 0;
+        st.itab = 0;
+        st.wave = 0;
 #ifdef HAVE_IPP
         if( len*count >= 64 ) // use IPP DFT if available
         {
@@ -1593,14 +1900,16 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         else
 #endif
         {
-            if( len != prev_len )
-                nf = DFTFactorize( len, factors );
+            plan = getDFTPlan( len, complex_elem_size, stage == 0 && inv && real_transform );
+            st.nf = plan->nf;
+            st.factors = plan->factors;
+            st.itab = (const int*)plan->itab.data;
+            st.wave = plan->wave.data;
 
-            inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
-            i = nf > 1 && (factors[0] & 1) == 0;
-            if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                sz += (factors[i]+1)*complex_elem_size;
+            inplace_transform = st.factors[0] == st.factors[st.nf-1];
+            i = st.nf > 1 && (st.factors[0] & 1) == 0;
+            if( (st.factors[i] & 1) != 0 && st.factors[i] > 5 )
+                sz += (st.factors[i]+1)*complex_elem_size;
 
             if( (stage == 0 && ((src.data == dst.data && !inplace_transform) || odd_real)) ||
                 (stage == 1 && !inplace_transform) )
@@ -1610,70 +1919,45 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             }
         }
 
-        ptr = (uchar*)buf;
-        buf.allocate( sz + 32 );
-        if( ptr != (uchar*)buf )
-            prev_len = 0; // because we release the buffer,
-                          // force recalculation of
-                          // twiddle factors and permutation table
-        ptr = (uchar*)buf;
-        if( !spec )
-        {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                DFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
-        }
+        st.len = len;
+        st.spec = spec;
+        st.complex_elem_size = complex_elem_size;
+        st.use_buf = use_buf != 0;
+        st.buf_size = sz;
 
         if( stage == 0 )
         {
-            uchar* tmp_buf = 0;
             int dptr_offset = 0;
             int dst_full_len = len*elem_size;
             int _flags = (int)inv + (src.channels() != dst.channels() ?
                          DFT_COMPLEX_INPUT_OR_OUTPUT : 0);
-            if( use_buf )
-            {
-                tmp_buf = ptr;
-                ptr += len*complex_elem_size;
-                if( odd_real && !inv && len > 1 &&
-                    !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT))
-                    dptr_offset = elem_size;
-            }
+            if( use_buf && odd_real && !inv && len > 1 &&
+                !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT) )
+                dptr_offset = elem_size;
 
             if( !inv && (_flags & DFT_COMPLEX_INPUT_OR_OUTPUT) )
                 dst_full_len += (len & 1) ? elem_size : complex_elem_size;
 
-            dft_func = dft_tbl[(!real_transform ? 0 : !inv ? 1 : 2) + (depth == CV_64F)*3];
+            st.func = dft_tbl[(!real_transform ? 0 : !inv ? 1 : 2) + (depth == CV_64F)*3];
+            st.flags = _flags;
 
             if( count > 1 && !(flags & DFT_ROWS) && (!inv || !real_transform) )
                 stage = 1;
             else if( flags & CV_DXT_SCALE )
                 scale = 1./(len * (flags & DFT_ROWS ? 1 : count));
+            st.scale = scale;
 
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
 
-            for( i = 0; i < nonzero_rows; i++ )
-            {
-                uchar* sptr = src.data + i*src.step;
-                uchar* dptr0 = dst.data + i*dst.step;
-                uchar* dptr = dptr0;
-
-                if( tmp_buf )
-                    dptr = tmp_buf;
-
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
-            }
+            DFTRowsInvoker invoker(src, dst, st, dptr_offset, dst_full_len);
+            int nstripes = getDFTNStripes(len, nonzero_rows);
+            if( nstripes > 1 )
+                parallel_for_(Range(0, nonzero_rows), invoker, nstripes);
+            else
+                invoker(Range(0, nonzero_rows));
 
-            for( ; i < count; i++ )
+            for( i = nonzero_rows; i < count; i++ )
             {
                 uchar* dptr0 = dst.data + i*dst.step;
                 memset( dptr0, 0, dst_full_len );
@@ -1689,25 +1973,15 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             uchar *buf0, *buf1, *dbuf0, *dbuf1;
             uchar* sptr0 = src.data;
             uchar* dptr0 = dst.data;
-            buf0 = ptr;
-            ptr += len*complex_elem_size;
-            buf1 = ptr;
-            ptr += len*complex_elem_size;
-            dbuf0 = buf0, dbuf1 = buf1;
-
-            if( use_buf )
-            {
-                dbuf1 = ptr;
-                dbuf0 = buf1;
-                ptr += len*complex_elem_size;
-            }
 
-            dft_func = dft_tbl[(depth == CV_64F)*3];
+            st.func = dft_tbl[(depth == CV_64F)*3];
+            st.flags = inv;
 
             if( real_transform && inv && src.cols > 1 )
                 stage = 0;
             else if( flags & CV_DXT_SCALE )
                 scale = 1./(len * count);
+            st.scale = scale;
 
             if( real_transform )
             {
@@ -1715,6 +1989,22 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 a = 1;
                 even = (count & 1) == 0;
                 b = (count+1)/2;
+
+                buf.allocate( sz + 32 );
+                ptr = alignPtr((uchar*)buf, 16);
+                buf0 = ptr;
+                ptr += len*complex_elem_size;
+                buf1 = ptr;
+                ptr += len*complex_elem_size;
+                dbuf0 = buf0, dbuf1 = buf1;
+
+                if( use_buf )
+                {
+                    dbuf1 = ptr;
+                    dbuf0 = buf1;
+                    ptr += len*complex_elem_size;
+                }
+
                 if( !inv )
                 {
                     memset( buf0, 0, len*complex_elem_size );
@@ -1750,11 +2040,13 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                     sptr0 += complex_elem_size;
                 }
 
+                int factors[34];
+                memcpy( factors, st.factors, st.nf*sizeof(factors[0]) );
                 if( even )
-                    dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
-                dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
+                    st.func( buf1, dbuf1, len, st.nf, factors, st.itab,
+                             st.wave, len, spec, ptr, inv, scale );
+                st.func( buf0, dbuf0, len, st.nf, factors, st.itab,
+                         st.wave, len, spec, ptr, inv, scale );
 
                 if( dst.channels() == 1 )
                 {
@@ -1797,26 +2089,15 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
+            if( a < b )
             {
-                if( i+1 < b )
-                {
-                    CopyFrom2Columns( sptr0, src.step, buf0, buf1, len, complex_elem_size );
-                    dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
-                }
-                else
-                    CopyColumn( sptr0, src.step, buf0, complex_elem_size, len, complex_elem_size );
-
-                dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
-
-                if( i+1 < b )
-                    CopyTo2Columns( dbuf0, dbuf1, dptr0, dst.step, len, complex_elem_size );
+                DFTColumnsInvoker invoker(sptr0, src.step, dptr0, dst.step, b - a, st);
+                int npairs = (b - a + 1)/2;
+                int nstripes = getDFTNStripes(len, b - a);
+                if( nstripes > 1 )
+                    parallel_for_(Range(0, npairs), invoker, std::min(nstripes, npairs));
                 else
-                    CopyColumn( dbuf0, complex_elem_size, dptr0, dst.step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
+                    invoker(Range(0, npairs));
             }
 
             if( stage != 0 )
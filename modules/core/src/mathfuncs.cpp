@@ -77,6 +77,37 @@ float fastAtan2( float y, float x )
     return a;
 }
 
+#if CV_AVX2_DISPATCH
+static CV_AVX2_TARGET int FastAtan2_32f_AVX2(const float *Y, const float *X, float *angle, int len, float scale)
+{
+    int i = 0;
+    __m256 eps = _mm256_set1_ps((float)DBL_EPSILON), absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 _90 = _mm256_set1_ps(90.f), _180 = _mm256_set1_ps(180.f), _360 = _mm256_set1_ps(360.f);
+    __m256 z = _mm256_setzero_ps(), scale8 = _mm256_set1_ps(scale);
+    __m256 p1 = _mm256_set1_ps(atan2_p1), p3 = _mm256_set1_ps(atan2_p3);
+    __m256 p5 = _mm256_set1_ps(atan2_p5), p7 = _mm256_set1_ps(atan2_p7);
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256 x = _mm256_loadu_ps(X + i), y = _mm256_loadu_ps(Y + i);
+        __m256 ax = _mm256_and_ps(x, absmask), ay = _mm256_and_ps(y, absmask);
+        __m256 c = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_add_ps(_mm256_max_ps(ax, ay), eps));
+        __m256 c2 = _mm256_mul_ps(c, c);
+        __m256 a = _mm256_fmadd_ps(c2, p7, p5);
+        a = _mm256_fmadd_ps(a, c2, p3);
+        a = _mm256_fmadd_ps(a, c2, p1);
+        a = _mm256_mul_ps(a, c);
+
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_90, a), _mm256_cmp_ps(ax, ay, _CMP_LT_OQ));
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_180, a), _mm256_cmp_ps(x, z, _CMP_LT_OQ));
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_360, a), _mm256_cmp_ps(y, z, _CMP_LT_OQ));
+
+        _mm256_storeu_ps(angle + i, _mm256_mul_ps(a, scale8));
+    }
+    return i;
+}
+#endif
+
 static void FastAtan2_32f(const float *Y, const float *X, float *angle, int len, bool angleInDegrees=true )
 {
     int i = 0;
@@ -87,6 +118,11 @@ static void FastAtan2_32f(const float *Y, const float *X, float *angle, int len,
         return;
 #endif
 
+#if CV_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = FastAtan2_32f_AVX2(Y, X, angle, len, scale);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -194,10 +230,47 @@ float  cubeRoot( float value )
     return v.f;
 }
 
+#if CV_AVX2_DISPATCH
+static CV_AVX2_TARGET int Magnitude_32f_AVX2(const float* x, const float* y, float* mag, int len)
+{
+    int i = 0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256 x0 = _mm256_loadu_ps(x + i), x1 = _mm256_loadu_ps(x + i + 8);
+        __m256 y0 = _mm256_loadu_ps(y + i), y1 = _mm256_loadu_ps(y + i + 8);
+        x0 = _mm256_fmadd_ps(x0, x0, _mm256_mul_ps(y0, y0));
+        x1 = _mm256_fmadd_ps(x1, x1, _mm256_mul_ps(y1, y1));
+        _mm256_storeu_ps(mag + i, _mm256_sqrt_ps(x0));
+        _mm256_storeu_ps(mag + i + 8, _mm256_sqrt_ps(x1));
+    }
+    return i;
+}
+
+static CV_AVX2_TARGET int Magnitude_64f_AVX2(const double* x, const double* y, double* mag, int len)
+{
+    int i = 0;
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256d x0 = _mm256_loadu_pd(x + i), x1 = _mm256_loadu_pd(x + i + 4);
+        __m256d y0 = _mm256_loadu_pd(y + i), y1 = _mm256_loadu_pd(y + i + 4);
+        x0 = _mm256_fmadd_pd(x0, x0, _mm256_mul_pd(y0, y0));
+        x1 = _mm256_fmadd_pd(x1, x1, _mm256_mul_pd(y1, y1));
+        _mm256_storeu_pd(mag + i, _mm256_sqrt_pd(x0));
+        _mm256_storeu_pd(mag + i + 4, _mm256_sqrt_pd(x1));
+    }
+    return i;
+}
+#endif
+
 static void Magnitude_32f(const float* x, const float* y, float* mag, int len)
 {
     int i = 0;
 
+#if CV_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = Magnitude_32f_AVX2(x, y, mag, len);
+#endif
+
 #if CV_SSE
     if( USE_SSE2 )
     {
@@ -224,6 +297,11 @@ static void Magnitude_64f(const double* x, const double* y, double* mag, int len
 {
     int i = 0;
 
+#if CV_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = Magnitude_64f_AVX2(x, y, mag, len);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -765,6 +843,61 @@ static const double exp_prescale = 1.4426950408889634073599246810019 * (1 << EXP
 static const double exp_postscale = 1./(1 << EXPTAB_SCALE);
 static const double exp_max_val = 3000.*(1 << EXPTAB_SCALE); // log10(DBL_MAX) < 3000
 
+#if CV_AVX2_DISPATCH
+// the masked form does not leave the destination register undefined
+static inline CV_AVX2_TARGET __m256d v256_gather_pd(const double* tab, const __m128i& idx)
+{
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), tab, idx,
+                                    _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+}
+
+// the AVX2 version of the SSE2 code below; A1..A4 are the coefficients of EXPPOLY
+static CV_AVX2_TARGET int Exp_32f_AVX2( const float *x, float *y, int n,
+                                        float A1, float A2, float A3, float A4 )
+{
+    const __m256d prescale = _mm256_set1_pd(exp_prescale);
+    const __m256 postscale = _mm256_set1_ps((float)exp_postscale);
+    const __m256 maxval = _mm256_set1_ps((float)(exp_max_val/exp_prescale));
+    const __m256 minval = _mm256_set1_ps((float)(-exp_max_val/exp_prescale));
+    const __m256 mA1 = _mm256_set1_ps(A1), mA2 = _mm256_set1_ps(A2);
+    const __m256 mA3 = _mm256_set1_ps(A3), mA4 = _mm256_set1_ps(A4);
+    const __m256i tabmask = _mm256_set1_epi32(EXPTAB_MASK), bias = _mm256_set1_epi32(127);
+    const __m256i maxexp = _mm256_set1_epi32(255), z = _mm256_setzero_si256();
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8 )
+    {
+        __m256 xf = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(x + i), minval), maxval);
+
+        __m256d xd0 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(xf)), prescale);
+        __m256d xd1 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(xf, 1)), prescale);
+        __m128i xi0 = _mm256_cvtpd_epi32(xd0), xi1 = _mm256_cvtpd_epi32(xd1);
+        xd0 = _mm256_sub_pd(xd0, _mm256_cvtepi32_pd(xi0));
+        xd1 = _mm256_sub_pd(xd1, _mm256_cvtepi32_pd(xi1));
+
+        xf = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(xd0)), _mm256_cvtpd_ps(xd1), 1);
+        xf = _mm256_mul_ps(xf, postscale);
+
+        __m256i xi = _mm256_inserti128_si256(_mm256_castsi128_si256(xi0), xi1, 1);
+        __m256i idx = _mm256_and_si256(xi, tabmask);
+        xi = _mm256_add_epi32(_mm256_srai_epi32(xi, EXPTAB_SCALE), bias);
+        xi = _mm256_min_epi32(_mm256_max_epi32(xi, z), maxexp);
+
+        __m256d t0 = v256_gather_pd(expTab, _mm256_castsi256_si128(idx));
+        __m256d t1 = v256_gather_pd(expTab, _mm256_extracti128_si256(idx, 1));
+        __m256 yf = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(t0)), _mm256_cvtpd_ps(t1), 1);
+        yf = _mm256_mul_ps(yf, _mm256_castsi256_ps(_mm256_slli_epi32(xi, 23)));
+
+        __m256 zf = _mm256_add_ps(xf, mA1);
+        zf = _mm256_fmadd_ps(zf, xf, mA2);
+        zf = _mm256_fmadd_ps(zf, xf, mA3);
+        zf = _mm256_fmadd_ps(zf, xf, mA4);
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(zf, yf));
+    }
+    return i;
+}
+#endif
+
 static void Exp_32f( const float *_x, float *y, int n )
 {
     static const float
@@ -781,8 +914,13 @@ static void Exp_32f( const float *_x, float *y, int n )
     const Cv32suf* x = (const Cv32suf*)_x;
     Cv32suf buf[4];
 
+#if CV_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = Exp_32f_AVX2(_x, y, n, A1, A2, A3, A4);
+#endif
+
 #if CV_SSE2
-    if( n >= 8 && USE_SSE2 )
+    if( n - i >= 8 && USE_SSE2 )
     {
         static const __m128d prescale2 = _mm_set1_pd(exp_prescale);
         static const __m128 postscale4 = _mm_set1_ps((float)exp_postscale);
@@ -1449,6 +1587,47 @@ static const double CV_DECL_ALIGNED(16) icvLogTab[] = {
 #define LOGTAB_TRANSLATE(x,h) (((x) - 1.)*icvLogTab[(h)+1])
 static const double ln_2 = 0.69314718055994530941723212145818;
 
+#if CV_AVX2_DISPATCH
+// the AVX2 version of the SSE2 code below; A0..A2 are the coefficients of LOGPOLY
+static CV_AVX2_TARGET int Log_32f_AVX2( const float *x, float *y, int n, float A0, float A1, float A2 )
+{
+    const __m256d ln2 = _mm256_set1_pd(ln_2);
+    const __m256 one = _mm256_set1_ps(1.f), shift8 = _mm256_set1_ps(-1.f/512);
+    const __m256 mA0 = _mm256_set1_ps(A0), mA1 = _mm256_set1_ps(A1), mA2 = _mm256_set1_ps(A2);
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8 )
+    {
+        __m256i h = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i yi = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(h, 23), _mm256_set1_epi32(255)),
+                                      _mm256_set1_epi32(127));
+        __m256i xi = _mm256_or_si256(_mm256_and_si256(h, _mm256_set1_epi32(LOGTAB_MASK2_32F)),
+                                     _mm256_set1_epi32(127 << 23));
+        __m256i idx = _mm256_and_si256(_mm256_srli_epi32(h, 23 - LOGTAB_SCALE - 1), _mm256_set1_epi32(LOGTAB_MASK*2));
+        __m256 corr = _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(idx, _mm256_set1_epi32(510))), shift8);
+
+        __m128i idx0 = _mm256_castsi256_si128(idx), idx1 = _mm256_extracti128_si256(idx, 1);
+        __m256d yd0 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(yi)), ln2);
+        __m256d yd1 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(yi, 1)), ln2);
+        yd0 = _mm256_add_pd(yd0, v256_gather_pd(icvLogTab, idx0));
+        yd1 = _mm256_add_pd(yd1, v256_gather_pd(icvLogTab, idx1));
+        __m256d r0 = v256_gather_pd(icvLogTab + 1, idx0);
+        __m256d r1 = v256_gather_pd(icvLogTab + 1, idx1);
+
+        __m256 yf = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(yd0)), _mm256_cvtpd_ps(yd1), 1);
+        __m256 rf = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(r0)), _mm256_cvtpd_ps(r1), 1);
+
+        __m256 xf = _mm256_fmadd_ps(_mm256_sub_ps(_mm256_castsi256_ps(xi), one), rf, corr);
+        __m256 zf = _mm256_fmadd_ps(xf, mA0, mA1);
+        zf = _mm256_fmadd_ps(zf, xf, mA2);
+        yf = _mm256_fmadd_ps(zf, xf, yf);
+
+        _mm256_storeu_ps(y + i, yf);
+    }
+    return i;
+}
+#endif
+
 static void Log_32f( const float *_x, float *y, int n )
 {
     static const float shift[] = { 0, -1.f/512 };
@@ -1464,6 +1643,11 @@ static void Log_32f( const float *_x, float *y, int n )
     Cv32suf buf[4];
     const int* x = (const int*)_x;
 
+#if CV_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = Log_32f_AVX2(_x, y, n, A0, A1, A2);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -693,6 +693,333 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
     GEMMStore(c_data, c_step, d_buf, d_buf_step, d_data, d_step, d_size, alpha, beta, flags);
 }
 
+
+/****************************************************************************************\
+*                          Packed GEMM for the large real matrices                       *
+\****************************************************************************************/
+
+// D is split into GEMM_MC x GEMM_NC tiles that are computed in parallel. For every
+// GEMM_KC-long slice of the common dimension the tile's parts of A and B are packed into
+// panels of GEMM_MR rows and GEMM_NR columns (zero-padded at the edges), and each
+// GEMM_MR x GEMM_NR block of the tile is then accumulated in registers by the micro-kernel.
+// Like the unpacked code, which uses GEMMSingleMul<float,double>, the products of the float
+// matrices are accumulated in double precision, over the slices too; D is written once.
+enum { GEMM_MR = 4, GEMM_MC = 128, GEMM_NC = 256, GEMM_KC = 256 };
+
+// the matrices with fewer than GEMM_PACKED_MIN_OPS multiply-adds use the code above
+static const double GEMM_PACKED_MIN_OPS = 1 << 18;
+
+template<typename T> struct GEMMPacked
+{
+    enum { NR = 64/sizeof(T) };
+
+    // packs the mc x kc block of A into the GEMM_MR-row panels, k-major within a panel
+    static void packA( const T* a, size_t rs, size_t cs, int mc, int kc, T* buf )
+    {
+        for( int i = 0; i < mc; i += GEMM_MR, a += rs*GEMM_MR )
+        {
+            int r, k, mr = std::min(mc - i, (int)GEMM_MR);
+            for( k = 0; k < kc; k++, buf += GEMM_MR )
+            {
+                const T* ak = a + k*cs;
+                for( r = 0; r < mr; r++ )
+                    buf[r] = ak[r*rs];
+                for( ; r < GEMM_MR; r++ )
+                    buf[r] = 0;
+            }
+        }
+    }
+
+    // packs the kc x nc block of B into the NR-column panels, k-major within a panel
+    static void packB( const T* b, size_t rs, size_t cs, int kc, int nc, T* buf )
+    {
+        for( int j = 0; j < nc; j += NR, b += cs*NR )
+        {
+            int c, k, nr = std::min(nc - j, (int)NR);
+            for( k = 0; k < kc; k++, buf += NR )
+            {
+                const T* bk = b + k*rs;
+                if( cs == 1 && nr == NR )
+                    memcpy(buf, bk, NR*sizeof(T));
+                else
+                {
+                    for( c = 0; c < nr; c++ )
+                        buf[c] = bk[c*cs];
+                    for( ; c < NR; c++ )
+                        buf[c] = 0;
+                }
+            }
+        }
+    }
+
+    // acc[r*NR + c] = sum_k a[k*GEMM_MR + r]*b[k*NR + c]
+    static void kernel( const T* a, const T* b, int kc, double* acc )
+    {
+        double s[GEMM_MR*NR];
+        int r, c, k;
+        for( r = 0; r < GEMM_MR*NR; r++ )
+            s[r] = 0;
+        for( k = 0; k < kc; k++, a += GEMM_MR, b += NR )
+            for( r = 0; r < GEMM_MR; r++ )
+            {
+                double ar = a[r];
+                for( c = 0; c < NR; c++ )
+                    s[r*NR + c] += ar*b[c];
+            }
+        for( r = 0; r < GEMM_MR*NR; r++ )
+            acc[r] = s[r];
+    }
+};
+
+#if CV_SSE2
+
+// the SSE2 kernels process the panel in parts of 4 columns (converted to double for the floats)
+// or 4 doubles, so that the accumulators fit into the 8 registers of the 32-bit mode
+static void GEMMKernel_32f_SSE2( const float* a, const float* b, int kc, double* acc )
+{
+    for( int h = 0; h < 16; h += 4 )
+    {
+        __m128d s00 = _mm_setzero_pd(), s01 = s00, s10 = s00, s11 = s00;
+        __m128d s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+        const float* bh = b + h;
+
+        for( int k = 0; k < kc; k++, bh += 16 )
+        {
+            __m128 bf = _mm_load_ps(bh);
+            __m128d b0 = _mm_cvtps_pd(bf), b1 = _mm_cvtps_pd(_mm_movehl_ps(bf, bf)), ak;
+            ak = _mm_set1_pd(a[k*4]);
+            s00 = _mm_add_pd(s00, _mm_mul_pd(ak, b0)); s01 = _mm_add_pd(s01, _mm_mul_pd(ak, b1));
+            ak = _mm_set1_pd(a[k*4 + 1]);
+            s10 = _mm_add_pd(s10, _mm_mul_pd(ak, b0)); s11 = _mm_add_pd(s11, _mm_mul_pd(ak, b1));
+            ak = _mm_set1_pd(a[k*4 + 2]);
+            s20 = _mm_add_pd(s20, _mm_mul_pd(ak, b0)); s21 = _mm_add_pd(s21, _mm_mul_pd(ak, b1));
+            ak = _mm_set1_pd(a[k*4 + 3]);
+            s30 = _mm_add_pd(s30, _mm_mul_pd(ak, b0)); s31 = _mm_add_pd(s31, _mm_mul_pd(ak, b1));
+        }
+
+        _mm_storeu_pd(acc + h, s00); _mm_storeu_pd(acc + h + 2, s01);
+        _mm_storeu_pd(acc + h + 16, s10); _mm_storeu_pd(acc + h + 18, s11);
+        _mm_storeu_pd(acc + h + 32, s20); _mm_storeu_pd(acc + h + 34, s21);
+        _mm_storeu_pd(acc + h + 48, s30); _mm_storeu_pd(acc + h + 50, s31);
+    }
+}
+
+static void GEMMKernel_64f_SSE2( const double* a, const double* b, int kc, double* acc )
+{
+    for( int h = 0; h < 8; h += 4 )
+    {
+        __m128d s00 = _mm_setzero_pd(), s01 = s00, s10 = s00, s11 = s00;
+        __m128d s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+        const double* bh = b + h;
+
+        for( int k = 0; k < kc; k++, bh += 8 )
+        {
+            __m128d b0 = _mm_load_pd(bh), b1 = _mm_load_pd(bh + 2), ak;
+            ak = _mm_set1_pd(a[k*4]);
+            s00 = _mm_add_pd(s00, _mm_mul_pd(ak, b0)); s01 = _mm_add_pd(s01, _mm_mul_pd(ak, b1));
+            ak = _mm_set1_pd(a[k*4 + 1]);
+            s10 = _mm_add_pd(s10, _mm_mul_pd(ak, b0)); s11 = _mm_add_pd(s11, _mm_mul_pd(ak, b1));
+            ak = _mm_set1_pd(a[k*4 + 2]);
+            s20 = _mm_add_pd(s20, _mm_mul_pd(ak, b0)); s21 = _mm_add_pd(s21, _mm_mul_pd(ak, b1));
+            ak = _mm_set1_pd(a[k*4 + 3]);
+            s30 = _mm_add_pd(s30, _mm_mul_pd(ak, b0)); s31 = _mm_add_pd(s31, _mm_mul_pd(ak, b1));
+        }
+
+        _mm_storeu_pd(acc + h, s00); _mm_storeu_pd(acc + h + 2, s01);
+        _mm_storeu_pd(acc + h + 8, s10); _mm_storeu_pd(acc + h + 10, s11);
+        _mm_storeu_pd(acc + h + 16, s20); _mm_storeu_pd(acc + h + 18, s21);
+        _mm_storeu_pd(acc + h + 24, s30); _mm_storeu_pd(acc + h + 26, s31);
+    }
+}
+
+#endif
+
+#if CV_AVX2_DISPATCH
+
+static CV_AVX2_TARGET void GEMMKernel_32f_AVX2( const float* a, const float* b, int kc, double* acc )
+{
+    for( int h = 0; h < 16; h += 8 )
+    {
+        __m256d s00 = _mm256_setzero_pd(), s01 = s00, s10 = s00, s11 = s00;
+        __m256d s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+        const float* bh = b + h;
+
+        for( int k = 0; k < kc; k++, bh += 16 )
+        {
+            __m256 bf = _mm256_load_ps(bh);
+            __m256d b0 = _mm256_cvtps_pd(_mm256_castps256_ps128(bf));
+            __m256d b1 = _mm256_cvtps_pd(_mm256_extractf128_ps(bf, 1)), ak;
+            ak = _mm256_set1_pd(a[k*4]);
+            s00 = _mm256_fmadd_pd(ak, b0, s00); s01 = _mm256_fmadd_pd(ak, b1, s01);
+            ak = _mm256_set1_pd(a[k*4 + 1]);
+            s10 = _mm256_fmadd_pd(ak, b0, s10); s11 = _mm256_fmadd_pd(ak, b1, s11);
+            ak = _mm256_set1_pd(a[k*4 + 2]);
+            s20 = _mm256_fmadd_pd(ak, b0, s20); s21 = _mm256_fmadd_pd(ak, b1, s21);
+            ak = _mm256_set1_pd(a[k*4 + 3]);
+            s30 = _mm256_fmadd_pd(ak, b0, s30); s31 = _mm256_fmadd_pd(ak, b1, s31);
+        }
+
+        _mm256_storeu_pd(acc + h, s00); _mm256_storeu_pd(acc + h + 4, s01);
+        _mm256_storeu_pd(acc + h + 16, s10); _mm256_storeu_pd(acc + h + 20, s11);
+        _mm256_storeu_pd(acc + h + 32, s20); _mm256_storeu_pd(acc + h + 36, s21);
+        _mm256_storeu_pd(acc + h + 48, s30); _mm256_storeu_pd(acc + h + 52, s31);
+    }
+}
+
+static CV_AVX2_TARGET void GEMMKernel_64f_AVX2( const double* a, const double* b, int kc, double* acc )
+{
+    __m256d s00 = _mm256_setzero_pd(), s01 = s00, s10 = s00, s11 = s00;
+    __m256d s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+
+    for( int k = 0; k < kc; k++, a += 4, b += 8 )
+    {
+        __m256d b0 = _mm256_load_pd(b), b1 = _mm256_load_pd(b + 4), ak;
+        ak = _mm256_broadcast_sd(a);
+        s00 = _mm256_fmadd_pd(ak, b0, s00); s01 = _mm256_fmadd_pd(ak, b1, s01);
+        ak = _mm256_broadcast_sd(a + 1);
+        s10 = _mm256_fmadd_pd(ak, b0, s10); s11 = _mm256_fmadd_pd(ak, b1, s11);
+        ak = _mm256_broadcast_sd(a + 2);
+        s20 = _mm256_fmadd_pd(ak, b0, s20); s21 = _mm256_fmadd_pd(ak, b1, s21);
+        ak = _mm256_broadcast_sd(a + 3);
+        s30 = _mm256_fmadd_pd(ak, b0, s30); s31 = _mm256_fmadd_pd(ak, b1, s31);
+    }
+
+    _mm256_storeu_pd(acc, s00); _mm256_storeu_pd(acc + 4, s01);
+    _mm256_storeu_pd(acc + 8, s10); _mm256_storeu_pd(acc + 12, s11);
+    _mm256_storeu_pd(acc + 16, s20); _mm256_storeu_pd(acc + 20, s21);
+    _mm256_storeu_pd(acc + 24, s30); _mm256_storeu_pd(acc + 28, s31);
+}
+
+#endif
+
+typedef void (*GEMMKernelFunc_32f)( const float* a, const float* b, int kc, double* acc );
+typedef void (*GEMMKernelFunc_64f)( const double* a, const double* b, int kc, double* acc );
+
+static GEMMKernelFunc_32f getGEMMKernel( const float* )
+{
+#if CV_AVX2_DISPATCH
+    if( USE_AVX2 )
+        return GEMMKernel_32f_AVX2;
+#endif
+#if CV_SSE2
+    if( USE_SSE2 )
+        return GEMMKernel_32f_SSE2;
+#endif
+    return GEMMPacked<float>::kernel;
+}
+
+static GEMMKernelFunc_64f getGEMMKernel( const double* )
+{
+#if CV_AVX2_DISPATCH
+    if( USE_AVX2 )
+        return GEMMKernel_64f_AVX2;
+#endif
+#if CV_SSE2
+    if( USE_SSE2 )
+        return GEMMKernel_64f_SSE2;
+#endif
+    return GEMMPacked<double>::kernel;
+}
+
+template<typename T> class GEMMPackedInvoker : public ParallelLoopBody
+{
+public:
+    enum { NR = GEMMPacked<T>::NR };
+
+    GEMMPackedInvoker( const Mat& _A, const Mat& _B, const Mat& _C, Mat& _D,
+                       double _alpha, double _beta, int _flags, int _len )
+        : A(&_A), B(&_B), C(&_C), D(&_D), alpha(_alpha), beta(_beta), flags(_flags), len(_len)
+    {
+        ntilesX = (D->cols + GEMM_NC - 1)/GEMM_NC;
+    }
+
+    int ntiles() const { return ntilesX*((D->rows + GEMM_MC - 1)/GEMM_MC); }
+
+    void operator()( const Range& range ) const
+    {
+        size_t astep = A->step/sizeof(T), bstep = B->step/sizeof(T);
+        size_t cstep = C->data ? C->step/sizeof(T) : 0, dstep = D->step/sizeof(T);
+        size_t ars = astep, acs = 1, brs = bstep, bcs = 1, crs = cstep, ccs = 1;
+        if( flags & GEMM_1_T )
+            std::swap(ars, acs);
+        if( flags & GEMM_2_T )
+            std::swap(brs, bcs);
+        if( flags & GEMM_3_T )
+            std::swap(crs, ccs);
+
+        AutoBuffer<T> _abuf(GEMM_MC*GEMM_KC + 16), _bbuf(GEMM_KC*GEMM_NC + 16);
+        T* abuf = alignPtr((T*)_abuf, 32);
+        T* bbuf = alignPtr((T*)_bbuf, 32);
+        double acc[GEMM_MR*NR];
+        // the sums over the previous slices of the common dimension
+        AutoBuffer<double> _tbuf(len > GEMM_KC ? GEMM_MC*GEMM_NC : 1);
+        double* tbuf = _tbuf;
+        void (*kernel)( const T* a, const T* b, int kc, double* acc ) = getGEMMKernel((const T*)0);
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int i0 = (t / ntilesX)*GEMM_MC, j0 = (t % ntilesX)*GEMM_NC;
+            int mc = std::min(D->rows - i0, (int)GEMM_MC), nc = std::min(D->cols - j0, (int)GEMM_NC);
+
+            for( int k0 = 0; k0 < len; k0 += GEMM_KC )
+            {
+                int kc = std::min(len - k0, (int)GEMM_KC);
+                GEMMPacked<T>::packA((const T*)A->data + i0*ars + k0*acs, ars, acs, mc, kc, abuf);
+                GEMMPacked<T>::packB((const T*)B->data + k0*brs + j0*bcs, brs, bcs, kc, nc, bbuf);
+
+                for( int j = 0; j < nc; j += NR )
+                    for( int i = 0; i < mc; i += GEMM_MR )
+                    {
+                        int r, c, mr = std::min(mc - i, (int)GEMM_MR), nr = std::min(nc - j, (int)NR);
+                        kernel(abuf + i*kc, bbuf + j*kc, kc, acc);
+
+                        double* tb = tbuf + i*GEMM_NC + j;
+                        if( k0 + kc < len )
+                        {
+                            for( r = 0; r < mr; r++, tb += GEMM_NC )
+                                for( c = 0; c < nr; c++ )
+                                    tb[c] = k0 > 0 ? tb[c] + acc[r*NR + c] : acc[r*NR + c];
+                            continue;
+                        }
+                        if( k0 > 0 )
+                            for( r = 0; r < mr; r++, tb += GEMM_NC )
+                                for( c = 0; c < nr; c++ )
+                                    acc[r*NR + c] += tb[c];
+
+                        T* d = (T*)D->data + (i0 + i)*dstep + j0 + j;
+                        if( C->data && beta != 0 )
+                        {
+                            const T* cp = (const T*)C->data + (i0 + i)*crs + (j0 + j)*ccs;
+                            for( r = 0; r < mr; r++, d += dstep, cp += crs )
+                                for( c = 0; c < nr; c++ )
+                                    d[c] = (T)(alpha*acc[r*NR + c] + beta*cp[c*ccs]);
+                        }
+                        else
+                        {
+                            for( r = 0; r < mr; r++, d += dstep )
+                                for( c = 0; c < nr; c++ )
+                                    d[c] = (T)(alpha*acc[r*NR + c]);
+                        }
+                    }
+            }
+        }
+    }
+
+private:
+    const Mat *A, *B, *C;
+    Mat* D;
+    double alpha, beta;
+    int flags, len, ntilesX;
+};
+
+template<typename T> static void
+GEMMPackedMul( const Mat& A, const Mat& B, const Mat& C, Mat& D,
+               double alpha, double beta, int flags, int len )
+{
+    GEMMPackedInvoker<T> invoker(A, B, C, D, alpha, beta, flags, len);
+    parallel_for_(Range(0, invoker.ntiles()), invoker, invoker.ntiles());
+}
+
 }
 
 void cv::gemm( InputArray matA, InputArray matB, double alpha,
@@ -1050,6 +1377,18 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
         matD = &tmat;
     }
 
+    if( (type == CV_32FC1 || type == CV_64FC1) && std::min(d_size.width, d_size.height) >= GEMM_MR &&
+        len >= GEMM_MR && (double)d_size.width*d_size.height*len >= GEMM_PACKED_MIN_OPS )
+    {
+        if( type == CV_32FC1 )
+            GEMMPackedMul<float>(A, B, C, *matD, alpha, beta, flags, len);
+        else
+            GEMMPackedMul<double>(A, B, C, *matD, alpha, beta, flags, len);
+        if( matD != &D )
+            matD->copyTo(D);
+        return;
+    }
+
     if( (d_size.width == 1 || len == 1) && !(flags & GEMM_2_T) && B.isContinuous() )
     {
         b_step = d_size.width == 1 ? 0 : CV_ELEM_SIZE(type);
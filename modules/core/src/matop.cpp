@@ -205,6 +205,36 @@ public:
 
 static MatOp_Initializer g_MatOp_Initializer;
 
+class MatOp_Fused : public MatOp
+{
+public:
+    MatOp_Fused() {}
+    virtual ~MatOp_Fused() {}
+
+    bool elementWise(const MatExpr& /*expr*/) const { return true; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const;
+
+    void roi(const MatExpr& expr, const Range& rowRange, const Range& colRange, MatExpr& res) const;
+    void diag(const MatExpr& expr, int d, MatExpr& res) const;
+
+    void add(const MatExpr& e1, const Scalar& s, MatExpr& res) const;
+    void subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const;
+    void multiply(const MatExpr& e1, double s, MatExpr& res) const;
+    void divide(double s, const MatExpr& e, MatExpr& res) const;
+    void abs(const MatExpr& expr, MatExpr& res) const;
+
+    Size size(const MatExpr& expr) const;
+    int type(const MatExpr& expr) const;
+
+    // builds 'e1 op e2' (op is '+', '-', '*' or '/') if the eager evaluation
+    // would have to store e1 or e2 in a temporary matrix; returns false otherwise
+    static bool makeExpr(MatExpr& res, char op, const MatExpr& e1, const MatExpr& e2, double scale=1);
+    // the same for 'e*alpha + s' (op == '+'), 'alpha/e' (op == '/') and 'abs(e)' (op == 'a')
+    static bool makeExpr(MatExpr& res, char op, const MatExpr& e, double alpha=1, const Scalar& s=Scalar());
+};
+
+static MatOp_Fused g_MatOp_Fused;
+
 static inline bool isIdentity(const MatExpr& e) { return e.op == &g_MatOp_Identity; }
 static inline bool isAddEx(const MatExpr& e) { return e.op == &g_MatOp_AddEx; }
 static inline bool isScaled(const MatExpr& e) { return isAddEx(e) && (!e.b.data || e.beta == 0) && e.s == Scalar(); }
@@ -217,6 +247,7 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 static inline bool isGEMM(const MatExpr& e) { return e.op == &g_MatOp_GEMM; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == &g_MatOp_Initializer; }
+static inline bool isFused(const MatExpr& e) { return e.op == &g_MatOp_Fused; }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -270,6 +301,13 @@ void MatOp::diag(const MatExpr& expr, int d, MatExpr& e) const
 
 void MatOp::augAssignAdd(const MatExpr& expr, Mat& m) const
 {
+    MatExpr e;
+    if( MatOp_Fused::makeExpr(e, '+', MatExpr(m), expr) )
+    {
+        e.op->assign(e, m);
+        return;
+    }
+
     Mat temp;
     expr.op->assign(expr, temp);
     m += temp;
@@ -278,6 +316,13 @@ void MatOp::augAssignAdd(const MatExpr& expr, Mat& m) const
 
 void MatOp::augAssignSubtract(const MatExpr& expr, Mat& m) const
 {
+    MatExpr e;
+    if( MatOp_Fused::makeExpr(e, '-', MatExpr(m), expr) )
+    {
+        e.op->assign(e, m);
+        return;
+    }
+
     Mat temp;
     expr.op->assign(expr, temp);
     m -= temp;
@@ -294,6 +339,13 @@ void MatOp::augAssignMultiply(const MatExpr& expr, Mat& m) const
 
 void MatOp::augAssignDivide(const MatExpr& expr, Mat& m) const
 {
+    MatExpr e;
+    if( MatOp_Fused::makeExpr(e, '/', MatExpr(m), expr) )
+    {
+        e.op->assign(e, m);
+        return;
+    }
+
     Mat temp;
     expr.op->assign(expr, temp);
     m /= temp;
@@ -328,6 +380,9 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( MatOp_Fused::makeExpr(res, '+', e1, e2) )
+            return;
+
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
@@ -357,6 +412,9 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
+    if( MatOp_Fused::makeExpr(res, '+', expr1, 1, s) )
+        return;
+
     Mat m1;
     expr1.op->assign(expr1, m1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
@@ -367,6 +425,9 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( MatOp_Fused::makeExpr(res, '-', e1, e2) )
+            return;
+
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
@@ -396,6 +457,9 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
+    if( MatOp_Fused::makeExpr(res, '+', expr, -1, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
@@ -406,6 +470,9 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 {
     if( this == e2.op )
     {
+        if( MatOp_Fused::makeExpr(res, '*', e1, e2, scale) )
+            return;
+
         Mat m1, m2;
 
         if( isReciprocal(e1) )
@@ -455,6 +522,9 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
 void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
+    if( MatOp_Fused::makeExpr(res, '+', expr, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
@@ -465,6 +535,9 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 {
     if( this == e2.op )
     {
+        if( MatOp_Fused::makeExpr(res, '/', e1, e2, scale) )
+            return;
+
         if( isReciprocal(e1) && isReciprocal(e2) )
             MatOp_Bin::makeExpr(res, '/', e2.a, e1.a, e1.alpha/e2.alpha);
         else
@@ -503,6 +576,9 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 
 void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
+    if( MatOp_Fused::makeExpr(res, '/', expr, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
@@ -511,6 +587,9 @@ void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 
 void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
+    if( MatOp_Fused::makeExpr(res, 'a', expr) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
@@ -1586,6 +1665,763 @@ inline void MatOp_Initializer::makeExpr(MatExpr& res, int method, int ndims, con
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/*
+  Fused element-wise expressions.
+
+  When an element-wise expression is an operand of another one, e.g. (a*0.5 + b*0.25) - c,
+  the eager evaluation stores the inner expression in a temporary matrix. Instead, such
+  expressions are compiled into a stack-machine program that is run over blocks of
+  FUSED_BLOCK_SIZE elements: the operands are loaded and converted to the working type,
+  all the operations are applied to the block while it is in the cache and the result
+  is converted and written to the destination matrix. Every operation is followed by the
+  same rounding and saturation that the eager evaluation applies to its temporary matrices.
+  The 8- and 16-bit operands are processed in single precision, like the eager add, addWeighted,
+  multiply, min, max, absdiff and compare do, so these operations give the same integer results.
+  Large products, e.g. a.mul(b) of 16-bit matrices, are rounded to float in both cases.
+  The division is the exception: cv::divide scales by a reciprocal shared by 4 neighbour
+  elements, so its integer results may differ by 1 from the fused ones, which divide every
+  element separately. Floating-point results may differ in the last bits.
+*/
+
+enum { FUSED_BLOCK_SIZE = 1024 };
+
+class MatExprProgram
+{
+public:
+    enum
+    {
+        OP_LOAD,    // r[dst] = args[arg]
+        OP_ADDW,    // r[dst] = r[dst]*alpha + r[src2]*beta + s (src2 < 0 means that there is no r[src2]*beta term)
+        OP_MUL,     // r[dst] = alpha*r[dst]*r[src2]
+        OP_DIV,     // r[dst] = r[src2] != 0 ? r[dst]*alpha/r[src2] : 0
+        OP_RECIP,   // r[dst] = r[dst] != 0 ? alpha/r[dst] : 0
+        OP_MIN,     // r[dst] = min(r[dst], r[src2] or s)
+        OP_MAX,     // r[dst] = max(r[dst], r[src2] or s)
+        OP_ABSDIFF, // r[dst] = |r[dst] - (r[src2] or s)|
+        OP_CMP,     // r[dst] = r[dst] <arg> (r[src2] or s) ? 255 : 0
+        OP_SAT      // r[dst] = saturate_cast<depth arg>(r[dst])
+    };
+
+    struct Instr
+    {
+        int op, dst, src2, arg;
+        double alpha, beta;
+        Scalar s;
+    };
+
+    MatExprProgram() : nregs(0), type(-1), scaled(false), alpha(1) {}
+
+    void emit(int op, int dst, int src2=-1, int arg=0, double _alpha=1, double _beta=0,
+              const Scalar& _s=Scalar())
+    {
+        Instr instr = { op, dst, src2, arg, _alpha, _beta, _s };
+        code.push_back(instr);
+        nregs = std::max(nregs, std::max(dst, src2) + 1);
+    }
+
+    void load(const Mat& m, int dst)
+    {
+        args.push_back(m);
+        emit(OP_LOAD, dst, -1, (int)args.size() - 1);
+    }
+
+    void saturate(int dst, int depth)
+    {
+        if( depth != CV_64F )
+            emit(OP_SAT, dst, -1, depth);
+    }
+
+    // appends the code of another program, moving its registers by 'shift'
+    void append(const MatExprProgram& p, int shift)
+    {
+        int argofs = (int)args.size();
+        args.insert(args.end(), p.args.begin(), p.args.end());
+        for( size_t i = 0; i < p.code.size(); i++ )
+        {
+            Instr instr = p.code[i];
+            instr.dst += shift;
+            if( instr.src2 >= 0 )
+                instr.src2 += shift;
+            if( instr.op == OP_LOAD )
+                instr.arg += argofs;
+            code.push_back(instr);
+        }
+        nregs = std::max(nregs, p.nregs + shift);
+    }
+
+    std::vector<Mat> args;
+    std::vector<Instr> code;
+    int nregs;
+    Size size;
+    int type;
+
+    // if set, the expression is r[0]*alpha + s; like in MatOp_AddEx, the scale and the shift
+    // are not applied until the expression is evaluated or used as an operand, so that
+    // the following multiplications by a number and additions of a scalar are folded into them
+    bool scaled;
+    double alpha;
+    Scalar s;
+};
+
+/*
+  A fused expression keeps its program in MatExpr::a, a 1 x sizeof(MatExprProgram) byte matrix
+  allocated by MatExprProgramAllocator; b and c are empty. The matrix reference counter controls
+  the lifetime of the program, so the expression can be copied like the other ones. The program
+  is not modified after it has been built; the operations on the expression make new ones.
+*/
+class MatExprProgramAllocator : public MatAllocator
+{
+public:
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step)
+    {
+        CV_Assert( dims == 2 && sizes[0] == 1 && sizes[1] == (int)sizeof(MatExprProgram) && type == CV_8U );
+        size_t totalsize = alignSize(sizeof(MatExprProgram), (int)sizeof(*refcount));
+        data = datastart = (uchar*)fastMalloc(totalsize + sizeof(*refcount));
+        new(data) MatExprProgram;
+        refcount = (int*)(data + totalsize);
+        *refcount = 1;
+        step[0] = sizeof(MatExprProgram);
+        step[1] = 1;
+    }
+
+    void deallocate(int* /*refcount*/, uchar* datastart, uchar* /*data*/)
+    {
+        ((MatExprProgram*)datastart)->~MatExprProgram();
+        fastFree(datastart);
+    }
+};
+
+static MatExprProgramAllocator g_MatExprProgramAllocator;
+
+// creates the holder of a new program, optionally a copy of another one
+static MatExprProgram& createProgram(Mat& holder, const MatExprProgram* src=0)
+{
+    holder.allocator = &g_MatExprProgramAllocator;
+    holder.create(1, (int)sizeof(MatExprProgram), CV_8U);
+    MatExprProgram& p = *(MatExprProgram*)holder.data;
+    if( src )
+        p = *src;
+    return p;
+}
+
+static inline const MatExprProgram& fusedProgram(const MatExpr& e)
+{
+    return *(const MatExprProgram*)e.a.data;
+}
+
+// the expressions that can be operands of a fused expression
+static bool isFusable(const MatExpr& e)
+{
+    if( !e.op || !e.op->elementWise(e) )
+        return false;
+    if( isFused(e) )
+        return true;
+    return e.a.dims <= 2 && e.a.channels() <= 4 &&
+        (!e.b.data || (e.b.size() == e.a.size() && e.b.type() == e.a.type()));
+}
+
+// MatExpr::type() reports single-channel type for the comparisons
+static int exprType(const MatExpr& e)
+{
+    return isCmp(e) ? CV_8UC(e.a.channels()) : e.type();
+}
+
+// evaluates e*alpha + b*beta + s into register dst the way MatOp_AddEx::assign() does
+static void compileAddEx(MatExprProgram& p, int dst, bool haveB, double alpha, double beta,
+                         const Scalar& s, int depth)
+{
+    if( haveB )
+    {
+        if( s == Scalar() || !s.isReal() )
+        {
+            p.emit(MatExprProgram::OP_ADDW, dst, dst + 1, 0, alpha, beta);
+            p.saturate(dst, depth);
+            if( !s.isReal() )
+            {
+                p.emit(MatExprProgram::OP_ADDW, dst, -1, 0, 1, 0, s);
+                p.saturate(dst, depth);
+            }
+        }
+        else
+        {
+            p.emit(MatExprProgram::OP_ADDW, dst, dst + 1, 0, alpha, beta, Scalar::all(s[0]));
+            p.saturate(dst, depth);
+        }
+    }
+    else if( s.isReal() && fabs(alpha) != 1 )
+    {
+        p.emit(MatExprProgram::OP_ADDW, dst, -1, 0, alpha, 0, Scalar::all(s[0]));
+        p.saturate(dst, depth);
+    }
+    else if( fabs(alpha) == 1 )
+    {
+        p.emit(MatExprProgram::OP_ADDW, dst, -1, 0, alpha, 0, s);
+        p.saturate(dst, depth);
+    }
+    else
+    {
+        p.emit(MatExprProgram::OP_ADDW, dst, -1, 0, alpha, 0);
+        p.saturate(dst, depth);
+        p.emit(MatExprProgram::OP_ADDW, dst, -1, 0, 1, 0, s);
+        p.saturate(dst, depth);
+    }
+}
+
+// appends the code that computes e into register dst; registers above dst may be used as scratch
+static void compileExpr(MatExprProgram& p, const MatExpr& e, int dst)
+{
+    typedef MatExprProgram P;
+    int depth = CV_MAT_DEPTH(e.type());
+
+    if( isFused(e) )
+    {
+        p.append(fusedProgram(e), dst);
+        if( fusedProgram(e).scaled )
+            compileAddEx(p, dst, false, fusedProgram(e).alpha, 0, fusedProgram(e).s, depth);
+    }
+    else if( isIdentity(e) )
+        p.load(e.a, dst);
+    else if( isAddEx(e) && isFusable(e) )
+    {
+        p.load(e.a, dst);
+        if( e.b.data )
+            p.load(e.b, dst + 1);
+        compileAddEx(p, dst, e.b.data != 0, e.alpha, e.beta, e.s, depth);
+    }
+    else if( isCmp(e) && isFusable(e) )
+    {
+        p.load(e.a, dst);
+        if( e.b.data )
+        {
+            p.load(e.b, dst + 1);
+            p.emit(P::OP_CMP, dst, dst + 1, e.flags);
+        }
+        else
+            p.emit(P::OP_CMP, dst, -1, e.flags, 1, 0, Scalar::all(e.alpha));
+    }
+    else if( e.op == &g_MatOp_Bin && isFusable(e) && strchr("*/mMa", e.flags) != 0 &&
+             (e.b.data || e.flags != '*') )
+    {
+        p.load(e.a, dst);
+        if( e.b.data )
+            p.load(e.b, dst + 1);
+        int src2 = e.b.data ? dst + 1 : -1;
+
+        if( e.flags == '*' )
+            p.emit(P::OP_MUL, dst, src2, 0, e.alpha);
+        else if( e.flags == '/' )
+            p.emit(e.b.data ? P::OP_DIV : P::OP_RECIP, dst, src2, 0, e.alpha);
+        else if( e.flags == 'a' )
+            p.emit(P::OP_ABSDIFF, dst, src2, 0, 1, 0, e.s);
+        else
+            p.emit(e.flags == 'm' ? P::OP_MIN : P::OP_MAX, dst, src2, 0, 1, 0, Scalar::all(e.s[0]));
+        p.saturate(dst, depth);
+    }
+    else
+    {
+        Mat m;
+        e.op->assign(e, m);
+        p.load(m, dst);
+    }
+}
+
+// the operand of a binary operation that the eager evaluation uses without a temporary matrix
+static bool isSimpleOperand(const MatExpr& e, char op)
+{
+    if( isIdentity(e) )
+        return true;
+    if( op == '+' || op == '-' )
+        return (isAddEx(e) && (!e.b.data || e.beta == 0)) || (isFused(e) && fusedProgram(e).scaled);
+    return isScaled(e) || (isFused(e) && fusedProgram(e).scaled && fusedProgram(e).s == Scalar());
+}
+
+// puts e into register dst; for the simple operands the scale and the shift
+// are returned in alpha and s instead of being applied
+static void compileOperand(MatExprProgram& p, const MatExpr& e, int dst, char op, double& alpha, Scalar& s)
+{
+    alpha = 1;
+    s = Scalar();
+    if( isIdentity(e) )
+        p.load(e.a, dst);
+    else if( !isSimpleOperand(e, op) )
+        compileExpr(p, e, dst);
+    else if( isFused(e) )
+    {
+        p.append(fusedProgram(e), dst);
+        alpha = fusedProgram(e).alpha;
+        s = fusedProgram(e).s;
+    }
+    else
+    {
+        p.load(e.a, dst);
+        alpha = e.alpha;
+        s = e.s;
+    }
+}
+
+static void makeFusedExpr(MatExpr& res, const Mat& holder)
+{
+    res = MatExpr(&g_MatOp_Fused, 0, holder);
+}
+
+bool MatOp_Fused::makeExpr(MatExpr& res, char op, const MatExpr& e1, const MatExpr& e2, double scale)
+{
+    if( (isSimpleOperand(e1, op) && isSimpleOperand(e2, op) && !isFused(e1) && !isFused(e2)) ||
+        !isFusable(e1) || !isFusable(e2) || isReciprocal(e1) || isReciprocal(e2) ||
+        e1.size() != e2.size() || exprType(e1) != exprType(e2) )
+        return false;
+
+    typedef MatExprProgram P;
+    Mat holder;
+    P* p = &createProgram(holder);
+    p->size = e1.size();
+    p->type = exprType(e1);
+    int depth = CV_MAT_DEPTH(p->type);
+    double alpha1, alpha2;
+    Scalar s1, s2;
+
+    compileOperand(*p, e1, 0, op, alpha1, s1);
+    compileOperand(*p, e2, 1, op, alpha2, s2);
+
+    if( op == '+' )
+        compileAddEx(*p, 0, true, alpha1, alpha2, s1 + s2, depth);
+    else if( op == '-' )
+        compileAddEx(*p, 0, true, alpha1, -alpha2, s1 - s2, depth);
+    else
+    {
+        scale *= op == '*' ? alpha1*alpha2 : alpha1/alpha2;
+        p->emit(op == '*' ? P::OP_MUL : P::OP_DIV, 0, 1, 0, scale);
+        p->saturate(0, depth);
+    }
+
+    makeFusedExpr(res, holder);
+    return true;
+}
+
+bool MatOp_Fused::makeExpr(MatExpr& res, char op, const MatExpr& e, double alpha, const Scalar& s)
+{
+    if( isIdentity(e) || !isFusable(e) )
+        return false;
+
+    typedef MatExprProgram P;
+    Mat holder;
+    P* p = &createProgram(holder);
+    p->size = e.size();
+    p->type = exprType(e);
+    int depth = CV_MAT_DEPTH(p->type);
+
+    compileExpr(*p, e, 0);
+    if( op == '+' )
+    {
+        p->scaled = true;
+        p->alpha = alpha;
+        p->s = s;
+    }
+    else
+    {
+        if( op == '/' )
+            p->emit(P::OP_RECIP, 0, -1, 0, alpha);
+        else
+            p->emit(P::OP_ABSDIFF, 0, -1, 0, 1, 0, Scalar());
+        p->saturate(0, depth);
+    }
+
+    makeFusedExpr(res, holder);
+    return true;
+}
+
+void MatOp_Fused::add(const MatExpr& e, const Scalar& s, MatExpr& res) const
+{
+    if( !fusedProgram(e).scaled )
+    {
+        MatOp::add(e, s, res);
+        return;
+    }
+    Mat holder;
+    MatExprProgram* p = &createProgram(holder, &fusedProgram(e));
+    p->s += s;
+    makeFusedExpr(res, holder);
+}
+
+void MatOp_Fused::subtract(const Scalar& s, const MatExpr& e, MatExpr& res) const
+{
+    if( !fusedProgram(e).scaled )
+    {
+        MatOp::subtract(s, e, res);
+        return;
+    }
+    Mat holder;
+    MatExprProgram* p = &createProgram(holder, &fusedProgram(e));
+    p->alpha = -p->alpha;
+    p->s = s - p->s;
+    makeFusedExpr(res, holder);
+}
+
+void MatOp_Fused::multiply(const MatExpr& e, double s, MatExpr& res) const
+{
+    if( !fusedProgram(e).scaled )
+    {
+        MatOp::multiply(e, s, res);
+        return;
+    }
+    Mat holder;
+    MatExprProgram* p = &createProgram(holder, &fusedProgram(e));
+    p->alpha *= s;
+    p->s *= s;
+    makeFusedExpr(res, holder);
+}
+
+void MatOp_Fused::divide(double s, const MatExpr& e, MatExpr& res) const
+{
+    const MatExprProgram& q = fusedProgram(e);
+    if( !q.scaled || q.s != Scalar() )
+    {
+        MatOp::divide(s, e, res);
+        return;
+    }
+    Mat holder;
+    MatExprProgram* p = &createProgram(holder, &q);
+    p->scaled = false;
+    p->emit(MatExprProgram::OP_RECIP, 0, -1, 0, s/q.alpha);
+    p->saturate(0, CV_MAT_DEPTH(q.type));
+    makeFusedExpr(res, holder);
+}
+
+void MatOp_Fused::abs(const MatExpr& e, MatExpr& res) const
+{
+    const MatExprProgram& q = fusedProgram(e);
+    if( !q.scaled || fabs(q.alpha) != 1 )
+    {
+        MatOp::abs(e, res);
+        return;
+    }
+    Mat holder;
+    MatExprProgram* p = &createProgram(holder, &q);
+    p->scaled = false;
+    p->emit(MatExprProgram::OP_ABSDIFF, 0, -1, 0, 1, 0, -q.s*q.alpha);
+    p->saturate(0, CV_MAT_DEPTH(q.type));
+    makeFusedExpr(res, holder);
+}
+
+template<typename WT> static void
+saturateBlock( WT* r, int len, int depth )
+{
+    static const double lo[] = { 0, SCHAR_MIN, 0, SHRT_MIN, INT_MIN };
+    static const double hi[] = { UCHAR_MAX, SCHAR_MAX, USHRT_MAX, SHRT_MAX, INT_MAX };
+    int i = 0;
+
+    if( depth == CV_32F )
+    {
+        for( ; i < len; i++ )
+            r[i] = (WT)saturate_cast<float>(r[i]);
+        return;
+    }
+
+    WT a = (WT)lo[depth], b = (WT)hi[depth];
+#if CV_SSE2
+    if( sizeof(WT) == sizeof(float) && USE_SSE2 )
+    {
+        __m128 va = _mm_set1_ps((float)a), vb = _mm_set1_ps((float)b);
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps((const float*)(r + i)), va), vb);
+            _mm_storeu_ps((float*)(r + i), _mm_cvtepi32_ps(_mm_cvtps_epi32(v)));
+        }
+    }
+#endif
+    for( ; i < len; i++ )
+        r[i] = (WT)cvRound(std::min(std::max(r[i], a), b));
+}
+
+// processes the beginning of the block with SSE2 and returns the number of elements done;
+// the order of the operations and the rounding are the same as in runFusedBlock()
+template<typename WT> static inline int
+runFusedOpVec( int, WT*, const WT*, const WT*, bool, double, double, int )
+{
+    return 0;
+}
+
+#if CV_SSE2
+template<> inline int
+runFusedOpVec<float>( int op, float* d, const float* x, const float* c, bool hasSrc2,
+                      double alpha, double beta, int len )
+{
+    typedef MatExprProgram P;
+    int i = 0;
+    if( !USE_SSE2 )
+        return 0;
+
+    __m128 va = _mm_set1_ps((float)alpha), vb = _mm_set1_ps((float)beta);
+    switch( op )
+    {
+    case P::OP_ADDW:
+        if( hasSrc2 )
+            for( ; i <= len - 4; i += 4 )
+            {
+                __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(d + i), va),
+                                      _mm_mul_ps(_mm_loadu_ps(x + i), vb));
+                _mm_storeu_ps(d + i, _mm_add_ps(v, _mm_loadu_ps(c + i)));
+            }
+        else
+            for( ; i <= len - 4; i += 4 )
+                _mm_storeu_ps(d + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(d + i), va), _mm_loadu_ps(c + i)));
+        break;
+    case P::OP_MUL:
+        for( ; i <= len - 4; i += 4 )
+            _mm_storeu_ps(d + i, _mm_mul_ps(_mm_mul_ps(va, _mm_loadu_ps(d + i)), _mm_loadu_ps(x + i)));
+        break;
+    case P::OP_DIV:
+        {
+            // the quotient is computed in double precision, as alpha is a double
+            __m128d va2 = _mm_set1_pd(alpha);
+            __m128 z = _mm_setzero_ps();
+            for( ; i <= len - 4; i += 4 )
+            {
+                __m128 vd = _mm_loadu_ps(d + i), vx = _mm_loadu_ps(x + i);
+                __m128d q0 = _mm_div_pd(_mm_mul_pd(_mm_cvtps_pd(vd), va2), _mm_cvtps_pd(vx));
+                __m128d q1 = _mm_div_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(vd, vd)), va2),
+                                        _mm_cvtps_pd(_mm_movehl_ps(vx, vx)));
+                __m128 q = _mm_movelh_ps(_mm_cvtpd_ps(q0), _mm_cvtpd_ps(q1));
+                _mm_storeu_ps(d + i, _mm_and_ps(q, _mm_cmpneq_ps(vx, z)));
+            }
+        }
+        break;
+    case P::OP_MIN:
+        // std::min(a, b) is b < a ? b : a, and _mm_min_ps(b, a) is the same
+        for( ; i <= len - 4; i += 4 )
+            _mm_storeu_ps(d + i, _mm_min_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(d + i)));
+        break;
+    case P::OP_MAX:
+        for( ; i <= len - 4; i += 4 )
+            _mm_storeu_ps(d + i, _mm_max_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(d + i)));
+        break;
+    }
+    return i;
+}
+#endif
+
+template<typename WT> static void
+runFusedBlock( const MatExprProgram& p, WT* regs, const WT* consts, int blockSize,
+               const uchar** ptrs, const BinaryFunc* loadFuncs, int len )
+{
+    typedef MatExprProgram P;
+    int i;
+
+    for( size_t k = 0; k < p.code.size(); k++ )
+    {
+        const P::Instr& instr = p.code[k];
+        WT* d = regs + instr.dst*blockSize;
+        const WT* x = instr.src2 >= 0 ? regs + instr.src2*blockSize : consts + k*blockSize;
+        WT alpha = (WT)instr.alpha, beta = (WT)instr.beta;
+
+        switch( instr.op )
+        {
+        case P::OP_LOAD:
+            loadFuncs[instr.arg](ptrs[instr.arg], 0, 0, 0, (uchar*)d, 0, Size(len, 1), 0);
+            break;
+        case P::OP_ADDW:
+            {
+                const WT* c = consts + k*blockSize;
+                i = runFusedOpVec(instr.op, d, x, c, instr.src2 >= 0, instr.alpha, instr.beta, len);
+                if( instr.src2 >= 0 )
+                    for( ; i < len; i++ )
+                        d[i] = d[i]*alpha + x[i]*beta + c[i];
+                else
+                    for( ; i < len; i++ )
+                        d[i] = d[i]*alpha + c[i];
+            }
+            break;
+        case P::OP_MUL:
+            i = runFusedOpVec(instr.op, d, x, (const WT*)0, true, instr.alpha, 0., len);
+            for( ; i < len; i++ )
+                d[i] = alpha*d[i]*x[i];
+            break;
+        case P::OP_DIV:
+            i = runFusedOpVec(instr.op, d, x, (const WT*)0, true, instr.alpha, 0., len);
+            for( ; i < len; i++ )
+                d[i] = x[i] != 0 ? (WT)(d[i]*instr.alpha/x[i]) : 0;
+            break;
+        case P::OP_RECIP:
+            for( i = 0; i < len; i++ )
+                d[i] = d[i] != 0 ? (WT)(instr.alpha/d[i]) : 0;
+            break;
+        case P::OP_MIN:
+            i = runFusedOpVec(instr.op, d, x, (const WT*)0, true, 1., 0., len);
+            for( ; i < len; i++ )
+                d[i] = std::min(d[i], x[i]);
+            break;
+        case P::OP_MAX:
+            i = runFusedOpVec(instr.op, d, x, (const WT*)0, true, 1., 0., len);
+            for( ; i < len; i++ )
+                d[i] = std::max(d[i], x[i]);
+            break;
+        case P::OP_ABSDIFF:
+            for( i = 0; i < len; i++ )
+                d[i] = std::abs(d[i] - x[i]);
+            break;
+        case P::OP_CMP:
+            for( i = 0; i < len; i++ )
+            {
+                WT a = d[i], b = x[i];
+                bool f = instr.arg == CMP_EQ ? a == b : instr.arg == CMP_GT ? a > b :
+                         instr.arg == CMP_GE ? a >= b : instr.arg == CMP_LT ? a < b :
+                         instr.arg == CMP_LE ? a <= b : a != b;
+                d[i] = f ? (WT)255 : (WT)0;
+            }
+            break;
+        case P::OP_SAT:
+            saturateBlock(d, len, instr.arg);
+            break;
+        default:
+            CV_Error(CV_StsBadArg, "Unknown fused operation");
+        }
+    }
+}
+
+template<typename WT> static void
+runFused( const MatExprProgram& p, const Mat* args, Mat& dst )
+{
+    int wdepth = DataType<WT>::depth, cn = dst.channels();
+    int blockSize = (FUSED_BLOCK_SIZE/cn)*cn;
+    size_t k, nargs = p.args.size(), ncode = p.code.size();
+
+    AutoBuffer<WT> _buf(blockSize*(p.nregs + ncode));
+    WT* regs = _buf;
+    WT* consts = regs + blockSize*p.nregs;
+    for( k = 0; k < ncode; k++ )
+    {
+        const Scalar& s = p.code[k].s;
+        for( int i = 0; i < blockSize; i++ )
+            consts[k*blockSize + i] = saturate_cast<WT>(s[i % cn]);
+    }
+
+    AutoBuffer<uchar> _ptrs((nargs + 2)*(sizeof(Mat*) + sizeof(uchar*) + sizeof(BinaryFunc)) + 16);
+    const Mat** arrays = (const Mat**)(uchar*)_ptrs;
+    uchar** ptrs = (uchar**)alignPtr(arrays + nargs + 2, 16);
+    BinaryFunc* loadFuncs = (BinaryFunc*)(ptrs + nargs + 1);
+    for( k = 0; k < nargs; k++ )
+    {
+        arrays[k] = &args[k];
+        loadFuncs[k] = getConvertFunc(args[k].depth(), wdepth);
+    }
+    arrays[nargs] = &dst;
+    arrays[nargs + 1] = 0;
+    BinaryFunc storeFunc = getConvertFunc(wdepth, dst.depth());
+    size_t desz = dst.elemSize1();
+
+    NAryMatIterator it(arrays, ptrs, (int)(nargs + 1));
+    int total = (int)(it.size*cn);
+
+    for( size_t i = 0; i < it.nplanes; i++, ++it )
+    {
+        for( int j = 0; j < total; j += blockSize )
+        {
+            int len = std::min(total - j, blockSize);
+            runFusedBlock(p, regs, consts, blockSize, (const uchar**)ptrs, loadFuncs, len);
+            storeFunc((const uchar*)regs, 0, 0, 0, ptrs[nargs], 0, Size(len, 1), 0);
+
+            for( k = 0; k < nargs; k++ )
+                ptrs[k] += len*args[k].elemSize1();
+            ptrs[nargs] += len*desz;
+        }
+    }
+}
+
+static void runFused( const MatExprProgram& p, const Mat* args, Mat& dst )
+{
+    // the integer types up to 16 bits are computed in single precision, as the eager
+    // arithmetic does for them; 32-bit integers and doubles need double precision
+    bool useDouble = dst.depth() == CV_32S || dst.depth() == CV_64F;
+    for( size_t k = 0; k < p.args.size(); k++ )
+        useDouble = useDouble || args[k].depth() == CV_32S || args[k].depth() == CV_64F;
+    for( size_t k = 0; k < p.code.size(); k++ )
+        useDouble = useDouble || (p.code[k].op == MatExprProgram::OP_SAT && p.code[k].arg == CV_32S);
+
+    if( useDouble )
+        runFused<double>(p, args, dst);
+    else
+        runFused<float>(p, args, dst);
+}
+
+class FusedInvoker : public ParallelLoopBody
+{
+public:
+    FusedInvoker(const MatExprProgram& _p, const Mat& _dst) : p(_p), dst(_dst) {}
+
+    void operator()(const Range& range) const
+    {
+        size_t nargs = p.args.size();
+        AutoBuffer<Mat> args(nargs);
+        for( size_t k = 0; k < nargs; k++ )
+            args[k] = getElemwiseStripe(p.args[k], range);
+        Mat dstripe = getElemwiseStripe(dst, range);
+        runFused(p, args, dstripe);
+    }
+
+private:
+    const MatExprProgram& p;
+    Mat dst;
+};
+
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    MatExprProgram p;
+    p.size = fusedProgram(e).size;
+    p.type = fusedProgram(e).type;
+    compileExpr(p, e, 0);
+
+    int type = _type < 0 ? p.type : CV_MAKETYPE(CV_MAT_DEPTH(_type), CV_MAT_CN(p.type));
+    size_t i, nargs = p.args.size();
+
+    m.create(p.size, type);
+
+    size_t total = m.total()*m.elemSize();
+    for( i = 0; i < nargs; i++ )
+    {
+        CV_Assert( p.args[i].size() == p.size && p.args[i].channels() == m.channels() );
+        total += p.args[i].total()*p.args[i].elemSize();
+    }
+
+    int nstripes = getElemwiseNStripes(total);
+    if( nstripes > 1 )
+        parallel_for_(Range(0, getElemwiseRange(m)), FusedInvoker(p, m), nstripes);
+    else
+        runFused(p, nargs > 0 ? &p.args[0] : 0, m);
+}
+
+void MatOp_Fused::roi(const MatExpr& e, const Range& rowRange, const Range& colRange, MatExpr& res) const
+{
+    Mat holder;
+    MatExprProgram* p = &createProgram(holder, &fusedProgram(e));
+    for( size_t i = 0; i < p->args.size(); i++ )
+        p->args[i] = p->args[i](rowRange, colRange);
+    p->size = p->args[0].size();
+    makeFusedExpr(res, holder);
+}
+
+void MatOp_Fused::diag(const MatExpr& e, int d, MatExpr& res) const
+{
+    Mat holder;
+    MatExprProgram* p = &createProgram(holder, &fusedProgram(e));
+    for( size_t i = 0; i < p->args.size(); i++ )
+        p->args[i] = p->args[i].diag(d);
+    p->size = p->args[0].size();
+    makeFusedExpr(res, holder);
+}
+
+Size MatOp_Fused::size(const MatExpr& e) const
+{
+    return fusedProgram(e).size;
+}
+
+int MatOp_Fused::type(const MatExpr& e) const
+{
+    return fusedProgram(e).type;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 MatExpr Mat::t() const
 {
     MatExpr e;
@@ -198,6 +198,9 @@ void Mat::create(int d, const int* _sizes, int _type)
     }
 
     release();
+    // the allocator taken from MatAllocatorScope is not kept when the matrix is re-allocated
+    if( flags & DEFAULT_ALLOCATOR_FLAG )
+        allocator = 0;
     if( d == 0 )
         return;
     flags = (_type & CV_MAT_TYPE_MASK) | MAGIC_VAL;
@@ -205,6 +208,8 @@ void Mat::create(int d, const int* _sizes, int _type)
 
     if( total() > 0 )
     {
+        if( !allocator && (allocator = getDefaultMatAllocator()) != 0 )
+            flags |= DEFAULT_ALLOCATOR_FLAG;
 #ifdef HAVE_TGPU
         if( !allocator || allocator == tegra::getAllocator() ) allocator = tegra::getAllocator(d, _sizes, _type);
 #endif
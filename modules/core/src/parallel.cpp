@@ -54,6 +54,7 @@
     #include <unistd.h>
     #include <stdio.h>
     #include <sys/types.h>
+    #include <pthread.h>
     #if defined ANDROID
         #include <sys/sysconf.h>
     #else
@@ -79,6 +80,7 @@
    3. HAVE_OPENMP      - integrated to compiler, should be explicitly enabled
    4. HAVE_GCD         - system wide, used automatically        (APPLE only)
    5. HAVE_CONCURRENCY - part of runtime, used automatically    (Windows only - MSVS 10, MSVS 11)
+   6. HAVE_PTHREADS_PF - built-in thread pool, used automatically if none of the above is available
 */
 
 #if defined HAVE_TBB
@@ -107,21 +109,116 @@
         #include <pthread.h>
     #elif defined HAVE_CONCURRENCY
         #include <ppl.h>
+    #elif defined HAVE_PTHREADS_PF
+        // see parallel_pthreads.cpp
     #endif
 #endif
 
 #if defined HAVE_TBB || defined HAVE_CSTRIPES || defined HAVE_OPENMP || defined HAVE_GCD || defined HAVE_CONCURRENCY
+    #undef HAVE_PTHREADS_PF
+#endif
+
+#if defined HAVE_TBB || defined HAVE_CSTRIPES || defined HAVE_OPENMP || defined HAVE_GCD || defined HAVE_CONCURRENCY || defined HAVE_PTHREADS_PF
    #define HAVE_PARALLEL_FRAMEWORK
 #endif
 
 namespace cv
 {
     ParallelLoopBody::~ParallelLoopBody() {}
+
+    // per-thread state of the parallel framework
+    struct ParallelContext
+    {
+        ParallelContext() : maxThreads(-1), level(0) {}
+
+        int maxThreads; // limit set by ParallelScope, negative if there is no limit
+        int level;      // > 0 while the thread executes a parallel_for_ body
+    };
+
+#if defined WIN32 || defined _WIN32
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+    static DWORD tlsParallelKey = TLS_OUT_OF_INDEXES;
+
+    void deleteThreadParallelData()
+    {
+        if( tlsParallelKey != TLS_OUT_OF_INDEXES )
+            delete (ParallelContext*)TlsGetValue( tlsParallelKey );
+    }
+
+    static ParallelContext& getParallelContext()
+    {
+        if( tlsParallelKey == TLS_OUT_OF_INDEXES )
+        {
+            tlsParallelKey = TlsAlloc();
+            CV_Assert(tlsParallelKey != TLS_OUT_OF_INDEXES);
+        }
+        ParallelContext* ctx = (ParallelContext*)TlsGetValue( tlsParallelKey );
+        if( !ctx )
+        {
+            ctx = new ParallelContext;
+            TlsSetValue( tlsParallelKey, ctx );
+        }
+        return *ctx;
+    }
+#else
+    static pthread_key_t tlsParallelKey = 0;
+    static pthread_once_t tlsParallelKeyOnce = PTHREAD_ONCE_INIT;
+
+    static void deleteParallelContext(void* data)
+    {
+        delete (ParallelContext*)data;
+    }
+
+    static void makeParallelKey()
+    {
+        int errcode = pthread_key_create(&tlsParallelKey, deleteParallelContext);
+        CV_Assert(errcode == 0);
+    }
+
+    static ParallelContext& getParallelContext()
+    {
+        pthread_once(&tlsParallelKeyOnce, makeParallelKey);
+        ParallelContext* ctx = (ParallelContext*)pthread_getspecific(tlsParallelKey);
+        if( !ctx )
+        {
+            ctx = new ParallelContext;
+            pthread_setspecific(tlsParallelKey, ctx);
+        }
+        return *ctx;
+    }
+#endif
+
+    ParallelScope::ParallelScope(int nthreads)
+    {
+        ParallelContext& ctx = getParallelContext();
+        prevThreads = ctx.maxThreads;
+        // a scope can only tighten the limit of the enclosing one
+        if( prevThreads >= 0 && (nthreads < 0 || nthreads > prevThreads) )
+            nthreads = prevThreads;
+        ctx.maxThreads = nthreads;
+    }
+
+    ParallelScope::~ParallelScope()
+    {
+        getParallelContext().maxThreads = prevThreads;
+    }
 }
 
 namespace
 {
 #ifdef HAVE_PARALLEL_FRAMEWORK
+    // marks the current thread as running a loop body, so that nested parallel_for_ calls run inline
+    class NestedRegion
+    {
+    public:
+        NestedRegion() : ctx(cv::getParallelContext()) { ctx.level++; }
+        ~NestedRegion() { ctx.level--; }
+    private:
+        cv::ParallelContext& ctx;
+    };
+
     class ParallelLoopBodyWrapper
     {
     public:
@@ -139,6 +236,7 @@ namespace
                             ((size_t)sr.start*(wholeRange.end - wholeRange.start) + nstripes/2)/nstripes);
             r.end = sr.end >= nstripes ? wholeRange.end : (int)(wholeRange.start +
                             ((size_t)sr.end*(wholeRange.end - wholeRange.start) + nstripes/2)/nstripes);
+            NestedRegion region;
             (*body)(r);
         }
         cv::Range stripeRange() const { return cv::Range(0, nstripes); }
@@ -184,6 +282,19 @@ namespace
             this->ParallelLoopBodyWrapper::operator()(cv::Range(i, i + 1));
         }
     };
+#elif defined HAVE_PTHREADS_PF
+    class ProxyLoopBody : public cv::ParallelLoopBody, public ParallelLoopBodyWrapper
+    {
+    public:
+        ProxyLoopBody(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes)
+        : ParallelLoopBodyWrapper(_body, _r, _nstripes)
+        {}
+
+        void operator ()(const cv::Range& r) const
+        {
+            this->ParallelLoopBodyWrapper::operator()(r);
+        }
+    };
 #else
     typedef ParallelLoopBodyWrapper ProxyLoopBody;
 #endif
@@ -216,6 +327,8 @@ public:
     ~SchedPtr() { *this = 0; }
 };
 static SchedPtr pplScheduler;
+#elif defined HAVE_PTHREADS_PF
+// the pool is created on first use
 #endif
 
 #endif // HAVE_PARALLEL_FRAMEWORK
@@ -228,8 +341,17 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
 {
 #ifdef HAVE_PARALLEL_FRAMEWORK
 
-    if(numThreads != 0)
+    const ParallelContext& ctx = getParallelContext();
+    int maxThreads = ctx.maxThreads;
+
+    if(numThreads != 0 && ctx.level == 0 && (maxThreads < 0 || maxThreads > 1))
     {
+#if defined HAVE_TBB || defined HAVE_GCD || defined HAVE_CONCURRENCY
+        // these frameworks can not limit the number of threads per call,
+        // so the number of stripes that may run concurrently is limited instead
+        if(maxThreads > 0)
+            nstripes = std::min(nstripes <= 0 ? (double)(range.end - range.start) : nstripes, (double)maxThreads);
+#endif
         ProxyLoopBody pbody(body, range, nstripes);
         cv::Range stripeRange = pbody.stripeRange();
 
@@ -239,7 +361,7 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
 
 #elif defined HAVE_CSTRIPES
 
-        parallel(MAX(0, numThreads))
+        parallel(maxThreads > 0 ? (numThreads > 0 ? MIN(numThreads, maxThreads) : maxThreads) : MAX(0, numThreads))
         {
             int offset = stripeRange.start;
             int len = stripeRange.end - offset;
@@ -250,7 +372,7 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
 
 #elif defined HAVE_OPENMP
 
-        #pragma omp parallel for schedule(dynamic)
+        #pragma omp parallel for schedule(dynamic) num_threads(maxThreads > 0 ? std::min(maxThreads, omp_get_max_threads()) : omp_get_max_threads())
         for (int i = stripeRange.start; i < stripeRange.end; ++i)
             pbody(Range(i, i + 1));
 
@@ -272,6 +394,10 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
             Concurrency::CurrentScheduler::Detach();
         }
 
+#elif defined HAVE_PTHREADS_PF
+
+        parallel_for_pthreads(stripeRange, pbody, maxThreads);
+
 #else
 
 #error You have hacked and compiling with unsupported parallel framework
@@ -288,7 +414,7 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
     }
 }
 
-int cv::getNumThreads(void)
+static int getNumThreadsImpl()
 {
 #ifdef HAVE_PARALLEL_FRAMEWORK
 
@@ -323,6 +449,10 @@ int cv::getNumThreads(void)
                 ? Concurrency::CurrentScheduler::Get()->GetNumberOfVirtualProcessors()
                 : pplScheduler->GetNumberOfVirtualProcessors());
 
+#elif defined HAVE_PTHREADS_PF
+
+    return cv::parallel_pthreads_get_threads_num();
+
 #else
 
     return 1;
@@ -330,6 +460,13 @@ int cv::getNumThreads(void)
 #endif
 }
 
+int cv::getNumThreads(void)
+{
+    int nthreads = getNumThreadsImpl();
+    int maxThreads = cv::getParallelContext().maxThreads;
+    return maxThreads >= 0 ? std::max(std::min(nthreads, maxThreads), 1) : nthreads;
+}
+
 void cv::setNumThreads( int threads )
 {
     (void)threads;
@@ -376,6 +513,13 @@ void cv::setNumThreads( int threads )
                        Concurrency::MaxConcurrency, threads-1));
     }
 
+#elif defined HAVE_PTHREADS_PF
+
+    if(threads == 1)
+        numThreads = 0; // run everything in the calling thread, keep the pool as is
+    else
+        parallel_pthreads_set_threads_num(threads);
+
 #endif
 }
 
@@ -396,6 +540,8 @@ int cv::getThreadNum(void)
     return (int)(size_t)(void*)pthread_self(); // no zero-based indexing
 #elif defined HAVE_CONCURRENCY
     return std::max(0, (int)Concurrency::Context::VirtualProcessorId()); // zero for master thread, unique number for others but not necessary 1,2,3,...
+#elif defined HAVE_PTHREADS_PF
+    return parallel_pthreads_get_thread_num();
 #else
     return 0;
 #endif
@@ -0,0 +1,525 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#ifdef HAVE_PTHREADS_PF
+
+#include <pthread.h>
+#include <sched.h>
+
+/*
+   Native thread pool used by cv::parallel_for_ when no other parallel framework is available.
+
+   Every thread taking part in a loop (the caller plus N-1 pool workers) owns a queue that
+   holds a contiguous sub-range of stripe indices. The owner pops stripes from the front of its
+   queue; once the queue is empty it steals the back half of another thread's queue. Workers
+   spin for a short while before going to sleep, so back-to-back calls on small images do not
+   pay for a futex round-trip each time.
+
+   An exception thrown by the loop body is caught in the thread that executed the stripe; the
+   first one is kept, the stripes that have not been started yet are skipped, and the exception
+   is rethrown in the caller's thread once all the workers are done with the body.
+*/
+
+namespace cv
+{
+
+class StripeQueue
+{
+public:
+    StripeQueue() : begin(0), end(0) {}
+
+    void reset(int _begin, int _end)
+    {
+        AutoLock lock(mutex);
+        begin = _begin;
+        end = _end;
+    }
+
+    bool pop(int& idx)
+    {
+        AutoLock lock(mutex);
+        if( begin >= end )
+            return false;
+        idx = begin++;
+        return true;
+    }
+
+    // takes the back half of the remaining stripes (at least one)
+    bool steal(int& _begin, int& _end)
+    {
+        AutoLock lock(mutex);
+        int len = end - begin;
+        if( len <= 0 )
+            return false;
+        _end = end;
+        _begin = end - (len + 1)/2;
+        end = _begin;
+        return true;
+    }
+
+    bool empty() const { return begin >= end; }
+
+protected:
+    Mutex mutex;
+    volatile int begin, end;
+    // keeps the queues of different threads in different cache lines
+    char pad[64];
+};
+
+
+class ParallelThreadPool
+{
+public:
+    ParallelThreadPool();
+    ~ParallelThreadPool();
+
+    void run(const Range& stripeRange, const ParallelLoopBody& body, int maxThreads);
+
+    void setNumThreads(int nthreads);
+    int getNumThreads() const { return nthreads; }
+
+    static ParallelThreadPool& instance();
+    static int threadIndex();
+
+protected:
+    struct WorkerArg
+    {
+        ParallelThreadPool* pool;
+        int idx;
+    };
+
+    static void* workerMain(void* arg);
+    void workerLoop(int idx);
+    void processStripes(int idx);
+    void start(int nthreads);
+    void stop();
+    void runStripe(const ParallelLoopBody& loopBody, int i);
+    void setError(const Exception* e, const char* what);
+
+    int nthreads;
+    std::vector<pthread_t> threads;
+    std::vector<WorkerArg> args;
+    // not a std::vector: copies of cv::Mutex share the same lock
+    StripeQueue* queues;
+
+    // the loop currently being executed and the number of threads taking part in it
+    const ParallelLoopBody* body;
+    int jobThreads;
+    volatile int generation;
+    volatile int remaining;
+    int active;
+    bool stopping;
+    // set by the caller that owns jobMutex while its loop is executed by the pool
+    bool jobActive;
+    // a thread count requested while a loop was running; applied once it is finished
+    int pendingThreads;
+
+    // the first exception thrown by the current loop body
+    volatile bool hasError;
+    Exception error;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t wakeCond;
+    pthread_cond_t doneCond;
+    // serializes callers; a caller that can not get the pool runs its loop inline
+    Mutex jobMutex;
+};
+
+
+// tries to lock jobMutex, never waits for it, and unlocks it on every way out of the scope.
+// It must stay a trylock: jobMutex is not recursive, and setNumThreads() is called with it
+// already held by the same thread when a loop body running in the caller changes the thread count
+class JobLock
+{
+public:
+    JobLock(Mutex& _m) : m(_m), locked(m.trylock() != 0) {}
+    ~JobLock() { if( locked ) m.unlock(); }
+    bool isLocked() const { return locked; }
+
+private:
+    Mutex& m;
+    bool locked;
+
+    JobLock(const JobLock&);
+    JobLock& operator = (const JobLock&);
+};
+
+
+enum { SPIN_COUNT = 4096 };
+
+static pthread_key_t tlsThreadIdxKey = 0;
+static pthread_once_t tlsThreadIdxKeyOnce = PTHREAD_ONCE_INIT;
+
+static void makeThreadIdxKey()
+{
+    int errcode = pthread_key_create(&tlsThreadIdxKey, 0);
+    CV_Assert(errcode == 0);
+}
+
+// 0 means "not a pool worker", workers store their index + 1
+static void setThreadIndex(int idx)
+{
+    pthread_once(&tlsThreadIdxKeyOnce, makeThreadIdxKey);
+    pthread_setspecific(tlsThreadIdxKey, (void*)(size_t)(idx + 1));
+}
+
+int ParallelThreadPool::threadIndex()
+{
+    pthread_once(&tlsThreadIdxKeyOnce, makeThreadIdxKey);
+    return std::max((int)(size_t)pthread_getspecific(tlsThreadIdxKey) - 1, 0);
+}
+
+static bool isPoolWorker()
+{
+    pthread_once(&tlsThreadIdxKeyOnce, makeThreadIdxKey);
+    return pthread_getspecific(tlsThreadIdxKey) != 0;
+}
+
+static inline void cpuRelax()
+{
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+    __asm__ __volatile__("pause" ::: "memory");
+#else
+    __sync_synchronize();
+#endif
+}
+
+
+ParallelThreadPool::ParallelThreadPool()
+{
+    nthreads = 0;
+    queues = 0;
+    body = 0;
+    jobThreads = 0;
+    generation = 0;
+    remaining = 0;
+    active = 0;
+    stopping = false;
+    jobActive = false;
+    pendingThreads = 0;
+    hasError = false;
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&wakeCond, 0);
+    pthread_cond_init(&doneCond, 0);
+    start(getNumberOfCPUs());
+}
+
+ParallelThreadPool::~ParallelThreadPool()
+{
+    stop();
+    pthread_cond_destroy(&doneCond);
+    pthread_cond_destroy(&wakeCond);
+    pthread_mutex_destroy(&mutex);
+}
+
+ParallelThreadPool& ParallelThreadPool::instance()
+{
+    static ParallelThreadPool pool;
+    return pool;
+}
+
+void ParallelThreadPool::start(int _nthreads)
+{
+    nthreads = std::max(_nthreads, 1);
+    stopping = false;
+    queues = new StripeQueue[nthreads];
+    args.resize(nthreads);
+    threads.clear();
+
+    for( int i = 1; i < nthreads; i++ )
+    {
+        args[i].pool = this;
+        args[i].idx = i;
+        pthread_t t;
+        if( pthread_create(&t, 0, workerMain, &args[i]) != 0 )
+        {
+            // could not create more threads; work with what we have
+            nthreads = i;
+            break;
+        }
+        threads.push_back(t);
+    }
+}
+
+void ParallelThreadPool::stop()
+{
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    pthread_cond_broadcast(&wakeCond);
+    pthread_mutex_unlock(&mutex);
+
+    for( size_t i = 0; i < threads.size(); i++ )
+        pthread_join(threads[i], 0);
+    threads.clear();
+    delete[] queues;
+    queues = 0;
+    nthreads = 1;
+}
+
+void ParallelThreadPool::setNumThreads(int _nthreads)
+{
+    if( _nthreads <= 0 )
+        _nthreads = getNumberOfCPUs();
+
+    // the pool can not be rebuilt under a running loop: from a loop body (a worker, or the
+    // caller's own stripe) or while another thread's loop is running. The request is then
+    // applied by run() when that loop is finished. cv::Mutex is not recursive, and run() keeps
+    // jobMutex locked for the whole loop, so the caller's own stripe must not block on it here:
+    // JobLock only tries the lock, and the failure (or jobActive, if the lock was just released)
+    // means a loop is running. Taking the lock unconditionally would deadlock in that stripe.
+    JobLock lock(jobMutex);
+    if( isPoolWorker() || !lock.isLocked() || jobActive )
+    {
+        pthread_mutex_lock(&mutex);
+        pendingThreads = _nthreads;
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+
+    pendingThreads = 0;
+    if( _nthreads == nthreads )
+        return;
+    stop();
+    start(_nthreads);
+}
+
+void* ParallelThreadPool::workerMain(void* arg)
+{
+    WorkerArg* warg = (WorkerArg*)arg;
+    setThreadIndex(warg->idx);
+    warg->pool->workerLoop(warg->idx);
+    return 0;
+}
+
+void ParallelThreadPool::workerLoop(int idx)
+{
+    int lastGeneration = 0;
+
+    for(;;)
+    {
+        for( int i = 0; i < SPIN_COUNT && generation == lastGeneration && !stopping; i++ )
+            cpuRelax();
+
+        pthread_mutex_lock(&mutex);
+        while( generation == lastGeneration && !stopping )
+            pthread_cond_wait(&wakeCond, &mutex);
+        if( stopping )
+        {
+            pthread_mutex_unlock(&mutex);
+            break;
+        }
+        lastGeneration = generation;
+        // the loop may already be finished if we woke up too late,
+        // or it may be limited to fewer threads than the pool has
+        bool hasWork = body != 0 && idx < jobThreads;
+        if( hasWork )
+            active++;
+        pthread_mutex_unlock(&mutex);
+
+        if( !hasWork )
+            continue;
+
+        processStripes(idx);
+
+        pthread_mutex_lock(&mutex);
+        if( --active == 0 && remaining == 0 )
+            pthread_cond_signal(&doneCond);
+        pthread_mutex_unlock(&mutex);
+    }
+}
+
+void ParallelThreadPool::setError(const Exception* e, const char* what)
+{
+    pthread_mutex_lock(&mutex);
+    if( !hasError )
+    {
+        error = e ? *e : Exception(CV_StsError, what, "cv::parallel_for_", __FILE__, __LINE__);
+        hasError = true;
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void ParallelThreadPool::runStripe(const ParallelLoopBody& loopBody, int i)
+{
+    // once the loop has failed, the remaining stripes are only counted
+    if( hasError )
+        return;
+
+    try
+    {
+        loopBody(Range(i, i + 1));
+    }
+    catch( const Exception& e )
+    {
+        setError(&e, 0);
+    }
+    catch( const std::exception& e )
+    {
+        setError(0, e.what());
+    }
+    catch( ... )
+    {
+        setError(0, "Unknown exception in the parallel loop body");
+    }
+}
+
+void ParallelThreadPool::processStripes(int idx)
+{
+    const ParallelLoopBody& loopBody = *body;
+    StripeQueue& own = queues[idx];
+
+    for(;;)
+    {
+        int i;
+        while( own.pop(i) )
+        {
+            runStripe(loopBody, i);
+            CV_XADD(&remaining, -1);
+        }
+
+        // own queue is empty; try to steal from the others, starting from the neighbour
+        bool stolen = false;
+        for( int k = 1; k < jobThreads && !stolen; k++ )
+        {
+            StripeQueue& victim = queues[(idx + k) % jobThreads];
+            int sbegin, send;
+            if( !victim.empty() && victim.steal(sbegin, send) )
+            {
+                own.reset(sbegin, send);
+                stolen = true;
+            }
+        }
+
+        if( !stolen )
+            break;
+    }
+}
+
+void ParallelThreadPool::run(const Range& stripeRange, const ParallelLoopBody& _body, int maxThreads)
+{
+    int nstripes = stripeRange.end - stripeRange.start;
+
+    // nested calls, concurrent callers and tiny loops are executed inline
+    if( nstripes <= 1 || maxThreads == 1 || isPoolWorker() )
+    {
+        for( int i = stripeRange.start; i < stripeRange.end; i++ )
+            _body(Range(i, i + 1));
+        return;
+    }
+
+    JobLock lock(jobMutex);
+    // the thread count is read under jobMutex, setNumThreads() may change it otherwise
+    int n = std::min(nthreads, nstripes);
+    if( maxThreads > 0 )
+        n = std::min(n, maxThreads);
+
+    if( n <= 1 || !lock.isLocked() || jobActive )
+    {
+        for( int i = stripeRange.start; i < stripeRange.end; i++ )
+            _body(Range(i, i + 1));
+        return;
+    }
+
+    for( int i = 0; i < n; i++ )
+        queues[i].reset(stripeRange.start + (int)((int64)nstripes*i/n),
+                        stripeRange.start + (int)((int64)nstripes*(i+1)/n));
+
+    pthread_mutex_lock(&mutex);
+    body = &_body;
+    jobThreads = n;
+    remaining = nstripes;
+    jobActive = true;
+    hasError = false;
+    generation++;
+    pthread_cond_broadcast(&wakeCond);
+    pthread_mutex_unlock(&mutex);
+
+    // processStripes() does not throw, so the workers are always waited for
+    processStripes(0);
+
+    pthread_mutex_lock(&mutex);
+    while( remaining > 0 || active > 0 )
+        pthread_cond_wait(&doneCond, &mutex);
+    body = 0;
+    jobActive = false;
+    int _pendingThreads = pendingThreads;
+    pendingThreads = 0;
+    bool failed = hasError;
+    hasError = false;
+    pthread_mutex_unlock(&mutex);
+
+    if( _pendingThreads > 0 && _pendingThreads != nthreads )
+    {
+        stop();
+        start(_pendingThreads);
+    }
+
+    if( failed )
+        throw error;
+}
+
+
+void parallel_for_pthreads(const Range& stripeRange, const ParallelLoopBody& body, int maxThreads)
+{
+    ParallelThreadPool::instance().run(stripeRange, body, maxThreads);
+}
+
+void parallel_pthreads_set_threads_num(int nthreads)
+{
+    ParallelThreadPool::instance().setNumThreads(nthreads);
+}
+
+int parallel_pthreads_get_threads_num()
+{
+    return ParallelThreadPool::instance().getNumThreads();
+}
+
+int parallel_pthreads_get_thread_num()
+{
+    return ParallelThreadPool::threadIndex();
+}
+
+}
+
+#endif // HAVE_PTHREADS_PF
@@ -68,6 +68,14 @@
 #  include <zlib.h>
 #endif
 
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#  define USE_MMAP 0
+#else
+#  define USE_MMAP 1
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
 /****************************************************************************************\
 *                            Common macros and type definitions                          *
 \****************************************************************************************/
@@ -173,6 +181,31 @@ typedef struct CvFileMapNode
 }
 CvFileMapNode;
 
+/* the sequence of a binary storage node written with cvWriteRawData(). The numbers stay
+   in the file mapping; the sequence elements are only created when somebody asks for them */
+typedef struct CvFileNodeBlob
+{
+    CV_SEQUENCE_FIELDS()
+    const uchar* blob_data;
+    int blob_depth;
+}
+CvFileNodeBlob;
+
+#define CV_NODE_SEQ_BLOB 512
+#define CV_NODE_IS_BLOB(node) \
+    (CV_NODE_IS_SEQ((node)->tag) && ((node)->data.seq->flags & CV_NODE_SEQ_BLOB) != 0)
+
+/* the content of a binary storage, memory-mapped or read into memory. It is referenced
+   by the storage and by the matrices that are read from it without copying */
+typedef struct CvFileMapping
+{
+    int refcount;
+    uchar* data;
+    size_t size;
+    bool mapped;
+}
+CvFileMapping;
+
 typedef struct CvXMLStackRecord
 {
     CvMemStoragePos pos;
@@ -240,6 +273,12 @@ typedef struct CvFileStorage
     std::deque<char>* outbuf;
 
     bool is_opened;
+
+    CvFileMapping* mapping;
+    fpos_t rawpos;
+    int rawdepth;
+    int rawcount;
+    size_t binofs;
 }
 CvFileStorage;
 
@@ -326,6 +365,53 @@ static void icvRewind( CvFileStorage* fs )
     fs->strbufpos = 0;
 }
 
+static CvFileMapping* icvMapFile( FILE* file )
+{
+    CvFileMapping* mapping = new CvFileMapping;
+    memset( mapping, 0, sizeof(*mapping) );
+    mapping->refcount = 1;
+
+#if USE_MMAP
+    struct stat st;
+    if( fstat( fileno(file), &st ) == 0 && st.st_size > 0 )
+    {
+        // the mapping is private and writable, so that the matrices can be modified in place
+        void* ptr = mmap( 0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0 );
+        if( ptr != MAP_FAILED )
+        {
+            mapping->data = (uchar*)ptr;
+            mapping->size = (size_t)st.st_size;
+            mapping->mapped = true;
+            return mapping;
+        }
+    }
+#endif
+
+    fseek( file, 0, SEEK_END );
+    long size = ftell( file );
+    rewind( file );
+    if( size > 0 )
+    {
+        mapping->data = (uchar*)cv::fastMalloc( (size_t)size );
+        mapping->size = fread( mapping->data, 1, (size_t)size, file );
+    }
+    return mapping;
+}
+
+static void icvReleaseFileMapping( CvFileMapping* mapping )
+{
+    if( mapping && CV_XADD(&mapping->refcount, -1) == 1 )
+    {
+#if USE_MMAP
+        if( mapping->mapped )
+            munmap( mapping->data, mapping->size );
+        else
+#endif
+            cv::fastFree( mapping->data );
+        delete mapping;
+    }
+}
+
 #define CV_YML_INDENT  3
 #define CV_XML_INDENT  2
 #define CV_YML_INDENT_FLOW  1
@@ -435,6 +521,69 @@ icvFSCreateCollection( CvFileStorage* fs, int tag, CvFileNode* collection )
 }
 
 
+/* appends the numbers from a binary storage to the sequence as the regular file nodes */
+static void
+icvFSAppendNumbers( CvSeq* seq, const uchar* data, int depth, int count )
+{
+    CvSeqWriter writer;
+    cvStartAppendToSeq( seq, &writer );
+
+    for( int i = 0; i < count; i++ )
+    {
+        CvFileNode elem;
+        memset( &elem, 0, sizeof(elem) );
+        elem.tag = CV_NODE_INT;
+
+        switch( depth )
+        {
+        case CV_8U:
+            elem.data.i = ((const uchar*)data)[i];
+            break;
+        case CV_8S:
+            elem.data.i = ((const schar*)data)[i];
+            break;
+        case CV_16U:
+            elem.data.i = ((const ushort*)data)[i];
+            break;
+        case CV_16S:
+            elem.data.i = ((const short*)data)[i];
+            break;
+        case CV_32S:
+            elem.data.i = ((const int*)data)[i];
+            break;
+        case CV_32F:
+            elem.tag = CV_NODE_REAL;
+            elem.data.f = ((const float*)data)[i];
+            break;
+        default:
+            elem.tag = CV_NODE_REAL;
+            elem.data.f = ((const double*)data)[i];
+        }
+        CV_WRITE_SEQ_ELEM( elem, writer );
+    }
+    cvEndWriteSeq( &writer );
+}
+
+
+/* creates the sequence elements of a binary storage blob, if they have not been created yet.
+   It is called by the functions that give access to the individual elements */
+static void
+icvFSExpandBlob( const CvFileNode* node )
+{
+    if( !node || !CV_NODE_IS_BLOB(node) )
+        return;
+
+    CvSeq* seq = node->data.seq;
+    if( seq->first || seq->total == 0 )
+        return;
+
+    const CvFileNodeBlob* blob = (const CvFileNodeBlob*)seq;
+    int count = seq->total;
+    seq->total = 0;
+    icvFSAppendNumbers( seq, blob->blob_data, blob->blob_depth, count );
+}
+
+
 /*static void
 icvFSReleaseCollection( CvSeq* seq )
 {
@@ -515,6 +664,8 @@ icvFSFlush( CvFileStorage* fs )
 }
 
 
+static void icvBinFlushRawData( CvFileStorage* fs );
+
 static void
 icvClose( CvFileStorage* fs, std::string* out )
 {
@@ -533,7 +684,10 @@ icvClose( CvFileStorage* fs, std::string* out )
                 while( fs->write_stack->total > 0 )
                     cvEndWriteStruct(fs);
             }
-            icvFSFlush(fs);
+            if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+                icvBinFlushRawData(fs);
+            else
+                icvFSFlush(fs);
             if( fs->fmt == CV_STORAGE_FORMAT_XML )
                 icvPuts( fs, "</opencv_storage>\n" );
         }
@@ -566,6 +720,7 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
         cvReleaseMemStorage( &fs->strstorage );
         cvFree( &fs->buffer_start );
         cvReleaseMemStorage( &fs->memstorage );
+        icvReleaseFileMapping( fs->mapping );
 
         if( fs->outbuf )
             delete fs->outbuf;
@@ -682,6 +837,7 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
                 if( !create_missing )
                 {
                     value = &another->value;
+                    icvFSExpandBlob( value );
                     return value;
                 }
                 CV_PARSE_ERROR( "Duplicated key" );
@@ -702,8 +858,10 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
 }
 
 
-CV_IMPL CvFileNode*
-cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+/* the same as cvGetFileNodeByName(), but the binary storage blobs are not expanded,
+   so that they can be read directly from the file mapping */
+static CvFileNode*
+icvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
 {
     CvFileNode* value = 0;
     int i, len, tab_size;
@@ -773,6 +931,15 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
 }
 
 
+CV_IMPL CvFileNode*
+cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+{
+    CvFileNode* value = icvGetFileNodeByName( fs, _map_node, str );
+    icvFSExpandBlob( value );
+    return value;
+}
+
+
 CV_IMPL CvFileNode*
 cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
 {
@@ -2651,6 +2818,511 @@ icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
 }
 
 
+/****************************************************************************************\
+*                                     Binary Format                                      *
+\****************************************************************************************/
+
+/* The binary storage starts with CvBinHeader, followed by the records. Each record is
+   CvBinRecord, followed by the key and by the string value or the type name, both
+   zero-terminated; the next record starts at the next CV_BIN_ALIGN-aligned offset.
+   The numbers written by cvWriteRawData() make CV_BIN_RAW records, which keep the data
+   aligned to CV_BIN_DATA_ALIGN bytes, so that the matrices can use it right from the mapping.
+   The data is stored in the native byte order, which is checked when the file is opened. */
+
+static const char icvBinSignature[] = "%OCVBIN\n";
+
+enum
+{
+    CV_BIN_VERSION = 1,
+    CV_BIN_BYTE_ORDER = 0x01020304,
+    CV_BIN_ALIGN = 8,
+    CV_BIN_DATA_ALIGN = 64
+};
+
+enum
+{
+    CV_BIN_INT = 1,
+    CV_BIN_REAL = 2,
+    CV_BIN_STRING = 3,
+    CV_BIN_START_STRUCT = 4,
+    CV_BIN_END_STRUCT = 5,
+    CV_BIN_RAW = 6,
+    CV_BIN_NEXT_STREAM = 7
+};
+
+typedef struct CvBinHeader
+{
+    char signature[8];
+    int version;
+    int byte_order;
+}
+CvBinHeader;
+
+typedef struct CvBinRecord
+{
+    int kind;
+    int flags; // the collection type for CV_BIN_START_STRUCT, the depth for CV_BIN_RAW
+    int keylen;
+    int len;   // the length of the string value or the type name
+    union
+    {
+        double f;
+        int64 i; // the number of elements for CV_BIN_RAW
+    }
+    value;
+}
+CvBinRecord;
+
+typedef struct CvBinItem
+{
+    const CvBinRecord* rec;
+    const char* key;
+    const char* str;
+    const uchar* data;
+}
+CvBinItem;
+
+
+static bool
+icvBinIsStorage( FILE* file )
+{
+    CvBinHeader header;
+    bool ok = fread( &header, 1, sizeof(header), file ) == sizeof(header) &&
+              memcmp( header.signature, icvBinSignature, sizeof(header.signature) ) == 0;
+    rewind( file );
+    return ok;
+}
+
+
+static const uchar*
+icvBinReadItem( CvFileStorage* fs, const uchar* ptr, CvBinItem* item )
+{
+    const uchar* base = fs->mapping->data;
+    size_t size = fs->mapping->size, ofs = (size_t)(ptr - base);
+
+    if( size - ofs < sizeof(CvBinRecord) )
+        CV_PARSE_ERROR( "Truncated record" );
+
+    const CvBinRecord* rec = (const CvBinRecord*)ptr;
+    ofs += sizeof(*rec);
+    if( rec->keylen < 0 || rec->len < 0 || size - ofs < (size_t)rec->keylen + rec->len + 2 )
+        CV_PARSE_ERROR( "Truncated record" );
+
+    item->rec = rec;
+    item->key = rec->keylen > 0 ? (const char*)(base + ofs) : 0;
+    ofs += rec->keylen + 1;
+    item->str = (const char*)(base + ofs);
+    ofs += rec->len + 1;
+    item->data = 0;
+
+    if( item->str[rec->len] != '\0' || (item->key && item->key[rec->keylen] != '\0') )
+        CV_PARSE_ERROR( "Corrupted record" );
+
+    if( rec->kind == CV_BIN_RAW )
+    {
+        if( rec->flags < CV_8U || rec->flags > CV_64F ||
+            rec->value.i <= 0 || rec->value.i > INT_MAX )
+            CV_PARSE_ERROR( "Corrupted raw data record" );
+        size_t datasize = (size_t)rec->value.i*CV_ELEM_SIZE(rec->flags);
+        ofs = cv::alignSize( ofs, CV_BIN_DATA_ALIGN );
+        if( ofs > size || size - ofs < datasize )
+            CV_PARSE_ERROR( "Truncated raw data" );
+        item->data = base + ofs;
+        ofs += datasize;
+    }
+    else if( rec->kind < CV_BIN_INT || rec->kind > CV_BIN_NEXT_STREAM )
+        CV_PARSE_ERROR( "Unknown record type" );
+
+    return base + std::min( cv::alignSize( ofs, CV_BIN_ALIGN ), size );
+}
+
+
+/* turns the collection node into a blob, if the collection consists of a single raw data
+   record; returns the position after the collection in this case and NULL otherwise */
+static const uchar*
+icvBinTryCreateBlob( CvFileStorage* fs, const uchar* ptr, CvFileNode* node )
+{
+    const uchar* end = fs->mapping->data + fs->mapping->size;
+    CvBinItem raw, item;
+
+    if( ptr >= end )
+        return 0;
+    const uchar* next = icvBinReadItem( fs, ptr, &raw );
+    if( raw.rec->kind != CV_BIN_RAW || next >= end )
+        return 0;
+    next = icvBinReadItem( fs, next, &item );
+    if( item.rec->kind != CV_BIN_END_STRUCT )
+        return 0;
+
+    CvFileNodeBlob* blob = (CvFileNodeBlob*)cvCreateSeq( 0, sizeof(CvFileNodeBlob),
+                                                        sizeof(CvFileNode), fs->memstorage );
+    blob->flags |= CV_NODE_SEQ_SIMPLE | CV_NODE_SEQ_BLOB;
+    blob->total = (int)raw.rec->value.i;
+    blob->blob_data = raw.data;
+    blob->blob_depth = raw.rec->flags;
+    cvSetSeqBlockSize( (CvSeq*)blob, 1 << 10 );
+
+    node->tag = CV_NODE_SEQ;
+    node->data.seq = (CvSeq*)blob;
+    return next;
+}
+
+
+static void
+icvBinParse( CvFileStorage* fs )
+{
+    fs->mapping = icvMapFile( fs->file );
+
+    const uchar* base = fs->mapping->data;
+    const uchar* end = base + fs->mapping->size;
+    const CvBinHeader* header = (const CvBinHeader*)base;
+
+    if( fs->mapping->size < sizeof(*header) ||
+        memcmp( header->signature, icvBinSignature, sizeof(header->signature) ) != 0 )
+        CV_PARSE_ERROR( "Invalid binary storage header" );
+    if( header->byte_order != CV_BIN_BYTE_ORDER )
+        CV_PARSE_ERROR( "The binary storage has been written on a machine with a different byte order" );
+    if( header->version != CV_BIN_VERSION )
+        CV_PARSE_ERROR( "Unsupported version of the binary storage" );
+
+    const uchar* ptr = base + sizeof(*header);
+    std::vector<CvFileNode*> stack;
+    CvFileNode* root = 0;
+
+    while( ptr < end )
+    {
+        CvBinItem item;
+        ptr = icvBinReadItem( fs, ptr, &item );
+        int kind = item.rec->kind;
+
+        if( kind == CV_BIN_NEXT_STREAM )
+        {
+            if( !stack.empty() )
+                CV_PARSE_ERROR( "Unclosed collection at the end of the stream" );
+            root = 0;
+            continue;
+        }
+
+        if( kind == CV_BIN_END_STRUCT )
+        {
+            if( stack.empty() )
+                CV_PARSE_ERROR( "The end of a collection that has not been started" );
+            stack.pop_back();
+            continue;
+        }
+
+        if( !root )
+        {
+            root = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+            memset( root, 0, sizeof(*root) );
+            icvFSCreateCollection( fs, item.key ? CV_NODE_MAP : CV_NODE_SEQ, root );
+        }
+
+        CvFileNode* parent = stack.empty() ? root : stack.back();
+
+        if( kind == CV_BIN_RAW )
+        {
+            // the numbers share the sequence with some other elements
+            if( !CV_NODE_IS_SEQ(parent->tag) )
+                CV_PARSE_ERROR( "Raw data can only be stored in a sequence" );
+            icvFSAppendNumbers( parent->data.seq, item.data, item.rec->flags,
+                                (int)item.rec->value.i );
+            continue;
+        }
+
+        CvFileNode* node;
+        if( CV_NODE_IS_MAP(parent->tag) )
+        {
+            if( !item.key )
+                CV_PARSE_ERROR( "Map element should have a name" );
+            CvStringHashNode* key = cvGetHashedKey( fs, item.key, item.rec->keylen, 1 );
+            node = cvGetFileNode( fs, parent, key, 1 );
+        }
+        else
+        {
+            if( item.key )
+                CV_PARSE_ERROR( "Sequence element should not have name" );
+            node = (CvFileNode*)cvSeqPush( parent->data.seq, 0 );
+        }
+        memset( node, 0, sizeof(*node) );
+
+        switch( kind )
+        {
+        case CV_BIN_INT:
+            node->tag = CV_NODE_INT;
+            node->data.i = (int)item.rec->value.i;
+            break;
+        case CV_BIN_REAL:
+            node->tag = CV_NODE_REAL;
+            node->data.f = item.rec->value.f;
+            break;
+        case CV_BIN_STRING:
+            // the string stays in the mapping
+            node->tag = CV_NODE_STRING;
+            node->data.str.ptr = (char*)item.str;
+            node->data.str.len = item.rec->len;
+            break;
+        default:
+            {
+                int struct_flags = item.rec->flags;
+                if( !CV_NODE_IS_COLLECTION(struct_flags) )
+                    CV_PARSE_ERROR( "Unknown collection type" );
+
+                if( item.rec->len > 0 )
+                    node->info = cvFindType( item.str );
+
+                const uchar* next = 0;
+                if( CV_NODE_IS_SEQ(struct_flags) && !node->info )
+                    next = icvBinTryCreateBlob( fs, ptr, node );
+
+                if( next )
+                    ptr = next;
+                else
+                {
+                    icvFSCreateCollection( fs, CV_NODE_TYPE(struct_flags) +
+                                          (node->info ? CV_NODE_USER : 0), node );
+                    if( CV_NODE_IS_FLOW(struct_flags) )
+                        node->data.seq->flags |= CV_NODE_SEQ_SIMPLE;
+                    stack.push_back( node );
+                }
+            }
+        }
+
+        if( CV_NODE_IS_MAP(parent->tag) )
+            node->tag |= CV_NODE_NAMED;
+    }
+
+    if( !stack.empty() )
+        CV_PARSE_ERROR( "Unclosed collection at the end of the file" );
+}
+
+
+/****************************************************************************************\
+*                                    Binary Emitter                                      *
+\****************************************************************************************/
+
+static void
+icvBinPut( CvFileStorage* fs, const void* data, size_t size )
+{
+    if( size > 0 && fwrite( data, 1, size, fs->file ) != size )
+        CV_Error( CV_StsError, "Could not write to the file storage" );
+    fs->binofs += size;
+}
+
+
+static void
+icvBinPad( CvFileStorage* fs, int align )
+{
+    static const uchar zeros[CV_BIN_DATA_ALIGN] = {0};
+    icvBinPut( fs, zeros, cv::alignSize( fs->binofs, align ) - fs->binofs );
+}
+
+
+static void
+icvBinPutRecord( CvFileStorage* fs, CvBinRecord* rec, const char* key, const char* str )
+{
+    rec->keylen = key ? (int)strlen(key) : 0;
+    rec->len = str ? (int)strlen(str) : 0;
+    icvBinPut( fs, rec, sizeof(*rec) );
+    icvBinPut( fs, key, rec->keylen );
+    icvBinPut( fs, "", 1 );
+    icvBinPut( fs, str, rec->len );
+    icvBinPut( fs, "", 1 );
+    if( rec->kind == CV_BIN_RAW )
+        icvBinPad( fs, CV_BIN_DATA_ALIGN );
+    else
+        icvBinPad( fs, CV_BIN_ALIGN );
+}
+
+
+/* completes the raw data record that is being written: the record header
+   is written again with the final number of elements */
+static void
+icvBinFlushRawData( CvFileStorage* fs )
+{
+    if( fs->rawcount == 0 )
+        return;
+
+    CvBinRecord rec;
+    memset( &rec, 0, sizeof(rec) );
+    rec.kind = CV_BIN_RAW;
+    rec.flags = fs->rawdepth;
+    rec.value.i = fs->rawcount;
+    fs->rawcount = 0;
+
+    icvBinPad( fs, CV_BIN_ALIGN );
+    fpos_t pos;
+    if( fgetpos( fs->file, &pos ) != 0 || fsetpos( fs->file, &fs->rawpos ) != 0 ||
+        fwrite( &rec, sizeof(rec), 1, fs->file ) != 1 || fsetpos( fs->file, &pos ) != 0 )
+        CV_Error( CV_StsError, "Could not write to the file storage" );
+}
+
+
+/* checks that the element may be added to the current collection */
+static void
+icvBinStartElement( CvFileStorage* fs, const char* key )
+{
+    int struct_flags = fs->struct_flags;
+
+    if( CV_NODE_IS_COLLECTION(struct_flags) )
+    {
+        if( (CV_NODE_IS_MAP(struct_flags) ^ (key != 0)) )
+            CV_Error( CV_StsBadArg, "An attempt to add element without a key to a map, "
+                                    "or add element with key to sequence" );
+    }
+    else
+    {
+        fs->is_first = 0;
+        struct_flags = CV_NODE_EMPTY | (key ? CV_NODE_MAP : CV_NODE_SEQ);
+    }
+
+    if( key && strlen(key) > CV_FS_MAX_LEN )
+        CV_Error( CV_StsBadArg, "The key is too long" );
+
+    fs->struct_flags = struct_flags & ~CV_NODE_EMPTY;
+}
+
+
+static void
+icvBinWriteElement( CvFileStorage* fs, const char* key, CvBinRecord* rec, const char* str )
+{
+    if( key && key[0] == '\0' )
+        key = 0;
+    icvBinStartElement( fs, key );
+    icvBinFlushRawData( fs );
+    icvBinPutRecord( fs, rec, key, str );
+}
+
+
+static void
+icvBinStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
+                        const char* type_name CV_DEFAULT(0))
+{
+    struct_flags = struct_flags & (CV_NODE_TYPE_MASK|CV_NODE_FLOW);
+    if( !CV_NODE_IS_COLLECTION(struct_flags))
+        CV_Error( CV_StsBadArg,
+        "Some collection type - CV_NODE_SEQ or CV_NODE_MAP, must be specified" );
+
+    CvBinRecord rec;
+    memset( &rec, 0, sizeof(rec) );
+    rec.kind = CV_BIN_START_STRUCT;
+    rec.flags = struct_flags;
+    icvBinWriteElement( fs, key, &rec, type_name );
+
+    int parent_flags = fs->struct_flags;
+    cvSeqPush( fs->write_stack, &parent_flags );
+    fs->struct_flags = struct_flags | CV_NODE_EMPTY;
+}
+
+
+static void
+icvBinEndWriteStruct( CvFileStorage* fs )
+{
+    int parent_flags = 0;
+
+    if( fs->write_stack->total == 0 )
+        CV_Error( CV_StsError, "EndWriteStruct w/o matching StartWriteStruct" );
+
+    icvBinFlushRawData( fs );
+    cvSeqPop( fs->write_stack, &parent_flags );
+
+    CvBinRecord rec;
+    memset( &rec, 0, sizeof(rec) );
+    rec.kind = CV_BIN_END_STRUCT;
+    icvBinPutRecord( fs, &rec, 0, 0 );
+
+    fs->struct_flags = parent_flags;
+}
+
+
+static void
+icvBinStartNextStream( CvFileStorage* fs )
+{
+    if( !fs->is_first )
+    {
+        while( fs->write_stack->total > 0 )
+            icvBinEndWriteStruct(fs);
+        icvBinFlushRawData( fs );
+
+        CvBinRecord rec;
+        memset( &rec, 0, sizeof(rec) );
+        rec.kind = CV_BIN_NEXT_STREAM;
+        icvBinPutRecord( fs, &rec, 0, 0 );
+        fs->struct_flags = CV_NODE_EMPTY;
+    }
+}
+
+
+static void
+icvBinWriteInt( CvFileStorage* fs, const char* key, int value )
+{
+    CvBinRecord rec;
+    memset( &rec, 0, sizeof(rec) );
+    rec.kind = CV_BIN_INT;
+    rec.value.i = value;
+    icvBinWriteElement( fs, key, &rec, 0 );
+}
+
+
+static void
+icvBinWriteReal( CvFileStorage* fs, const char* key, double value )
+{
+    CvBinRecord rec;
+    memset( &rec, 0, sizeof(rec) );
+    rec.kind = CV_BIN_REAL;
+    rec.value.f = value;
+    icvBinWriteElement( fs, key, &rec, 0 );
+}
+
+
+static void
+icvBinWriteString( CvFileStorage* fs, const char* key,
+                   const char* str, int /*quote*/ CV_DEFAULT(0))
+{
+    if( !str )
+        CV_Error( CV_StsNullPtr, "Null string pointer" );
+
+    CvBinRecord rec;
+    memset( &rec, 0, sizeof(rec) );
+    rec.kind = CV_BIN_STRING;
+    icvBinWriteElement( fs, key, &rec, str );
+}
+
+
+static void
+icvBinWriteComment( CvFileStorage* /*fs*/, const char* /*comment*/, int /*eol_comment*/ )
+{
+    // the comments are not stored in the binary format
+}
+
+
+/* appends the array of numbers of the same type to the raw data record that is being written,
+   starting a new record if needed */
+static void
+icvBinWriteRawData( CvFileStorage* fs, const uchar* data, int count, int depth )
+{
+    icvBinStartElement( fs, 0 );
+
+    if( fs->rawcount > 0 && (fs->rawdepth != depth || fs->rawcount > INT_MAX - count) )
+        icvBinFlushRawData( fs );
+
+    if( fs->rawcount == 0 )
+    {
+        CvBinRecord rec;
+        memset( &rec, 0, sizeof(rec) );
+        rec.kind = CV_BIN_RAW;
+        rec.flags = depth;
+        if( fgetpos( fs->file, &fs->rawpos ) != 0 )
+            CV_Error( CV_StsError, "Could not write to the file storage" );
+        icvBinPutRecord( fs, &rec, 0, 0 );
+        fs->rawdepth = depth;
+    }
+
+    icvBinPut( fs, data, (size_t)count*CV_ELEM_SIZE(depth) );
+    fs->rawcount += count;
+}
+
+
 /****************************************************************************************\
 *                              Common High-Level Functions                               *
 \****************************************************************************************/
@@ -2664,6 +3336,7 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     bool append = (flags & 3) == CV_STORAGE_APPEND;
     bool mem = (flags & CV_STORAGE_MEMORY) != 0;
     bool write_mode = (flags & 3) != 0;
+    bool binary = write_mode && (flags & CV_STORAGE_FORMAT_MASK) == CV_STORAGE_FORMAT_BINARY;
     bool isGZ = false;
     size_t fnamelen = 0;
 
@@ -2679,6 +3352,9 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     if( mem && append )
         CV_Error( CV_StsBadFlag, "CV_STORAGE_APPEND and CV_STORAGE_MEMORY are not currently compatible" );
 
+    if( binary && (mem || append) )
+        CV_Error( CV_StsNotImplemented, "The binary storage can only be written to a new file" );
+
     fs = (CvFileStorage*)cvAlloc( sizeof(*fs) );
     memset( fs, 0, sizeof(*fs));
 
@@ -2701,6 +3377,8 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         {
             if( append )
                 CV_Error(CV_StsNotImplemented, "Appending data to compressed file is not implemented" );
+            if( binary )
+                CV_Error(CV_StsNotImplemented, "The binary storage can not be compressed" );
             isGZ = true;
             compression = dot_pos[3];
             if( compression )
@@ -2709,7 +3387,8 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         if( !isGZ )
         {
-            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : binary ? "wb" :
+                             !append ? "wt" : "a+t" );
             if( !fs->file )
                 goto _exit_;
         }
@@ -2738,6 +3417,31 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         if( mem )
             fs->outbuf = new std::deque<char>;
 
+        if( binary )
+        {
+            CvBinHeader header;
+            memset( &header, 0, sizeof(header) );
+            memcpy( header.signature, icvBinSignature, sizeof(header.signature) );
+            header.version = CV_BIN_VERSION;
+            header.byte_order = CV_BIN_BYTE_ORDER;
+
+            fs->fmt = CV_STORAGE_FORMAT_BINARY;
+            fs->write_stack = cvCreateSeq( 0, sizeof(CvSeq), sizeof(int), fs->memstorage );
+            fs->is_first = 1;
+            fs->struct_flags = CV_NODE_EMPTY;
+            icvBinPut( fs, &header, sizeof(header) );
+
+            fs->start_write_struct = icvBinStartWriteStruct;
+            fs->end_write_struct = icvBinEndWriteStruct;
+            fs->write_int = icvBinWriteInt;
+            fs->write_real = icvBinWriteReal;
+            fs->write_string = icvBinWriteString;
+            fs->write_comment = icvBinWriteComment;
+            fs->start_next_stream = icvBinStartNextStream;
+            fs->is_opened = true;
+            goto _exit_;
+        }
+
         if( fmt == CV_STORAGE_FORMAT_AUTO && filename )
         {
             const char* dot_pos = filename + fnamelen - (isGZ ? 7 : 4);
@@ -2850,6 +3554,21 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
             fs->strbufsize = fnamelen;
         }
 
+        if( fs->file && icvBinIsStorage( fs->file ) )
+        {
+            fs->file = freopen( fs->filename, "rb", fs->file );
+            if( !fs->file )
+                goto _exit_;
+            fs->fmt = CV_STORAGE_FORMAT_BINARY;
+            fs->str_hash = cvCreateMap( 0, sizeof(CvStringHash),
+                            sizeof(CvStringHashNode), fs->memstorage, 256 );
+            fs->roots = cvCreateSeq( 0, sizeof(CvSeq),
+                            sizeof(CvFileNode), fs->memstorage );
+            icvBinParse( fs );
+            fs->is_opened = true;
+            goto _exit_;
+        }
+
         size_t buf_size = 1 << 20;
         const char* yaml_signature = "%YAML:";
         char buf[16];
@@ -3081,6 +3800,60 @@ icvDecodeSimpleFormat( const char* dt )
 }
 
 
+/* writes the records of mixed types to the binary storage element by element */
+static void
+icvBinWriteRecords( CvFileStorage* fs, const uchar* data0, int len,
+                    const int* fmt_pairs, int fmt_pair_count )
+{
+    int offset = 0;
+
+    for(;len--;)
+    {
+        for( int k = 0; k < fmt_pair_count; k++ )
+        {
+            int count = fmt_pairs[k*2];
+            int elem_type = fmt_pairs[k*2+1];
+            int elem_size = CV_ELEM_SIZE(elem_type);
+
+            offset = cvAlign( offset, elem_size );
+            const uchar* data = data0 + offset;
+
+            for( int i = 0; i < count; i++, data += elem_size )
+            {
+                switch( elem_type )
+                {
+                case CV_8U:
+                    icvBinWriteInt( fs, 0, *data );
+                    break;
+                case CV_8S:
+                    icvBinWriteInt( fs, 0, *(const schar*)data );
+                    break;
+                case CV_16U:
+                    icvBinWriteInt( fs, 0, *(const ushort*)data );
+                    break;
+                case CV_16S:
+                    icvBinWriteInt( fs, 0, *(const short*)data );
+                    break;
+                case CV_32S:
+                    icvBinWriteInt( fs, 0, *(const int*)data );
+                    break;
+                case CV_32F:
+                    icvBinWriteReal( fs, 0, *(const float*)data );
+                    break;
+                case CV_64F:
+                    icvBinWriteReal( fs, 0, *(const double*)data );
+                    break;
+                default: /* reference */
+                    icvBinWriteInt( fs, 0, (int)*(const size_t*)data );
+                }
+            }
+
+            offset = (int)(data - data0);
+        }
+    }
+}
+
+
 CV_IMPL void
 cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
 {
@@ -3106,6 +3879,18 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
     {
         fmt_pairs[0] *= len;
         len = 1;
+
+        if( fs->fmt == CV_STORAGE_FORMAT_BINARY && fmt_pairs[1] != CV_USRTYPE1 )
+        {
+            icvBinWriteRawData( fs, (const uchar*)data0, fmt_pairs[0], fmt_pairs[1] );
+            return;
+        }
+    }
+
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        icvBinWriteRecords( fs, (const uchar*)data0, len, fmt_pairs, fmt_pair_count );
+        return;
     }
 
     for(;len--;)
@@ -3196,6 +3981,7 @@ cvStartReadRawData( const CvFileStorage* fs, const CvFileNode* src, CvSeqReader*
     }
     else if( node_type == CV_NODE_SEQ )
     {
+        icvFSExpandBlob( src );
         cvStartReadSeq( src->data.seq, reader, 0 );
     }
     else if( node_type == CV_NODE_NONE )
@@ -3356,6 +4142,29 @@ end_loop:
 }
 
 
+/* reads the binary storage blob right from the file mapping, if the format is simple enough */
+static bool
+icvReadBlobData( const CvFileNode* node, void* data, const char* dt )
+{
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2];
+    int fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+
+    if( fmt_pair_count != 1 || fmt_pairs[1] == CV_USRTYPE1 )
+        return false;
+
+    const CvFileNodeBlob* blob = (const CvFileNodeBlob*)node->data.seq;
+    int count = blob->total;
+    if( count % fmt_pairs[0] != 0 )
+        CV_Error( CV_StsBadSize,
+        "The sequence slice does not fit an integer number of records" );
+
+    cv::Mat src( 1, count, blob->blob_depth, (void*)blob->blob_data );
+    cv::Mat dst( 1, count, fmt_pairs[1], data );
+    src.convertTo( dst, dst.type() );
+    return true;
+}
+
+
 CV_IMPL void
 cvReadRawData( const CvFileStorage* fs, const CvFileNode* src,
                void* data, const char* dt )
@@ -3365,6 +4174,9 @@ cvReadRawData( const CvFileStorage* fs, const CvFileNode* src,
     if( !src || !data )
         CV_Error( CV_StsNullPtr, "Null pointers to source file node or destination array" );
 
+    if( CV_NODE_IS_BLOB(src) && icvReadBlobData( src, data, dt ) )
+        return;
+
     cvStartReadRawData( fs, src, &reader );
     cvReadRawDataSlice( fs, &reader, CV_NODE_IS_SEQ(src->tag) ?
                         src->data.seq->total : 1, data, dt );
@@ -3377,6 +4189,14 @@ icvWriteFileNode( CvFileStorage* fs, const char* name, const CvFileNode* node );
 static void
 icvWriteCollection( CvFileStorage* fs, const CvFileNode* node )
 {
+    if( CV_NODE_IS_BLOB(node) )
+    {
+        const CvFileNodeBlob* blob = (const CvFileNodeBlob*)node->data.seq;
+        char dt[16];
+        cvWriteRawData( fs, blob->blob_data, blob->total, icvEncodeFormat( blob->blob_depth, dt ));
+        return;
+    }
+
     int i, total = node->data.seq->total;
     int elem_size = node->data.seq->elem_size;
     int is_map = CV_NODE_IS_MAP(node->tag);
@@ -3547,7 +4367,7 @@ icvReadMat( CvFileStorage* fs, CvFileNode* node )
 
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
@@ -3624,7 +4444,7 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     int sizes[CV_MAX_DIM], dims, elem_type;
     int i, total_size;
 
-    sizes_node = cvGetFileNodeByName( fs, node, "sizes" );
+    sizes_node = icvGetFileNodeByName( fs, node, "sizes" );
     dt = cvReadStringByName( fs, node, "dt", 0 );
 
     if( !sizes_node || !dt )
@@ -3639,7 +4459,7 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     cvReadRawData( fs, sizes_node, sizes, "i" );
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
@@ -5284,8 +6104,10 @@ FileNode FileNode::operator[](const char* nodename) const
 
 FileNode FileNode::operator[](int i) const
 {
-    return isSeq() ? FileNode(fs, (CvFileNode*)cvGetSeqElem(node->data.seq, i)) :
-        i == 0 ? *this : FileNode();
+    if( !isSeq() )
+        return i == 0 ? *this : FileNode();
+    icvFSExpandBlob( node );
+    return FileNode(fs, (CvFileNode*)cvGetSeqElem(node->data.seq, i));
 }
 
 std::string FileNode::name() const
@@ -5319,6 +6141,7 @@ FileNodeIterator::FileNodeIterator(const CvFileStorage* _fs,
         container = _node;
         if( !(_node->tag & FileNode::USER) && (node_type == FileNode::SEQ || node_type == FileNode::MAP) )
         {
+            icvFSExpandBlob( _node );
             cvStartReadSeq( _node->data.seq, &reader );
             remaining = FileNode(_fs, _node).size();
         }
@@ -5469,6 +6292,110 @@ void write( FileStorage& fs, const std::string& name, const Mat& value )
     }
 }
 
+// keeps the binary storage mapping alive while the matrices read from it are in use
+class FileMappingAllocator : public MatAllocator
+{
+public:
+    struct Ref
+    {
+        int refcount; // must be the first member, Mat::refcount points to it
+        CvFileMapping* mapping;
+    };
+
+    // a matrix keeps its allocator when it is re-allocated, so the regular allocations
+    // have to be supported too
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step)
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            step[i] = total;
+            total *= sizes[i];
+        }
+        datastart = data = (uchar*)fastMalloc(total);
+        Ref* ref = new Ref;
+        ref->refcount = 1;
+        ref->mapping = 0;
+        refcount = &ref->refcount;
+    }
+
+    void deallocate(int* refcount, uchar* datastart, uchar*)
+    {
+        Ref* ref = (Ref*)refcount;
+        if( ref->mapping )
+            icvReleaseFileMapping(ref->mapping);
+        else
+            fastFree(datastart);
+        delete ref;
+    }
+};
+
+static FileMappingAllocator& getFileMappingAllocator()
+{
+    static FileMappingAllocator* allocator = new FileMappingAllocator;
+    return *allocator;
+}
+
+// makes the matrix header for the matrix data stored in the binary storage mapping;
+// returns false if the node is not such a matrix
+static bool readMappedMat( const CvFileStorage* fs, const CvFileNode* node, Mat& mat )
+{
+    if( !fs || !fs->mapping || !CV_NODE_IS_MAP(node->tag) || !node->info )
+        return false;
+
+    const char* type_name = node->info->type_name;
+    bool isND = strcmp(type_name, CV_TYPE_NAME_MATND) == 0;
+    if( !isND && strcmp(type_name, CV_TYPE_NAME_MAT) != 0 )
+        return false;
+
+    const char* dt = cvReadStringByName(fs, node, "dt", 0);
+    const CvFileNode* data = icvGetFileNodeByName(fs, node, "data");
+    if( !dt || !data || !CV_NODE_IS_BLOB(data) )
+        return false;
+
+    const CvFileNodeBlob* blob = (const CvFileNodeBlob*)data->data.seq;
+    int type = icvDecodeSimpleFormat(dt);
+    if( CV_MAT_DEPTH(type) != blob->blob_depth )
+        return false;
+
+    int dims = 2, sizes[CV_MAX_DIM];
+    if( isND )
+    {
+        const CvFileNode* sizes_node = icvGetFileNodeByName(fs, node, "sizes");
+        dims = !sizes_node ? -1 : CV_NODE_IS_SEQ(sizes_node->tag) ? sizes_node->data.seq->total :
+               CV_NODE_IS_INT(sizes_node->tag) ? 1 : -1;
+        if( dims <= 0 || dims > CV_MAX_DIM )
+            return false;
+        cvReadRawData(fs, sizes_node, sizes, "i");
+    }
+    else
+    {
+        sizes[0] = cvReadIntByName(fs, node, "rows", -1);
+        sizes[1] = cvReadIntByName(fs, node, "cols", -1);
+    }
+
+    int64 total = CV_MAT_CN(type);
+    for( int i = 0; i < dims; i++ )
+    {
+        if( sizes[i] < 0 )
+            return false;
+        total *= sizes[i];
+    }
+    if( total != blob->total )
+        return false;
+
+    Mat m(dims, sizes, type, (void*)blob->blob_data);
+    FileMappingAllocator::Ref* ref = new FileMappingAllocator::Ref;
+    ref->refcount = 1;
+    ref->mapping = fs->mapping;
+    CV_XADD(&fs->mapping->refcount, 1);
+    m.refcount = &ref->refcount;
+    m.allocator = &getFileMappingAllocator();
+    mat = m;
+    return true;
+}
+
 // TODO: the 4 functions below need to be implemented more efficiently
 void write( FileStorage& fs, const std::string& name, const SparseMat& value )
 {
@@ -5494,6 +6421,8 @@ void read( const FileNode& node, Mat& mat, const Mat& default_mat )
         default_mat.copyTo(mat);
         return;
     }
+    if( readMappedMat(node.fs, *node, mat) )
+        return;
     void* obj = cvRead((CvFileStorage*)node.fs, (CvFileNode*)*node);
     if(CV_IS_MAT_HDR_Z(obj))
     {
@@ -106,6 +106,14 @@ extern const uchar g_Saturate8u[];
 #if defined WIN32 || defined _WIN32
 void deleteThreadAllocData();
 void deleteThreadRNGData();
+void deleteThreadParallelData();
+#endif
+
+#ifdef HAVE_PTHREADS_PF
+void parallel_for_pthreads(const Range& stripeRange, const ParallelLoopBody& body, int maxThreads);
+void parallel_pthreads_set_threads_num(int nthreads);
+int parallel_pthreads_get_threads_num();
+int parallel_pthreads_get_thread_num();
 #endif
 
 template<typename T1, typename T2=T1, typename T3=T1> struct OpAdd
@@ -183,6 +191,33 @@ inline Size getContinuousSize( const Mat& m1, const Mat& m2,
         Size(m1.cols*m1.rows*widthScale, 1) : Size(m1.cols*widthScale, m1.rows);
 }
 
+// Element-wise functions (arithmetic, comparison, conversions, LUT, split/merge) switch to
+// parallel_for_ when the arrays they touch take at least ELEMWISE_PARALLEL_MIN_SIZE bytes,
+// and then split the work into stripes of about ELEMWISE_PARALLEL_STRIPE_SIZE bytes.
+enum { ELEMWISE_PARALLEL_MIN_SIZE = 1 << 18, ELEMWISE_PARALLEL_STRIPE_SIZE = 1 << 16 };
+
+// returns the number of stripes for an element-wise operation touching 'size' bytes;
+// 1 means that it should run in the calling thread
+int getElemwiseNStripes(size_t size);
+
+// calls func on a 2D region, in parallel if the region is large enough; esz1, esz2 and esz
+// are the numbers of bytes per unit of sz.width in src1, src2 and dst (src2 may be NULL)
+void parallelBinaryFunc(BinaryFunc func, const uchar* src1, size_t step1, size_t esz1,
+                        const uchar* src2, size_t step2, size_t esz2,
+                        uchar* dst, size_t step, size_t esz, Size sz, void* usrdata);
+
+// the part of a 2D array that corresponds to stripe 'r' of an element-wise operation
+// run over Range(0, getElemwiseRange(m)): rows, or columns for single-row arrays
+inline int getElemwiseRange( const Mat& m )
+{
+    return m.rows > 1 ? m.rows : m.cols;
+}
+
+inline Mat getElemwiseStripe( const Mat& m, const Range& r )
+{
+    return m.rows > 1 ? m.rowRange(r) : m.colRange(r);
+}
+
 struct NoVec
 {
     size_t operator()(const void*, const void*, void*, size_t) const { return 0; }
@@ -191,6 +226,7 @@ struct NoVec
 extern volatile bool USE_SSE2;
 extern volatile bool USE_SSE4_2;
 extern volatile bool USE_AVX;
+extern volatile bool USE_AVX2;
 
 enum { BLOCK_SIZE = 1024 };
 
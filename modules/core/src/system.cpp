@@ -187,8 +187,47 @@ struct HWFeatures
             f.have[CV_CPU_SSE4_2] = (cpuid_data[2] & (1<<20)) != 0;
             f.have[CV_CPU_POPCNT] = (cpuid_data[2] & (1<<23)) != 0;
             f.have[CV_CPU_AVX]    = (((cpuid_data[2] & (1<<28)) != 0)&&((cpuid_data[2] & (1<<27)) != 0));//OS uses XSAVE_XRSTORE and CPU support AVX
+            f.have[CV_CPU_FMA3]   = (cpuid_data[2] & (1<<12)) != 0;
         }
 
+        // AVX2 and FMA are only usable when the OS also saves the upper halves of the YMM registers
+        bool ymmEnabled = false;
+        int cpuid_data7[4] = { 0, 0, 0, 0 };
+        if( f.have[CV_CPU_AVX] )
+        {
+            unsigned xcr0 = 0;
+        #if defined _MSC_FULL_VER && _MSC_FULL_VER >= 160040219 && (defined _M_IX86 || defined _M_X64)
+            __cpuidex(cpuid_data7, 7, 0);
+            xcr0 = (unsigned)_xgetbv(0);
+        #elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+            #ifdef __x86_64__
+            asm __volatile__
+            (
+             "cpuid\n\t"
+             : "=a"(cpuid_data7[0]), "=b"(cpuid_data7[1]), "=c"(cpuid_data7[2]), "=d"(cpuid_data7[3])
+             : "a"(7), "c"(0)
+             : "cc"
+            );
+            #else
+            asm volatile
+            (
+             "movl %%ebx, %%esi\n\t"
+             "cpuid\n\t"
+             "xchgl %%ebx, %%esi\n\t"
+             : "=a"(cpuid_data7[0]), "=S"(cpuid_data7[1]), "=c"(cpuid_data7[2]), "=d"(cpuid_data7[3])
+             : "a"(7), "c"(0)
+             : "cc"
+            );
+            #endif
+            unsigned xcr0_hi = 0;
+            // xgetbv, spelled out for assemblers that do not know the mnemonic
+            asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(xcr0), "=d"(xcr0_hi) : "c"(0));
+        #endif
+            ymmEnabled = (xcr0 & 6) == 6;
+        }
+        f.have[CV_CPU_AVX2] = ymmEnabled && (cpuid_data7[1] & (1<<5)) != 0;
+        f.have[CV_CPU_FMA3] = ymmEnabled && f.have[CV_CPU_FMA3];
+
         return f;
     }
 
@@ -219,12 +258,14 @@ IPPInitializer ippInitializer;
 volatile bool USE_SSE2 = featuresEnabled.have[CV_CPU_SSE2];
 volatile bool USE_SSE4_2 = featuresEnabled.have[CV_CPU_SSE4_2];
 volatile bool USE_AVX = featuresEnabled.have[CV_CPU_AVX];
+volatile bool USE_AVX2 = featuresEnabled.have[CV_CPU_AVX2] && featuresEnabled.have[CV_CPU_FMA3];
 
 void setUseOptimized( bool flag )
 {
     useOptimizedFlag = flag;
     currentFeatures = flag ? &featuresEnabled : &featuresDisabled;
     USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+    USE_AVX2 = currentFeatures->have[CV_CPU_AVX2] && currentFeatures->have[CV_CPU_FMA3];
 }
 
 bool useOptimized(void)
@@ -788,6 +829,7 @@ BOOL WINAPI DllMain( HINSTANCE, DWORD  fdwReason, LPVOID )
     {
         cv::deleteThreadAllocData();
         cv::deleteThreadRNGData();
+        cv::deleteThreadParallelData();
     }
     return TRUE;
 }
@@ -1551,3 +1551,83 @@ TEST(Core_Add, AddToColumnWhen4Rows)
 
     ASSERT_EQ(0, countNonZero(m1 - m2));
 }
+
+TEST(Core_Arithm, ParallelMatchesSerial)
+{
+    cv::RNG& rng = cvtest::TS::ptr()->get_rng();
+    // a non-continuous 2D ROI, a continuous 2D array and a long single row
+    cv::Mat big(1111, 733, CV_8UC3);
+    cv::Size sizes[] = { cv::Size(700, 1000), cv::Size(733, 1111), cv::Size(1 << 20, 1) };
+    // make sure that the parallel code paths are taken even on a single-core machine
+    int prevThreads = cv::getNumThreads();
+    cv::setNumThreads(std::max(prevThreads, 4));
+
+    for( int k = 0; k < 3; k++ )
+    {
+        cv::Mat a, b, lut(1, 256, CV_8U);
+        if( k == 0 )
+        {
+            a = big(cv::Rect(cv::Point(5, 7), sizes[k]));
+            b = a.clone();
+        }
+        else
+        {
+            a.create(sizes[k], CV_8UC3);
+            b.create(sizes[k], CV_8UC3);
+        }
+        rng.fill(a, cv::RNG::UNIFORM, 0, 256);
+        rng.fill(b, cv::RNG::UNIFORM, 0, 256);
+        rng.fill(lut, cv::RNG::UNIFORM, 0, 256);
+
+        cv::Mat dst[2][7];
+        for( int parallel = 0; parallel < 2; parallel++ )
+        {
+            cv::ParallelScope scope(parallel ? -1 : 1);
+            std::vector<cv::Mat> planes;
+            int fromTo[] = { 0, 2, 1, 1, 2, 0 };
+            cv::Mat* d = dst[parallel];
+
+            cv::add(a, b, d[0]);
+            cv::multiply(a, b, d[1], 1./255);
+            cv::compare(a, b, d[2], cv::CMP_GE);
+            a.convertTo(d[3], CV_32F, 0.25, 3);
+            cv::LUT(a, lut, d[4]);
+            cv::split(a, planes);
+            cv::merge(planes, d[5]);
+            d[6].create(a.size(), a.type());
+            cv::mixChannels(&a, 1, &d[6], 1, fromTo, 3);
+        }
+
+        for( int i = 0; i < 7; i++ )
+            EXPECT_EQ(0, cv::norm(dst[0][i], dst[1][i], cv::NORM_INF)) << "size #" << k << ", function #" << i;
+    }
+
+    cv::setNumThreads(prevThreads);
+}
+
+TEST(Core_ConvertScale, OptimizedMatchesPlain)
+{
+    cv::RNG& rng = cvtest::TS::ptr()->get_rng();
+    static const int depths[] = { CV_8U, CV_8S, CV_16U, CV_16S, CV_32S, CV_32F };
+    static const double scales[][2] = { { 1, 0 }, { 1./255, 0 }, { 255, 0 }, { 0.37, 0.5 }, { -1.3, 3 } };
+    bool prevOptimized = cv::useOptimized();
+
+    for( int i = 0; i < 6; i++ )
+        for( int j = 0; j < 6; j++ )
+            for( int k = 0; k < 5; k++ )
+            {
+                // the width is not a multiple of the vector size
+                cv::Mat src(17, 103, depths[i]), dst[2];
+                rng.fill(src, cv::RNG::UNIFORM, -1000, 1000);
+
+                for( int optimized = 0; optimized < 2; optimized++ )
+                {
+                    cv::setUseOptimized(optimized != 0);
+                    src.convertTo(dst[optimized], depths[j], scales[k][0], scales[k][1]);
+                }
+                EXPECT_EQ(0, cv::norm(dst[0], dst[1], cv::NORM_INF))
+                    << "src depth=" << depths[i] << " dst depth=" << depths[j] << " scale #" << k;
+            }
+
+    cv::setUseOptimized(prevOptimized);
+}
@@ -868,3 +868,44 @@ protected:
 TEST(Core_DFT, complex_output) { Core_DFTComplexOutputTest test; test.safe_run(); }
 
 
+
+TEST(Core_DFT, parallel)
+{
+    // the rows and the columns are transformed by several threads;
+    // the results must not depend on the number of threads
+    int prevThreads = getNumThreads();
+    setNumThreads(std::max(prevThreads, 4));
+
+    RNG& rng = theRNG();
+    const Size sizes[] = { Size(256, 256), Size(360, 241), Size(1024, 64) };
+    const int flagsList[] = { 0, DFT_INVERSE, DFT_ROWS, DFT_SCALE | DFT_INVERSE,
+                              DFT_COMPLEX_OUTPUT, DFT_INVERSE | DFT_REAL_OUTPUT };
+
+    for( size_t si = 0; si < sizeof(sizes)/sizeof(sizes[0]); si++ )
+        for( int depth = CV_32F; depth <= CV_64F; depth++ )
+            for( int cn = 1; cn <= 2; cn++ )
+                for( size_t fi = 0; fi < sizeof(flagsList)/sizeof(flagsList[0]); fi++ )
+                {
+                    int flags = flagsList[fi];
+                    if( (cn == 2 && (flags & DFT_COMPLEX_OUTPUT)) ||
+                        (cn == 1 && (flags & DFT_REAL_OUTPUT)) )
+                        continue;
+                    Mat src(sizes[si], CV_MAKETYPE(depth, cn)), dst, dst0;
+                    rng.fill(src, RNG::UNIFORM, -1, 1);
+
+                    dft(src, dst, flags);
+                    {
+                        ParallelScope scope(1);
+                        dft(src, dst0, flags);
+                    }
+                    EXPECT_EQ(0, norm(dst, dst0, NORM_INF))
+                        << "size=" << sizes[si] << " type=" << src.type() << " flags=" << flags;
+
+                    // the same transform once more, with the cached plans
+                    dft(src, dst, flags);
+                    EXPECT_EQ(0, norm(dst, dst0, NORM_INF))
+                        << "size=" << sizes[si] << " type=" << src.type() << " flags=" << flags;
+                }
+
+    setNumThreads(prevThreads);
+}
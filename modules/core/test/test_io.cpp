@@ -91,7 +91,7 @@ protected:
             {-1000000, 1000000}, {-10, 10}, {-10, 10}};
         RNG& rng = ts->get_rng();
         RNG rng0;
-        test_case_count = 4;
+        test_case_count = 6;
         int progress = 0;
         MemStorage storage(cvCreateMemStorage(0));
 
@@ -102,10 +102,12 @@ protected:
 
             cvClearMemStorage(storage);
 
-            bool mem = (idx % 4) >= 2;
-            string filename = tempfile(idx % 2 ? ".yml" : ".xml");
+            bool binary = idx >= 4;
+            bool mem = !binary && (idx % 4) >= 2;
+            string filename = tempfile(binary ? ".bin" : idx % 2 ? ".yml" : ".xml");
 
-            FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0));
+            FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0) +
+                           (binary ? FileStorage::FORMAT_BINARY : 0));
 
             int test_int = (int)cvtest::randInt(rng);
             double test_real = (cvtest::randInt(rng)%2?1:-1)*exp(cvtest::randReal(rng)*18-9);
@@ -426,6 +428,88 @@ protected:
 
 TEST(Core_InputOutput, misc) { CV_MiscIOTest test; test.safe_run(); }
 
+TEST(Core_InputOutput, binary_storage)
+{
+    string fname = cv::tempfile(".bin");
+    RNG& rng = theRNG();
+
+    Mat big(300, 200, CV_32FC3), roi_src(40, 50, CV_16SC2), nd;
+    int sz[] = { 4, 5, 6 };
+    nd.create(3, sz, CV_64F);
+    rng.fill(big, RNG::UNIFORM, -100, 100);
+    rng.fill(roi_src, RNG::UNIFORM, -1000, 1000);
+    rng.fill(nd, RNG::UNIFORM, 0, 1);
+    Mat roi = roi_src(Rect(3, 5, 20, 30));
+
+    vector<int> vi(100);
+    for( size_t i = 0; i < vi.size(); i++ )
+        vi[i] = (int)i*7 - 300;
+
+    {
+        FileStorage fs(fname, FileStorage::WRITE + FileStorage::FORMAT_BINARY);
+        ASSERT_TRUE(fs.isOpened());
+        fs << "big" << big << "roi" << roi << "nd" << nd << "vi" << vi;
+        fs << "params" << "{" << "name" << "binary test" << "eps" << 1e-7 << "n" << 5
+           << "list" << "[" << 1 << 2.5 << "three" << "]" << "}";
+    }
+
+    Mat big2, big3, roi2, nd2;
+    vector<int> vi2;
+    {
+        FileStorage fs(fname, FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+        fs["big"] >> big2;
+        fs["big"] >> big3;
+        fs["roi"] >> roi2;
+        fs["nd"] >> nd2;
+        fs["vi"] >> vi2;
+
+        FileNode params = fs["params"];
+        EXPECT_EQ("binary test", (string)params["name"]);
+        EXPECT_EQ(1e-7, (double)params["eps"]);
+        EXPECT_EQ(5, (int)params["n"]);
+        FileNode list = params["list"];
+        ASSERT_EQ(3u, list.size());
+        EXPECT_EQ(1, (int)list[0]);
+        EXPECT_EQ(2.5, (double)list[1]);
+        EXPECT_EQ("three", (string)list[2]);
+
+        // the raw data can also be read with the type conversion and element by element
+        FileNode data = fs["roi"]["data"];
+        ASSERT_EQ((size_t)roi.total()*2, data.size());
+        Mat roi_f(roi.size(), CV_32FC2);
+        cvReadRawData(*fs, *data, roi_f.data, "2f");
+        Mat roi_f0;
+        roi.convertTo(roi_f0, CV_32F);
+        EXPECT_EQ(0, norm(roi_f, roi_f0, NORM_INF));
+        EXPECT_EQ((int)roi.at<Vec2s>(0, 1)[1], (int)data[3]);
+
+        // a copy to a text storage has the same content
+        FileStorage yml(".yml", FileStorage::WRITE + FileStorage::MEMORY);
+        cvWriteFileNode(*yml, "big", *fs["big"], 0);
+        string content = yml.releaseAndGetString();
+        FileStorage yml2(content, FileStorage::READ + FileStorage::MEMORY);
+        Mat big4;
+        yml2["big"] >> big4;
+        EXPECT_EQ(0, norm(big, big4, NORM_INF));
+    }
+
+    // the matrices point to the mapping that is still alive after the storage is closed
+    EXPECT_EQ(big2.data, big3.data);
+    EXPECT_EQ(0, (int)((size_t)big2.data % 16));
+    EXPECT_EQ(0, norm(big, big2, NORM_INF));
+    EXPECT_EQ(0, norm(roi, roi2, NORM_INF));
+    EXPECT_EQ(0, norm(nd, nd2, NORM_INF));
+    EXPECT_EQ(vi, vi2);
+
+    big3.release();
+    big2.create(10, 10, CV_8U);
+    big2.setTo(Scalar::all(1));
+    EXPECT_EQ(100, countNonZero(big2));
+
+    remove(fname.c_str());
+}
+
 /*class CV_BigMatrixIOTest : public cvtest::BaseTest
 {
 public:
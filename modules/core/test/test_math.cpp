@@ -2725,5 +2725,70 @@ TEST(CovariationMatrixVectorOfMatWithMean, accuracy)
     ASSERT_EQ(sDiff.dot(sDiff), 0.0);
 }
 
+TEST(Core_GEMM, large)
+{
+    // the sizes are not multiples of the tiles and panels of the packed implementation
+    cv::RNG& rng = cv::theRNG();
+    const int M = 157, N = 283, K = 301;
+    bool prevOptimized = cv::useOptimized();
+
+    for( int iter = 0; iter < 4; iter++ )
+    {
+        int depth = iter % 2 == 0 ? CV_32F : CV_64F;
+        cv::setUseOptimized(iter < 2);
+
+        for( int flags = 0; flags < 8; flags++ )
+        {
+            cv::Size asz = flags & cv::GEMM_1_T ? cv::Size(M, K) : cv::Size(K, M);
+            cv::Size bsz = flags & cv::GEMM_2_T ? cv::Size(K, N) : cv::Size(N, K);
+            cv::Size csz = flags & cv::GEMM_3_T ? cv::Size(M, N) : cv::Size(N, M);
+            cv::Mat abig(asz.height + 2, asz.width + 3, depth), b(bsz, depth), c(csz, depth);
+            cv::Mat a = abig(cv::Rect(cv::Point(1, 2), asz));
+            rng.fill(abig, cv::RNG::UNIFORM, -1, 1);
+            rng.fill(b, cv::RNG::UNIFORM, -1, 1);
+            rng.fill(c, cv::RNG::UNIFORM, -1, 1);
+
+            cv::Mat d, d0;
+            cv::gemm(a, b, 0.5, c, -2, d, flags);
+            cvtest::gemm(a, b, 0.5, c, -2, d0, flags);
+            EXPECT_LE(cv::norm(d, d0, cv::NORM_INF), depth == CV_32F ? 1e-4 : 1e-12)
+                << "depth=" << depth << " flags=" << flags << " optimized=" << (iter < 2);
+
+            cv::gemm(a, b, 1, cv::noArray(), 0, d, flags & ~cv::GEMM_3_T);
+            cvtest::gemm(a, b, 1, cv::Mat(), 0, d0, flags & ~cv::GEMM_3_T);
+            EXPECT_LE(cv::norm(d, d0, cv::NORM_INF), depth == CV_32F ? 1e-4 : 1e-12)
+                << "depth=" << depth << " flags=" << flags << " optimized=" << (iter < 2);
+        }
+    }
+
+    cv::setUseOptimized(prevOptimized);
+}
+
+TEST(Core_GEMM, largeKAccuracy)
+{
+    // with all-positive operands the error of a float accumulator grows with K;
+    // the products are accumulated in double, so only the final rounding is left
+    cv::RNG& rng = cv::theRNG();
+    const int M = 37, N = 70, K = 100000;
+    bool prevOptimized = cv::useOptimized();
+
+    cv::Mat a(M, K, CV_32F), b(K, N, CV_32F), a64, b64, d, d64;
+    rng.fill(a, cv::RNG::UNIFORM, 0, 1);
+    rng.fill(b, cv::RNG::UNIFORM, 0, 1);
+    a.convertTo(a64, CV_64F);
+    b.convertTo(b64, CV_64F);
+    cv::gemm(a64, b64, 1, cv::noArray(), 0, d64);
+
+    for( int optimized = 0; optimized < 2; optimized++ )
+    {
+        cv::setUseOptimized(optimized != 0);
+        cv::gemm(a, b, 1, cv::noArray(), 0, d);
+        d.convertTo(d, CV_64F);
+        EXPECT_LE(cv::norm(d, d64, cv::NORM_INF | cv::NORM_RELATIVE), 1e-6) << "optimized=" << optimized;
+    }
+
+    cv::setUseOptimized(prevOptimized);
+}
+
 /* End of file. */
 
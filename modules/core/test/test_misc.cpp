@@ -1,4 +1,5 @@
 #include "test_precomp.hpp"
+#include "opencv2/core/internal.hpp"
 
 using namespace cv;
 using namespace std;
@@ -48,3 +49,309 @@ TEST(Core_SaturateCast, NegativeNotClipped)
 
     ASSERT_EQ(0xffffffff, val);
 }
+
+namespace
+{
+class CountStripes_Invoker : public ParallelLoopBody
+{
+public:
+    CountStripes_Invoker(Mat& _counts, bool _nested) : counts(&_counts), nested(_nested) {}
+
+    void operator()(const Range& r) const
+    {
+        for (int i = r.start; i < r.end; ++i)
+        {
+            if (nested)
+            {
+                Mat row = counts->row(i);
+                parallel_for_(Range(0, row.cols), CountStripes_Invoker(row, false));
+            }
+            else
+                counts->at<int>(i)++;
+        }
+    }
+
+private:
+    Mat* counts;
+    bool nested;
+};
+}
+
+TEST(Core_Parallel, visitsEveryIndexOnce)
+{
+    int nthreads = getNumThreads();
+    Mat counts(1, 10007, CV_32S);
+
+    for (int n = 0; n <= 4; ++n)
+    {
+        setNumThreads(n);
+        for (int nstripes = -1; nstripes <= 64; nstripes += 13)
+        {
+            counts = Scalar::all(0);
+            parallel_for_(Range(0, counts.cols), CountStripes_Invoker(counts, false), nstripes);
+            ASSERT_EQ(counts.cols, countNonZero(counts == 1)) << "threads: " << n << " nstripes: " << nstripes;
+        }
+    }
+
+    setNumThreads(nthreads);
+}
+
+TEST(Core_Parallel, nestedLoopsAreExecuted)
+{
+    Mat counts(64, 129, CV_32S, Scalar::all(0));
+
+    parallel_for_(Range(0, counts.rows), CountStripes_Invoker(counts, true));
+
+    ASSERT_EQ((int)counts.total(), countNonZero(counts == 1));
+}
+
+namespace
+{
+class Throwing_Invoker : public ParallelLoopBody
+{
+public:
+    Throwing_Invoker(int _badIdx, int _resizeTo) : badIdx(_badIdx), resizeTo(_resizeTo) {}
+
+    void operator()(const Range& r) const
+    {
+        for (int i = r.start; i < r.end; ++i)
+        {
+            if (resizeTo >= 0)
+                setNumThreads(resizeTo);
+            if (i == badIdx)
+                CV_Error(CV_StsBadArg, "bad index");
+        }
+    }
+
+private:
+    int badIdx, resizeTo;
+};
+}
+
+TEST(Core_Parallel, exceptionIsRethrownInCaller)
+{
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+
+    // the first, the last and some middle stripe: executed by the caller or by a worker
+    for (int badIdx = 0; badIdx < 1000; badIdx += 333)
+    {
+        EXPECT_THROW(parallel_for_(Range(0, 1000), Throwing_Invoker(badIdx, -1), 100), cv::Exception);
+
+        // the pool is still usable afterwards
+        Mat counts(1, 1000, CV_32S, Scalar::all(0));
+        parallel_for_(Range(0, counts.cols), CountStripes_Invoker(counts, false));
+        ASSERT_EQ(counts.cols, countNonZero(counts == 1));
+    }
+
+    setNumThreads(nthreads);
+}
+
+TEST(Core_Parallel, setNumThreadsInsideLoop)
+{
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+
+    // the resize is deferred until the loop is finished
+    parallel_for_(Range(0, 1000), Throwing_Invoker(-1, 2), 100);
+    parallel_for_(Range(0, 1000), Throwing_Invoker(-1, 3), 100);
+
+    Mat counts(1, 1000, CV_32S, Scalar::all(0));
+    parallel_for_(Range(0, counts.cols), CountStripes_Invoker(counts, false));
+    ASSERT_EQ(counts.cols, countNonZero(counts == 1));
+
+    setNumThreads(nthreads);
+}
+
+namespace
+{
+class MaxThreadNum_Invoker : public ParallelLoopBody
+{
+public:
+    MaxThreadNum_Invoker(Mat& _threadIds) : threadIds(&_threadIds) {}
+
+    void operator()(const Range& r) const
+    {
+        for (int i = r.start; i < r.end; ++i)
+            threadIds->at<int>(i) = getThreadNum();
+    }
+
+private:
+    Mat* threadIds;
+};
+}
+
+TEST(Core_Parallel, scopeLimitsThreads)
+{
+    Mat threadIds(1, 1000, CV_32S);
+
+    {
+        ParallelScope scope(1);
+        ASSERT_EQ(1, getNumThreads());
+
+        threadIds = Scalar::all(-1);
+        parallel_for_(Range(0, threadIds.cols), MaxThreadNum_Invoker(threadIds));
+        ASSERT_EQ(0, countNonZero(threadIds != getThreadNum())); // everything runs in this thread
+
+        {
+            ParallelScope inner(4);
+            ASSERT_EQ(1, getNumThreads()); // a nested scope can not raise the limit
+        }
+    }
+
+    {
+        ParallelScope scope(2);
+        ASSERT_LE(getNumThreads(), 2);
+
+        Mat counts(1, 10007, CV_32S, Scalar::all(0));
+        parallel_for_(Range(0, counts.cols), CountStripes_Invoker(counts, false));
+        ASSERT_EQ(counts.cols, countNonZero(counts == 1));
+    }
+}
+
+namespace
+{
+class CountBlocks_Body
+{
+public:
+    CountBlocks_Body(Mat& _counts, int _minBlock) : counts(&_counts), minBlock(_minBlock) {}
+
+    void operator()(const BlockedRange& r) const
+    {
+        if (r.end() - r.begin() < minBlock)
+            counts->at<int>(r.begin()) = -1000; // the range was split below the grain size
+        for (int i = r.begin(); i < r.end(); ++i)
+            counts->at<int>(i)++;
+    }
+
+private:
+    Mat* counts;
+    int minBlock;
+};
+
+class Sum_Body
+{
+public:
+    Sum_Body(const Mat& _values) : values(&_values), sum(0), count(0) {}
+    Sum_Body(const Sum_Body& b, Split) : values(b.values), sum(0), count(0) {}
+
+    void operator()(const BlockedRange& r)
+    {
+        for (int i = r.begin(); i < r.end(); ++i)
+            sum += values->at<double>(i);
+        count += r.end() - r.begin();
+    }
+
+    void join(const Sum_Body& b)
+    {
+        sum += b.sum;
+        count += b.count;
+    }
+
+    const Mat* values;
+    double sum;
+    int count;
+};
+}
+
+TEST(Core_Parallel, legacyParallelForVisitsEveryIndexOnce)
+{
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+    Mat counts(1, 10007, CV_32S);
+
+    for (int grain = 1; grain <= 4096; grain *= 8)
+    {
+        counts = Scalar::all(0);
+        parallel_for(BlockedRange(0, counts.cols, grain), CountBlocks_Body(counts, std::min(grain, counts.cols)));
+        EXPECT_EQ(counts.cols, countNonZero(counts == 1)) << "grain: " << grain;
+    }
+
+    setNumThreads(nthreads);
+}
+
+TEST(Core_Parallel, legacyParallelReduceMatchesSerial)
+{
+    Mat values(1, 100003, CV_64F);
+    theRNG().fill(values, RNG::UNIFORM, -1., 1.);
+
+    Sum_Body serial(values);
+    serial(BlockedRange(0, values.cols));
+
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+    for (int iter = 0; iter < 3; ++iter)
+    {
+        Sum_Body body(values);
+        parallel_reduce(BlockedRange(0, values.cols), body);
+        EXPECT_EQ(values.cols, body.count);
+        EXPECT_NEAR(serial.sum, body.sum, 1e-9);
+
+        Sum_Body body2(values);
+        parallel_reduce(BlockedRange(0, values.cols), body2);
+        EXPECT_EQ(body.sum, body2.sum); // the partial sums are joined in the same order every time
+    }
+    setNumThreads(nthreads);
+}
+
+TEST(Core_Malloc, pooledBuffersAreReused)
+{
+    bool usePool = usePooledMalloc();
+    void* systemBuf = fastMalloc(1000);
+
+    setUsePooledMalloc(true);
+    void* pooledBuf = fastMalloc(12345);
+    MallocStatistics before = getMallocStatistics();
+
+    for (int i = 0; i < 10; i++)
+    {
+        Mat m(480, 640, CV_8UC3);
+        void* buf = fastMalloc(12345 - i);
+        ASSERT_EQ(0u, (size_t)buf % 16);
+        memset(buf, i, 12345 - i);
+        fastFree(buf);
+    }
+
+    MallocStatistics after = getMallocStatistics();
+    EXPECT_GE(after.hits - before.hits, 18);
+    EXPECT_GT(after.cachedBytes, 0u);
+
+    fastFree(systemBuf); // allocated before the pool was turned on
+    trimMallocPool();
+    EXPECT_EQ(0u, getMallocStatistics().cachedBytes);
+
+    setUsePooledMalloc(false);
+    fastFree(pooledBuf); // allocated from the pool
+    setUsePooledMalloc(usePool);
+}
+
+TEST(Core_MatArena, scopedTemporariesComeFromArena)
+{
+    MatArena arena(1 << 16);
+    Mat a(100, 100, CV_32F, Scalar::all(1)), result;
+
+    for (int iter = 0; iter < 3; iter++)
+    {
+        {
+            MatAllocatorScope scope(&arena);
+            Mat tmp = a.clone();
+            Mat tmp2;
+            add(tmp, a, tmp2);
+            ASSERT_TRUE(tmp.allocator == &arena);
+            ASSERT_TRUE(tmp2.allocator == &arena);
+            EXPECT_GE(arena.allocatedBytes(), 2*a.total()*a.elemSize());
+            tmp2.copyTo(result); // result is re-allocated from the arena on the first iteration
+
+            EXPECT_THROW(arena.reset(), cv::Exception); // tmp and tmp2 are still alive
+        }
+        result = result.clone(); // move the result out of the arena
+        ASSERT_TRUE(result.allocator == 0);
+        EXPECT_EQ(2, result.at<float>(99, 99));
+        arena.reset();
+        EXPECT_EQ(0u, arena.allocatedBytes());
+    }
+
+    // after the first cycle the arena keeps a single block that fits the whole cycle
+    EXPECT_GE(arena.capacity(), 3*a.total()*a.elemSize());
+    EXPECT_TRUE(getDefaultMatAllocator() == 0);
+}
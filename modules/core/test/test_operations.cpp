@@ -1214,3 +1214,104 @@ protected:
 };
 
 TEST(Core_SparseMat, iterations) { CV_SparseMatTest test; test.safe_run(); }
+
+TEST(Core_MatExpr, FusedOptimizedMatchesPlain)
+{
+    int types[] = { CV_8UC1, CV_16UC1, CV_16SC3, CV_32FC1 };
+    bool useOpt = cv::useOptimized();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        int type = types[t], depth = CV_MAT_DEPTH(type);
+        SCOPED_TRACE(cv::format("type=%d", type));
+
+        // an odd width leaves a tail after the vector loops in every block
+        cv::Mat a(61, 1037, type), b(a.size(), type), c(a.size(), type);
+        cv::randu(a, depth == CV_16S || depth == CV_32F ? -1000 : 0, depth == CV_8U ? 256 : 1000);
+        cv::randu(b, depth == CV_16S || depth == CV_32F ? -1000 : 0, depth == CV_8U ? 256 : 1000);
+        cv::randu(c, 0, 100);
+
+        cv::Mat r[2][4];
+        for( int opt = 0; opt < 2; opt++ )
+        {
+            cv::setUseOptimized(opt != 0);
+            r[opt][0] = a*0.5 + b*0.25 - c;
+            r[opt][1] = cv::min(a, b) + a.mul(b, 1./255);
+            r[opt][2] = (a + b)/(c*2 + 1) + a/(c - 1);
+            r[opt][3] = cv::max(a, b*2) - c*0.5;
+        }
+        cv::setUseOptimized(useOpt);
+
+        for( int i = 0; i < 4; i++ )
+            EXPECT_EQ(0, cv::norm(r[0][i], r[1][i], cv::NORM_INF)) << "expression " << i;
+    }
+}
+
+TEST(Core_MatExpr, FusedMatchesEager)
+{
+    int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_32FC1, CV_64FC2 };
+    cv::Size sizes[] = { cv::Size(37, 19), cv::Size(1000, 1000) };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int k = 0; k < 2; k++ )
+        {
+            int type = types[t], depth = CV_MAT_DEPTH(type);
+            double lo = depth == CV_8U ? 0 : depth == CV_16S ? -1000 : -100;
+            double hi = depth == CV_8U ? 256 : -lo;
+            double eps = depth >= CV_32F ? 1e-3 : 0;
+            SCOPED_TRACE(cv::format("type=%d, size=%dx%d", type, sizes[k].width, sizes[k].height));
+
+            cv::Mat a(sizes[k], type), b(sizes[k], type), c(sizes[k], type);
+            cv::randu(a, lo, hi);
+            cv::randu(b, lo, hi);
+            cv::randu(c, lo, hi);
+
+            cv::Mat r, t1, t2, r0;
+
+            r = a*0.5 + b*0.25 - c;
+            cv::addWeighted(a, 0.5, b, 0.25, 0, t1);
+            cv::subtract(t1, c, r0);
+            EXPECT_LE(cv::norm(r, r0, cv::NORM_INF), eps);
+
+            r = (a - b)*2 + c;
+            cv::addWeighted(a, 2, b, -2, 0, t1);
+            cv::add(t1, c, r0);
+            EXPECT_LE(cv::norm(r, r0, cv::NORM_INF), eps);
+
+            r = cv::min(a, b) + a.mul(b, 1./255);
+            cv::min(a, b, t1);
+            cv::multiply(a, b, t2, 1./255);
+            cv::add(t1, t2, r0);
+            EXPECT_LE(cv::norm(r, r0, cv::NORM_INF), eps);
+
+            r = cv::abs(a - b*0.5);
+            cv::addWeighted(a, 1, b, -0.5, 0, t1);
+            r0 = cv::abs(t1);
+            EXPECT_LE(cv::norm(r, r0, cv::NORM_INF), eps);
+
+            r = (a > b)*0.5 + cv::Scalar(1);
+            cv::compare(a, b, t1, cv::CMP_GT);
+            t1.convertTo(r0, -1, 0.5, 1);
+            EXPECT_EQ(0, cv::norm(r, r0, cv::NORM_INF));
+
+            // the eager division is computed in a slightly different way,
+            // so the integer results may differ by 1 in the rounding ties
+            r = (a + b)/(c*2 + 1);
+            cv::add(a, b, t1);
+            c.convertTo(t2, -1, 2, 1);
+            cv::divide(t1, t2, r0);
+            EXPECT_LE(cv::norm(r, r0, cv::NORM_INF), depth >= CV_32F ? eps : 1);
+
+            r = c.clone();
+            r += a*0.5 + b*0.25;
+            cv::addWeighted(a, 0.5, b, 0.25, 0, t1);
+            cv::add(c, t1, r0);
+            EXPECT_LE(cv::norm(r, r0, cv::NORM_INF), eps);
+
+            cv::Rect roi(3, 2, sizes[k].width/2, sizes[k].height/2);
+            r = (a*0.5 + b*0.25 - c)(roi);
+            cv::addWeighted(a, 0.5, b, 0.25, 0, t1);
+            cv::subtract(t1, c, r0);
+            EXPECT_LE(cv::norm(r, r0(roi), cv::NORM_INF), eps);
+        }
+}
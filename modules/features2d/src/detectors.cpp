@@ -217,27 +217,18 @@ class GridAdaptedFeatureDetectorInvoker
 private:
     int gridRows_, gridCols_;
     int maxPerCell_;
-    std::vector<KeyPoint>& keypoints_;
+    std::vector<std::vector<KeyPoint> >& cellKeypoints_;
     const Mat& image_;
     const Mat& mask_;
     const Ptr<FeatureDetector>& detector_;
-#ifdef HAVE_TBB
-    tbb::mutex* kptLock_;
-#endif
 
     GridAdaptedFeatureDetectorInvoker& operator=(const GridAdaptedFeatureDetectorInvoker&); // to quiet MSVC
 
 public:
 
-    GridAdaptedFeatureDetectorInvoker(const Ptr<FeatureDetector>& detector, const Mat& image, const Mat& mask, std::vector<KeyPoint>& keypoints, int maxPerCell, int gridRows, int gridCols
-#ifdef HAVE_TBB
-        , tbb::mutex* kptLock
-#endif
-        ) : gridRows_(gridRows), gridCols_(gridCols), maxPerCell_(maxPerCell),
-            keypoints_(keypoints), image_(image), mask_(mask), detector_(detector)
-#ifdef HAVE_TBB
-            , kptLock_(kptLock)
-#endif
+    GridAdaptedFeatureDetectorInvoker(const Ptr<FeatureDetector>& detector, const Mat& image, const Mat& mask, std::vector<std::vector<KeyPoint> >& cellKeypoints, int maxPerCell, int gridRows, int gridCols)
+        : gridRows_(gridRows), gridCols_(gridCols), maxPerCell_(maxPerCell),
+          cellKeypoints_(cellKeypoints), image_(image), mask_(mask), detector_(detector)
     {
     }
 
@@ -255,7 +246,7 @@ public:
             Mat sub_mask;
             if (!mask_.empty()) sub_mask = mask_(row_range, col_range);
 
-            std::vector<KeyPoint> sub_keypoints;
+            std::vector<KeyPoint>& sub_keypoints = cellKeypoints_[i];
             sub_keypoints.reserve(maxPerCell_);
 
             detector_->detect( sub_image, sub_keypoints, sub_mask );
@@ -268,10 +259,6 @@ public:
                 it->pt.x += col_range.start;
                 it->pt.y += row_range.start;
             }
-#ifdef HAVE_TBB
-            tbb::mutex::scoped_lock join_keypoints(*kptLock_);
-#endif
-            keypoints_.insert( keypoints_.end(), sub_keypoints.begin(), sub_keypoints.end() );
         }
     }
 };
@@ -287,13 +274,13 @@ void GridAdaptedFeatureDetector::detectImpl( const Mat& image, std::vector<KeyPo
     keypoints.reserve(maxTotalKeypoints);
     int maxPerCell = maxTotalKeypoints / (gridRows * gridCols);
 
-#ifdef HAVE_TBB
-    tbb::mutex kptLock;
+    // every cell keeps its own keypoints, so they are joined in the same order however the cells were scheduled
+    std::vector<std::vector<KeyPoint> > cellKeypoints(gridRows * gridCols);
     cv::parallel_for(cv::BlockedRange(0, gridRows * gridCols),
-        GridAdaptedFeatureDetectorInvoker(detector, image, mask, keypoints, maxPerCell, gridRows, gridCols, &kptLock));
-#else
-    GridAdaptedFeatureDetectorInvoker(detector, image, mask, keypoints, maxPerCell, gridRows, gridCols)(cv::BlockedRange(0, gridRows * gridCols));
-#endif
+        GridAdaptedFeatureDetectorInvoker(detector, image, mask, cellKeypoints, maxPerCell, gridRows, gridCols));
+
+    for( size_t i = 0; i < cellKeypoints.size(); i++ )
+        keypoints.insert( keypoints.end(), cellKeypoints[i].begin(), cellKeypoints[i].end() );
 }
 
 /*
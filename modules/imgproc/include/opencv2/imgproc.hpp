@@ -348,6 +348,85 @@ CV_EXPORTS Ptr<FilterEngine> createBoxFilter( int srcType, int dstType, Size ksi
 CV_EXPORTS_W Mat getGaborKernel( Size ksize, double sigma, double theta, double lambd,
                                  double gamma, double psi=CV_PI*0.5, int ktype=CV_64F );
 
+/*!
+ The Base Class for Element-wise Stages of cv::FilterPipeline
+
+ The operator is called on blocks of rows: src[i] are the same rows of the i-th stage input,
+ and dst is the block of the stage output. dst is already allocated with the stage type,
+ so that the functions like cv::magnitude() or cv::threshold() can write into it directly.
+*/
+class CV_EXPORTS BasePipelineOp
+{
+public:
+    //! the destructor
+    virtual ~BasePipelineOp();
+    //! the processing operator. Must be overrided in the derived classes.
+    virtual void operator()(const Mat* src, int nsrc, Mat& dst) = 0;
+};
+
+//! returns the stage that computes the magnitude of 2D vectors from their x and y components
+CV_EXPORTS Ptr<BasePipelineOp> getMagnitudeOp();
+//! returns the stage that computes the rotation angle of 2D vectors from their x and y components
+CV_EXPORTS Ptr<BasePipelineOp> getPhaseOp(bool angleInDegrees=false);
+//! returns the stage that applies the fixed-level threshold (cv::THRESH_OTSU is not supported)
+CV_EXPORTS Ptr<BasePipelineOp> getThresholdOp(double thresh, double maxval, int type);
+//! returns the stage that converts its input to the stage type: dst = saturate_cast<>(src*alpha + beta)
+CV_EXPORTS Ptr<BasePipelineOp> getConvertOp(double alpha=1, double beta=0);
+
+/*!
+ The Filter Pipeline
+
+ The class chains filters and element-wise operations, so that the image is processed
+ a few rows at a time. Each stage takes the output of the earlier stages (or the pipeline source)
+ and produces an image of the same size, which only exists as the band of rows that the next
+ stages still need. So the full-size intermediate images are never allocated and the rows
+ passed between the stages stay in cache. The result is the same as if the stages were
+ applied one by one to the whole images.
+
+ \code
+ FilterPipeline edges;
+ int blurred = edges.addFilter(createGaussianFilter(CV_8U, Size(5,5), 1.5));
+ int dx = edges.addFilter(createDerivFilter(CV_8U, CV_32F, 1, 0, 3), blurred);
+ int dy = edges.addFilter(createDerivFilter(CV_8U, CV_32F, 0, 1, 3), blurred);
+ int mag = edges.addOp(getMagnitudeOp(), CV_32F, dx, dy);
+ edges.addOp(getThresholdOp(100, 255, THRESH_BINARY), CV_32F, mag);
+ // dst is the output of the last stage
+ edges.apply(src, dst);
+ \endcode
+
+ The filter engines keep their state between the calls of FilterEngine::proceed(), so a pipeline
+ can not be used from several threads at once. To process an image in parallel, build
+ a pipeline per thread and let each of them compute its part of dst.
+*/
+class CV_EXPORTS FilterPipeline
+{
+public:
+    enum { SOURCE=-1, NONE=-2 };
+
+    //! the default constructor
+    FilterPipeline();
+    //! the destructor
+    virtual ~FilterPipeline();
+    //! adds the filter stage that processes the output of the stage #input; returns index of the new stage
+    int addFilter(const Ptr<FilterEngine>& filter, int input=SOURCE);
+    //! adds the element-wise stage that produces an image of type dstType from a single input
+    int addOp(const Ptr<BasePipelineOp>& op, int dstType, int input=SOURCE);
+    //! adds the element-wise stage that produces an image of type dstType from two inputs
+    int addOp(const Ptr<BasePipelineOp>& op, int dstType, int input0, int input1);
+    //! removes all the stages
+    void clear();
+    //! runs the pipeline on src. dst is the output of the last stage
+    virtual void apply(const Mat& src, Mat& dst);
+    //! computes the specified rows of dst only; dst must already have the proper size and type
+    virtual void apply(const Mat& src, Mat& dst, const Range& rows);
+
+    std::vector<Ptr<FilterEngine> > filters;
+    std::vector<Ptr<BasePipelineOp> > ops;
+    //! inputs of the stages; the second input is NONE for the filters and single-input operations
+    std::vector<Vec2i> inputs;
+    std::vector<int> types;
+};
+
 //! type of morphological operation
 enum { MORPH_ERODE=CV_MOP_ERODE, MORPH_DILATE=CV_MOP_DILATE,
        MORPH_OPEN=CV_MOP_OPEN, MORPH_CLOSE=CV_MOP_CLOSE,
@@ -394,6 +473,10 @@ CV_EXPORTS_W void GaussianBlur( InputArray src,
 CV_EXPORTS_W void bilateralFilter( InputArray src, OutputArray dst, int d,
                                    double sigmaColor, double sigmaSpace,
                                    int borderType=BORDER_DEFAULT );
+//! smooths the image using the bilateral grid, a fast approximation of the bilateral filter
+//! that takes the same time for any sigmaSpace
+CV_EXPORTS_W void bilateralGridFilter( InputArray src, OutputArray dst,
+                                       double sigmaColor, double sigmaSpace );
 //! smooths the image using the box filter. Each pixel is processed in O(1) time
 CV_EXPORTS_W void boxFilter( InputArray src, OutputArray dst, int ddepth,
                              Size ksize, Point anchor=Point(-1,-1),
@@ -557,6 +640,11 @@ CV_EXPORTS_W void resize( InputArray src, OutputArray dst,
                           Size dsize, double fx=0, double fy=0,
                           int interpolation=INTER_LINEAR );
 
+//! resizes the image, converts its colors and writes the channels, scaled and shifted, as separate float planes
+CV_EXPORTS_W void resizeToPlanar( InputArray src, OutputArray dst, Size dsize, int code=-1,
+                                  double scale=1, const Scalar& shift=Scalar(),
+                                  int interpolation=INTER_LINEAR );
+
 //! warps the image using affine transformation
 CV_EXPORTS_W void warpAffine( InputArray src, OutputArray dst,
                               InputArray M, Size dsize,
@@ -578,6 +666,35 @@ enum
     INTER_TAB_SIZE2=INTER_TAB_SIZE*INTER_TAB_SIZE
 };
 
+//! the maps of warpAffine() or warpPerspective() for the given transformation, computed once and applied to many images
+class CV_EXPORTS_W WarpPlan
+{
+public:
+    CV_WRAP WarpPlan();
+
+    //! computes the fixed-point maps of warpAffine() with the 2x3 matrix M, destination size and flags
+    CV_WRAP void initAffine( InputArray M, Size dsize, int flags=INTER_LINEAR );
+    //! computes the fixed-point maps of warpPerspective() with the 3x3 matrix M, destination size and flags
+    CV_WRAP void initPerspective( InputArray M, Size dsize, int flags=INTER_LINEAR );
+
+    //! warps the image; the result is the same as of warpAffine() or warpPerspective() with the same parameters
+    CV_WRAP void apply( InputArray src, OutputArray dst, int borderMode=BORDER_CONSTANT,
+                        const Scalar& borderValue=Scalar() ) const;
+    //! warps every image of the batch; the images are processed in parallel
+    void apply( const std::vector<Mat>& src, std::vector<Mat>& dst, int borderMode=BORDER_CONSTANT,
+                const Scalar& borderValue=Scalar() ) const;
+
+    CV_WRAP bool empty() const;
+    CV_WRAP Size size() const;
+
+    //! the integer coordinates (CV_16SC2) and the interpolation table indices (CV_16UC1, empty for INTER_NEAREST)
+    CV_PROP Mat map1, map2;
+    CV_PROP int interpolation;
+
+protected:
+    void init( InputArray M, Size dsize, int flags, bool perspective );
+};
+
 //! warps the image using the precomputed maps. The maps are stored in either floating-point or integer fixed-point format
 CV_EXPORTS_W void remap( InputArray src, OutputArray dst,
                          InputArray map1, InputArray map2,
@@ -753,6 +870,28 @@ CV_EXPORTS double compareHist( const SparseMat& H1, const SparseMat& H2, int met
 //! normalizes the grayscale image brightness and contrast by normalizing its histogram
 CV_EXPORTS_W void equalizeHist( InputArray src, OutputArray dst );
 
+//! Contrast Limited Adaptive Histogram Equalization
+class CV_EXPORTS_W CLAHE : public Algorithm
+{
+public:
+    //! equalizes the histogram of the 8-bit single-channel image src in every tile and
+    //! interpolates the resulting mappings bilinearly between the tile centers
+    CV_WRAP virtual void apply( InputArray src, OutputArray dst ) = 0;
+
+    //! sets the contrast limit, relative to the average count per histogram bin; 0 disables clipping
+    CV_WRAP virtual void setClipLimit( double clipLimit ) = 0;
+    CV_WRAP virtual double getClipLimit() const = 0;
+
+    //! sets the number of tiles in the horizontal and the vertical directions
+    CV_WRAP virtual void setTilesGridSize( Size tileGridSize ) = 0;
+    CV_WRAP virtual Size getTilesGridSize() const = 0;
+
+    //! releases the buffers that are kept between the calls of apply()
+    CV_WRAP virtual void collectGarbage() = 0;
+};
+
+CV_EXPORTS_W Ptr<CLAHE> createCLAHE( double clipLimit=40.0, Size tileGridSize=Size(8, 8) );
+
 CV_EXPORTS float EMD( InputArray signature1, InputArray signature2,
                       int distType, InputArray cost=noArray(),
                       float* lowerBound=0, OutputArray flow=noArray() );
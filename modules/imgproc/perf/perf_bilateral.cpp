@@ -36,3 +36,34 @@ PERF_TEST_P( TestBilateralFilter, BilateralFilter,
 
     SANITY_CHECK(dst);
 }
+
+typedef TestBaseWithParam< tr1::tuple<Size, double, Mat_Type> > TestBilateralGridFilter;
+
+PERF_TEST_P( TestBilateralGridFilter, BilateralGridFilter,
+             Combine(
+                Values( szVGA, sz1080p ), // image size
+                Values( 2., 4., 8., 16., 32. ), // sigmaSpace
+                ValuesIn( Mat_Type::all() ) // image type
+             )
+)
+{
+    Size sz;
+    int type;
+    double sigmaSpace;
+    const double sigmaColor = 20.;
+
+    sz         = get<0>(GetParam());
+    sigmaSpace = get<1>(GetParam());
+    type       = get<2>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    // the grid has a cell per sigmaColor values, so the floating-point images get the range of 8-bit ones
+    randu(src, 0, 256);
+    declare.in(src).out(dst).time(20);
+
+    TEST_CYCLE() bilateralGridFilter(src, dst, sigmaColor, sigmaSpace);
+
+    SANITY_CHECK(dst, 1);
+}
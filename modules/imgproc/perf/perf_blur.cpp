@@ -35,6 +35,55 @@ PERF_TEST_P(Size_MatType_kSize, medianBlur,
     SANITY_CHECK(dst);
 }
 
+PERF_TEST_P(Size_MatType_kSize, medianBlur_large,
+            testing::Combine(
+                testing::Values(szVGA, sz720p),
+                testing::Values(CV_8UC1, CV_16UC1, CV_16SC1, CV_32FC1),
+                testing::Values(7, 15, 31)
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int ksize = get<2>(GetParam());
+
+    Mat src(size, type);
+    Mat dst(size, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(30);
+
+    TEST_CYCLE() medianBlur(src, dst, ksize);
+
+    SANITY_CHECK(dst, 1e-4);
+}
+
+typedef std::tr1::tuple<MatType, int, int> MatType_kSize_Threads_t;
+typedef perf::TestBaseWithParam<MatType_kSize_Threads_t> MatType_kSize_Threads;
+
+PERF_TEST_P(MatType_kSize_Threads, medianBlur_threads,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_16UC1),
+                testing::Values(3, 15),
+                testing::Values(1, 2, 4, 8)
+                )
+            )
+{
+    int type = get<0>(GetParam());
+    int ksize = get<1>(GetParam());
+    int nthreads = get<2>(GetParam());
+
+    Mat src(sz1080p, type);
+    Mat dst(sz1080p, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(30);
+
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE() medianBlur(src, dst, ksize);
+
+    SANITY_CHECK(dst);
+}
+
 CV_ENUM(BorderType3x3, BORDER_REPLICATE, BORDER_CONSTANT)
 CV_ENUM(BorderType, BORDER_REPLICATE, BORDER_CONSTANT, BORDER_REFLECT, BORDER_REFLECT101)
 
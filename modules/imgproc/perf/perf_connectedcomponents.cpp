@@ -0,0 +1,36 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<int, int> Connectivity_Threads_t;
+typedef perf::TestBaseWithParam<Connectivity_Threads_t> Connectivity_Threads;
+
+PERF_TEST_P(Connectivity_Threads, connectedComponentsWithStats,
+            testing::Combine(
+                testing::Values(4, 8),
+                testing::Values(1, 2, 4, 8)
+            )
+           )
+{
+    int connectivity = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    // blobs of various sizes on a 20-megapixel image
+    Mat noise(4000, 5000, CV_8U), img, labels, stats, centroids;
+    randu(noise, 0, 256);
+    GaussianBlur(noise, img, Size(7, 7), 0);
+    img = img > 128;
+    declare.in(img);
+
+    ParallelScope scope(nthreads);
+
+    int nlabels = 0;
+    TEST_CYCLE() nlabels = connectedComponentsWithStats(img, labels, stats, centroids, connectivity, CV_32S);
+
+    SANITY_CHECK(nlabels);
+    SANITY_CHECK(stats);
+}
@@ -263,6 +263,49 @@ PERF_TEST_P(Size_CvtMode, cvtColor8u,
     SANITY_CHECK(dst, 1);
 }
 
+CV_ENUM(CvtModeVec, CV_BGR2GRAY, CV_BGRA2GRAY, CV_BGR2YCrCb, CX_BGRA2YCrCb, CV_BGR2HSV, CX_BGRA2HSV,
+        CV_BGR2Lab, CV_LBGR2Lab, CV_BGR2Luv, CV_LBGR2Luv)
+
+typedef std::tr1::tuple<CvtModeVec, MatDepth, bool> CvtMode_Depth_Optimized_t;
+typedef perf::TestBaseWithParam<CvtMode_Depth_Optimized_t> CvtMode_Depth_Optimized;
+
+// the vectorized conversions, with the optimized code paths on and off
+PERF_TEST_P(CvtMode_Depth_Optimized, cvtColorVectorized,
+            testing::Combine(
+                testing::ValuesIn(CvtModeVec::all()),
+                testing::Values(CV_8U, CV_32F),
+                testing::Bool()
+                )
+            )
+{
+    int mode = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+    bool optimized = get<2>(GetParam());
+    ChPair ch = getConversionInfo(mode);
+    mode %= CV_COLORCVT_MAX;
+
+    Mat src(sz1080p, CV_MAKETYPE(depth, ch.scn));
+    Mat dst(sz1080p, CV_MAKETYPE(depth, ch.dcn));
+
+    if( depth == CV_8U )
+        declare.in(src, WARMUP_RNG);
+    else
+    {
+        randu(src, 0, 1);
+        declare.in(src);
+    }
+    declare.out(dst);
+
+    bool prevOptimized = useOptimized();
+    setUseOptimized(optimized);
+
+    TEST_CYCLE() cvtColor(src, dst, mode, ch.dcn);
+
+    setUseOptimized(prevOptimized);
+
+    SANITY_CHECK(dst, depth == CV_8U ? 1 : 1e-3);
+}
+
 typedef std::tr1::tuple<Size, CvtModeBayer> Size_CvtMode_Bayer_t;
 typedef perf::TestBaseWithParam<Size_CvtMode_Bayer_t> Size_CvtMode_Bayer;
 
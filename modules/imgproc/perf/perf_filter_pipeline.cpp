@@ -0,0 +1,44 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// blur -> Sobel dx/dy -> magnitude -> threshold on 4K images, either stage by stage
+// on full-size images or fused into a FilterPipeline
+
+typedef perf::TestBaseWithParam<bool> Edges_Fused;
+
+PERF_TEST_P(Edges_Fused, gradientMagnitude, testing::Bool())
+{
+    bool fused = GetParam();
+
+    Mat src(sz2160p, CV_8UC1), dst;
+    declare.in(src, WARMUP_RNG);
+
+    FilterPipeline p;
+    int b = p.addFilter(createGaussianFilter(CV_8U, Size(5, 5), 1.5));
+    int dx = p.addFilter(createDerivFilter(CV_8U, CV_32F, 1, 0, 3), b);
+    int dy = p.addFilter(createDerivFilter(CV_8U, CV_32F, 0, 1, 3), b);
+    int m = p.addOp(getMagnitudeOp(), CV_32F, dx, dy);
+    p.addOp(getThresholdOp(100, 255, THRESH_BINARY), CV_32F, m);
+
+    TEST_CYCLE()
+    {
+        if( fused )
+            p.apply(src, dst);
+        else
+        {
+            Mat blurred, gx, gy, mag;
+            GaussianBlur(src, blurred, Size(5, 5), 1.5);
+            Sobel(blurred, gx, CV_32F, 1, 0, 3);
+            Sobel(blurred, gy, CV_32F, 0, 1, 3);
+            magnitude(gx, gy, mag);
+            threshold(mag, dst, 100, 255, THRESH_BINARY);
+        }
+    }
+
+    SANITY_CHECK(dst, 1e-5);
+}
@@ -0,0 +1,62 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// Runs the FilterEngine-based filters on 4K images with a limited number of threads,
+// so the report shows how the parallel filter driver scales with the number of cores.
+
+enum { FILTER_2D, FILTER_SEP2D, FILTER_SOBEL, FILTER_SCHARR, FILTER_GAUSSIAN, FILTER_BOX };
+CV_ENUM(FilterType, FILTER_2D, FILTER_SEP2D, FILTER_SOBEL, FILTER_SCHARR, FILTER_GAUSSIAN, FILTER_BOX)
+
+typedef std::tr1::tuple<FilterType, int> FilterType_Threads_t;
+typedef perf::TestBaseWithParam<FilterType_Threads_t> FilterType_Threads;
+
+PERF_TEST_P(FilterType_Threads, filter,
+            testing::Combine(
+                testing::ValuesIn(FilterType::all()),
+                testing::Values(1, 2, 4, 8, 16)
+            )
+           )
+{
+    int type = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    Mat src(sz2160p, CV_8UC1), dst;
+    Mat kernel(5, 5, CV_32F), kernelX(1, 7, CV_32F), kernelY(1, 7, CV_32F);
+    declare.in(src, WARMUP_RNG);
+    randu(kernel, -1, 1);
+    randu(kernelX, 0, 0.2);
+    randu(kernelY, 0, 0.2);
+
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE()
+    {
+        switch( type )
+        {
+        case FILTER_2D:
+            filter2D(src, dst, CV_16S, kernel);
+            break;
+        case FILTER_SEP2D:
+            sepFilter2D(src, dst, -1, kernelX, kernelY);
+            break;
+        case FILTER_SOBEL:
+            Sobel(src, dst, CV_16S, 1, 0, 3);
+            break;
+        case FILTER_SCHARR:
+            Scharr(src, dst, CV_16S, 0, 1);
+            break;
+        case FILTER_GAUSSIAN:
+            GaussianBlur(src, dst, Size(7, 7), 1.5);
+            break;
+        default:
+            blur(src, dst, Size(9, 9));
+        }
+    }
+
+    SANITY_CHECK(dst, 1);
+}
@@ -115,3 +115,64 @@ PERF_TEST_P(MatSize, equalizeHist,
 
     SANITY_CHECK(destination);
 }
+
+enum { HIST_CALC, HIST_EQUALIZE, HIST_BACKPROJECT };
+CV_ENUM(HistOp, HIST_CALC, HIST_EQUALIZE, HIST_BACKPROJECT)
+
+typedef tr1::tuple<HistOp, int> HistOp_Threads_t;
+typedef TestBaseWithParam<HistOp_Threads_t> HistOp_Threads;
+
+PERF_TEST_P(HistOp_Threads, hist8u_threads,
+            testing::Combine(testing::ValuesIn(HistOp::all()),
+                             testing::Values(1, 2, 4, 8) )
+            )
+{
+    int op = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+    Mat source(sz1080p, CV_8U), hist, destination;
+    int channels [] = {0};
+    int histSize [] = {256};
+    const float r[] = {rangeLow, rangeHight};
+    const float* ranges[] = {r};
+
+    declare.in(source, WARMUP_RNG);
+    calcHist(&source, 1, channels, Mat(), hist, 1, histSize, ranges);
+
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE()
+    {
+        if( op == HIST_CALC )
+            calcHist(&source, 1, channels, Mat(), destination, 1, histSize, ranges);
+        else if( op == HIST_EQUALIZE )
+            equalizeHist(source, destination);
+        else
+            calcBackProject(&source, 1, channels, hist, destination, ranges, 1./1024);
+    }
+
+    SANITY_CHECK(destination);
+}
+
+typedef tr1::tuple<Size, int> Size_Threads_t;
+typedef TestBaseWithParam<Size_Threads_t> Size_Threads;
+
+PERF_TEST_P(Size_Threads, CLAHE,
+            testing::Combine(testing::Values(sz720p, sz1080p, sz2160p),
+                             testing::Values(1, 2, 4, 8) )
+            )
+{
+    Size size = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+    Mat source(size, CV_8U), destination;
+    declare.in(source, WARMUP_RNG);
+
+    Ptr<CLAHE> clahe = createCLAHE(2.0, Size(8, 8));
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE()
+    {
+        clahe->apply(source, destination);
+    }
+
+    SANITY_CHECK(destination);
+}
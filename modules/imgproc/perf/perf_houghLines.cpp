@@ -39,3 +39,59 @@ PERF_TEST_P(Image_RhoStep_ThetaStep_Threshold, HoughLines,
     transpose(lines, lines);
     SANITY_CHECK(lines);
 }
+
+typedef std::tr1::tuple<Size, int> Size_Threads_t;
+typedef perf::TestBaseWithParam<Size_Threads_t> Size_Threads;
+
+static Mat houghScene( Size size )
+{
+    Mat img(size, CV_8U, Scalar(40));
+    RNG rng(0x3c);
+    for( int i = 0; i < 20; i++ )
+        circle(img, Point(rng.uniform(0, size.width), rng.uniform(0, size.height)),
+               rng.uniform(10, 120), Scalar(rng.uniform(120, 256)), rng.uniform(-1, 4));
+    for( int i = 0; i < 30; i++ )
+        line(img, Point(rng.uniform(0, size.width), rng.uniform(0, size.height)),
+             Point(rng.uniform(0, size.width), rng.uniform(0, size.height)),
+             Scalar(rng.uniform(100, 256)), rng.uniform(1, 3));
+    GaussianBlur(img, img, Size(5, 5), 1.5);
+    return img;
+}
+
+PERF_TEST_P(Size_Threads, HoughLinesP_threads,
+            testing::Combine(
+                testing::Values( sz720p, sz1080p ),
+                testing::Values( 1, 2, 4, 8 )
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    Mat edges, lines;
+    Canny(houghScene(size), edges, 50, 150);
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE() HoughLinesP(edges, lines, 1, CV_PI/180, 50, 30, 10);
+
+    SANITY_CHECK(lines);
+}
+
+PERF_TEST_P(Size_Threads, HoughCircles_threads,
+            testing::Combine(
+                testing::Values( sz720p, sz1080p ),
+                testing::Values( 1, 2, 4, 8 )
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    Mat img = houghScene(size), circles;
+    declare.time(60);
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE() HoughCircles(img, circles, CV_HOUGH_GRADIENT, 1, 20, 100, 30, 5, 130);
+
+    SANITY_CHECK(circles);
+}
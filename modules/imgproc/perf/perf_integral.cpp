@@ -82,3 +82,31 @@ PERF_TEST_P( Size_MatType_OutMatDepth, integral_sqsum_tilted,
     SANITY_CHECK(sqsum, 1e-6);
     SANITY_CHECK(tilted, 1e-6, tilted.depth() > CV_32S ? ERROR_RELATIVE : ERROR_ABSOLUTE);
 }
+
+typedef std::tr1::tuple<MatType, MatDepth, int> MatType_OutMatDepth_Threads_t;
+typedef perf::TestBaseWithParam<MatType_OutMatDepth_Threads_t> MatType_OutMatDepth_Threads;
+
+PERF_TEST_P(MatType_OutMatDepth_Threads, integral_sqsum_threads,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_8UC4),
+                testing::Values(CV_32S, CV_64F),
+                testing::Values(1, 2, 4, 8)
+                )
+            )
+{
+    int matType = get<0>(GetParam());
+    int sdepth = get<1>(GetParam());
+    int nthreads = get<2>(GetParam());
+
+    Mat src(sz2160p, matType);
+    Mat sum, sqsum;
+
+    declare.in(src, WARMUP_RNG);
+
+    ParallelScope scope(nthreads);
+
+    TEST_CYCLE() integral(src, sum, sqsum, sdepth);
+
+    SANITY_CHECK(sum, 1e-6);
+    SANITY_CHECK(sqsum, 1e-6);
+}
@@ -119,3 +119,54 @@ PERF_TEST_P(MatInfo_Size_Scale_Area, ResizeArea,
     //difference equal to 1 is allowed because of different possible rounding modes: round-to-nearest vs bankers' rounding
     SANITY_CHECK(dst, 1);
 }
+
+CV_ENUM(PlanarCode, -1, CV_BGR2RGB, CV_BGR2GRAY, CV_YUV2RGB_NV12)
+
+typedef tr1::tuple<Size, PlanarCode, bool> Size_PlanarCode_Fused_t;
+typedef TestBaseWithParam<Size_PlanarCode_Fused_t> Size_PlanarCode_Fused;
+
+PERF_TEST_P(Size_PlanarCode_Fused, resizeToPlanar,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                testing::ValuesIn(PlanarCode::all()),
+                testing::Bool()
+                )
+            )
+{
+    Size from = get<0>(GetParam());
+    int code = get<1>(GetParam());
+    bool fused = get<2>(GetParam());
+    Size to(224, 224);
+    bool yuv = code == CV_YUV2RGB_NV12;
+    int dcn = code == CV_BGR2GRAY ? 1 : 3;
+    Scalar shift(-0.485, -0.456, -0.406);
+
+    Mat src(yuv ? from.height*3/2 : from.height, from.width, yuv ? CV_8UC1 : CV_8UC3);
+    Mat dst(to.height*dcn, to.width, CV_32F);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    if( fused )
+    {
+        TEST_CYCLE() resizeToPlanar(src, dst, to, code, 1./255, shift);
+    }
+    else
+    {
+        Mat converted, resized;
+        std::vector<Mat> planes(dcn);
+        for( int c = 0; c < dcn; c++ )
+            planes[c] = dst.rowRange(c*to.height, (c+1)*to.height);
+
+        TEST_CYCLE()
+        {
+            if( code >= 0 )
+                cvtColor(src, converted, code);
+            else
+                converted = src;
+            resize(converted, resized, to);
+            resized.convertTo(resized, CV_32F, 1./255, -0.5);
+            split(resized, planes);
+        }
+    }
+
+    SANITY_CHECK(dst, 1e-5);
+}
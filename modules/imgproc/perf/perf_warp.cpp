@@ -134,6 +134,87 @@ PERF_TEST_P( TestWarpPerspectiveNear_t, WarpPerspectiveNear,
 #endif
 }
 
+typedef TestBaseWithParam< tr1::tuple<Size, InterType, bool> > TestWarpPlan;
+
+PERF_TEST_P( TestWarpPlan, WarpPlanPerspective,
+             Combine(
+                Values( szVGA, sz1080p ),
+                ValuesIn( InterType::all() ),
+                Bool()
+             )
+)
+{
+    Size sz = get<0>(GetParam()), szSrc(512, 512);
+    int interType = get<1>(GetParam());
+    bool usePlan = get<2>(GetParam());
+    Scalar borderColor = Scalar::all(150);
+
+    Mat src(szSrc, CV_8UC4), dst(sz, CV_8UC4);
+    cvtest::fillGradient(src);
+    cvtest::smoothBorder(src, borderColor, 1);
+    Mat warpMat = Mat::eye(3, 3, CV_64F);
+    getRotationMatrix2D(Point2f(src.cols/2.f, src.rows/2.f), 30., 2.2).copyTo(warpMat.rowRange(0, 2));
+    warpMat.at<double>(2, 0) = .3/sz.width;
+    warpMat.at<double>(2, 1) = .3/sz.height;
+
+    WarpPlan plan;
+    plan.initPerspective(warpMat, sz, interType);
+    declare.in(src).out(dst);
+
+    if( usePlan )
+    {
+        TEST_CYCLE() plan.apply( src, dst, BORDER_CONSTANT, borderColor );
+    }
+    else
+    {
+        TEST_CYCLE() warpPerspective( src, dst, warpMat, sz, interType, BORDER_CONSTANT, borderColor );
+    }
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P( TestWarpPlan, WarpPlanAffineBatch,
+             Combine(
+                Values( Size(64, 64), Size(256, 256) ),
+                ValuesIn( InterType::all() ),
+                Bool()
+             )
+)
+{
+    Size sz = get<0>(GetParam());
+    int interType = get<1>(GetParam());
+    bool usePlan = get<2>(GetParam());
+    const int batchSize = 64;
+
+    vector<Mat> src(batchSize), dst(batchSize);
+    for( int i = 0; i < batchSize; i++ )
+    {
+        src[i].create(sz, CV_8UC3);
+        dst[i].create(sz, CV_8UC3);
+        declare.in(src[i], WARMUP_RNG);
+    }
+    Mat warpMat = getRotationMatrix2D(Point2f(sz.width/2.f, sz.height/2.f), 10., 1.1);
+
+    WarpPlan plan;
+    plan.initAffine(warpMat, sz, interType);
+
+    if( usePlan )
+    {
+        TEST_CYCLE() plan.apply( src, dst );
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            for( int i = 0; i < batchSize; i++ )
+                warpAffine( src[i], dst[i], warpMat, sz, interType );
+        }
+    }
+
+    Mat dst0 = dst[0];
+    SANITY_CHECK(dst0, 1);
+}
+
 PERF_TEST_P( TestRemap, remap,
              Combine(
                  Values( TYPICAL_MAT_TYPES ),
@@ -168,6 +249,52 @@ PERF_TEST_P( TestRemap, remap,
     SANITY_CHECK(destination, 1);
 }
 
+CV_ENUM(RemapInterType, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4)
+CV_ENUM(RemapDepth, CV_8U, CV_16U, CV_16S, CV_32F)
+
+typedef TestBaseWithParam< tr1::tuple<RemapDepth, int, RemapInterType, bool> > TestRemapOptimized;
+
+PERF_TEST_P( TestRemapOptimized, remapOptimized,
+             Combine(
+                 ValuesIn( RemapDepth::all() ),
+                 Values( 1, 3, 4 ),
+                 ValuesIn( RemapInterType::all() ),
+                 Bool()
+                 )
+             )
+{
+    int type = CV_MAKETYPE(get<0>(GetParam()), get<1>(GetParam()));
+    int interpolationType = get<2>(GetParam());
+    bool optimized = get<3>(GetParam());
+    Size size = sz720p;
+    Mat source(size, type), destination(size, type);
+    Mat map_x(size, CV_32F), map_y(size, CV_32F), map1, map2;
+
+    declare.in(source, WARMUP_RNG).out(destination);
+
+    // a slight rotation, so that the samples are neither contiguous nor in the same rows
+    Mat M = getRotationMatrix2D(Point2f(size.width/2.f, size.height/2.f), 10., 1.1);
+    for( int j = 0; j < size.height; j++ )
+        for( int i = 0; i < size.width; i++ )
+        {
+            map_x.at<float>(j, i) = (float)(M.at<double>(0, 0)*i + M.at<double>(0, 1)*j + M.at<double>(0, 2));
+            map_y.at<float>(j, i) = (float)(M.at<double>(1, 0)*i + M.at<double>(1, 1)*j + M.at<double>(1, 2));
+        }
+    convertMaps(map_x, map_y, map1, map2, CV_16SC2);
+
+    bool prevOptimized = useOptimized();
+    setUseOptimized(optimized);
+
+    TEST_CYCLE()
+    {
+        remap(source, destination, map1, map2, interpolationType, BORDER_CONSTANT);
+    }
+
+    setUseOptimized(prevOptimized);
+
+    SANITY_CHECK(destination, 1);
+}
+
 void update_map(const Mat& src, Mat& map_x, Mat& map_y, const int remapMode )
 {
     for( int j = 0; j < src.rows; j++ )
@@ -41,157 +41,144 @@
 
 #include "precomp.hpp"
 
-void cv::Canny( InputArray _src, OutputArray _dst,
-                double low_thresh, double high_thresh,
-                int aperture_size, bool L2gradient )
-{
-    Mat src = _src.getMat();
-    CV_Assert( src.depth() == CV_8U );
 
-    _dst.create(src.size(), CV_8U);
-    Mat dst = _dst.getMat();
-
-    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
-    {
-        //backward compatibility
-        aperture_size &= ~CV_CANNY_L2_GRADIENT;
-        L2gradient = true;
-    }
-
-    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
-        CV_Error(CV_StsBadFlag, "");
-
-#ifdef HAVE_TEGRA_OPTIMIZATION
-    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
-        return;
-#endif
-
-    const int cn = src.channels();
-    cv::Mat dx(src.rows, src.cols, CV_16SC(cn));
-    cv::Mat dy(src.rows, src.cols, CV_16SC(cn));
+namespace cv
+{
 
-    cv::Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, cv::BORDER_REPLICATE);
-    cv::Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, cv::BORDER_REPLICATE);
+/* sector numbers
+   (Top-Left Origin)
 
-    if (low_thresh > high_thresh)
-        std::swap(low_thresh, high_thresh);
+    1   2   3
+     *  *  *
+      * * *
+    0*******0
+      * * *
+     *  *  *
+    3   2   1
+*/
 
-    if (L2gradient)
-    {
-        low_thresh = std::min(32767.0, low_thresh);
-        high_thresh = std::min(32767.0, high_thresh);
+// the edge map keeps one of the following values per pixel:
+//   0 - the pixel might belong to an edge
+//   1 - the pixel can not belong to an edge
+//   2 - the pixel does belong to an edge
+#define CANNY_PUSH(d)    *(d) = uchar(2), stack.push_back(d)
 
-        if (low_thresh > 0) low_thresh *= low_thresh;
-        if (high_thresh > 0) high_thresh *= high_thresh;
-    }
-    int low = cvFloor(low_thresh);
-    int high = cvFloor(high_thresh);
+#define CANNY_SHIFT 15
 
-    ptrdiff_t mapstep = src.cols + 2;
-    cv::AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2) + cn * mapstep * 3 * sizeof(int));
+// images with fewer pixels are processed as a single band;
+// the bands are at least CANNY_MIN_BAND_ROWS rows tall
+enum { CANNY_PARALLEL_MIN_SIZE = 1 << 16, CANNY_MIN_BAND_ROWS = 32 };
 
-    int* mag_buf[3];
-    mag_buf[0] = (int*)(uchar*)buffer;
-    mag_buf[1] = mag_buf[0] + mapstep*cn;
-    mag_buf[2] = mag_buf[1] + mapstep*cn;
-    memset(mag_buf[0], 0, /* cn* */mapstep*sizeof(int));
+#if CV_SSE2
+static inline __m128i cannyAbs32(__m128i v)
+{
+    __m128i s = _mm_srai_epi32(v, 31);
+    return _mm_sub_epi32(_mm_xor_si128(v, s), s);
+}
+#endif
 
-    uchar* map = (uchar*)(mag_buf[2] + mapstep*cn);
-    memset(map, 1, mapstep);
-    memset(map + mapstep*(src.rows + 1), 1, mapstep);
+// computes the gradient magnitude of a row. For multi-channel images the magnitude
+// of the channel with the largest one is kept, and its derivatives are stored to x and y
+static void cannyMagnitude(const short* _dx, const short* _dy, int* _norm, short* x, short* y,
+                           int cols, int cn, bool L2gradient, bool haveSSE2)
+{
+    int j = 0, len = cols*cn;
 
-    int maxsize = std::max(1 << 10, src.cols * src.rows / 10);
-    std::vector<uchar*> stack(maxsize);
-    uchar **stack_top = &stack[0];
-    uchar **stack_bottom = &stack[0];
-
-    /* sector numbers
-       (Top-Left Origin)
-
-        1   2   3
-         *  *  *
-          * * *
-        0*******0
-          * * *
-         *  *  *
-        3   2   1
-    */
-
-    #define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-    // calculate magnitude and angle of gradient, perform non-maxima supression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for (int i = 0; i <= src.rows; i++)
+#if CV_SSE2
+    if (haveSSE2)
     {
-        int* _norm = mag_buf[(i > 0) + 1] + 1;
-        if (i < src.rows)
+        if (!L2gradient)
         {
-            short* _dx = dx.ptr<short>(i);
-            short* _dy = dy.ptr<short>(i);
-
-            if (!L2gradient)
+            for ( ; j <= len - 8; j += 8)
             {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
+                __m128i v_dx = _mm_loadu_si128((const __m128i*)(_dx + j));
+                __m128i v_dy = _mm_loadu_si128((const __m128i*)(_dy + j));
+                __m128i dx0 = _mm_srai_epi32(_mm_unpacklo_epi16(v_dx, v_dx), 16);
+                __m128i dx1 = _mm_srai_epi32(_mm_unpackhi_epi16(v_dx, v_dx), 16);
+                __m128i dy0 = _mm_srai_epi32(_mm_unpacklo_epi16(v_dy, v_dy), 16);
+                __m128i dy1 = _mm_srai_epi32(_mm_unpackhi_epi16(v_dy, v_dy), 16);
+                _mm_storeu_si128((__m128i*)(_norm + j), _mm_add_epi32(cannyAbs32(dx0), cannyAbs32(dy0)));
+                _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_add_epi32(cannyAbs32(dx1), cannyAbs32(dy1)));
             }
-            else
-            {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
-            }
-
-            if (cn > 1)
+        }
+        else
+        {
+            for ( ; j <= len - 8; j += 8)
             {
-                for(int j = 0, jn = 0; j < src.cols; ++j, jn += cn)
-                {
-                    int maxIdx = jn;
-                    for(int k = 1; k < cn; ++k)
-                        if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
-                    _norm[j] = _norm[maxIdx];
-                    _dx[j] = _dx[maxIdx];
-                    _dy[j] = _dy[maxIdx];
-                }
+                __m128i v_dx = _mm_loadu_si128((const __m128i*)(_dx + j));
+                __m128i v_dy = _mm_loadu_si128((const __m128i*)(_dy + j));
+                __m128i v0 = _mm_unpacklo_epi16(v_dx, v_dy);
+                __m128i v1 = _mm_unpackhi_epi16(v_dx, v_dy);
+                _mm_storeu_si128((__m128i*)(_norm + j), _mm_madd_epi16(v0, v0));
+                _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_madd_epi16(v1, v1));
             }
-            _norm[-1] = _norm[src.cols] = 0;
         }
-        else
-            memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
+    }
+#endif
 
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if (i == 0)
-            continue;
+    if (!L2gradient)
+    {
+        for ( ; j < len; j++)
+            _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
+    }
+    else
+    {
+        for ( ; j < len; j++)
+            _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
+    }
 
-        uchar* _map = map + mapstep*i + 1;
-        _map[-1] = _map[src.cols] = 1;
+    if (cn > 1)
+    {
+        for (j = 0; j < cols; j++)
+        {
+            int jn = j*cn, maxIdx = jn;
+            for (int k = 1; k < cn; ++k)
+                if (_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
+            _norm[j] = _norm[maxIdx];
+            x[j] = _dx[maxIdx];
+            y[j] = _dy[maxIdx];
+        }
+    }
+    _norm[-1] = _norm[cols] = 0;
+}
 
-        int* _mag = mag_buf[1] + 1; // take the central row
-        ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
-        ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
+// performs the non-maxima suppression of a row and fills its part of the map.
+// _mag points to the central of the three magnitude rows, magstep1 and magstep2 are the offsets
+// to the next and the previous rows. The strong edge pixels are marked and pushed to the stack.
+static void cannyNonMaxima(const int* _mag, ptrdiff_t magstep1, ptrdiff_t magstep2,
+                           const short* _x, const short* _y, uchar* _map, ptrdiff_t mapstep,
+                           bool checkAbove, int cols, int low, int high,
+                           std::vector<uchar*>& stack, bool haveSSE2)
+{
+    const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
+    int prev_flag = 0;
 
-        const short* _x = dx.ptr<short>(i-1);
-        const short* _y = dy.ptr<short>(i-1);
+    for (int j0 = 0; j0 < cols; j0 += 8)
+    {
+        int j1 = std::min(j0 + 8, cols);
 
-        if ((stack_top - stack_bottom) + src.cols > maxsize)
+#if CV_SSE2
+        // most of the pixels are below the low threshold, skip them 8 at a time
+        if (haveSSE2 && j1 - j0 == 8)
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
+            __m128i v_low = _mm_set1_epi32(low);
+            __m128i m0 = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(_mag + j0)), v_low);
+            __m128i m1 = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(_mag + j0 + 4)), v_low);
+            if (_mm_movemask_epi8(_mm_or_si128(m0, m1)) == 0)
+            {
+                _mm_storel_epi64((__m128i*)(_map + j0), _mm_set1_epi8(1));
+                prev_flag = 0;
+                continue;
+            }
         }
+#else
+        (void)haveSSE2;
+#endif
 
-        int prev_flag = 0;
-        for (int j = 0; j < src.cols; j++)
+        for (int j = j0; j < j1; j++)
         {
-            #define CANNY_SHIFT 15
-            const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
-
             int m = _mag[j];
+            bool maximum = false;
 
             if (m > low)
             {
@@ -203,28 +190,26 @@ void cv::Canny( InputArray _src, OutputArray _dst,
                 int tg22x = x * TG22;
 
                 if (y < tg22x)
-                {
-                    if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
-                }
+                    maximum = m > _mag[j-1] && m >= _mag[j+1];
                 else
                 {
                     int tg67x = tg22x + (x << (CANNY_SHIFT+1));
                     if (y > tg67x)
-                    {
-                        if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
-                    }
+                        maximum = m > _mag[j+magstep2] && m >= _mag[j+magstep1];
                     else
                     {
                         int s = (xs ^ ys) < 0 ? -1 : 1;
-                        if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
+                        maximum = m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s];
                     }
                 }
             }
-            prev_flag = 0;
-            _map[j] = uchar(1);
-            continue;
-__ocv_canny_push:
-            if (!prev_flag && m > high && _map[j-mapstep] != 2)
+
+            if (!maximum)
+            {
+                prev_flag = 0;
+                _map[j] = uchar(1);
+            }
+            else if (!prev_flag && m > high && (!checkAbove || _map[j-mapstep] != 2))
             {
                 CANNY_PUSH(_map + j);
                 prev_flag = 1;
@@ -232,46 +217,252 @@ __ocv_canny_push:
             else
                 _map[j] = 0;
         }
+    }
+}
 
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
+// tracks the edges from the pixels in the stack (hysteresis thresholding).
+// Only the map rows that start in [lo, hi) are visited.
+static void cannyHysteresis(std::vector<uchar*>& stack, const uchar* lo, const uchar* hi,
+                            ptrdiff_t mapstep)
+{
+    while (!stack.empty())
+    {
+        uchar* m = stack.back();
+        stack.pop_back();
+
+        if (!m[-1])         CANNY_PUSH(m - 1);
+        if (!m[1])          CANNY_PUSH(m + 1);
+        if (m - mapstep >= lo)
+        {
+            if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
+            if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
+            if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
+        }
+        if (m + mapstep < hi)
+        {
+            if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
+            if (!m[mapstep])    CANNY_PUSH(m + mapstep);
+            if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+        }
     }
+}
 
-    // now track the edges (hysteresis thresholding)
-    while (stack_top > stack_bottom)
+// Computes the edge map of a band of rows: the magnitude, the non-maxima suppression
+// and the hysteresis inside the band. The edges that cross the band boundaries
+// are connected afterwards, see Canny().
+class CannyInvoker : public ParallelLoopBody
+{
+public:
+    CannyInvoker(const Mat& _dx, const Mat& _dy, uchar* _map, ptrdiff_t _mapstep,
+                 int _low, int _high, bool _L2gradient, int _nStripes) :
+        dx(_dx), dy(_dy), map(_map), mapstep(_mapstep), low(_low), high(_high),
+        L2gradient(_L2gradient), nStripes(_nStripes)
     {
-        uchar* m;
-        if ((stack_top - stack_bottom) + 8 > maxsize)
+    }
+
+    int bandStart(int k) const
+    {
+        return (int)((int64)k*dx.rows/nStripes);
+    }
+
+    void operator()(const Range& range) const
+    {
+        for (int k = range.start; k < range.end; k++)
+            processBand(bandStart(k), bandStart(k + 1));
+    }
+
+    void processBand(int r0, int r1) const
+    {
+        int rows = dx.rows, cols = dx.cols, cn = dx.channels();
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+
+        AutoBuffer<int> _magbuf(mapstep*cn*3);
+        AutoBuffer<short> _xybuf(cn > 1 ? cols*6 : 1);
+        int* mag_buf[3];
+        short *xbuf[3], *ybuf[3];
+        const short *xrow[3], *yrow[3];
+        for (int k = 0; k < 3; k++)
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
+            mag_buf[k] = (int*)_magbuf + mapstep*cn*k;
+            xbuf[k] = (short*)_xybuf + cols*k*2;
+            ybuf[k] = xbuf[k] + cols;
+            xrow[k] = yrow[k] = 0;
         }
 
-        CANNY_POP(m);
+        std::vector<uchar*> stack;
+        stack.reserve(std::max(1 << 10, cols*(r1 - r0)/10));
 
-        if (!m[-1])         CANNY_PUSH(m - 1);
-        if (!m[1])          CANNY_PUSH(m + 1);
-        if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
-        if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
-        if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
-        if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
-        if (!m[mapstep])    CANNY_PUSH(m + mapstep);
-        if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+        // the magnitude of the rows above and below the image is 0
+        for (int i = r0 - 1; i <= r1; i++)
+        {
+            int* _norm = mag_buf[2] + 1;
+            if (0 <= i && i < rows)
+            {
+                cannyMagnitude(dx.ptr<short>(i), dy.ptr<short>(i), _norm, xbuf[2], ybuf[2],
+                               cols, cn, L2gradient, haveSSE2);
+                xrow[2] = cn > 1 ? xbuf[2] : dx.ptr<short>(i);
+                yrow[2] = cn > 1 ? ybuf[2] : dy.ptr<short>(i);
+            }
+            else
+                memset(_norm-1, 0, mapstep*sizeof(int));
+
+            // the three magnitude rows around row i-1 are available
+            if (i > r0)
+            {
+                uchar* _map = map + mapstep*i + 1;
+                _map[-1] = _map[cols] = 1;
+
+                // the row above the band belongs to another thread; not looking at it
+                // may only leave more pixels for the hysteresis to mark
+                cannyNonMaxima(mag_buf[1] + 1, mag_buf[2] - mag_buf[1], mag_buf[0] - mag_buf[1],
+                               xrow[1], yrow[1], _map, mapstep, i - 1 > r0, cols, low, high,
+                               stack, haveSSE2);
+            }
+
+            // scroll the ring buffers
+            int* _mag = mag_buf[0];
+            mag_buf[0] = mag_buf[1]; mag_buf[1] = mag_buf[2]; mag_buf[2] = _mag;
+            short* t = xbuf[0];
+            xbuf[0] = xbuf[1]; xbuf[1] = xbuf[2]; xbuf[2] = t;
+            t = ybuf[0];
+            ybuf[0] = ybuf[1]; ybuf[1] = ybuf[2]; ybuf[2] = t;
+            const short* p = xrow[0];
+            xrow[0] = xrow[1]; xrow[1] = xrow[2]; xrow[2] = p;
+            p = yrow[0];
+            yrow[0] = yrow[1]; yrow[1] = yrow[2]; yrow[2] = p;
+        }
+
+        cannyHysteresis(stack, map + mapstep*(r0 + 1), map + mapstep*(r1 + 1), mapstep);
+    }
+
+private:
+    Mat dx, dy;
+    uchar* map;
+    ptrdiff_t mapstep;
+    int low, high;
+    bool L2gradient;
+    int nStripes;
+};
+
+class CannyFinalizeInvoker : public ParallelLoopBody
+{
+public:
+    CannyFinalizeInvoker(const uchar* _map, ptrdiff_t _mapstep, const Mat& _dst) :
+        map(_map), mapstep(_mapstep), dst(_dst)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        const uchar* pmap = map + mapstep*(range.start + 1) + 1;
+        for (int i = range.start; i < range.end; i++, pmap += mapstep)
+        {
+            uchar* pdst = dst.data + dst.step*i;
+            for (int j = 0; j < dst.cols; j++)
+                pdst[j] = (uchar)-(pmap[j] >> 1);
+        }
+    }
+
+private:
+    const uchar* map;
+    ptrdiff_t mapstep;
+    Mat dst;
+};
+
+}
+
+void cv::Canny( InputArray _src, OutputArray _dst,
+                double low_thresh, double high_thresh,
+                int aperture_size, bool L2gradient )
+{
+    Mat src = _src.getMat();
+    CV_Assert( src.depth() == CV_8U );
+
+    _dst.create(src.size(), CV_8U);
+    Mat dst = _dst.getMat();
+
+    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
+    {
+        //backward compatibility
+        aperture_size &= ~CV_CANNY_L2_GRADIENT;
+        L2gradient = true;
+    }
+
+    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
+        CV_Error(CV_StsBadFlag, "");
+
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
+        return;
+#endif
+
+    const int cn = src.channels();
+    cv::Mat dx(src.rows, src.cols, CV_16SC(cn));
+    cv::Mat dy(src.rows, src.cols, CV_16SC(cn));
+
+    cv::Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, cv::BORDER_REPLICATE);
+    cv::Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, cv::BORDER_REPLICATE);
+
+    if (low_thresh > high_thresh)
+        std::swap(low_thresh, high_thresh);
+
+    if (L2gradient)
+    {
+        low_thresh = std::min(32767.0, low_thresh);
+        high_thresh = std::min(32767.0, high_thresh);
+
+        if (low_thresh > 0) low_thresh *= low_thresh;
+        if (high_thresh > 0) high_thresh *= high_thresh;
     }
+    int low = cvFloor(low_thresh);
+    int high = cvFloor(high_thresh);
+
+    ptrdiff_t mapstep = src.cols + 2;
+    cv::AutoBuffer<uchar> buffer(mapstep*(src.rows + 2));
+    uchar* map = buffer;
+    memset(map, 1, mapstep);
+    memset(map + mapstep*(src.rows + 1), 1, mapstep);
+
+    int nStripes = 1;
+    if (src.total() >= (size_t)CANNY_PARALLEL_MIN_SIZE)
+        nStripes = std::max(std::min(getNumThreads(), src.rows/CANNY_MIN_BAND_ROWS), 1);
 
-    // the final pass, form the final image
-    const uchar* pmap = map + mapstep + 1;
-    uchar* pdst = dst.ptr();
-    for (int i = 0; i < src.rows; i++, pmap += mapstep, pdst += dst.step)
+    CannyInvoker invoker(dx, dy, map, mapstep, low, high, L2gradient, nStripes);
+    if (nStripes > 1)
+    {
+        parallel_for_(Range(0, nStripes), invoker);
+
+        // connect the edges across the band boundaries: the candidate pixels next to
+        // the edge pixels of the neighbouring band are tracked through the whole map
+        std::vector<uchar*> stack;
+        for (int k = 1; k < nStripes; k++)
+        {
+            uchar* m0 = map + mapstep*invoker.bandStart(k) + 1;
+            uchar* m1 = m0 + mapstep;
+            for (int j = 0; j < src.cols; j++)
+            {
+                if (m0[j] == 2)
+                {
+                    if (!m1[j-1]) CANNY_PUSH(m1 + j - 1);
+                    if (!m1[j])   CANNY_PUSH(m1 + j);
+                    if (!m1[j+1]) CANNY_PUSH(m1 + j + 1);
+                }
+                if (m1[j] == 2)
+                {
+                    if (!m0[j-1]) CANNY_PUSH(m0 + j - 1);
+                    if (!m0[j])   CANNY_PUSH(m0 + j);
+                    if (!m0[j+1]) CANNY_PUSH(m0 + j + 1);
+                }
+            }
+        }
+        cannyHysteresis(stack, map, map + mapstep*(src.rows + 2), mapstep);
+
+        parallel_for_(Range(0, src.rows), CannyFinalizeInvoker(map, mapstep, dst), nStripes);
+    }
+    else
     {
-        for (int j = 0; j < src.cols; j++)
-            pdst[j] = (uchar)-(pmap[j] >> 1);
+        invoker(Range(0, 1));
+        CannyFinalizeInvoker(map, mapstep, dst)(Range(0, src.rows));
     }
 }
 
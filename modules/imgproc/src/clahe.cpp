@@ -0,0 +1,353 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                          License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+namespace cv
+{
+
+// The interpolation pass of big images is split into horizontal bands processed in parallel.
+// The tile lookup tables are computed in parallel, one tile per task.
+enum { CLAHE_PARALLEL_MIN_SIZE = 1 << 16, CLAHE_MIN_BAND_ROWS = 16 };
+
+class CLAHE_CalcLut_Invoker : public ParallelLoopBody
+{
+public:
+    CLAHE_CalcLut_Invoker( const Mat& _src, Mat& _lut, Size _tileSize, int _tilesX,
+                           int _clipLimit, float _lutScale )
+        : src(_src), lut(_lut), tileSize(_tileSize), tilesX(_tilesX),
+          clipLimit(_clipLimit), lutScale(_lutScale) {}
+
+    void operator()( const Range& range ) const
+    {
+        const int histSize = 256;
+        int hist[histSize];
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int tx = k % tilesX, ty = k / tilesX;
+            Mat tile = src(Rect(tx*tileSize.width, ty*tileSize.height, tileSize.width, tileSize.height));
+            calcHist_8uC1(tile, hist);
+
+            if( clipLimit > 0 )
+            {
+                int i, clipped = 0;
+                for( i = 0; i < histSize; i++ )
+                    if( hist[i] > clipLimit )
+                    {
+                        clipped += hist[i] - clipLimit;
+                        hist[i] = clipLimit;
+                    }
+
+                // the clipped counts are spread evenly over the whole histogram
+                int redistBatch = clipped / histSize;
+                int residual = clipped - redistBatch*histSize;
+
+                for( i = 0; i < histSize; i++ )
+                    hist[i] += redistBatch;
+
+                if( residual > 0 )
+                {
+                    int residualStep = std::max(histSize / residual, 1);
+                    for( i = 0; i < histSize && residual > 0; i += residualStep, residual-- )
+                        hist[i]++;
+                }
+            }
+
+            uchar* tileLut = lut.ptr(k);
+            int sum = 0;
+            for( int i = 0; i < histSize; i++ )
+            {
+                sum += hist[i];
+                tileLut[i] = saturate_cast<uchar>(sum*lutScale);
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& lut;
+    Size tileSize;
+    int tilesX;
+    int clipLimit;
+    float lutScale;
+};
+
+#if CV_SSE2
+// interpolates 4 pixels between the mappings of the 4 tiles around them
+static inline __m128i claheInterpolate4_SSE2( const uchar* lutPlane1, const uchar* lutPlane2,
+                                              const uchar* src, const int* ind1, const int* ind2,
+                                              const float* xa1, const float* xa,
+                                              __m128 v_ya1, __m128 v_ya )
+{
+    int i10 = ind1[0] + src[0], i11 = ind1[1] + src[1], i12 = ind1[2] + src[2], i13 = ind1[3] + src[3];
+    int i20 = ind2[0] + src[0], i21 = ind2[1] + src[1], i22 = ind2[2] + src[2], i23 = ind2[3] + src[3];
+
+    __m128 v_xa1 = _mm_loadu_ps(xa1), v_xa = _mm_loadu_ps(xa);
+    __m128 r1 = _mm_add_ps(
+        _mm_mul_ps(_mm_setr_ps(lutPlane1[i10], lutPlane1[i11], lutPlane1[i12], lutPlane1[i13]), v_xa1),
+        _mm_mul_ps(_mm_setr_ps(lutPlane1[i20], lutPlane1[i21], lutPlane1[i22], lutPlane1[i23]), v_xa));
+    __m128 r2 = _mm_add_ps(
+        _mm_mul_ps(_mm_setr_ps(lutPlane2[i10], lutPlane2[i11], lutPlane2[i12], lutPlane2[i13]), v_xa1),
+        _mm_mul_ps(_mm_setr_ps(lutPlane2[i20], lutPlane2[i21], lutPlane2[i22], lutPlane2[i23]), v_xa));
+
+    return _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(r1, v_ya1), _mm_mul_ps(r2, v_ya)));
+}
+#endif
+
+class CLAHE_Interpolation_Invoker : public ParallelLoopBody
+{
+public:
+    CLAHE_Interpolation_Invoker( const Mat& _src, Mat& _dst, const Mat& _lut, Size _tileSize,
+                                 int _tilesX, int _tilesY, const Mat& _ind, const Mat& _xa )
+        : src(_src), dst(_dst), lut(_lut), tileSize(_tileSize), tilesX(_tilesX), tilesY(_tilesY),
+          ind(_ind), xa(_xa) {}
+
+    void operator()( const Range& range ) const
+    {
+        const float inv_th = 1.0f / tileSize.height;
+        const int* ind1 = ind.ptr<int>(0);
+        const int* ind2 = ind.ptr<int>(1);
+        const float* xa1_p = xa.ptr<float>(0);
+        const float* xa_p = xa.ptr<float>(1);
+        int cols = src.cols;
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const uchar* srcRow = src.ptr(y);
+            uchar* dstRow = dst.data + dst.step*y;
+
+            float tyf = y*inv_th - 0.5f;
+            int ty1 = cvFloor(tyf), ty2 = ty1 + 1;
+            float ya = tyf - ty1, ya1 = 1.f - ya;
+            ty1 = std::max(ty1, 0);
+            ty2 = std::min(ty2, tilesY - 1);
+
+            const uchar* lutPlane1 = lut.ptr(ty1*tilesX);
+            const uchar* lutPlane2 = lut.ptr(ty2*tilesX);
+            int x = 0;
+
+#if CV_SSE2
+            if( haveSSE2 )
+            {
+                __m128 v_ya = _mm_set1_ps(ya), v_ya1 = _mm_set1_ps(ya1);
+                for( ; x <= cols - 8; x += 8 )
+                {
+                    __m128i r0 = claheInterpolate4_SSE2(lutPlane1, lutPlane2, srcRow + x, ind1 + x, ind2 + x,
+                                                        xa1_p + x, xa_p + x, v_ya1, v_ya);
+                    __m128i r1 = claheInterpolate4_SSE2(lutPlane1, lutPlane2, srcRow + x + 4, ind1 + x + 4,
+                                                        ind2 + x + 4, xa1_p + x + 4, xa_p + x + 4, v_ya1, v_ya);
+                    __m128i r = _mm_packs_epi32(r0, r1);
+                    _mm_storel_epi64((__m128i*)(dstRow + x), _mm_packus_epi16(r, r));
+                }
+            }
+#endif
+            for( ; x < cols; x++ )
+            {
+                int srcVal = srcRow[x];
+                int i1 = ind1[x] + srcVal, i2 = ind2[x] + srcVal;
+
+                float res = (lutPlane1[i1]*xa1_p[x] + lutPlane1[i2]*xa_p[x])*ya1 +
+                            (lutPlane2[i1]*xa1_p[x] + lutPlane2[i2]*xa_p[x])*ya;
+                dstRow[x] = saturate_cast<uchar>(res);
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    const Mat& lut;
+    Size tileSize;
+    int tilesX;
+    int tilesY;
+    const Mat& ind;
+    const Mat& xa;
+};
+
+class CLAHE_Impl : public CLAHE
+{
+public:
+    CLAHE_Impl( double clipLimit = 40.0, int tilesX = 8, int tilesY = 8 );
+
+    AlgorithmInfo* info() const;
+
+    void apply( InputArray src, OutputArray dst );
+
+    void setClipLimit( double clipLimit );
+    double getClipLimit() const;
+
+    void setTilesGridSize( Size tileGridSize );
+    Size getTilesGridSize() const;
+
+    void collectGarbage();
+
+private:
+    double clipLimit_;
+    int tilesX_;
+    int tilesY_;
+
+    // kept between the calls, so that a sequence of frames of the same size does not reallocate them
+    Mat srcExt_;
+    Mat lut_;
+    Mat ind_;
+    Mat xa_;
+};
+
+CLAHE_Impl::CLAHE_Impl( double clipLimit, int tilesX, int tilesY )
+    : clipLimit_(clipLimit), tilesX_(tilesX), tilesY_(tilesY)
+{
+}
+
+CV_INIT_ALGORITHM(CLAHE_Impl, "CLAHE",
+                  obj.info()->addParam(obj, "clipLimit", obj.clipLimit_);
+                  obj.info()->addParam(obj, "tilesX", obj.tilesX_);
+                  obj.info()->addParam(obj, "tilesY", obj.tilesY_))
+
+void CLAHE_Impl::apply( InputArray _src, OutputArray _dst )
+{
+    Mat src = _src.getMat();
+
+    CV_Assert( src.type() == CV_8UC1 );
+    CV_Assert( tilesX_ > 0 && tilesY_ > 0 );
+
+    _dst.create( src.size(), src.type() );
+    Mat dst = _dst.getMat();
+
+    if( src.empty() )
+        return;
+
+    const int histSize = 256;
+
+    // the image is extended to a whole number of tiles
+    int padX = (tilesX_ - src.cols % tilesX_) % tilesX_;
+    int padY = (tilesY_ - src.rows % tilesY_) % tilesY_;
+    Mat srcForLut = src;
+    if( padX > 0 || padY > 0 )
+    {
+        copyMakeBorder(src, srcExt_, 0, padY, 0, padX, BORDER_REFLECT_101);
+        srcForLut = srcExt_;
+    }
+
+    Size tileSize(srcForLut.cols / tilesX_, srcForLut.rows / tilesY_);
+    int tileSizeTotal = tileSize.area();
+    float lutScale = (float)(histSize - 1) / tileSizeTotal;
+
+    int clipLimit = 0;
+    if( clipLimit_ > 0.0 )
+        clipLimit = std::max(cvRound(clipLimit_ * tileSizeTotal / histSize), 1);
+
+    lut_.create(tilesX_ * tilesY_, histSize, CV_8UC1);
+    parallel_for_(Range(0, tilesX_ * tilesY_),
+                  CLAHE_CalcLut_Invoker(srcForLut, lut_, tileSize, tilesX_, clipLimit, lutScale));
+
+    // the pair of tiles to interpolate between and their weights depend only on the column
+    ind_.create(2, src.cols, CV_32S);
+    xa_.create(2, src.cols, CV_32F);
+    int* ind1 = ind_.ptr<int>(0);
+    int* ind2 = ind_.ptr<int>(1);
+    float* xa1 = xa_.ptr<float>(0);
+    float* xa = xa_.ptr<float>(1);
+    float inv_tw = 1.0f / tileSize.width;
+
+    for( int x = 0; x < src.cols; x++ )
+    {
+        float txf = x*inv_tw - 0.5f;
+        int tx1 = cvFloor(txf), tx2 = tx1 + 1;
+
+        xa[x] = txf - tx1;
+        xa1[x] = 1.0f - xa[x];
+        ind1[x] = std::max(tx1, 0) * histSize;
+        ind2[x] = std::min(tx2, tilesX_ - 1) * histSize;
+    }
+
+    CLAHE_Interpolation_Invoker body(src, dst, lut_, tileSize, tilesX_, tilesY_, ind_, xa_);
+    int nStripes = 1;
+    if( src.total() >= (size_t)CLAHE_PARALLEL_MIN_SIZE )
+        nStripes = std::max(std::min(getNumThreads(), src.rows / CLAHE_MIN_BAND_ROWS), 1);
+
+    if( nStripes > 1 )
+        parallel_for_(Range(0, src.rows), body, nStripes);
+    else
+        body(Range(0, src.rows));
+}
+
+void CLAHE_Impl::setClipLimit( double clipLimit )
+{
+    clipLimit_ = clipLimit;
+}
+
+double CLAHE_Impl::getClipLimit() const
+{
+    return clipLimit_;
+}
+
+void CLAHE_Impl::setTilesGridSize( Size tileGridSize )
+{
+    CV_Assert( tileGridSize.width > 0 && tileGridSize.height > 0 );
+    tilesX_ = tileGridSize.width;
+    tilesY_ = tileGridSize.height;
+}
+
+Size CLAHE_Impl::getTilesGridSize() const
+{
+    return Size(tilesX_, tilesY_);
+}
+
+void CLAHE_Impl::collectGarbage()
+{
+    srcExt_.release();
+    lut_.release();
+    ind_.release();
+    xa_.release();
+}
+
+}
+
+cv::Ptr<cv::CLAHE> cv::createCLAHE( double clipLimit, cv::Size tileGridSize )
+{
+    CV_Assert( tileGridSize.width > 0 && tileGridSize.height > 0 );
+    return new CLAHE_Impl(clipLimit, tileGridSize.width, tileGridSize.height);
+}
@@ -90,6 +90,7 @@
 \**********************************************************************************/
 
 #include "precomp.hpp"
+#include "opencv2/core/sse_utils.hpp"
 #include <limits>
 
 namespace cv
@@ -152,6 +153,116 @@ template<> struct ColorChannel<float>
     static double half() { return 0.5; }
 };*/
 
+#if CV_SSE2
+
+// loads 32 pixels with scn (3 or 4) 8-bit channels and returns their first 3 channels as planes
+static inline void loadDeinterleave_8u(const uchar* src, int scn, __m128i& v_c0_0, __m128i& v_c0_1,
+                                       __m128i& v_c1_0, __m128i& v_c1_1, __m128i& v_c2_0, __m128i& v_c2_1)
+{
+    v_c0_0 = _mm_loadu_si128((const __m128i*)src);
+    v_c0_1 = _mm_loadu_si128((const __m128i*)(src + 16));
+    v_c1_0 = _mm_loadu_si128((const __m128i*)(src + 32));
+    v_c1_1 = _mm_loadu_si128((const __m128i*)(src + 48));
+    v_c2_0 = _mm_loadu_si128((const __m128i*)(src + 64));
+    v_c2_1 = _mm_loadu_si128((const __m128i*)(src + 80));
+
+    if( scn == 3 )
+        _mm_deinterleave_epi8(v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1);
+    else
+    {
+        __m128i v_c3_0 = _mm_loadu_si128((const __m128i*)(src + 96));
+        __m128i v_c3_1 = _mm_loadu_si128((const __m128i*)(src + 112));
+        _mm_deinterleave_epi8(v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1, v_c3_0, v_c3_1);
+    }
+}
+
+// stores 32 pixels given as channel planes; the 4th channel, if any, is set to 255
+static inline void storeInterleave_8u(uchar* dst, int dcn, __m128i v_c0_0, __m128i v_c0_1,
+                                      __m128i v_c1_0, __m128i v_c1_1, __m128i v_c2_0, __m128i v_c2_1)
+{
+    if( dcn == 3 )
+        _mm_interleave_epi8(v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1);
+    else
+    {
+        __m128i v_c3_0 = _mm_set1_epi8(-1), v_c3_1 = v_c3_0;
+        _mm_interleave_epi8(v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1, v_c3_0, v_c3_1);
+        _mm_storeu_si128((__m128i*)(dst + 96), v_c3_0);
+        _mm_storeu_si128((__m128i*)(dst + 112), v_c3_1);
+    }
+
+    _mm_storeu_si128((__m128i*)dst, v_c0_0);
+    _mm_storeu_si128((__m128i*)(dst + 16), v_c0_1);
+    _mm_storeu_si128((__m128i*)(dst + 32), v_c1_0);
+    _mm_storeu_si128((__m128i*)(dst + 48), v_c1_1);
+    _mm_storeu_si128((__m128i*)(dst + 64), v_c2_0);
+    _mm_storeu_si128((__m128i*)(dst + 80), v_c2_1);
+}
+
+// loads 8 pixels with scn (3 or 4) float channels and returns their first 3 channels as planes
+static inline void loadDeinterleave_32f(const float* src, int scn, __m128& v_c0_0, __m128& v_c0_1,
+                                        __m128& v_c1_0, __m128& v_c1_1, __m128& v_c2_0, __m128& v_c2_1)
+{
+    v_c0_0 = _mm_loadu_ps(src);
+    v_c0_1 = _mm_loadu_ps(src + 4);
+    v_c1_0 = _mm_loadu_ps(src + 8);
+    v_c1_1 = _mm_loadu_ps(src + 12);
+    v_c2_0 = _mm_loadu_ps(src + 16);
+    v_c2_1 = _mm_loadu_ps(src + 20);
+
+    if( scn == 3 )
+        _mm_deinterleave_ps(v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1);
+    else
+    {
+        __m128 v_c3_0 = _mm_loadu_ps(src + 24), v_c3_1 = _mm_loadu_ps(src + 28);
+        _mm_deinterleave_ps(v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1, v_c3_0, v_c3_1);
+    }
+}
+
+// stores 8 3-channel float pixels given as channel planes
+static inline void storeInterleave_32f(float* dst, __m128 v_c0_0, __m128 v_c0_1,
+                                       __m128 v_c1_0, __m128 v_c1_1, __m128 v_c2_0, __m128 v_c2_1)
+{
+    _mm_interleave_ps(v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1);
+
+    _mm_storeu_ps(dst, v_c0_0);
+    _mm_storeu_ps(dst + 4, v_c0_1);
+    _mm_storeu_ps(dst + 8, v_c1_0);
+    _mm_storeu_ps(dst + 12, v_c1_1);
+    _mm_storeu_ps(dst + 16, v_c2_0);
+    _mm_storeu_ps(dst + 20, v_c2_1);
+}
+
+#endif
+
+#if CV_AVX2_DISPATCH
+
+// the vectorized splineInterpolate(): 8 values of x and 4 gathers from the coefficient table
+static inline CV_AVX2_TARGET __m256 splineInterpolate_AVX2(__m256 x, const float* tab, int n)
+{
+    __m256i ix = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvttps_epi32(x), _mm256_setzero_si256()),
+                                  _mm256_set1_epi32(n-1));
+    x = _mm256_sub_ps(x, _mm256_cvtepi32_ps(ix));
+    ix = _mm256_slli_epi32(ix, 2);
+
+    __m256 t0 = _mm256_i32gather_ps(tab, ix, 4), t1 = _mm256_i32gather_ps(tab + 1, ix, 4);
+    __m256 t2 = _mm256_i32gather_ps(tab + 2, ix, 4), t3 = _mm256_i32gather_ps(tab + 3, ix, 4);
+    return _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_fmadd_ps(t3, x, t2), x, t1), x, t0);
+}
+
+// joins two halves of 8 float values
+static inline CV_AVX2_TARGET __m256 join_ps(__m128 lo, __m128 hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+// narrows 8 32-bit values to 16 bits with signed saturation
+static inline CV_AVX2_TARGET __m128i pack_epi32_AVX2(__m256i v)
+{
+    return _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+}
+
+#endif
+
 
 ///////////////////////////// Top-level template function ////////////////////////////////
 
@@ -398,6 +509,80 @@ struct RGB5x52Gray
 };
 
 
+// the SIMD parts of the converters below process the head of a row and return the number of pixels done;
+// the generic versions do nothing and the specializations cover the depths worth vectorizing
+template<typename _Tp> static inline int RGB2Gray_SIMD(const _Tp*, _Tp*, int, int, const float*)
+{
+    return 0;
+}
+
+#if CV_SSE2
+
+static int RGB2Gray_SIMD(const float* src, float* dst, int n, int scn, const float* coeffs)
+{
+    __m128 v_cb = _mm_set1_ps(coeffs[0]), v_cg = _mm_set1_ps(coeffs[1]), v_cr = _mm_set1_ps(coeffs[2]);
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8, src += scn*8 )
+    {
+        __m128 v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1;
+        loadDeinterleave_32f(src, scn, v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1);
+
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(v_c0_0, v_cb), _mm_mul_ps(v_c1_0, v_cg)),
+                                          _mm_mul_ps(v_c2_0, v_cr)));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_add_ps(_mm_mul_ps(v_c0_1, v_cb), _mm_mul_ps(v_c1_1, v_cg)),
+                                              _mm_mul_ps(v_c2_1, v_cr)));
+    }
+    return i;
+}
+
+// (a*c0 + b*c1 + c*c2 + d) >> yuv_shift for 8 pixels given as 16-bit values;
+// v_c01 holds the (c0, c1) pairs and v_c2d the (c2, d) pairs of 16-bit coefficients
+static inline __m128i dotProduct3_SSE2(__m128i a, __m128i b, __m128i c, __m128i v_c01, __m128i v_c2d)
+{
+    const __m128i v_one = _mm_set1_epi16(1);
+    __m128i v_lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), v_c01),
+                                 _mm_madd_epi16(_mm_unpacklo_epi16(c, v_one), v_c2d));
+    __m128i v_hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), v_c01),
+                                 _mm_madd_epi16(_mm_unpackhi_epi16(c, v_one), v_c2d));
+    return _mm_packs_epi32(_mm_srai_epi32(v_lo, yuv_shift), _mm_srai_epi32(v_hi, yuv_shift));
+}
+
+static inline __m128i setPair_epi16(int a, int b)
+{
+    return _mm_setr_epi16((short)a, (short)b, (short)a, (short)b, (short)a, (short)b, (short)a, (short)b);
+}
+
+// the coefficients must fit 16 bits
+static int RGB2Gray_8u_SSE2(const uchar* src, uchar* dst, int n, int scn, const int* coeffs)
+{
+    const __m128i v_zero = _mm_setzero_si128();
+    __m128i v_c01 = setPair_epi16(coeffs[0], coeffs[1]);
+    __m128i v_c2d = setPair_epi16(coeffs[2], 1 << (yuv_shift-1));
+    int i = 0;
+
+    for( ; i <= n - 32; i += 32, src += scn*32 )
+    {
+        __m128i v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1;
+        loadDeinterleave_8u(src, scn, v_c0_0, v_c0_1, v_c1_0, v_c1_1, v_c2_0, v_c2_1);
+
+        __m128i v_y0 = dotProduct3_SSE2(_mm_unpacklo_epi8(v_c0_0, v_zero), _mm_unpacklo_epi8(v_c1_0, v_zero),
+                                        _mm_unpacklo_epi8(v_c2_0, v_zero), v_c01, v_c2d);
+        __m128i v_y1 = dotProduct3_SSE2(_mm_unpackhi_epi8(v_c0_0, v_zero), _mm_unpackhi_epi8(v_c1_0, v_zero),
+                                        _mm_unpackhi_epi8(v_c2_0, v_zero), v_c01, v_c2d);
+        __m128i v_y2 = dotProduct3_SSE2(_mm_unpacklo_epi8(v_c0_1, v_zero), _mm_unpacklo_epi8(v_c1_1, v_zero),
+                                        _mm_unpacklo_epi8(v_c2_1, v_zero), v_c01, v_c2d);
+        __m128i v_y3 = dotProduct3_SSE2(_mm_unpackhi_epi8(v_c0_1, v_zero), _mm_unpackhi_epi8(v_c1_1, v_zero),
+                                        _mm_unpackhi_epi8(v_c2_1, v_zero), v_c01, v_c2d);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(v_y0, v_y1));
+        _mm_storeu_si128((__m128i*)(dst + i + 16), _mm_packus_epi16(v_y2, v_y3));
+    }
+    return i;
+}
+
+#endif
+
 template<typename _Tp> struct RGB2Gray
 {
     typedef _Tp channel_type;
@@ -408,17 +593,30 @@ template<typename _Tp> struct RGB2Gray
         memcpy( coeffs, _coeffs ? _coeffs : coeffs0, 3*sizeof(coeffs[0]) );
         if(blueIdx == 0)
             std::swap(coeffs[0], coeffs[2]);
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
     }
 
     void operator()(const _Tp* src, _Tp* dst, int n) const
     {
-        int scn = srccn;
+        int i = 0, scn = srccn;
         float cb = coeffs[0], cg = coeffs[1], cr = coeffs[2];
-        for(int i = 0; i < n; i++, src += scn)
+#if CV_SSE2
+        if( haveSIMD )
+        {
+            i = RGB2Gray_SIMD(src, dst, n, scn, coeffs);
+            src += i*scn;
+        }
+#endif
+        for( ; i < n; i++, src += scn)
             dst[i] = saturate_cast<_Tp>(src[0]*cb + src[1]*cg + src[2]*cr);
     }
     int srccn;
     float coeffs[3];
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -440,16 +638,32 @@ template<> struct RGB2Gray<uchar>
             tab[i+256] = g;
             tab[i+512] = r;
         }
+#if CV_SSE2
+        sseCoeffs[0] = db; sseCoeffs[1] = dg; sseCoeffs[2] = dr;
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2) &&
+            (short)db == db && (short)dg == dg && (short)dr == dr;
+#endif
     }
     void operator()(const uchar* src, uchar* dst, int n) const
     {
-        int scn = srccn;
+        int i = 0, scn = srccn;
         const int* _tab = tab;
-        for(int i = 0; i < n; i++, src += scn)
+#if CV_SSE2
+        if( haveSIMD )
+        {
+            i = RGB2Gray_8u_SSE2(src, dst, n, scn, sseCoeffs);
+            src += i*scn;
+        }
+#endif
+        for( ; i < n; i++, src += scn)
             dst[i] = (uchar)((_tab[src[0]] + _tab[src[1]+256] + _tab[src[2]+512]) >> yuv_shift);
     }
     int srccn;
     int tab[256*3];
+#if CV_SSE2
+    int sseCoeffs[3];
+    bool haveSIMD;
+#endif
 };
 
 
@@ -478,6 +692,91 @@ template<> struct RGB2Gray<ushort>
 
 ///////////////////////////////////// RGB <-> YCrCb //////////////////////////////////////
 
+template<typename _Tp> static inline int RGB2YCrCb_f_SIMD(const _Tp*, _Tp*, int, int, int, const float*)
+{
+    return 0;
+}
+
+template<typename _Tp> static inline int RGB2YCrCb_i_SIMD(const _Tp*, _Tp*, int, int, int, const int*)
+{
+    return 0;
+}
+
+#if CV_SSE2
+
+static int RGB2YCrCb_f_SIMD(const float* src, float* dst, int n, int scn, int bidx, const float* coeffs)
+{
+    __m128 v_c0 = _mm_set1_ps(coeffs[0]), v_c1 = _mm_set1_ps(coeffs[1]), v_c2 = _mm_set1_ps(coeffs[2]);
+    __m128 v_c3 = _mm_set1_ps(coeffs[3]), v_c4 = _mm_set1_ps(coeffs[4]);
+    __m128 v_delta = _mm_set1_ps(ColorChannel<float>::half());
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8, src += scn*8 )
+    {
+        __m128 v_s[6];
+        loadDeinterleave_32f(src, scn, v_s[0], v_s[1], v_s[2], v_s[3], v_s[4], v_s[5]);
+
+        __m128 v_y[2], v_cr[2], v_cb[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            v_y[k] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v_s[k], v_c0), _mm_mul_ps(v_s[k+2], v_c1)),
+                                _mm_mul_ps(v_s[k+4], v_c2));
+            v_cr[k] = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(v_s[(bidx^2)*2+k], v_y[k]), v_c3), v_delta);
+            v_cb[k] = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(v_s[bidx*2+k], v_y[k]), v_c4), v_delta);
+        }
+        storeInterleave_32f(dst + i*3, v_y[0], v_y[1], v_cr[0], v_cr[1], v_cb[0], v_cb[1]);
+    }
+    return i;
+}
+
+// (d*c + delta) >> yuv_shift for 8 16-bit differences d; v_c holds c in the low 16 bits of each 32-bit lane
+static inline __m128i scaleDiff_SSE2(__m128i d, __m128i v_c, __m128i v_delta)
+{
+    const __m128i v_zero = _mm_setzero_si128();
+    __m128i v_lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(d, v_zero), v_c), v_delta);
+    __m128i v_hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(d, v_zero), v_c), v_delta);
+    return _mm_packs_epi32(_mm_srai_epi32(v_lo, yuv_shift), _mm_srai_epi32(v_hi, yuv_shift));
+}
+
+// the coefficients must fit 16 bits
+static int RGB2YCrCb_i_SIMD(const uchar* src, uchar* dst, int n, int scn, int bidx, const int* coeffs)
+{
+    const __m128i v_zero = _mm_setzero_si128();
+    __m128i v_c01 = setPair_epi16(coeffs[0], coeffs[1]);
+    __m128i v_c2d = setPair_epi16(coeffs[2], 1 << (yuv_shift-1));
+    __m128i v_c3 = setPair_epi16(coeffs[3], 0), v_c4 = setPair_epi16(coeffs[4], 0);
+    __m128i v_delta = _mm_set1_epi32(ColorChannel<uchar>::half()*(1 << yuv_shift) + (1 << (yuv_shift-1)));
+    int i = 0;
+
+    for( ; i <= n - 32; i += 32, src += scn*32 )
+    {
+        __m128i v_s[6];
+        loadDeinterleave_8u(src, scn, v_s[0], v_s[1], v_s[2], v_s[3], v_s[4], v_s[5]);
+
+        // 4 groups of 8 pixels, as 16-bit values
+        __m128i v_y[4], v_cr[4], v_cb[4];
+        for( int k = 0; k < 4; k++ )
+        {
+            __m128i v_c[3];
+            for( int c = 0; c < 3; c++ )
+                v_c[c] = k % 2 == 0 ? _mm_unpacklo_epi8(v_s[c*2 + k/2], v_zero) :
+                                      _mm_unpackhi_epi8(v_s[c*2 + k/2], v_zero);
+
+            v_y[k] = dotProduct3_SSE2(v_c[0], v_c[1], v_c[2], v_c01, v_c2d);
+            v_cr[k] = scaleDiff_SSE2(_mm_sub_epi16(v_c[bidx^2], v_y[k]), v_c3, v_delta);
+            v_cb[k] = scaleDiff_SSE2(_mm_sub_epi16(v_c[bidx], v_y[k]), v_c4, v_delta);
+        }
+
+        storeInterleave_8u(dst + i*3, 3,
+                           _mm_packus_epi16(v_y[0], v_y[1]), _mm_packus_epi16(v_y[2], v_y[3]),
+                           _mm_packus_epi16(v_cr[0], v_cr[1]), _mm_packus_epi16(v_cr[2], v_cr[3]),
+                           _mm_packus_epi16(v_cb[0], v_cb[1]), _mm_packus_epi16(v_cb[2], v_cb[3]));
+    }
+    return i;
+}
+
+#endif
+
 template<typename _Tp> struct RGB2YCrCb_f
 {
     typedef _Tp channel_type;
@@ -487,15 +786,24 @@ template<typename _Tp> struct RGB2YCrCb_f
         static const float coeffs0[] = {0.299f, 0.587f, 0.114f, 0.713f, 0.564f};
         memcpy(coeffs, _coeffs ? _coeffs : coeffs0, 5*sizeof(coeffs[0]));
         if(blueIdx==0) std::swap(coeffs[0], coeffs[2]);
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
     }
 
     void operator()(const _Tp* src, _Tp* dst, int n) const
     {
-        int scn = srccn, bidx = blueIdx;
+        int i = 0, scn = srccn, bidx = blueIdx;
         const _Tp delta = ColorChannel<_Tp>::half();
         float C0 = coeffs[0], C1 = coeffs[1], C2 = coeffs[2], C3 = coeffs[3], C4 = coeffs[4];
-        n *= 3;
-        for(int i = 0; i < n; i += 3, src += scn)
+#if CV_SSE2
+        if( haveSIMD )
+        {
+            i = RGB2YCrCb_f_SIMD(src, dst, n, scn, bidx, coeffs);
+            src += i*scn;
+        }
+#endif
+        for( i *= 3, n *= 3; i < n; i += 3, src += scn )
         {
             _Tp Y = saturate_cast<_Tp>(src[0]*C0 + src[1]*C1 + src[2]*C2);
             _Tp Cr = saturate_cast<_Tp>((src[bidx^2] - Y)*C3 + delta);
@@ -505,6 +813,9 @@ template<typename _Tp> struct RGB2YCrCb_f
     }
     int srccn, blueIdx;
     float coeffs[5];
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -518,14 +829,25 @@ template<typename _Tp> struct RGB2YCrCb_i
         static const int coeffs0[] = {R2Y, G2Y, B2Y, 11682, 9241};
         memcpy(coeffs, _coeffs ? _coeffs : coeffs0, 5*sizeof(coeffs[0]));
         if(blueIdx==0) std::swap(coeffs[0], coeffs[2]);
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+        for( int k = 0; k < 5; k++ )
+            haveSIMD = haveSIMD && (short)coeffs[k] == coeffs[k];
+#endif
     }
     void operator()(const _Tp* src, _Tp* dst, int n) const
     {
-        int scn = srccn, bidx = blueIdx;
+        int i = 0, scn = srccn, bidx = blueIdx;
         int C0 = coeffs[0], C1 = coeffs[1], C2 = coeffs[2], C3 = coeffs[3], C4 = coeffs[4];
         int delta = ColorChannel<_Tp>::half()*(1 << yuv_shift);
-        n *= 3;
-        for(int i = 0; i < n; i += 3, src += scn)
+#if CV_SSE2
+        if( haveSIMD )
+        {
+            i = RGB2YCrCb_i_SIMD(src, dst, n, scn, bidx, coeffs);
+            src += i*scn;
+        }
+#endif
+        for( i *= 3, n *= 3; i < n; i += 3, src += scn )
         {
             int Y = CV_DESCALE(src[0]*C0 + src[1]*C1 + src[2]*C2, yuv_shift);
             int Cr = CV_DESCALE((src[bidx^2] - Y)*C3 + delta, yuv_shift);
@@ -537,6 +859,9 @@ template<typename _Tp> struct RGB2YCrCb_i
     }
     int srccn, blueIdx;
     int coeffs[5];
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -797,6 +1122,74 @@ template<typename _Tp> struct XYZ2RGB_i
 ////////////////////////////////////// RGB <-> HSV ///////////////////////////////////////
 
 
+#if CV_AVX2_DISPATCH
+
+// 8 pixels of RGB2HSV_b, given as 32-bit values; the results are returned as 16-bit values
+static inline CV_AVX2_TARGET void RGB2HSV_8u_AVX2(__m256i b, __m256i g, __m256i r, int hr,
+                                                  const int* sdiv_table, const int* hdiv_table,
+                                                  __m128i& h, __m128i& s, __m128i& v)
+{
+    const int hsv_shift = 12;
+    const __m256i v_half = _mm256_set1_epi32(1 << (hsv_shift-1));
+    __m256i v_max = _mm256_max_epi32(_mm256_max_epi32(b, g), r);
+    __m256i v_min = _mm256_min_epi32(_mm256_min_epi32(b, g), r);
+    __m256i v_diff = _mm256_sub_epi32(v_max, v_min);
+    __m256i v_vr = _mm256_cmpeq_epi32(v_max, r), v_vg = _mm256_cmpeq_epi32(v_max, g);
+
+    __m256i v_s = _mm256_mullo_epi32(v_diff, _mm256_i32gather_epi32(sdiv_table, v_max, 4));
+    v_s = _mm256_srai_epi32(_mm256_add_epi32(v_s, v_half), hsv_shift);
+
+    __m256i v_diff2 = _mm256_add_epi32(v_diff, v_diff);
+    __m256i v_hg = _mm256_and_si256(v_vg, _mm256_add_epi32(_mm256_sub_epi32(b, r), v_diff2));
+    __m256i v_hb = _mm256_andnot_si256(v_vg, _mm256_add_epi32(_mm256_sub_epi32(r, g),
+                                                               _mm256_add_epi32(v_diff2, v_diff2)));
+    __m256i v_h = _mm256_add_epi32(_mm256_and_si256(v_vr, _mm256_sub_epi32(g, b)),
+                                   _mm256_andnot_si256(v_vr, _mm256_add_epi32(v_hg, v_hb)));
+    v_h = _mm256_mullo_epi32(v_h, _mm256_i32gather_epi32(hdiv_table, v_diff, 4));
+    v_h = _mm256_srai_epi32(_mm256_add_epi32(v_h, v_half), hsv_shift);
+    v_h = _mm256_add_epi32(v_h, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), v_h),
+                                                 _mm256_set1_epi32(hr)));
+
+    h = pack_epi32_AVX2(v_h);
+    s = pack_epi32_AVX2(v_s);
+    v = pack_epi32_AVX2(v_max);
+}
+
+static CV_AVX2_TARGET int RGB2HSV_8u_AVX2(const uchar* src, uchar* dst, int n, int scn, int bidx, int hr,
+                                          const int* sdiv_table, const int* hdiv_table)
+{
+    int i = 0;
+
+    for( ; i <= n - 32; i += 32, src += scn*32 )
+    {
+        __m128i v_s[6];
+        loadDeinterleave_8u(src, scn, v_s[0], v_s[1], v_s[2], v_s[3], v_s[4], v_s[5]);
+
+        __m128i v_h[4], v_sat[4], v_v[4];
+        for( int k = 0; k < 4; k++ )
+        {
+            // the k-th group of 8 pixels
+            __m128i v_b = v_s[bidx*2 + k/2], v_g = v_s[2 + k/2], v_r = v_s[(bidx^2)*2 + k/2];
+            if( k % 2 )
+            {
+                v_b = _mm_unpackhi_epi64(v_b, v_b);
+                v_g = _mm_unpackhi_epi64(v_g, v_g);
+                v_r = _mm_unpackhi_epi64(v_r, v_r);
+            }
+            RGB2HSV_8u_AVX2(_mm256_cvtepu8_epi32(v_b), _mm256_cvtepu8_epi32(v_g), _mm256_cvtepu8_epi32(v_r),
+                            hr, sdiv_table, hdiv_table, v_h[k], v_sat[k], v_v[k]);
+        }
+
+        storeInterleave_8u(dst + i*3, 3,
+                           _mm_packus_epi16(v_h[0], v_h[1]), _mm_packus_epi16(v_h[2], v_h[3]),
+                           _mm_packus_epi16(v_sat[0], v_sat[1]), _mm_packus_epi16(v_sat[2], v_sat[3]),
+                           _mm_packus_epi16(v_v[0], v_v[1]), _mm_packus_epi16(v_v[2], v_v[3]));
+    }
+    return i;
+}
+
+#endif
+
 struct RGB2HSV_b
 {
     typedef uchar channel_type;
@@ -805,6 +1198,9 @@ struct RGB2HSV_b
     : srccn(_srccn), blueIdx(_blueIdx), hrange(_hrange)
     {
         CV_Assert( hrange == 180 || hrange == 256 );
+#if CV_AVX2_DISPATCH
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3);
+#endif
     }
 
     void operator()(const uchar* src, uchar* dst, int n) const
@@ -833,7 +1229,15 @@ struct RGB2HSV_b
             initialized = true;
         }
 
-        for( i = 0; i < n; i += 3, src += scn )
+        i = 0;
+#if CV_AVX2_DISPATCH
+        if( haveAVX2 )
+        {
+            i = RGB2HSV_8u_AVX2(src, dst, n/3, scn, bidx, hr, sdiv_table, hdiv_table)*3;
+            src += i/3*scn;
+        }
+#endif
+        for( ; i < n; i += 3, src += scn )
         {
             int b = src[bidx], g = src[1], r = src[bidx^2];
             int h, s, v = b;
@@ -862,6 +1266,9 @@ struct RGB2HSV_b
     }
 
     int srccn, blueIdx, hrange;
+#if CV_AVX2_DISPATCH
+    bool haveAVX2;
+#endif
 };
 
 
@@ -1230,13 +1637,14 @@ static const float LabCbrtTabScale = LAB_CBRT_TAB_SIZE/1.5f;
 static float sRGBGammaTab[GAMMA_TAB_SIZE*4], sRGBInvGammaTab[GAMMA_TAB_SIZE*4];
 static const float GammaTabScale = (float)GAMMA_TAB_SIZE;
 
-static ushort sRGBGammaTab_b[256], linearGammaTab_b[256];
+// the 8-bit tables have an extra element, so that their last entries can be read with 32-bit gathers
+static ushort sRGBGammaTab_b[256+1], linearGammaTab_b[256+1];
 #undef lab_shift
 #define lab_shift xyz_shift
 #define gamma_shift 3
 #define lab_shift2 (lab_shift + gamma_shift)
 #define LAB_CBRT_TAB_SIZE_B (256*3/2*(1<<gamma_shift))
-static ushort LabCbrtTab_b[LAB_CBRT_TAB_SIZE_B];
+static ushort LabCbrtTab_b[LAB_CBRT_TAB_SIZE_B+1];
 
 static void initLabTabs()
 {
@@ -1278,6 +1686,138 @@ static void initLabTabs()
     }
 }
 
+#if CV_AVX2_DISPATCH
+
+// reads 8 entries of a 16-bit table, which must have one element more than the largest index
+static inline CV_AVX2_TARGET __m256i gather_epu16(const ushort* tab, __m256i idx)
+{
+    return _mm256_and_si256(_mm256_i32gather_epi32((const int*)tab, idx, 2), _mm256_set1_epi32(0xffff));
+}
+
+static inline CV_AVX2_TARGET __m256i descale_epi32(__m256i x, int n)
+{
+    return _mm256_srai_epi32(_mm256_add_epi32(x, _mm256_set1_epi32(1 << (n-1))), n);
+}
+
+static CV_AVX2_TARGET int RGB2Lab_8u_AVX2(const uchar* src, uchar* dst, int n, int scn,
+                                          const ushort* tab, const int* coeffs)
+{
+    const int Lscale = (116*255+50)/100;
+    const int Lshift = -((16*255*(1 << lab_shift2) + 50)/100);
+    __m256i v_c[9];
+    for( int k = 0; k < 9; k++ )
+        v_c[k] = _mm256_set1_epi32(coeffs[k]);
+    __m256i v_Lscale = _mm256_set1_epi32(Lscale), v_Lshift = _mm256_set1_epi32(Lshift);
+    __m256i v_500 = _mm256_set1_epi32(500), v_200 = _mm256_set1_epi32(200);
+    __m256i v_128 = _mm256_set1_epi32(128*(1 << lab_shift2));
+    int i = 0;
+
+    for( ; i <= n - 32; i += 32, src += scn*32 )
+    {
+        __m128i v_s[6];
+        loadDeinterleave_8u(src, scn, v_s[0], v_s[1], v_s[2], v_s[3], v_s[4], v_s[5]);
+
+        __m128i v_L[4], v_a[4], v_b[4];
+        for( int k = 0; k < 4; k++ )
+        {
+            // the k-th group of 8 pixels
+            __m256i v_rgb[3];
+            for( int c = 0; c < 3; c++ )
+            {
+                __m128i v = v_s[c*2 + k/2];
+                if( k % 2 )
+                    v = _mm_unpackhi_epi64(v, v);
+                v_rgb[c] = gather_epu16(tab, _mm256_cvtepu8_epi32(v));
+            }
+
+            __m256i v_f[3];
+            for( int c = 0; c < 3; c++ )
+            {
+                __m256i v_xyz = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(v_rgb[0], v_c[c*3]),
+                                                                  _mm256_mullo_epi32(v_rgb[1], v_c[c*3+1])),
+                                                 _mm256_mullo_epi32(v_rgb[2], v_c[c*3+2]));
+                v_f[c] = gather_epu16(LabCbrtTab_b, descale_epi32(v_xyz, lab_shift));
+            }
+
+            __m256i v_Lk = descale_epi32(_mm256_add_epi32(_mm256_mullo_epi32(v_f[1], v_Lscale), v_Lshift), lab_shift2);
+            __m256i v_ak = descale_epi32(_mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(v_f[0], v_f[1]), v_500),
+                                                          v_128), lab_shift2);
+            __m256i v_bk = descale_epi32(_mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(v_f[1], v_f[2]), v_200),
+                                                          v_128), lab_shift2);
+            v_L[k] = pack_epi32_AVX2(v_Lk);
+            v_a[k] = pack_epi32_AVX2(v_ak);
+            v_b[k] = pack_epi32_AVX2(v_bk);
+        }
+
+        storeInterleave_8u(dst + i*3, 3,
+                           _mm_packus_epi16(v_L[0], v_L[1]), _mm_packus_epi16(v_L[2], v_L[3]),
+                           _mm_packus_epi16(v_a[0], v_a[1]), _mm_packus_epi16(v_a[2], v_a[3]),
+                           _mm_packus_epi16(v_b[0], v_b[1]), _mm_packus_epi16(v_b[2], v_b[3]));
+    }
+    return i;
+}
+
+// cube root of 8 positive values: a bit-level initial guess refined by Newton iterations
+static inline CV_AVX2_TARGET __m256 cbrt_AVX2(__m256 x)
+{
+    const __m256 v_1_3 = _mm256_set1_ps(1.f/3.f), v_2 = _mm256_set1_ps(2.f);
+    __m256i ix = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_castps_si256(x)), v_1_3));
+    __m256 y = _mm256_castsi256_ps(_mm256_add_epi32(ix, _mm256_set1_epi32(709958130)));
+
+    for( int k = 0; k < 3; k++ )
+        y = _mm256_mul_ps(_mm256_fmadd_ps(y, v_2, _mm256_div_ps(x, _mm256_mul_ps(y, y))), v_1_3);
+    return y;
+}
+
+static CV_AVX2_TARGET int RGB2Lab_32f_AVX2(const float* src, float* dst, int n, int scn,
+                                           const float* gammaTab, const float* coeffs)
+{
+    const __m256 v_zero = _mm256_setzero_ps(), v_one = _mm256_set1_ps(1.f);
+    const __m256 v_gscale = _mm256_set1_ps(GammaTabScale), v_thresh = _mm256_set1_ps(0.008856f);
+    const __m256 v_7_787 = _mm256_set1_ps(7.787f), v_a = _mm256_set1_ps(16.0f / 116.0f);
+    __m256 v_c[9];
+    for( int k = 0; k < 9; k++ )
+        v_c[k] = _mm256_set1_ps(coeffs[k]);
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8, src += scn*8 )
+    {
+        __m128 v_s[6];
+        loadDeinterleave_32f(src, scn, v_s[0], v_s[1], v_s[2], v_s[3], v_s[4], v_s[5]);
+
+        __m256 v_rgb[3];
+        for( int c = 0; c < 3; c++ )
+        {
+            v_rgb[c] = _mm256_min_ps(_mm256_max_ps(join_ps(v_s[c*2], v_s[c*2+1]), v_zero), v_one);
+            if( gammaTab )
+                v_rgb[c] = splineInterpolate_AVX2(_mm256_mul_ps(v_rgb[c], v_gscale), gammaTab, GAMMA_TAB_SIZE);
+        }
+
+        __m256 v_xyz[3], v_f[3];
+        for( int c = 0; c < 3; c++ )
+        {
+            v_xyz[c] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v_rgb[0], v_c[c*3]),
+                                                   _mm256_mul_ps(v_rgb[1], v_c[c*3+1])),
+                                     _mm256_mul_ps(v_rgb[2], v_c[c*3+2]));
+            v_f[c] = _mm256_blendv_ps(_mm256_add_ps(_mm256_mul_ps(v_xyz[c], v_7_787), v_a), cbrt_AVX2(v_xyz[c]),
+                                      _mm256_cmp_ps(v_xyz[c], v_thresh, _CMP_GT_OQ));
+        }
+
+        __m256 v_L = _mm256_blendv_ps(_mm256_mul_ps(v_xyz[1], _mm256_set1_ps(903.3f)),
+                                      _mm256_sub_ps(_mm256_mul_ps(v_f[1], _mm256_set1_ps(116.f)), _mm256_set1_ps(16.f)),
+                                      _mm256_cmp_ps(v_xyz[1], v_thresh, _CMP_GT_OQ));
+        __m256 v_La = _mm256_mul_ps(_mm256_sub_ps(v_f[0], v_f[1]), _mm256_set1_ps(500.f));
+        __m256 v_Lb = _mm256_mul_ps(_mm256_sub_ps(v_f[1], v_f[2]), _mm256_set1_ps(200.f));
+
+        storeInterleave_32f(dst + i*3, _mm256_castps256_ps128(v_L), _mm256_extractf128_ps(v_L, 1),
+                            _mm256_castps256_ps128(v_La), _mm256_extractf128_ps(v_La, 1),
+                            _mm256_castps256_ps128(v_Lb), _mm256_extractf128_ps(v_Lb, 1));
+    }
+    return i;
+}
+
+#endif
+
 struct RGB2Lab_b
 {
     typedef uchar channel_type;
@@ -1307,6 +1847,9 @@ struct RGB2Lab_b
             CV_Assert( coeffs[i] >= 0 && coeffs[i*3+1] >= 0 && coeffs[i*3+2] >= 0 &&
                       coeffs[i*3] + coeffs[i*3+1] + coeffs[i*3+2] < 2*(1 << lab_shift) );
         }
+#if CV_AVX2_DISPATCH
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3);
+#endif
     }
 
     void operator()(const uchar* src, uchar* dst, int n) const
@@ -1320,7 +1863,15 @@ struct RGB2Lab_b
             C6 = coeffs[6], C7 = coeffs[7], C8 = coeffs[8];
         n *= 3;
 
-        for( i = 0; i < n; i += 3, src += scn )
+        i = 0;
+#if CV_AVX2_DISPATCH
+        if( haveAVX2 )
+        {
+            i = RGB2Lab_8u_AVX2(src, dst, n/3, scn, tab, coeffs)*3;
+            src += i/3*scn;
+        }
+#endif
+        for( ; i < n; i += 3, src += scn )
         {
             int R = tab[src[0]], G = tab[src[1]], B = tab[src[2]];
             int fX = LabCbrtTab_b[CV_DESCALE(R*C0 + G*C1 + B*C2, lab_shift)];
@@ -1340,6 +1891,9 @@ struct RGB2Lab_b
     int srccn;
     int coeffs[9];
     bool srgb;
+#if CV_AVX2_DISPATCH
+    bool haveAVX2;
+#endif
 };
 
 
@@ -1374,6 +1928,9 @@ struct RGB2Lab_f
             CV_Assert( coeffs[j] >= 0 && coeffs[j + 1] >= 0 && coeffs[j + 2] >= 0 &&
                        coeffs[j] + coeffs[j + 1] + coeffs[j + 2] < 1.5f*LabCbrtTabScale );
         }
+#if CV_AVX2_DISPATCH
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3);
+#endif
     }
 
     void operator()(const float* src, float* dst, int n) const
@@ -1388,7 +1945,16 @@ struct RGB2Lab_f
 
         static const float _1_3 = 1.0f / 3.0f;
         static const float _a = 16.0f / 116.0f;
-        for (i = 0; i < n; i += 3, src += scn )
+
+        i = 0;
+#if CV_AVX2_DISPATCH
+        if( haveAVX2 )
+        {
+            i = RGB2Lab_32f_AVX2(src, dst, n/3, scn, gammaTab, coeffs)*3;
+            src += i/3*scn;
+        }
+#endif
+        for ( ; i < n; i += 3, src += scn )
         {
             float R = clip(src[0]);
             float G = clip(src[1]);
@@ -1425,6 +1991,9 @@ struct RGB2Lab_f
     int srccn;
     float coeffs[9];
     bool srgb;
+#if CV_AVX2_DISPATCH
+    bool haveAVX2;
+#endif
 };
 
 struct Lab2RGB_f
@@ -1564,6 +2133,57 @@ struct Lab2RGB_b
 
 ///////////////////////////////////// RGB <-> L*u*v* /////////////////////////////////////
 
+#if CV_AVX2_DISPATCH
+
+static CV_AVX2_TARGET int RGB2Luv_32f_AVX2(const float* src, float* dst, int n, int scn,
+                                           const float* gammaTab, const float* coeffs, float _un, float _vn)
+{
+    const __m256 v_gscale = _mm256_set1_ps(GammaTabScale), v_cbrtScale = _mm256_set1_ps(LabCbrtTabScale);
+    const __m256 v_116 = _mm256_set1_ps(116.f), v_16 = _mm256_set1_ps(16.f), v_15 = _mm256_set1_ps(15.f);
+    const __m256 v_3 = _mm256_set1_ps(3.f), v_52 = _mm256_set1_ps(4*13), v_2_25 = _mm256_set1_ps(9*0.25f);
+    const __m256 v_eps = _mm256_set1_ps(FLT_EPSILON), v_un = _mm256_set1_ps(_un), v_vn = _mm256_set1_ps(_vn);
+    __m256 v_c[9];
+    for( int k = 0; k < 9; k++ )
+        v_c[k] = _mm256_set1_ps(coeffs[k]);
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8, src += scn*8 )
+    {
+        __m128 v_s[6];
+        loadDeinterleave_32f(src, scn, v_s[0], v_s[1], v_s[2], v_s[3], v_s[4], v_s[5]);
+
+        __m256 v_rgb[3];
+        for( int c = 0; c < 3; c++ )
+        {
+            v_rgb[c] = join_ps(v_s[c*2], v_s[c*2+1]);
+            if( gammaTab )
+                v_rgb[c] = splineInterpolate_AVX2(_mm256_mul_ps(v_rgb[c], v_gscale), gammaTab, GAMMA_TAB_SIZE);
+        }
+
+        __m256 v_xyz[3];
+        for( int c = 0; c < 3; c++ )
+            v_xyz[c] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v_rgb[0], v_c[c*3]),
+                                                   _mm256_mul_ps(v_rgb[1], v_c[c*3+1])),
+                                     _mm256_mul_ps(v_rgb[2], v_c[c*3+2]));
+
+        __m256 v_L = splineInterpolate_AVX2(_mm256_mul_ps(v_xyz[1], v_cbrtScale), LabCbrtTab, LAB_CBRT_TAB_SIZE);
+        v_L = _mm256_sub_ps(_mm256_mul_ps(v_L, v_116), v_16);
+
+        __m256 v_d = _mm256_add_ps(_mm256_add_ps(v_xyz[0], _mm256_mul_ps(v_xyz[1], v_15)),
+                                   _mm256_mul_ps(v_xyz[2], v_3));
+        v_d = _mm256_div_ps(v_52, _mm256_max_ps(v_d, v_eps));
+        __m256 v_u = _mm256_mul_ps(v_L, _mm256_sub_ps(_mm256_mul_ps(v_xyz[0], v_d), v_un));
+        __m256 v_v = _mm256_mul_ps(v_L, _mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(v_2_25, v_xyz[1]), v_d), v_vn));
+
+        storeInterleave_32f(dst + i*3, _mm256_castps256_ps128(v_L), _mm256_extractf128_ps(v_L, 1),
+                            _mm256_castps256_ps128(v_u), _mm256_extractf128_ps(v_u, 1),
+                            _mm256_castps256_ps128(v_v), _mm256_extractf128_ps(v_v, 1));
+    }
+    return i;
+}
+
+#endif
+
 struct RGB2Luv_f
 {
     typedef float channel_type;
@@ -1594,6 +2214,9 @@ struct RGB2Luv_f
         vn = 9*whitept[1]*d;
 
         CV_Assert(whitept[1] == 1.f);
+#if CV_AVX2_DISPATCH
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3);
+#endif
     }
 
     void operator()(const float* src, float* dst, int n) const
@@ -1607,7 +2230,15 @@ struct RGB2Luv_f
         float _un = 13*un, _vn = 13*vn;
         n *= 3;
 
-        for( i = 0; i < n; i += 3, src += scn )
+        i = 0;
+#if CV_AVX2_DISPATCH
+        if( haveAVX2 )
+        {
+            i = RGB2Luv_32f_AVX2(src, dst, n/3, scn, gammaTab, coeffs, _un, _vn)*3;
+            src += i/3*scn;
+        }
+#endif
+        for( ; i < n; i += 3, src += scn )
         {
             float R = src[0], G = src[1], B = src[2];
             if( gammaTab )
@@ -1635,6 +2266,9 @@ struct RGB2Luv_f
     int srccn;
     float coeffs[9], un, vn;
     bool srgb;
+#if CV_AVX2_DISPATCH
+    bool haveAVX2;
+#endif
 };
 
 
@@ -1718,18 +2352,45 @@ struct RGB2Luv_b
 
     RGB2Luv_b( int _srccn, int blueIdx, const float* _coeffs,
                const float* _whitept, bool _srgb )
-    : srccn(_srccn), cvt(3, blueIdx, _coeffs, _whitept, _srgb) {}
+    : srccn(_srccn), cvt(3, blueIdx, _coeffs, _whitept, _srgb)
+    {
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+    }
 
     void operator()(const uchar* src, uchar* dst, int n) const
     {
         int i, j, scn = srccn;
         float buf[3*BLOCK_SIZE];
+        static const float scale[] = { 2.55f, 0.72033898305084743f, 0.99609375f };
+        static const float shift[] = { 0.f, 96.525423728813564f, 139.453125f };
 
         for( i = 0; i < n; i += BLOCK_SIZE, dst += BLOCK_SIZE*3 )
         {
             int dn = std::min(n - i, (int)BLOCK_SIZE);
+            j = 0;
 
-            for( j = 0; j < dn*3; j += 3, src += scn )
+#if CV_SSE2
+            if( haveSIMD && scn == 3 )
+            {
+                const __m128i v_zero = _mm_setzero_si128();
+                const __m128 v_scale = _mm_set1_ps(1.f/255.f);
+                for( ; j <= dn*3 - 16; j += 16, src += 16 )
+                {
+                    __m128i v_src = _mm_loadu_si128((const __m128i*)src);
+                    __m128i v_lo = _mm_unpacklo_epi8(v_src, v_zero), v_hi = _mm_unpackhi_epi8(v_src, v_zero);
+                    _mm_storeu_ps(buf + j, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v_lo, v_zero)), v_scale));
+                    _mm_storeu_ps(buf + j + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v_lo, v_zero)), v_scale));
+                    _mm_storeu_ps(buf + j + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v_hi, v_zero)), v_scale));
+                    _mm_storeu_ps(buf + j + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v_hi, v_zero)), v_scale));
+                }
+                // the loop above may stop in the middle of a pixel
+                for( ; j % 3 != 0; j++ )
+                    buf[j] = *src++*(1.f/255.f);
+            }
+#endif
+            for( ; j < dn*3; j += 3, src += scn )
             {
                 buf[j] = src[0]*(1.f/255.f);
                 buf[j+1] = (float)(src[1]*(1.f/255.f));
@@ -1737,7 +2398,32 @@ struct RGB2Luv_b
             }
             cvt(buf, buf, dn);
 
-            for( j = 0; j < dn*3; j += 3 )
+            j = 0;
+#if CV_SSE2
+            if( haveSIMD )
+            {
+                // 24 values are 8 whole pixels; the scale and shift vectors repeat every 3 registers
+                __m128 v_scale[3], v_shift[3];
+                for( int k = 0; k < 3; k++ )
+                {
+                    v_scale[k] = _mm_setr_ps(scale[k*4 % 3], scale[(k*4+1) % 3], scale[(k*4+2) % 3], scale[(k*4+3) % 3]);
+                    v_shift[k] = _mm_setr_ps(shift[k*4 % 3], shift[(k*4+1) % 3], shift[(k*4+2) % 3], shift[(k*4+3) % 3]);
+                }
+
+                for( ; j <= dn*3 - 24; j += 24 )
+                {
+                    __m128i v_dst[6];
+                    for( int k = 0; k < 6; k++ )
+                        v_dst[k] = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(buf + j + k*4), v_scale[k % 3]),
+                                                              v_shift[k % 3]));
+                    __m128i v_w0 = _mm_packs_epi32(v_dst[0], v_dst[1]), v_w1 = _mm_packs_epi32(v_dst[2], v_dst[3]);
+                    __m128i v_w2 = _mm_packs_epi32(v_dst[4], v_dst[5]);
+                    _mm_storeu_si128((__m128i*)(dst + j), _mm_packus_epi16(v_w0, v_w1));
+                    _mm_storel_epi64((__m128i*)(dst + j + 16), _mm_packus_epi16(v_w2, v_w2));
+                }
+            }
+#endif
+            for( ; j < dn*3; j += 3 )
             {
                 dst[j] = saturate_cast<uchar>(buf[j]*2.55f);
                 dst[j+1] = saturate_cast<uchar>(buf[j+1]*0.72033898305084743f + 96.525423728813564f);
@@ -1748,6 +2434,9 @@ struct RGB2Luv_b
 
     int srccn;
     RGB2Luv_f cvt;
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -1812,6 +2501,124 @@ const int ITUR_BT_601_CBU =  460324;
 const int ITUR_BT_601_CGV = -385875;
 const int ITUR_BT_601_CBV = -74448;
 
+#if CV_SSE2
+
+// The SSE2 version of the conversion below computes the same 32-bit sums with 16-bit multiplications:
+// every coefficient is split as c = c_hi*16384 + c_lo, so that c*x = _mm_madd_epi16((x*c_hi, x), (16384, c_lo)).
+// The green term is -16384*(52*v + 25*u) - 524*v - 393*u.
+
+// ruv, guv and buv for 8 (u, v) pairs given as 16-bit values with 128 subtracted;
+// every term is duplicated for the two pixels sharing the pair, so each output takes 4 registers
+static inline void YUV420UVTerms_SSE2(__m128i v_u, __m128i v_v, __m128i* v_ruv, __m128i* v_guv, __m128i* v_buv)
+{
+    const __m128i v_zero = _mm_setzero_si128();
+    const __m128i v_half = _mm_set1_epi32(1 << (ITUR_BT_601_SHIFT - 1));
+    const __m128i v_cvr = setPair_epi16(16384, 2359), v_cub = setPair_epi16(16384, 2490);
+    const __m128i v_cvg = setPair_epi16(-16384, -524), v_cug = setPair_epi16(-393, 0);
+
+    __m128i v_vr = _mm_mullo_epi16(v_v, _mm_set1_epi16(102));
+    __m128i v_ub = _mm_mullo_epi16(v_u, _mm_set1_epi16(129));
+    __m128i v_uvg = _mm_add_epi16(_mm_mullo_epi16(v_v, _mm_set1_epi16(52)), _mm_mullo_epi16(v_u, _mm_set1_epi16(25)));
+
+    __m128i v_t[6];
+    v_t[0] = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(v_vr, v_v), v_cvr), v_half);
+    v_t[1] = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(v_vr, v_v), v_cvr), v_half);
+    v_t[2] = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(v_uvg, v_v), v_cvg),
+                                         _mm_madd_epi16(_mm_unpacklo_epi16(v_u, v_zero), v_cug)), v_half);
+    v_t[3] = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(v_uvg, v_v), v_cvg),
+                                         _mm_madd_epi16(_mm_unpackhi_epi16(v_u, v_zero), v_cug)), v_half);
+    v_t[4] = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(v_ub, v_u), v_cub), v_half);
+    v_t[5] = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(v_ub, v_u), v_cub), v_half);
+
+    __m128i* v_dst[] = { v_ruv, v_guv, v_buv };
+    for( int k = 0; k < 3; k++ )
+    {
+        v_dst[k][0] = _mm_unpacklo_epi32(v_t[k*2], v_t[k*2]);
+        v_dst[k][1] = _mm_unpackhi_epi32(v_t[k*2], v_t[k*2]);
+        v_dst[k][2] = _mm_unpacklo_epi32(v_t[k*2+1], v_t[k*2+1]);
+        v_dst[k][3] = _mm_unpackhi_epi32(v_t[k*2+1], v_t[k*2+1]);
+    }
+}
+
+// (y + uv) >> ITUR_BT_601_SHIFT for 16 pixels, saturated to 8 bits
+static inline __m128i YUV420Descale_SSE2(const __m128i* v_y, const __m128i* v_uv)
+{
+    __m128i v_lo = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(v_y[0], v_uv[0]), ITUR_BT_601_SHIFT),
+                                   _mm_srai_epi32(_mm_add_epi32(v_y[1], v_uv[1]), ITUR_BT_601_SHIFT));
+    __m128i v_hi = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(v_y[2], v_uv[2]), ITUR_BT_601_SHIFT),
+                                   _mm_srai_epi32(_mm_add_epi32(v_y[3], v_uv[3]), ITUR_BT_601_SHIFT));
+    return _mm_packus_epi16(v_lo, v_hi);
+}
+
+// converts 16 pixels of a row given their shared uv terms; the results are planes of 8-bit R, G and B
+static inline void YUV420ToRGB_SSE2(const uchar* y, const __m128i* v_ruv, const __m128i* v_guv, const __m128i* v_buv,
+                                    __m128i& v_r, __m128i& v_g, __m128i& v_b)
+{
+    const __m128i v_zero = _mm_setzero_si128(), v_16 = _mm_set1_epi16(16), v_74 = _mm_set1_epi16(74);
+    const __m128i v_cy = setPair_epi16(16384, 8126);
+
+    __m128i v_src = _mm_loadu_si128((const __m128i*)y);
+    __m128i v_lo = _mm_subs_epu16(_mm_unpacklo_epi8(v_src, v_zero), v_16);
+    __m128i v_hi = _mm_subs_epu16(_mm_unpackhi_epi8(v_src, v_zero), v_16);
+    __m128i v_ylo = _mm_mullo_epi16(v_lo, v_74), v_yhi = _mm_mullo_epi16(v_hi, v_74);
+
+    __m128i v_y[4];
+    v_y[0] = _mm_madd_epi16(_mm_unpacklo_epi16(v_ylo, v_lo), v_cy);
+    v_y[1] = _mm_madd_epi16(_mm_unpackhi_epi16(v_ylo, v_lo), v_cy);
+    v_y[2] = _mm_madd_epi16(_mm_unpacklo_epi16(v_yhi, v_hi), v_cy);
+    v_y[3] = _mm_madd_epi16(_mm_unpackhi_epi16(v_yhi, v_hi), v_cy);
+
+    v_r = YUV420Descale_SSE2(v_y, v_ruv);
+    v_g = YUV420Descale_SSE2(v_y, v_guv);
+    v_b = YUV420Descale_SSE2(v_y, v_buv);
+}
+
+// converts 32 pixels of two rows sharing 16 (u, v) pairs: v_u0, v_v0 hold pairs 0..7 and v_u1, v_v1 pairs 8..15,
+// as 16-bit values with 128 subtracted
+template<int bIdx, int dcn> static inline void
+YUV420ToRGBRows_SSE2(const uchar* y1, const uchar* y2, __m128i v_u0, __m128i v_v0, __m128i v_u1, __m128i v_v1,
+                     uchar* row1, uchar* row2)
+{
+    __m128i v_ruv0[4], v_guv0[4], v_buv0[4], v_ruv1[4], v_guv1[4], v_buv1[4];
+    YUV420UVTerms_SSE2(v_u0, v_v0, v_ruv0, v_guv0, v_buv0);
+    YUV420UVTerms_SSE2(v_u1, v_v1, v_ruv1, v_guv1, v_buv1);
+
+    for( int k = 0; k < 2; k++ )
+    {
+        const uchar* y = k == 0 ? y1 : y2;
+        __m128i v_r0, v_g0, v_b0, v_r1, v_g1, v_b1;
+        YUV420ToRGB_SSE2(y, v_ruv0, v_guv0, v_buv0, v_r0, v_g0, v_b0);
+        YUV420ToRGB_SSE2(y + 16, v_ruv1, v_guv1, v_buv1, v_r1, v_g1, v_b1);
+
+        if( bIdx == 0 )
+            storeInterleave_8u(k == 0 ? row1 : row2, dcn, v_b0, v_b1, v_g0, v_g1, v_r0, v_r1);
+        else
+            storeInterleave_8u(k == 0 ? row1 : row2, dcn, v_r0, v_r1, v_g0, v_g1, v_b0, v_b1);
+    }
+}
+
+// splits 16 interleaved (u, v) bytes into 8 u and 8 v values, with 128 subtracted
+template<int uIdx> static inline void YUV420SplitUV_SSE2(const uchar* uv, __m128i& v_u, __m128i& v_v)
+{
+    const __m128i v_128 = _mm_set1_epi16(128);
+    __m128i v_src = _mm_loadu_si128((const __m128i*)uv);
+    __m128i v_even = _mm_sub_epi16(_mm_and_si128(v_src, _mm_set1_epi16(0xff)), v_128);
+    __m128i v_odd = _mm_sub_epi16(_mm_srli_epi16(v_src, 8), v_128);
+    v_u = uIdx == 0 ? v_even : v_odd;
+    v_v = uIdx == 0 ? v_odd : v_even;
+}
+
+// widens 16 bytes of a chroma plane to 16-bit values with 128 subtracted
+static inline void YUV420LoadPlane_SSE2(const uchar* p, __m128i& v_lo, __m128i& v_hi)
+{
+    const __m128i v_zero = _mm_setzero_si128(), v_128 = _mm_set1_epi16(128);
+    __m128i v_src = _mm_loadu_si128((const __m128i*)p);
+    v_lo = _mm_sub_epi16(_mm_unpacklo_epi8(v_src, v_zero), v_128);
+    v_hi = _mm_sub_epi16(_mm_unpackhi_epi8(v_src, v_zero), v_128);
+}
+
+#endif
+
 template<int bIdx, int uIdx>
 struct YUV420sp2RGB888Invoker
 {
@@ -1842,13 +2649,30 @@ struct YUV420sp2RGB888Invoker
             return;
 #endif
 
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
         for (int j = rangeBegin; j < rangeEnd; j += 2, y1 += stride * 2, uv += stride)
         {
             uchar* row1 = dst->ptr<uchar>(j);
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width; i += 2, row1 += 6, row2 += 6)
+            int i = 0;
+#if CV_SSE2
+            if( haveSSE2 )
+            {
+                for( ; i <= width - 32; i += 32, row1 += 96, row2 += 96 )
+                {
+                    __m128i v_u0, v_u1, v_v0, v_v1;
+                    YUV420SplitUV_SSE2<uIdx>(uv + i, v_u0, v_v0);
+                    YUV420SplitUV_SSE2<uIdx>(uv + i + 16, v_u1, v_v1);
+                    YUV420ToRGBRows_SSE2<bIdx, 3>(y1 + i, y2 + i, v_u0, v_v0, v_u1, v_v1, row1, row2);
+                }
+            }
+#endif
+            for ( ; i < width; i += 2, row1 += 6, row2 += 6)
             {
                 int u = int(uv[i + 0 + uIdx]) - 128;
                 int v = int(uv[i + 1 - uIdx]) - 128;
@@ -1911,13 +2735,30 @@ struct YUV420sp2RGBA8888Invoker
             return;
 #endif
 
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
         for (int j = rangeBegin; j < rangeEnd; j += 2, y1 += stride * 2, uv += stride)
         {
             uchar* row1 = dst->ptr<uchar>(j);
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width; i += 2, row1 += 8, row2 += 8)
+            int i = 0;
+#if CV_SSE2
+            if( haveSSE2 )
+            {
+                for( ; i <= width - 32; i += 32, row1 += 128, row2 += 128 )
+                {
+                    __m128i v_u0, v_u1, v_v0, v_v1;
+                    YUV420SplitUV_SSE2<uIdx>(uv + i, v_u0, v_v0);
+                    YUV420SplitUV_SSE2<uIdx>(uv + i + 16, v_u1, v_v1);
+                    YUV420ToRGBRows_SSE2<bIdx, 4>(y1 + i, y2 + i, v_u0, v_v0, v_u1, v_v1, row1, row2);
+                }
+            }
+#endif
+            for ( ; i < width; i += 2, row1 += 8, row2 += 8)
             {
                 int u = int(uv[i + 0 + uIdx]) - 128;
                 int v = int(uv[i + 1 - uIdx]) - 128;
@@ -1983,13 +2824,30 @@ struct YUV420p2RGB888Invoker
             v1 += uvsteps[(vsIdx++) & 1];
         }
 
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
         for (int j = rangeBegin; j < rangeEnd; j += 2, y1 += stride * 2, u1 += uvsteps[(usIdx++) & 1], v1 += uvsteps[(vsIdx++) & 1])
         {
             uchar* row1 = dst->ptr<uchar>(j);
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width / 2; i += 1, row1 += 6, row2 += 6)
+            int i = 0;
+#if CV_SSE2
+            if( haveSSE2 )
+            {
+                for( ; i <= width / 2 - 16; i += 16, row1 += 96, row2 += 96 )
+                {
+                    __m128i v_u0, v_u1, v_v0, v_v1;
+                    YUV420LoadPlane_SSE2(u1 + i, v_u0, v_u1);
+                    YUV420LoadPlane_SSE2(v1 + i, v_v0, v_v1);
+                    YUV420ToRGBRows_SSE2<bIdx, 3>(y1 + 2 * i, y2 + 2 * i, v_u0, v_v0, v_u1, v_v1, row1, row2);
+                }
+            }
+#endif
+            for ( ; i < width / 2; i += 1, row1 += 6, row2 += 6)
             {
                 int u = int(u1[i]) - 128;
                 int v = int(v1[i]) - 128;
@@ -2051,13 +2909,30 @@ struct YUV420p2RGBA8888Invoker
             v1 += uvsteps[(vsIdx++) & 1];
         }
 
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
         for (int j = rangeBegin; j < rangeEnd; j += 2, y1 += stride * 2, u1 += uvsteps[(usIdx++) & 1], v1 += uvsteps[(vsIdx++) & 1])
         {
             uchar* row1 = dst->ptr<uchar>(j);
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width / 2; i += 1, row1 += 8, row2 += 8)
+            int i = 0;
+#if CV_SSE2
+            if( haveSSE2 )
+            {
+                for( ; i <= width / 2 - 16; i += 16, row1 += 128, row2 += 128 )
+                {
+                    __m128i v_u0, v_u1, v_v0, v_v1;
+                    YUV420LoadPlane_SSE2(u1 + i, v_u0, v_u1);
+                    YUV420LoadPlane_SSE2(v1 + i, v_v0, v_v1);
+                    YUV420ToRGBRows_SSE2<bIdx, 4>(y1 + 2 * i, y2 + 2 * i, v_u0, v_v0, v_u1, v_v1, row1, row2);
+                }
+            }
+#endif
+            for ( ; i < width / 2; i += 1, row1 += 8, row2 += 8)
             {
                 int u = int(u1[i]) - 128;
                 int v = int(v1[i]) - 128;
@@ -2100,11 +2975,9 @@ template<int bIdx, int uIdx>
 inline void cvtYUV420sp2RGB(Mat& _dst, int _stride, const uchar* _y1, const uchar* _uv)
 {
     YUV420sp2RGB888Invoker<bIdx, uIdx> converter(&_dst, _stride, _y1,  _uv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
         parallel_for(BlockedRange(0, _dst.rows/2), converter);
     else
-#endif
         converter(BlockedRange(0, _dst.rows/2));
 }
 
@@ -2112,11 +2985,9 @@ template<int bIdx, int uIdx>
 inline void cvtYUV420sp2RGBA(Mat& _dst, int _stride, const uchar* _y1, const uchar* _uv)
 {
     YUV420sp2RGBA8888Invoker<bIdx, uIdx> converter(&_dst, _stride, _y1,  _uv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
         parallel_for(BlockedRange(0, _dst.rows/2), converter);
     else
-#endif
         converter(BlockedRange(0, _dst.rows/2));
 }
 
@@ -2124,11 +2995,9 @@ template<int bIdx>
 inline void cvtYUV420p2RGB(Mat& _dst, int _stride, const uchar* _y1, const uchar* _u, const uchar* _v, int ustepIdx, int vstepIdx)
 {
     YUV420p2RGB888Invoker<bIdx> converter(&_dst, _stride, _y1,  _u, _v, ustepIdx, vstepIdx);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
         parallel_for(BlockedRange(0, _dst.rows/2), converter);
     else
-#endif
         converter(BlockedRange(0, _dst.rows/2));
 }
 
@@ -2136,11 +3005,9 @@ template<int bIdx>
 inline void cvtYUV420p2RGBA(Mat& _dst, int _stride, const uchar* _y1, const uchar* _u, const uchar* _v, int ustepIdx, int vstepIdx)
 {
     YUV420p2RGBA8888Invoker<bIdx> converter(&_dst, _stride, _y1,  _u, _v, ustepIdx, vstepIdx);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
         parallel_for(BlockedRange(0, _dst.rows/2), converter);
     else
-#endif
         converter(BlockedRange(0, _dst.rows/2));
 }
 
@@ -2324,11 +3191,9 @@ template<int bIdx, int uIdx, int yIdx>
 inline void cvtYUV422toRGB(Mat& _dst, int _stride, const uchar* _yuv)
 {
     YUV422toRGB888Invoker<bIdx, uIdx, yIdx> converter(&_dst, _stride, _yuv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV422_CONVERSION)
         parallel_for(BlockedRange(0, _dst.rows), converter);
     else
-#endif
         converter(BlockedRange(0, _dst.rows));
 }
 
@@ -2336,11 +3201,9 @@ template<int bIdx, int uIdx, int yIdx>
 inline void cvtYUV422toRGBA(Mat& _dst, int _stride, const uchar* _yuv)
 {
     YUV422toRGBA8888Invoker<bIdx, uIdx, yIdx> converter(&_dst, _stride, _yuv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV422_CONVERSION)
         parallel_for(BlockedRange(0, _dst.rows), converter);
     else
-#endif
         converter(BlockedRange(0, _dst.rows));
 }
 
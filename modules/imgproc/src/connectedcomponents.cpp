@@ -58,6 +58,11 @@ namespace cv{
             (void) l;
         }
         void finish(){}
+        void initLocal(int /*labels*/){
+        }
+        template<typename LabelT>
+        void merge(const NoOp &, const LabelT *){
+        }
     };
     struct Point2ui64{
         uint64 x, y;
@@ -73,13 +78,23 @@ namespace cv{
 
         CCStatsOp(OutputArray _statsv, OutputArray _centroidsv): _mstatsv(&_statsv), _mcentroidsv(&_centroidsv){
         }
+        //the accumulator of a strip in the parallel labeling, see initLocal()
+        CCStatsOp(): _mstatsv(0), _mcentroidsv(0){
+        }
         inline
         void init(int nlabels){
             _mstatsv->create(cv::Size(CC_STAT_MAX, nlabels), cv::DataType<int>::type);
             statsv = _mstatsv->getMat();
             _mcentroidsv->create(cv::Size(2, nlabels), cv::DataType<double>::type);
             centroidsv = _mcentroidsv->getMat();
-
+            reset(nlabels);
+        }
+        //collects the stats of the provisional labels of a strip; they are added to the final ones by merge()
+        void initLocal(int nlabels){
+            statsv.create(cv::Size(CC_STAT_MAX, nlabels), cv::DataType<int>::type);
+            reset(nlabels);
+        }
+        void reset(int nlabels){
             for(int l = 0; l < (int) nlabels; ++l){
                 int *row = (int *) &statsv.at<int>(l, 0);
                 row[CC_STAT_LEFT] = INT_MAX;
@@ -88,7 +103,27 @@ namespace cv{
                 row[CC_STAT_HEIGHT] = INT_MIN;
                 row[CC_STAT_AREA] = 0;
             }
-            integrals.resize(nlabels, Point2ui64(0, 0));
+            integrals.assign(nlabels, Point2ui64(0, 0));
+        }
+        //adds the stats of a strip; labels[l] is the final label of the strip's provisional label l > 0,
+        //and l = 0 is the background
+        template<typename LabelT>
+        void merge(const CCStatsOp &local, const LabelT *labels){
+            for(int l = 0; l < local.statsv.rows; ++l){
+                const int *lrow = &local.statsv.at<int>(l, 0);
+                if(lrow[CC_STAT_AREA] == 0){
+                    continue;
+                }
+                const int gl = l == 0 ? 0 : (int) labels[l];
+                int *row = &statsv.at<int>(gl, 0);
+                row[CC_STAT_LEFT] = std::min(row[CC_STAT_LEFT], std::min(lrow[CC_STAT_LEFT], lrow[CC_STAT_WIDTH]));
+                row[CC_STAT_WIDTH] = std::max(row[CC_STAT_WIDTH], lrow[CC_STAT_WIDTH]);
+                row[CC_STAT_TOP] = std::min(row[CC_STAT_TOP], std::min(lrow[CC_STAT_TOP], lrow[CC_STAT_HEIGHT]));
+                row[CC_STAT_HEIGHT] = std::max(row[CC_STAT_HEIGHT], lrow[CC_STAT_HEIGHT]);
+                row[CC_STAT_AREA] += lrow[CC_STAT_AREA];
+                integrals[gl].x += local.integrals[l].x;
+                integrals[gl].y += local.integrals[l].y;
+            }
         }
         void operator()(int r, int c, int l){
             int *row = &statsv.at<int>(l, 0);
@@ -191,6 +226,21 @@ namespace cv{
         return k;
     }
 
+    //upper bound of the number of provisional labels in a rows x cols image
+    inline static
+    size_t labelsUpperBound(int rows, int cols, int connectivity){
+        //with 8-way connectivity every new label is at least 2 pixels apart from the others in both directions
+        //(isolated pixels on a grid with step 2), with 4-way connectivity a checkerboard gives a label to half of the pixels
+        if(connectivity == 8){
+            return (size_t(rows + 1)/2) * (size_t(cols + 1)/2);
+        }
+        return (size_t(rows) * cols + 1)/2;
+    }
+
+    //images with fewer pixels are labeled on a single thread,
+    //and the strips of the parallel labeling are at least CC_MIN_STRIP_ROWS rows tall
+    enum { CC_PARALLEL_MIN_SIZE = 1 << 16, CC_MIN_STRIP_ROWS = 32 };
+
     //Based on "Two Strategies to Speed up Connected Components Algorithms", the SAUF (Scan array union find) variant
     //using decision trees
     //Kesheng Wu, et al
@@ -199,24 +249,14 @@ namespace cv{
     const int G4[2][2] = {{1, 0}, {0, -1}};//b, d neighborhoods
     //reference for 8-way: {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}};//a, b, c, d neighborhoods
     const int G8[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, -1}};//a, b, c, d neighborhoods
-    template<typename LabelT, typename PixelT, typename StatsOp = NoOp >
-    struct LabelingImpl{
-    LabelT operator()(const cv::Mat &I, cv::Mat &L, int connectivity, StatsOp &sop){
-        CV_Assert(L.rows == I.rows);
-        CV_Assert(L.cols == I.cols);
-        CV_Assert(connectivity == 8 || connectivity == 4);
-        const int rows = L.rows;
+
+    //the scanning phase for the rows [r0, r1), as if r0 was the first row of the image:
+    //assigns the provisional labels starting from lunique and returns the next free label
+    template<typename LabelT, typename PixelT>
+    static
+    LabelT scanRows(const cv::Mat &I, cv::Mat &L, int connectivity, LabelT *P, int r0, int r1, LabelT lunique){
         const int cols = L.cols;
-        size_t Plength = (size_t(rows + 3 - 1)/3) * (size_t(cols + 3 - 1)/3);
-        if(connectivity == 4){
-            Plength = 4 * Plength;//a quick and dirty upper bound, an exact answer exists if you want to find it
-            //the 4 comes from the fact that a 3x3 block can never have more than 4 unique labels
-        }
-        LabelT *P = (LabelT *) fastMalloc(sizeof(LabelT) * Plength);
-        P[0] = 0;
-        LabelT lunique = 1;
-        //scanning phase
-        for(int r_i = 0; r_i < rows; ++r_i){
+        for(int r_i = r0; r_i < r1; ++r_i){
             LabelT *Lrow = (LabelT *)(L.data + L.step.p[0] * r_i);
             LabelT *Lrow_prev = (LabelT *)(((char *)Lrow) - L.step.p[0]);
             const PixelT *Irow = (PixelT *)(I.data + I.step.p[0] * r_i);
@@ -234,9 +274,9 @@ namespace cv{
                 const int b = 1;
                 const int c = 2;
                 const int d = 3;
-                const bool T_a_r = (r_i - G8[a][0]) >= 0;
-                const bool T_b_r = (r_i - G8[b][0]) >= 0;
-                const bool T_c_r = (r_i - G8[c][0]) >= 0;
+                const bool T_a_r = (r_i - G8[a][0]) >= r0;
+                const bool T_b_r = (r_i - G8[b][0]) >= r0;
+                const bool T_c_r = (r_i - G8[c][0]) >= r0;
                 for(int c_i = 0; Irows[0] != Irow + cols; ++Irows[0], c_i++){
                     if(!*Irows[0]){
                         Lrow[c_i] = 0;
@@ -290,7 +330,7 @@ namespace cv{
                 //B & D only
                 const int b = 0;
                 const int d = 1;
-                const bool T_b_r = (r_i - G4[b][0]) >= 0;
+                const bool T_b_r = (r_i - G4[b][0]) >= r0;
                 for(int c_i = 0; Irows[0] != Irow + cols; ++Irows[0], c_i++){
                     if(!*Irows[0]){
                         Lrow[c_i] = 0;
@@ -324,6 +364,90 @@ namespace cv{
             }
         }
 
+        return lunique;
+    }
+
+    template<typename LabelT, typename PixelT>
+    struct ScanInvoker : public ParallelLoopBody{
+        const cv::Mat &I;
+        cv::Mat &L;
+        int connectivity;
+        const std::vector<int> &stripStart;
+        std::vector<std::vector<LabelT> > &Ps;
+        std::vector<LabelT> &counts;
+
+        ScanInvoker(const cv::Mat &_I, cv::Mat &_L, int _connectivity, const std::vector<int> &_stripStart,
+                    std::vector<std::vector<LabelT> > &_Ps, std::vector<LabelT> &_counts):
+            I(_I), L(_L), connectivity(_connectivity), stripStart(_stripStart), Ps(_Ps), counts(_counts){
+        }
+
+        void operator()(const cv::Range &range) const{
+            for(int k = range.start; k < range.end; ++k){
+                const int r0 = stripStart[k], r1 = stripStart[k + 1];
+                std::vector<LabelT> &P = Ps[k];
+                P.resize(labelsUpperBound(r1 - r0, L.cols, connectivity) + 1);
+                P[0] = 0;
+                counts[k] = scanRows<LabelT, PixelT>(I, L, connectivity, &P[0], r0, r1, (LabelT) 1) - 1;
+            }
+        }
+    };
+
+    template<typename LabelT, typename StatsOp>
+    struct RelabelInvoker : public ParallelLoopBody{
+        cv::Mat &L;
+        const LabelT *P;
+        const std::vector<int> &stripStart;
+        const std::vector<LabelT> &offsets;
+        const std::vector<LabelT> &counts;
+        std::vector<StatsOp> &sops;
+
+        RelabelInvoker(cv::Mat &_L, const LabelT *_P, const std::vector<int> &_stripStart,
+                       const std::vector<LabelT> &_offsets, const std::vector<LabelT> &_counts,
+                       std::vector<StatsOp> &_sops):
+            L(_L), P(_P), stripStart(_stripStart), offsets(_offsets), counts(_counts), sops(_sops){
+        }
+
+        void operator()(const cv::Range &range) const{
+            for(int k = range.start; k < range.end; ++k){
+                //the provisional label l > 0 of the strip is P[offsets[k] + l - 1] in the whole image
+                const LabelT *labels = P + offsets[k] - 1;
+                StatsOp &sop = sops[k];
+                sop.initLocal((int) counts[k] + 1);
+                for(int r_i = stripStart[k]; r_i < stripStart[k + 1]; ++r_i){
+                    LabelT *Lrow = (LabelT *)(L.data + L.step.p[0] * r_i);
+                    for(int c_i = 0; c_i < L.cols; ++c_i){
+                        const LabelT l = Lrow[c_i];
+                        Lrow[c_i] = l ? labels[l] : 0;
+                        sop(r_i, c_i, l);
+                    }
+                }
+            }
+        }
+    };
+
+    template<typename LabelT, typename PixelT, typename StatsOp = NoOp >
+    struct LabelingImpl{
+    LabelT operator()(const cv::Mat &I, cv::Mat &L, int connectivity, StatsOp &sop){
+        CV_Assert(L.rows == I.rows);
+        CV_Assert(L.cols == I.cols);
+        CV_Assert(connectivity == 8 || connectivity == 4);
+        const int rows = L.rows;
+        const int cols = L.cols;
+
+        int nStrips = 1;
+        if((size_t) rows * cols >= (size_t) CC_PARALLEL_MIN_SIZE){
+            nStrips = std::max(std::min(cv::getNumThreads(), rows / CC_MIN_STRIP_ROWS), 1);
+        }
+        if(nStrips > 1){
+            return labelParallel(I, L, connectivity, sop, nStrips);
+        }
+
+        size_t Plength = labelsUpperBound(rows, cols, connectivity) + 1;
+        LabelT *P = (LabelT *) fastMalloc(sizeof(LabelT) * Plength);
+        P[0] = 0;
+        //scanning phase
+        LabelT lunique = scanRows<LabelT, PixelT>(I, L, connectivity, P, 0, rows, (LabelT) 1);
+
         //analysis
         LabelT nLabels = flattenL(P, lunique);
         sop.init(nLabels);
@@ -345,6 +469,78 @@ namespace cv{
         return nLabels;
     }//End function LabelingImpl operator()
 
+    //Every strip of rows is scanned on its own, with the provisional labels local to the strip.
+    //The local labels are then numbered after the ones of the strips above, so that they keep the raster order,
+    //and the trees are united across the strip boundaries. The smallest label is always the root,
+    //so the final labels are the same as the ones of the serial labeling
+    LabelT labelParallel(const cv::Mat &I, cv::Mat &L, int connectivity, StatsOp &sop, int nStrips){
+        const int rows = L.rows;
+        const int cols = L.cols;
+        std::vector<int> stripStart(nStrips + 1);
+        for(int k = 0; k <= nStrips; ++k){
+            stripStart[k] = (int)((int64) k * rows / nStrips);
+        }
+
+        std::vector<std::vector<LabelT> > Ps(nStrips);
+        std::vector<LabelT> counts(nStrips), offsets(nStrips);
+        cv::parallel_for_(cv::Range(0, nStrips), ScanInvoker<LabelT, PixelT>(I, L, connectivity, stripStart, Ps, counts));
+
+        size_t Plength = 1;
+        for(int k = 0; k < nStrips; ++k){
+            offsets[k] = (LabelT) Plength;
+            Plength += counts[k];
+        }
+        LabelT *P = (LabelT *) fastMalloc(sizeof(LabelT) * Plength);
+        P[0] = 0;
+        for(int k = 0; k < nStrips; ++k){
+            const LabelT *Pk = &Ps[k][0];
+            LabelT *Pg = P + offsets[k] - 1;
+            for(LabelT l = 1; l <= counts[k]; ++l){
+                Pg[l] = offsets[k] + Pk[l] - 1;
+            }
+            std::vector<LabelT>().swap(Ps[k]);
+        }
+
+        //merge the trees across the strip boundaries; the pixels are foreground iff they have a label
+        for(int k = 1; k < nStrips; ++k){
+            const int r_i = stripStart[k];
+            const LabelT *Lrow = (const LabelT *)(L.data + L.step.p[0] * r_i);
+            const LabelT *Lrow_prev = (const LabelT *)(L.data + L.step.p[0] * (r_i - 1));
+            const LabelT ofs = offsets[k] - 1, ofs_prev = offsets[k - 1] - 1;
+            for(int c_i = 0; c_i < cols; ++c_i){
+                if(!Lrow[c_i]){
+                    continue;
+                }
+                const LabelT l = ofs + Lrow[c_i];
+                if(connectivity == 8){
+                    for(int dc = -1; dc <= 1; ++dc){
+                        const int cc = c_i + dc;
+                        if(0 <= cc && cc < cols && Lrow_prev[cc]){
+                            set_union(P, l, (LabelT)(ofs_prev + Lrow_prev[cc]));
+                        }
+                    }
+                }else if(Lrow_prev[c_i]){
+                    set_union(P, l, (LabelT)(ofs_prev + Lrow_prev[c_i]));
+                }
+            }
+        }
+
+        //analysis
+        LabelT nLabels = flattenL(P, (LabelT) Plength);
+        sop.init(nLabels);
+
+        std::vector<StatsOp> sops(nStrips);
+        cv::parallel_for_(cv::Range(0, nStrips), RelabelInvoker<LabelT, StatsOp>(L, P, stripStart, offsets, counts, sops));
+        for(int k = 0; k < nStrips; ++k){
+            sop.merge(sops[k], P + offsets[k] - 1);
+        }
+
+        sop.finish();
+        fastFree(P);
+
+        return nLabels;
+    }
+
     };//End struct LabelingImpl
 }//end namespace connectedcomponents
 
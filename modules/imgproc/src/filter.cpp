@@ -451,6 +451,61 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
              dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
 }
 
+
+// images smaller than FILTER_PARALLEL_MIN_SIZE bytes (src and dst together) are filtered
+// in the calling thread. A band should be several times taller than the kernel, since
+// the ksize.height-1 rows around each band boundary are run through the row filter twice.
+enum { FILTER_PARALLEL_MIN_SIZE = 1 << 16, FILTER_PARALLEL_MIN_BAND_ROWS = 16 };
+
+class FilterEngineInvoker : public ParallelLoopBody
+{
+public:
+    FilterEngineInvoker(const FilterEngineFactory& _factory, const Mat& _src,
+                        const Mat& _dst, bool _isolated) :
+        factory(&_factory), src(_src), dst(_dst), isolated(_isolated)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        // the band is filtered with the rows above and below it as the border,
+        // so the result does not depend on how the image is split
+        Ptr<FilterEngine> f = (*factory)();
+        Mat d = dst;
+        f->apply( src, d, Rect(0, range.start, src.cols, range.end - range.start),
+                  Point(0, range.start), isolated );
+    }
+
+private:
+    const FilterEngineFactory* factory;
+    Mat src;
+    Mat dst;
+    bool isolated;
+};
+
+void applyFilterEngine( const FilterEngineFactory& factory, const Mat& src, Mat& dst,
+                        bool isolated )
+{
+    CV_Assert( src.size() == dst.size() );
+
+    int nStripes = 1;
+
+    // in-place filtering relies on the ring buffer holding the source rows
+    // that have already been overwritten, so it can only be done by a single engine
+    bool overlap = src.datastart < dst.dataend && dst.datastart < src.dataend;
+    if( !overlap && src.total()*(src.elemSize() + dst.elemSize()) >= (size_t)FILTER_PARALLEL_MIN_SIZE )
+    {
+        int minBandRows = std::max((factory.kernelHeight() - 1)*4, (int)FILTER_PARALLEL_MIN_BAND_ROWS);
+        // one band per thread, so that every thread allocates its ring buffer once
+        nStripes = std::min(getNumThreads(), src.rows/minBandRows);
+    }
+
+    if( nStripes > 1 )
+        parallel_for_(Range(0, src.rows), FilterEngineInvoker(factory, src, dst, isolated), nStripes);
+    else
+        factory()->apply(src, dst, Rect(0,0,-1,-1), Point(), isolated);
+}
+
 }
 
 /****************************************************************************************\
@@ -3228,6 +3283,62 @@ cv::Ptr<cv::FilterEngine> cv::createLinearFilter( int _srcType, int _dstType,
 }
 
 
+namespace cv
+{
+
+class LinearFilterFactory : public FilterEngineFactory
+{
+public:
+    LinearFilterFactory(int _srcType, int _dstType, const Mat& _kernel,
+                        Point _anchor, double _delta, int _borderType) :
+        srcType(_srcType), dstType(_dstType), kernel(_kernel),
+        anchor(_anchor), delta(_delta), borderType(_borderType)
+    {
+    }
+
+    Ptr<FilterEngine> operator()() const
+    {
+        return createLinearFilter(srcType, dstType, kernel, anchor, delta, borderType);
+    }
+
+    int kernelHeight() const { return kernel.rows; }
+
+private:
+    int srcType, dstType;
+    Mat kernel;
+    Point anchor;
+    double delta;
+    int borderType;
+};
+
+class SeparableLinearFilterFactory : public FilterEngineFactory
+{
+public:
+    SeparableLinearFilterFactory(int _srcType, int _dstType, const Mat& _kernelX,
+                                 const Mat& _kernelY, Point _anchor, double _delta, int _borderType) :
+        srcType(_srcType), dstType(_dstType), kernelX(_kernelX), kernelY(_kernelY),
+        anchor(_anchor), delta(_delta), borderType(_borderType)
+    {
+    }
+
+    Ptr<FilterEngine> operator()() const
+    {
+        return createSeparableLinearFilter(srcType, dstType, kernelX, kernelY,
+                                           anchor, delta, borderType);
+    }
+
+    int kernelHeight() const { return (int)kernelY.total(); }
+
+private:
+    int srcType, dstType;
+    Mat kernelX, kernelY;
+    Point anchor;
+    double delta;
+    int borderType;
+};
+
+}
+
 void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
                    InputArray _kernel, Point anchor,
                    double delta, int borderType )
@@ -3268,9 +3379,9 @@ void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
         return;
     }
 
-    Ptr<FilterEngine> f = createLinearFilter(src.type(), dst.type(), kernel,
-                                             anchor, delta, borderType & ~BORDER_ISOLATED );
-    f->apply(src, dst, Rect(0,0,-1,-1), Point(), (borderType & BORDER_ISOLATED) != 0 );
+    applyFilterEngine( LinearFilterFactory(src.type(), dst.type(), kernel,
+                                           anchor, delta, borderType & ~BORDER_ISOLATED),
+                       src, dst, (borderType & BORDER_ISOLATED) != 0 );
 }
 
 
@@ -3286,9 +3397,9 @@ void cv::sepFilter2D( InputArray _src, OutputArray _dst, int ddepth,
     _dst.create( src.size(), CV_MAKETYPE(ddepth, src.channels()) );
     Mat dst = _dst.getMat();
 
-    Ptr<FilterEngine> f = createSeparableLinearFilter(src.type(),
-        dst.type(), kernelX, kernelY, anchor, delta, borderType & ~BORDER_ISOLATED );
-    f->apply(src, dst, Rect(0,0,-1,-1), Point(), (borderType & BORDER_ISOLATED) != 0 );
+    applyFilterEngine( SeparableLinearFilterFactory(src.type(), dst.type(), kernelX, kernelY,
+                                                    anchor, delta, borderType & ~BORDER_ISOLATED),
+                       src, dst, (borderType & BORDER_ISOLATED) != 0 );
 }
 
 
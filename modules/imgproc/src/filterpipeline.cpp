@@ -0,0 +1,408 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+/****************************************************************************************\
+*                                     Filter Pipeline                                    *
+\****************************************************************************************/
+
+namespace cv
+{
+
+BasePipelineOp::~BasePipelineOp() {}
+
+class MagnitudeOp : public BasePipelineOp
+{
+public:
+    void operator()(const Mat* src, int nsrc, Mat& dst)
+    {
+        CV_Assert( nsrc == 2 );
+        magnitude( src[0], src[1], dst );
+    }
+};
+
+class PhaseOp : public BasePipelineOp
+{
+public:
+    PhaseOp(bool _angleInDegrees) : angleInDegrees(_angleInDegrees) {}
+
+    void operator()(const Mat* src, int nsrc, Mat& dst)
+    {
+        CV_Assert( nsrc == 2 );
+        phase( src[0], src[1], dst, angleInDegrees );
+    }
+
+    bool angleInDegrees;
+};
+
+class ThresholdOp : public BasePipelineOp
+{
+public:
+    ThresholdOp(double _thresh, double _maxval, int _type) :
+        thresh(_thresh), maxval(_maxval), type(_type) {}
+
+    void operator()(const Mat* src, int nsrc, Mat& dst)
+    {
+        CV_Assert( nsrc == 1 );
+        threshold( src[0], dst, thresh, maxval, type );
+    }
+
+    double thresh, maxval;
+    int type;
+};
+
+class ConvertOp : public BasePipelineOp
+{
+public:
+    ConvertOp(double _alpha, double _beta) : alpha(_alpha), beta(_beta) {}
+
+    void operator()(const Mat* src, int nsrc, Mat& dst)
+    {
+        CV_Assert( nsrc == 1 );
+        src[0].convertTo( dst, dst.type(), alpha, beta );
+    }
+
+    double alpha, beta;
+};
+
+}
+
+cv::Ptr<cv::BasePipelineOp> cv::getMagnitudeOp()
+{
+    return Ptr<BasePipelineOp>(new MagnitudeOp);
+}
+
+cv::Ptr<cv::BasePipelineOp> cv::getPhaseOp(bool angleInDegrees)
+{
+    return Ptr<BasePipelineOp>(new PhaseOp(angleInDegrees));
+}
+
+cv::Ptr<cv::BasePipelineOp> cv::getThresholdOp(double thresh, double maxval, int type)
+{
+    // Otsu's method needs the histogram of the whole image
+    CV_Assert( (type & THRESH_OTSU) == 0 );
+    return Ptr<BasePipelineOp>(new ThresholdOp(thresh, maxval, type));
+}
+
+cv::Ptr<cv::BasePipelineOp> cv::getConvertOp(double alpha, double beta)
+{
+    return Ptr<BasePipelineOp>(new ConvertOp(alpha, beta));
+}
+
+
+namespace cv
+{
+
+FilterPipeline::FilterPipeline() {}
+FilterPipeline::~FilterPipeline() {}
+
+int FilterPipeline::addFilter(const Ptr<FilterEngine>& filter, int input)
+{
+    int n = (int)types.size();
+    CV_Assert( !filter.empty() && SOURCE <= input && input < n );
+    if( input >= 0 && types[input] != filter->srcType )
+        CV_Error( CV_StsUnmatchedFormats, "The filter input type does not match the type of the stage output" );
+
+    filters.push_back(filter);
+    ops.push_back(Ptr<BasePipelineOp>());
+    inputs.push_back(Vec2i(input, NONE));
+    types.push_back(filter->dstType);
+    return n;
+}
+
+int FilterPipeline::addOp(const Ptr<BasePipelineOp>& op, int dstType, int input)
+{
+    return addOp(op, dstType, input, NONE);
+}
+
+int FilterPipeline::addOp(const Ptr<BasePipelineOp>& op, int dstType, int input0, int input1)
+{
+    int n = (int)types.size();
+    CV_Assert( !op.empty() && SOURCE <= input0 && input0 < n && NONE <= input1 && input1 < n );
+
+    filters.push_back(Ptr<FilterEngine>());
+    ops.push_back(op);
+    inputs.push_back(Vec2i(input0, input1));
+    types.push_back(CV_MAT_TYPE(dstType));
+    return n;
+}
+
+void FilterPipeline::clear()
+{
+    filters.clear();
+    ops.clear();
+    inputs.clear();
+    types.clear();
+}
+
+void FilterPipeline::apply(const Mat& src, Mat& dst)
+{
+    CV_Assert( !types.empty() );
+    dst.create(src.size(), types.back());
+    apply(src, dst, Range(0, src.rows));
+}
+
+// the pipeline passes about PIPELINE_STRIPE_SIZE bytes of source
+// and intermediate data through all the stages at a time
+enum { PIPELINE_STRIPE_SIZE = 1 << 17 };
+
+struct PipelineStage
+{
+    PipelineStage() : first(0), count(0), isOutput(false)
+    {
+        need = Range(INT_MAX, INT_MIN);
+        pos[0] = pos[1] = 0;
+    }
+
+    void extend(int start, int end)
+    {
+        need.start = std::min(need.start, start);
+        need.end = std::max(need.end, end);
+    }
+
+    bool empty() const { return need.start >= need.end; }
+
+    // the rows of the stage output that are yet to be computed
+    int remaining() const { return need.end - (first + count); }
+
+    // the rows [need.start, need.end) of the stage output are computed;
+    // the rows [first, first + count) of them are currently stored in buf
+    Range need;
+    Mat buf;
+    int first, count;
+    bool isOutput;
+    // the next rows of the inputs the stage will read; the source rows
+    // are counted from the top of src and may be negative if src is a ROI
+    int pos[2];
+};
+
+static void reserveStageRows(std::vector<PipelineStage>& stages, const std::vector<Vec2i>& inputs,
+                             int idx, int n)
+{
+    PipelineStage& s = stages[idx];
+    if( s.count + n <= s.buf.rows )
+        return;
+    CV_Assert( !s.isOutput );
+
+    // drop the rows that all the consumers have read already
+    int minPos = s.first + s.count;
+    for( size_t i = idx + 1; i < stages.size(); i++ )
+        for( int j = 0; j < 2; j++ )
+            if( inputs[i][j] == idx && !stages[i].empty() )
+                minPos = std::min(minPos, stages[i].pos[j]);
+    int drop = std::max(minPos - s.first, 0);
+    if( drop > 0 )
+    {
+        if( drop < s.count )
+            memmove( s.buf.data, s.buf.data + drop*s.buf.step, (s.count - drop)*s.buf.step );
+        s.first += drop;
+        s.count -= drop;
+    }
+
+    if( s.count + n > s.buf.rows )
+    {
+        Mat buf(std::max(s.count + n, s.buf.rows*3/2), s.buf.cols, s.buf.type());
+        if( s.count > 0 )
+            s.buf.rowRange(0, s.count).copyTo(buf.rowRange(0, s.count));
+        s.buf = buf;
+    }
+}
+
+void FilterPipeline::apply(const Mat& src, Mat& dst, const Range& rows)
+{
+    int i, j, nstages = (int)types.size();
+    CV_Assert( nstages > 0 && src.dims <= 2 &&
+               dst.size() == src.size() && dst.type() == types.back() &&
+               0 <= rows.start && rows.start <= rows.end && rows.end <= src.rows );
+
+    if( rows.start == rows.end )
+        return;
+
+    std::vector<PipelineStage> stages(nstages);
+    int height = src.rows;
+    size_t rowSize = src.cols*src.elemSize();
+
+    // walk the pipeline backwards, from the rows of dst that are requested
+    // to the rows of every intermediate image that are needed for them
+    stages[nstages-1].need = rows;
+    for( i = nstages - 1; i >= 0; i-- )
+    {
+        PipelineStage& s = stages[i];
+        if( s.empty() )
+            continue;
+        rowSize += src.cols*CV_ELEM_SIZE(types[i]);
+        if( !filters[i].empty() )
+        {
+            const FilterEngine& f = *filters[i];
+            if( inputs[i][0] >= 0 )
+                stages[inputs[i][0]].extend(std::max(s.need.start - f.anchor.y, 0),
+                    std::min(s.need.end + f.ksize.height - f.anchor.y - 1, height));
+            else if( f.srcType != src.type() )
+                CV_Error( CV_StsUnmatchedFormats, "The filter input type does not match the source type" );
+        }
+        else
+        {
+            for( j = 0; j < 2; j++ )
+                if( inputs[i][j] >= 0 )
+                    stages[inputs[i][j]].extend(s.need.start, s.need.end);
+        }
+    }
+
+    int dy0 = std::max((int)(PIPELINE_STRIPE_SIZE/rowSize), 1);
+
+    for( i = 0; i < nstages; i++ )
+    {
+        PipelineStage& s = stages[i];
+        if( s.empty() )
+            continue;
+        s.first = s.need.start;
+        if( i == nstages - 1 )
+        {
+            s.buf = dst.rowRange(s.need);
+            s.isOutput = true;
+        }
+        else
+        {
+            int ksize = 0;
+            for( j = i + 1; j < nstages; j++ )
+                if( !filters[j].empty() )
+                    ksize = std::max(ksize, filters[j]->ksize.height);
+            s.buf.create(std::min(dy0*2 + ksize, s.need.end - s.need.start), src.cols, types[i]);
+        }
+
+        if( !filters[i].empty() )
+        {
+            Rect roi(0, s.need.start, src.cols, s.need.end - s.need.start);
+            if( inputs[i][0] >= 0 )
+                s.pos[0] = filters[i]->start(Size(src.cols, height), roi);
+            else
+                s.pos[0] = filters[i]->start(src, roi);
+        }
+        else
+            s.pos[0] = s.pos[1] = s.need.start;
+    }
+
+    Mat blocks[2];
+
+    while( stages[nstages-1].remaining() > 0 )
+    {
+        bool progress = false;
+
+        for( i = 0; i < nstages; i++ )
+        {
+            PipelineStage& s = stages[i];
+            if( s.empty() || s.remaining() == 0 )
+                continue;
+
+            if( !filters[i].empty() )
+            {
+                FilterEngine& f = *filters[i];
+                int in = inputs[i][0];
+                int n = f.remainingInputRows();
+                const uchar* sptr;
+                int sstep;
+
+                if( in >= 0 )
+                {
+                    const PipelineStage& is = stages[in];
+                    n = std::min(n, is.first + is.count - s.pos[0]);
+                    sptr = is.buf.data + (s.pos[0] - is.first)*is.buf.step;
+                    sstep = (int)is.buf.step;
+                }
+                else
+                {
+                    n = std::min(n, dy0);
+                    sptr = src.data + s.pos[0]*src.step;
+                    sstep = (int)src.step;
+                }
+                if( n <= 0 )
+                    continue;
+
+                // at the end of the image the filter may produce up to ksize.height-1
+                // more rows than it is given
+                reserveStageRows(stages, inputs, i, std::min(n + f.ksize.height, s.remaining()));
+                int dy = f.proceed( sptr, sstep, n, s.buf.data + s.count*s.buf.step, (int)s.buf.step );
+                s.pos[0] += n;
+                s.count += dy;
+            }
+            else
+            {
+                int nsrc = inputs[i][1] >= 0 || inputs[i][1] == SOURCE ? 2 : 1;
+                int n = std::min(s.remaining(), dy0);
+                for( j = 0; j < nsrc; j++ )
+                {
+                    int in = inputs[i][j];
+                    if( in >= 0 )
+                        n = std::min(n, stages[in].first + stages[in].count - s.pos[j]);
+                }
+                if( n <= 0 )
+                    continue;
+
+                for( j = 0; j < nsrc; j++ )
+                {
+                    int in = inputs[i][j];
+                    blocks[j] = in >= 0 ? stages[in].buf.rowRange(s.pos[j] - stages[in].first, s.pos[j] - stages[in].first + n) :
+                                          src.rowRange(s.pos[j], s.pos[j] + n);
+                }
+
+                reserveStageRows(stages, inputs, i, n);
+                Mat dstBlock = s.buf.rowRange(s.count, s.count + n);
+                uchar* dstData = dstBlock.data;
+                (*ops[i])(blocks, nsrc, dstBlock);
+                if( dstBlock.data != dstData )
+                    CV_Error( CV_StsUnmatchedFormats,
+                        "The pipeline operation did not write into the output block; check the type of the stage" );
+                s.pos[0] += n;
+                s.pos[1] += n;
+                s.count += n;
+            }
+            progress = true;
+        }
+
+        CV_Assert( progress );
+    }
+}
+
+}
+
+/* End of file. */
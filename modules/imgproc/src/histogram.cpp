@@ -165,13 +165,11 @@ static void histPrepareImages( const Mat* images, int nimages, const int* channe
         deltas[dims*2 + 1] = (int)(mask.step/mask.elemSize1());
     }
 
-#ifndef HAVE_TBB
     if( isContinuous )
     {
         imsize.width *= imsize.height;
         imsize.height = 1;
     }
-#endif
 
     if( !ranges )
     {
@@ -209,538 +207,6 @@ static void histPrepareImages( const Mat* images, int nimages, const int* channe
 
 
 ////////////////////////////////// C A L C U L A T E    H I S T O G R A M ////////////////////////////////////
-#ifdef HAVE_TBB
-enum {one = 1, two, three}; // array elements number
-
-template<typename T>
-class calcHist1D_Invoker
-{
-public:
-    calcHist1D_Invoker( const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                        Mat& hist, const double* _uniranges, int sz, int dims,
-                        Size& imageSize )
-        : mask_(_ptrs[dims]),
-          mstep_(_deltas[dims*2 + 1]),
-          imageWidth_(imageSize.width),
-          histogramSize_(hist.size()), histogramType_(hist.type()),
-          globalHistogram_((tbb::atomic<int>*)hist.data)
-    {
-        p_[0] = ((T**)&_ptrs[0])[0];
-        step_[0] = (&_deltas[0])[1];
-        d_[0] = (&_deltas[0])[0];
-        a_[0] = (&_uniranges[0])[0];
-        b_[0] = (&_uniranges[0])[1];
-        size_[0] = sz;
-    }
-
-    void operator()( const BlockedRange& range ) const
-    {
-        T* p0 = p_[0] + range.begin() * (step_[0] + imageWidth_*d_[0]);
-        uchar* mask = mask_ + range.begin()*mstep_;
-
-        for( int row = range.begin(); row < range.end(); row++, p0 += step_[0] )
-        {
-            if( !mask_ )
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0] )
-                {
-                    int idx = cvFloor(*p0*a_[0] + b_[0]);
-                    if( (unsigned)idx < (unsigned)size_[0] )
-                    {
-                        globalHistogram_[idx].fetch_and_add(1);
-                    }
-                }
-            }
-            else
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0] )
-                {
-                    if( mask[x] )
-                    {
-                        int idx = cvFloor(*p0*a_[0] + b_[0]);
-                        if( (unsigned)idx < (unsigned)size_[0] )
-                        {
-                            globalHistogram_[idx].fetch_and_add(1);
-                        }
-                    }
-                }
-                mask += mstep_;
-            }
-        }
-    }
-
-private:
-    T* p_[one];
-    uchar* mask_;
-    int step_[one];
-    int d_[one];
-    int mstep_;
-    double a_[one];
-    double b_[one];
-    int size_[one];
-    int imageWidth_;
-    Size histogramSize_;
-    int histogramType_;
-    tbb::atomic<int>* globalHistogram_;
-};
-
-template<typename T>
-class calcHist2D_Invoker
-{
-public:
-    calcHist2D_Invoker( const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                        Mat& hist, const double* _uniranges, const int* size,
-                        int dims, Size& imageSize, size_t* hstep )
-        : mask_(_ptrs[dims]),
-          mstep_(_deltas[dims*2 + 1]),
-          imageWidth_(imageSize.width),
-          histogramSize_(hist.size()), histogramType_(hist.type()),
-          globalHistogram_(hist.data)
-    {
-        p_[0] = ((T**)&_ptrs[0])[0]; p_[1] = ((T**)&_ptrs[0])[1];
-        step_[0] = (&_deltas[0])[1]; step_[1] = (&_deltas[0])[3];
-        d_[0] = (&_deltas[0])[0];    d_[1] = (&_deltas[0])[2];
-        a_[0] = (&_uniranges[0])[0]; a_[1] = (&_uniranges[0])[2];
-        b_[0] = (&_uniranges[0])[1]; b_[1] = (&_uniranges[0])[3];
-        size_[0] = size[0];          size_[1] = size[1];
-        hstep_[0] = hstep[0];
-    }
-
-    void operator()(const BlockedRange& range) const
-    {
-        T* p0 = p_[0] + range.begin()*(step_[0] + imageWidth_*d_[0]);
-        T* p1 = p_[1] + range.begin()*(step_[1] + imageWidth_*d_[1]);
-        uchar* mask = mask_ + range.begin()*mstep_;
-
-        for( int row = range.begin(); row < range.end(); row++, p0 += step_[0], p1 += step_[1] )
-        {
-            if( !mask_ )
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1] )
-                {
-                    int idx0 = cvFloor(*p0*a_[0] + b_[0]);
-                    int idx1 = cvFloor(*p1*a_[1] + b_[1]);
-                    if( (unsigned)idx0 < (unsigned)size_[0] && (unsigned)idx1 < (unsigned)size_[1] )
-                        ( (tbb::atomic<int>*)(globalHistogram_ + hstep_[0]*idx0) )[idx1].fetch_and_add(1);
-                }
-            }
-            else
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1] )
-                {
-                    if( mask[x] )
-                    {
-                        int idx0 = cvFloor(*p0*a_[0] + b_[0]);
-                        int idx1 = cvFloor(*p1*a_[1] + b_[1]);
-                        if( (unsigned)idx0 < (unsigned)size_[0] && (unsigned)idx1 < (unsigned)size_[1] )
-                            ((tbb::atomic<int>*)(globalHistogram_ + hstep_[0]*idx0))[idx1].fetch_and_add(1);
-                    }
-                }
-                mask += mstep_;
-            }
-        }
-    }
-
-private:
-    T* p_[two];
-    uchar* mask_;
-    int step_[two];
-    int d_[two];
-    int mstep_;
-    double a_[two];
-    double b_[two];
-    int size_[two];
-    const int imageWidth_;
-    size_t hstep_[one];
-    Size histogramSize_;
-    int histogramType_;
-    uchar* globalHistogram_;
-};
-
-
-template<typename T>
-class calcHist3D_Invoker
-{
-public:
-    calcHist3D_Invoker( const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                        Size imsize, Mat& hist, const double* uniranges, int _dims,
-                        size_t* hstep, int* size )
-        : mask_(_ptrs[_dims]),
-          mstep_(_deltas[_dims*2 + 1]),
-          imageWidth_(imsize.width),
-          globalHistogram_(hist.data)
-    {
-        p_[0] = ((T**)&_ptrs[0])[0]; p_[1] = ((T**)&_ptrs[0])[1]; p_[2] = ((T**)&_ptrs[0])[2];
-        step_[0] = (&_deltas[0])[1]; step_[1] = (&_deltas[0])[3]; step_[2] = (&_deltas[0])[5];
-        d_[0] = (&_deltas[0])[0];    d_[1] = (&_deltas[0])[2];    d_[2] = (&_deltas[0])[4];
-        a_[0] = uniranges[0];        a_[1] = uniranges[2];        a_[2] = uniranges[4];
-        b_[0] = uniranges[1];        b_[1] = uniranges[3];        b_[2] = uniranges[5];
-        size_[0] = size[0];          size_[1] = size[1];          size_[2] = size[2];
-        hstep_[0] = hstep[0];        hstep_[1] = hstep[1];
-    }
-
-    void operator()( const BlockedRange& range ) const
-    {
-        T* p0 = p_[0] + range.begin()*(imageWidth_*d_[0] + step_[0]);
-        T* p1 = p_[1] + range.begin()*(imageWidth_*d_[1] + step_[1]);
-        T* p2 = p_[2] + range.begin()*(imageWidth_*d_[2] + step_[2]);
-        uchar* mask = mask_ + range.begin()*mstep_;
-
-        for( int i = range.begin(); i < range.end(); i++, p0 += step_[0], p1 += step_[1], p2 += step_[2] )
-        {
-            if( !mask_ )
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1], p2 += d_[2] )
-                {
-                    int idx0 = cvFloor(*p0*a_[0] + b_[0]);
-                    int idx1 = cvFloor(*p1*a_[1] + b_[1]);
-                    int idx2 = cvFloor(*p2*a_[2] + b_[2]);
-                    if( (unsigned)idx0 < (unsigned)size_[0] &&
-                            (unsigned)idx1 < (unsigned)size_[1] &&
-                            (unsigned)idx2 < (unsigned)size_[2] )
-                    {
-                        ( (tbb::atomic<int>*)(globalHistogram_ + hstep_[0]*idx0 + hstep_[1]*idx1) )[idx2].fetch_and_add(1);
-                    }
-                }
-            }
-            else
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1], p2 += d_[2] )
-                {
-                    if( mask[x] )
-                    {
-                        int idx0 = cvFloor(*p0*a_[0] + b_[0]);
-                        int idx1 = cvFloor(*p1*a_[1] + b_[1]);
-                        int idx2 = cvFloor(*p2*a_[2] + b_[2]);
-                        if( (unsigned)idx0 < (unsigned)size_[0] &&
-                                (unsigned)idx1 < (unsigned)size_[1] &&
-                                (unsigned)idx2 < (unsigned)size_[2] )
-                        {
-                            ( (tbb::atomic<int>*)(globalHistogram_ + hstep_[0]*idx0 + hstep_[1]*idx1) )[idx2].fetch_and_add(1);
-                        }
-                    }
-                }
-                mask += mstep_;
-            }
-        }
-    }
-
-    static bool isFit( const Mat& histogram, const Size imageSize )
-    {
-        return ( imageSize.width * imageSize.height >= 320*240
-                 && histogram.total() >= 8*8*8 );
-    }
-
-private:
-    T* p_[three];
-    uchar* mask_;
-    int step_[three];
-    int d_[three];
-    const int mstep_;
-    double a_[three];
-    double b_[three];
-    int size_[three];
-    int imageWidth_;
-    size_t hstep_[two];
-    uchar* globalHistogram_;
-};
-
-class CalcHist1D_8uInvoker
-{
-public:
-    CalcHist1D_8uInvoker( const std::vector<uchar*>& ptrs, const std::vector<int>& deltas,
-                          Size imsize, Mat& hist, int dims, const std::vector<size_t>& tab,
-                          tbb::mutex* lock )
-        : mask_(ptrs[dims]),
-          mstep_(deltas[dims*2 + 1]),
-          imageWidth_(imsize.width),
-          imageSize_(imsize),
-          histSize_(hist.size()), histType_(hist.type()),
-          tab_((size_t*)&tab[0]),
-          histogramWriteLock_(lock),
-          globalHistogram_(hist.data)
-    {
-        p_[0] = (&ptrs[0])[0];
-        step_[0] = (&deltas[0])[1];
-        d_[0] = (&deltas[0])[0];
-    }
-
-    void operator()( const BlockedRange& range ) const
-    {
-        int localHistogram[256] = { 0, };
-        uchar* mask = mask_;
-        uchar* p0 = p_[0];
-        int x;
-        tbb::mutex::scoped_lock lock;
-
-        if( !mask_ )
-        {
-            int n = (imageWidth_ - 4) / 4 + 1;
-            int tail = imageWidth_ - n*4;
-
-            int xN = 4*n;
-            p0 += (xN*d_[0] + tail*d_[0] + step_[0]) * range.begin();
-        }
-        else
-        {
-            p0 += (imageWidth_*d_[0] + step_[0]) * range.begin();
-            mask += mstep_*range.begin();
-        }
-
-        for( int i = range.begin(); i < range.end(); i++, p0 += step_[0] )
-        {
-            if( !mask_ )
-            {
-                if( d_[0] == 1 )
-                {
-                    for( x = 0; x <= imageWidth_ - 4; x += 4 )
-                    {
-                        int t0 = p0[x], t1 = p0[x+1];
-                        localHistogram[t0]++; localHistogram[t1]++;
-                        t0 = p0[x+2]; t1 = p0[x+3];
-                        localHistogram[t0]++; localHistogram[t1]++;
-                    }
-                    p0 += x;
-                }
-                else
-                {
-                    for( x = 0; x <= imageWidth_ - 4; x += 4 )
-                    {
-                        int t0 = p0[0], t1 = p0[d_[0]];
-                        localHistogram[t0]++; localHistogram[t1]++;
-                        p0 += d_[0]*2;
-                        t0 = p0[0]; t1 = p0[d_[0]];
-                        localHistogram[t0]++; localHistogram[t1]++;
-                        p0 += d_[0]*2;
-                    }
-                }
-
-                for( ; x < imageWidth_; x++, p0 += d_[0] )
-                {
-                    localHistogram[*p0]++;
-                }
-            }
-            else
-            {
-                for( x = 0; x < imageWidth_; x++, p0 += d_[0] )
-                {
-                    if( mask[x] )
-                    {
-                        localHistogram[*p0]++;
-                    }
-                }
-                mask += mstep_;
-            }
-        }
-
-        lock.acquire(*histogramWriteLock_);
-        for(int i = 0; i < 256; i++ )
-        {
-            size_t hidx = tab_[i];
-            if( hidx < OUT_OF_RANGE )
-            {
-                *(int*)((globalHistogram_ + hidx)) += localHistogram[i];
-            }
-        }
-        lock.release();
-    }
-
-    static bool isFit( const Mat& histogram, const Size imageSize )
-    {
-        return ( histogram.total() >= 8
-                && imageSize.width * imageSize.height >= 160*120 );
-    }
-
-private:
-    uchar* p_[one];
-    uchar* mask_;
-    int mstep_;
-    int step_[one];
-    int d_[one];
-    int imageWidth_;
-    Size imageSize_;
-    Size histSize_;
-    int histType_;
-    size_t* tab_;
-    tbb::mutex* histogramWriteLock_;
-    uchar* globalHistogram_;
-};
-
-class CalcHist2D_8uInvoker
-{
-public:
-    CalcHist2D_8uInvoker( const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                          Size imsize, Mat& hist, int dims, const std::vector<size_t>& _tab,
-                          tbb::mutex* lock )
-        : mask_(_ptrs[dims]),
-          mstep_(_deltas[dims*2 + 1]),
-          imageWidth_(imsize.width),
-          histSize_(hist.size()), histType_(hist.type()),
-          tab_((size_t*)&_tab[0]),
-          histogramWriteLock_(lock),
-          globalHistogram_(hist.data)
-    {
-        p_[0] = (uchar*)(&_ptrs[0])[0]; p_[1] = (uchar*)(&_ptrs[0])[1];
-        step_[0] = (&_deltas[0])[1];    step_[1] = (&_deltas[0])[3];
-        d_[0] = (&_deltas[0])[0];       d_[1] = (&_deltas[0])[2];
-    }
-
-    void operator()( const BlockedRange& range ) const
-    {
-        uchar* p0 = p_[0] + range.begin()*(step_[0] + imageWidth_*d_[0]);
-        uchar* p1 = p_[1] + range.begin()*(step_[1] + imageWidth_*d_[1]);
-        uchar* mask = mask_ + range.begin()*mstep_;
-
-        Mat localHist = Mat::zeros(histSize_, histType_);
-        uchar* localHistData = localHist.data;
-        tbb::mutex::scoped_lock lock;
-
-        for(int i = range.begin(); i < range.end(); i++, p0 += step_[0], p1 += step_[1])
-        {
-            if( !mask_ )
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1] )
-                {
-                    size_t idx = tab_[*p0] + tab_[*p1 + 256];
-                    if( idx < OUT_OF_RANGE )
-                    {
-                        ++*(int*)(localHistData + idx);
-                    }
-                }
-            }
-            else
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1] )
-                {
-                    size_t idx;
-                    if( mask[x] && (idx = tab_[*p0] + tab_[*p1 + 256]) < OUT_OF_RANGE )
-                    {
-                        ++*(int*)(localHistData + idx);
-                    }
-                }
-                mask += mstep_;
-            }
-        }
-
-        lock.acquire(*histogramWriteLock_);
-        for(int i = 0; i < histSize_.width*histSize_.height; i++)
-        {
-            ((int*)globalHistogram_)[i] += ((int*)localHistData)[i];
-        }
-        lock.release();
-    }
-
-    static bool isFit( const Mat& histogram, const Size imageSize )
-    {
-        return ( (histogram.total() > 4*4 &&  histogram.total() <= 116*116
-                  && imageSize.width * imageSize.height >= 320*240)
-                 || (histogram.total() > 116*116 && imageSize.width * imageSize.height >= 1280*720) );
-    }
-
-private:
-    uchar* p_[two];
-    uchar* mask_;
-    int step_[two];
-    int d_[two];
-    int mstep_;
-    int imageWidth_;
-    Size histSize_;
-    int histType_;
-    size_t* tab_;
-    tbb::mutex* histogramWriteLock_;
-    uchar* globalHistogram_;
-};
-
-class CalcHist3D_8uInvoker
-{
-public:
-    CalcHist3D_8uInvoker( const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                          Size imsize, Mat& hist, int dims, const std::vector<size_t>& tab )
-        : mask_(_ptrs[dims]),
-          mstep_(_deltas[dims*2 + 1]),
-          histogramSize_(hist.size.p), histogramType_(hist.type()),
-          imageWidth_(imsize.width),
-          tab_((size_t*)&tab[0]),
-          globalHistogram_(hist.data)
-    {
-        p_[0] = (uchar*)(&_ptrs[0])[0]; p_[1] = (uchar*)(&_ptrs[0])[1]; p_[2] = (uchar*)(&_ptrs[0])[2];
-        step_[0] = (&_deltas[0])[1];    step_[1] = (&_deltas[0])[3];    step_[2] = (&_deltas[0])[5];
-        d_[0] = (&_deltas[0])[0];       d_[1] = (&_deltas[0])[2];       d_[2] = (&_deltas[0])[4];
-    }
-
-    void operator()( const BlockedRange& range ) const
-    {
-        uchar* p0 = p_[0] + range.begin()*(step_[0] + imageWidth_*d_[0]);
-        uchar* p1 = p_[1] + range.begin()*(step_[1] + imageWidth_*d_[1]);
-        uchar* p2 = p_[2] + range.begin()*(step_[2] + imageWidth_*d_[2]);
-        uchar* mask = mask_ + range.begin()*mstep_;
-
-        for(int i = range.begin(); i < range.end(); i++, p0 += step_[0], p1 += step_[1], p2 += step_[2] )
-        {
-            if( !mask_ )
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1], p2 += d_[2] )
-                {
-                    size_t idx = tab_[*p0] + tab_[*p1 + 256] + tab_[*p2 + 512];
-                    if( idx < OUT_OF_RANGE )
-                    {
-                        ( *(tbb::atomic<int>*)(globalHistogram_ + idx) ).fetch_and_add(1);
-                    }
-                }
-            }
-            else
-            {
-                for( int x = 0; x < imageWidth_; x++, p0 += d_[0], p1 += d_[1], p2 += d_[2] )
-                {
-                    size_t idx;
-                    if( mask[x] && (idx = tab_[*p0] + tab_[*p1 + 256] + tab_[*p2 + 512]) < OUT_OF_RANGE )
-                    {
-                        (*(tbb::atomic<int>*)(globalHistogram_ + idx)).fetch_and_add(1);
-                    }
-                }
-                mask += mstep_;
-            }
-        }
-    }
-
-    static bool isFit( const Mat& histogram, const Size imageSize )
-    {
-        return ( histogram.total() >= 128*128*128
-                 && imageSize.width * imageSize.width >= 320*240 );
-    }
-
-private:
-    uchar* p_[three];
-    uchar* mask_;
-    int mstep_;
-    int step_[three];
-    int d_[three];
-    int* histogramSize_;
-    int histogramType_;
-    int imageWidth_;
-    size_t* tab_;
-    uchar* globalHistogram_;
-};
-
-static void
-callCalcHist2D_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                   Size imsize, Mat& hist, int dims,  std::vector<size_t>& _tab )
-{
-    int grainSize = imsize.height / tbb::task_scheduler_init::default_num_threads();
-    tbb::mutex histogramWriteLock;
-
-    CalcHist2D_8uInvoker body(_ptrs, _deltas, imsize, hist, dims, _tab, &histogramWriteLock);
-    parallel_for(BlockedRange(0, imsize.height, grainSize), body);
-}
-
-static void
-callCalcHist3D_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                   Size imsize, Mat& hist, int dims,  std::vector<size_t>& _tab )
-{
-    CalcHist3D_8uInvoker body(_ptrs, _deltas, imsize, hist, dims, _tab);
-    parallel_for(BlockedRange(0, imsize.height), body);
-}
-#endif
 
 template<typename T> static void
 calcHist_( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
@@ -768,11 +234,6 @@ calcHist_( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
 
         if( dims == 1 )
         {
-#ifdef HAVE_TBB
-            calcHist1D_Invoker<T> body(_ptrs, _deltas, hist, _uniranges, size[0], dims, imsize);
-            parallel_for(BlockedRange(0, imsize.height), body);
-            return;
-#endif
             double a = uniranges[0], b = uniranges[1];
             int sz = size[0], d0 = deltas[0], step0 = deltas[1];
             const T* p0 = (const T*)ptrs[0];
@@ -798,11 +259,6 @@ calcHist_( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
         }
         else if( dims == 2 )
         {
-#ifdef HAVE_TBB
-            calcHist2D_Invoker<T> body(_ptrs, _deltas, hist, _uniranges, size, dims, imsize, hstep);
-            parallel_for(BlockedRange(0, imsize.height), body);
-            return;
-#endif
             double a0 = uniranges[0], b0 = uniranges[1], a1 = uniranges[2], b1 = uniranges[3];
             int sz0 = size[0], sz1 = size[1];
             int d0 = deltas[0], step0 = deltas[1],
@@ -834,14 +290,6 @@ calcHist_( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
         }
         else if( dims == 3 )
         {
-#ifdef HAVE_TBB
-            if( calcHist3D_Invoker<T>::isFit(hist, imsize) )
-            {
-                calcHist3D_Invoker<T> body(_ptrs, _deltas, imsize, hist, uniranges, dims, hstep, size);
-                parallel_for(BlockedRange(0, imsize.height), body);
-                return;
-            }
-#endif
             double a0 = uniranges[0], b0 = uniranges[1],
                    a1 = uniranges[2], b1 = uniranges[3],
                    a2 = uniranges[4], b2 = uniranges[5];
@@ -975,6 +423,165 @@ calcHist_( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
 }
 
 
+// Big images are processed in parallel stripes. The histogram of every stripe is
+// collected separately and the partial histograms are summed up in the stripe order.
+enum { HIST_PARALLEL_MIN_SIZE = 1 << 16, HIST_MIN_STRIPE_SIZE = 1 << 15 };
+
+// every stripe clears and sums up a partial histogram of nbins bins,
+// so a stripe should have several pixels per bin
+static int histNumStripes( Size imsize, size_t nbins=256 )
+{
+    double total = (double)imsize.width*imsize.height;
+    if( total < HIST_PARALLEL_MIN_SIZE )
+        return 1;
+    double maxStripes = std::min(total/std::max((double)HIST_MIN_STRIPE_SIZE, nbins*4.),
+                                 (double)(imsize.height > 1 ? imsize.height : imsize.width));
+    return std::max(std::min(getNumThreads(), (int)maxStripes), 1);
+}
+
+// the part of the images (and of the mask or the back projection), described by ptrs and deltas
+// as histPrepareImages() prepares them, that stripe k of nStripes covers. The stripes are bands
+// of rows, or bands of columns when the continuous images have been merged into a single row.
+// esz is the size of the image elements; the mask and the 8-bit back projection have 1-byte elements.
+static Size histStripe( const std::vector<uchar*>& ptrs, const std::vector<int>& deltas,
+                        int dims, Size imsize, int k, int nStripes, std::vector<uchar*>& sptrs,
+                        size_t esz=1 )
+{
+    bool byRows = imsize.height > 1;
+    int len = byRows ? imsize.height : imsize.width;
+    int start = (int)((int64)k*len/nStripes), end = (int)((int64)(k + 1)*len/nStripes);
+
+    sptrs.assign(ptrs.begin(), ptrs.end());
+    for( int i = 0; i <= dims; i++ )
+    {
+        if( !sptrs[i] )
+            continue;
+        size_t ofs;
+        if( !byRows )
+            ofs = (size_t)start*deltas[i*2];
+        else if( i < dims )
+            ofs = (size_t)start*(imsize.width*deltas[i*2] + deltas[i*2 + 1]);
+        else
+            ofs = (size_t)start*deltas[i*2 + 1];
+        sptrs[i] += i < dims ? ofs*esz : ofs;
+    }
+    return byRows ? Size(imsize.width, end - start) : Size(end - start, 1);
+}
+
+// Counts the values of a single 8-bit channel into the 256 bins of hist.
+// Runs of equal values are typical for images, so the consecutive pixels go to 4 different
+// sub-histograms: an increment does not have to wait for the previous store to the same bin.
+static void calcHist1D_8u( const uchar* p0, int d0, int step0, const uchar* mask, int mstep,
+                           Size imsize, int* hist )
+{
+    int subHists[4][256];
+    int x;
+
+    memset(subHists, 0, sizeof(subHists));
+    for( ; imsize.height--; p0 += step0, mask += mask ? mstep : 0 )
+    {
+        if( !mask )
+        {
+            if( d0 == 1 )
+            {
+                // read 4 pixels at once; which byte goes to which sub-histogram does not matter
+                for( x = 0; x <= imsize.width - 8; x += 8 )
+                {
+                    unsigned v0, v1;
+                    memcpy(&v0, p0 + x, sizeof(v0));
+                    memcpy(&v1, p0 + x + 4, sizeof(v1));
+                    subHists[0][v0 & 255]++; subHists[1][(v0 >> 8) & 255]++;
+                    subHists[2][(v0 >> 16) & 255]++; subHists[3][v0 >> 24]++;
+                    subHists[0][v1 & 255]++; subHists[1][(v1 >> 8) & 255]++;
+                    subHists[2][(v1 >> 16) & 255]++; subHists[3][v1 >> 24]++;
+                }
+                p0 += x;
+            }
+            else
+                for( x = 0; x <= imsize.width - 4; x += 4, p0 += d0*4 )
+                {
+                    subHists[0][p0[0]]++; subHists[1][p0[d0]]++;
+                    subHists[2][p0[d0*2]]++; subHists[3][p0[d0*3]]++;
+                }
+
+            for( ; x < imsize.width; x++, p0 += d0 )
+                subHists[0][*p0]++;
+        }
+        else
+            for( x = 0; x < imsize.width; x++, p0 += d0 )
+                if( mask[x] )
+                    subHists[x & 3][*p0]++;
+    }
+
+    for( int i = 0; i < 256; i++ )
+        hist[i] = subHists[0][i] + subHists[1][i] + subHists[2][i] + subHists[3][i];
+}
+
+class CalcHist1D_8uInvoker : public ParallelLoopBody
+{
+public:
+    CalcHist1D_8uInvoker( const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
+                          Size _imsize, int _nStripes, int* _partialHists )
+        : ptrs(_ptrs), deltas(_deltas), imsize(_imsize), nStripes(_nStripes),
+          partialHists(_partialHists) {}
+
+    void operator()( const Range& range ) const
+    {
+        std::vector<uchar*> sptrs;
+        for( int k = range.start; k < range.end; k++ )
+        {
+            Size ssize = histStripe(ptrs, deltas, 1, imsize, k, nStripes, sptrs);
+            calcHist1D_8u(sptrs[0], deltas[0], deltas[1], sptrs[1], deltas[3],
+                          ssize, partialHists + k*256);
+        }
+    }
+
+private:
+    const std::vector<uchar*>& ptrs;
+    const std::vector<int>& deltas;
+    Size imsize;
+    int nStripes;
+    int* partialHists;
+};
+
+// the histogram of the first image channel, described by ptrs and deltas as histPrepareImages() prepares them
+static void calcHist1D_8u( const std::vector<uchar*>& ptrs, const std::vector<int>& deltas,
+                           Size imsize, int* hist )
+{
+    int nStripes = histNumStripes(imsize);
+    AutoBuffer<int> _partialHists(nStripes*256);
+    int* partialHists = _partialHists;
+    CalcHist1D_8uInvoker body(ptrs, deltas, imsize, nStripes, partialHists);
+
+    if( nStripes > 1 )
+        parallel_for_(Range(0, nStripes), body, nStripes);
+    else
+        body(Range(0, 1));
+
+    for( int i = 0; i < 256; i++ )
+    {
+        int sum = 0;
+        for( int k = 0; k < nStripes; k++ )
+            sum += partialHists[k*256 + i];
+        hist[i] = sum;
+    }
+}
+
+void calcHist_8uC1( const Mat& src, int* hist )
+{
+    CV_Assert( src.type() == CV_8UC1 );
+
+    std::vector<uchar*> ptrs;
+    std::vector<int> deltas;
+    std::vector<double> uniranges;
+    Size imsize;
+    int channel = 0, histSize = 256;
+
+    histPrepareImages( &src, 1, &channel, Mat(), 1, &histSize, 0, true, ptrs, deltas, imsize, uniranges );
+    calcHist1D_8u( ptrs, deltas, imsize, hist );
+}
+
+
 static void
 calcHist_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
              Size imsize, Mat& hist, int dims, const float** _ranges,
@@ -993,58 +600,10 @@ calcHist_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
 
     if( dims == 1 )
     {
-#ifdef HAVE_TBB
-        if( CalcHist1D_8uInvoker::isFit(hist, imsize) )
-        {
-            int treadsNumber = tbb::task_scheduler_init::default_num_threads();
-            int grainSize = imsize.height/treadsNumber;
-            tbb::mutex histogramWriteLock;
-
-            CalcHist1D_8uInvoker body(_ptrs, _deltas, imsize, hist, dims, _tab, &histogramWriteLock);
-            parallel_for(BlockedRange(0, imsize.height, grainSize), body);
-            return;
-        }
-#endif
-        int d0 = deltas[0], step0 = deltas[1];
-        int matH[256] = { 0, };
-        const uchar* p0 = (const uchar*)ptrs[0];
+        int matH[256];
+        calcHist1D_8u(_ptrs, _deltas, imsize, matH);
 
-        for( ; imsize.height--; p0 += step0, mask += mstep )
-        {
-            if( !mask )
-            {
-                if( d0 == 1 )
-                {
-                    for( x = 0; x <= imsize.width - 4; x += 4 )
-                    {
-                        int t0 = p0[x], t1 = p0[x+1];
-                        matH[t0]++; matH[t1]++;
-                        t0 = p0[x+2]; t1 = p0[x+3];
-                        matH[t0]++; matH[t1]++;
-                    }
-                    p0 += x;
-                }
-                else
-                    for( x = 0; x <= imsize.width - 4; x += 4 )
-                    {
-                        int t0 = p0[0], t1 = p0[d0];
-                        matH[t0]++; matH[t1]++;
-                        p0 += d0*2;
-                        t0 = p0[0]; t1 = p0[d0];
-                        matH[t0]++; matH[t1]++;
-                        p0 += d0*2;
-                    }
-
-                for( ; x < imsize.width; x++, p0 += d0 )
-                    matH[*p0]++;
-            }
-            else
-                for( x = 0; x < imsize.width; x++, p0 += d0 )
-                    if( mask[x] )
-                        matH[*p0]++;
-        }
-
-        for(int i = 0; i < 256; i++ )
+        for( int i = 0; i < 256; i++ )
         {
             size_t hidx = tab[i];
             if( hidx < OUT_OF_RANGE )
@@ -1053,13 +612,6 @@ calcHist_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
     }
     else if( dims == 2 )
     {
-#ifdef HAVE_TBB
-        if( CalcHist2D_8uInvoker::isFit(hist, imsize) )
-        {
-            callCalcHist2D_8u(_ptrs, _deltas, imsize, hist, dims, _tab);
-            return;
-        }
-#endif
         int d0 = deltas[0], step0 = deltas[1],
             d1 = deltas[2], step1 = deltas[3];
         const uchar* p0 = (const uchar*)ptrs[0];
@@ -1085,13 +637,6 @@ calcHist_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
     }
     else if( dims == 3 )
     {
-#ifdef HAVE_TBB
-        if( CalcHist3D_8uInvoker::isFit(hist, imsize) )
-        {
-            callCalcHist3D_8u(_ptrs, _deltas, imsize, hist, dims, _tab);
-            return;
-        }
-#endif
         int d0 = deltas[0], step0 = deltas[1],
             d1 = deltas[2], step1 = deltas[3],
             d2 = deltas[4], step2 = deltas[5];
@@ -1169,6 +714,71 @@ calcHist_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
     }
 }
 
+
+typedef void (*CalcHistFunc)( std::vector<uchar*>& ptrs, const std::vector<int>& deltas,
+                              Size imsize, Mat& hist, int dims, const float** ranges,
+                              const double* uniranges, bool uniform );
+
+class CalcHistInvoker : public ParallelLoopBody
+{
+public:
+    CalcHistInvoker( CalcHistFunc _func, const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
+                     Size _imsize, size_t _esz, const Mat& _hist, int _dims, const float** _ranges,
+                     const double* _uniranges, bool _uniform, int _nStripes, Mat* _partialHists )
+        : func(_func), ptrs(_ptrs), deltas(_deltas), imsize(_imsize), esz(_esz), hist(_hist),
+          dims(_dims), ranges(_ranges), uniranges(_uniranges), uniform(_uniform),
+          nStripes(_nStripes), partialHists(_partialHists) {}
+
+    void operator()( const Range& range ) const
+    {
+        std::vector<uchar*> sptrs;
+        for( int k = range.start; k < range.end; k++ )
+        {
+            Size ssize = histStripe(ptrs, deltas, dims, imsize, k, nStripes, sptrs, esz);
+            // the partial histogram has the layout of hist, so that the lookup tables fit it
+            Mat& h = partialHists[k];
+            h.create(hist.dims, hist.size.p, CV_32S);
+            h = Scalar::all(0);
+            func(sptrs, deltas, ssize, h, dims, ranges, uniranges, uniform);
+        }
+    }
+
+private:
+    CalcHistFunc func;
+    const std::vector<uchar*>& ptrs;
+    const std::vector<int>& deltas;
+    Size imsize;
+    size_t esz;
+    const Mat& hist;
+    int dims;
+    const float** ranges;
+    const double* uniranges;
+    bool uniform;
+    int nStripes;
+    Mat* partialHists;
+};
+
+// adds the histogram of the images, computed by func in parallel stripes, to the CV_32S hist
+static void
+calcHistStripes( CalcHistFunc func, std::vector<uchar*>& ptrs, const std::vector<int>& deltas,
+                 Size imsize, size_t esz, Mat& hist, int dims, const float** ranges,
+                 const double* uniranges, bool uniform )
+{
+    int nStripes = histNumStripes(imsize, hist.total());
+    if( nStripes <= 1 )
+    {
+        func(ptrs, deltas, imsize, hist, dims, ranges, uniranges, uniform);
+        return;
+    }
+
+    std::vector<Mat> partialHists(nStripes);
+    parallel_for_(Range(0, nStripes),
+                  CalcHistInvoker(func, ptrs, deltas, imsize, esz, hist, dims, ranges,
+                                  uniranges, uniform, nStripes, &partialHists[0]), nStripes);
+    for( int k = 0; k < nStripes; k++ )
+        add(hist, partialHists[k], hist);
+}
+
 }
 
 void cv::calcHist( const Mat* images, int nimages, const int* channels,
@@ -1201,12 +811,15 @@ void cv::calcHist( const Mat* images, int nimages, const int* channels,
 
     int depth = images[0].depth();
 
-    if( depth == CV_8U )
+    // the 1D 8-bit histogram is counted in parallel stripes by calcHist1D_8u itself
+    if( depth == CV_8U && dims == 1 )
         calcHist_8u(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+    else if( depth == CV_8U )
+        calcHistStripes(calcHist_8u, ptrs, deltas, imsize, sizeof(uchar), ihist, dims, ranges, _uniranges, uniform );
     else if( depth == CV_16U )
-        calcHist_<ushort>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        calcHistStripes(calcHist_<ushort>, ptrs, deltas, imsize, sizeof(ushort), ihist, dims, ranges, _uniranges, uniform );
     else if( depth == CV_32F )
-        calcHist_<float>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        calcHistStripes(calcHist_<float>, ptrs, deltas, imsize, sizeof(float), ihist, dims, ranges, _uniranges, uniform );
     else
         CV_Error(CV_StsUnsupportedFormat, "");
 
@@ -1606,8 +1219,7 @@ calcBackProj_( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
 
 static void
 calcBackProj_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
-                 Size imsize, const Mat& hist, int dims, const float** _ranges,
-                 const double* _uniranges, float scale, bool uniform )
+                 Size imsize, const Mat& hist, int dims, const size_t* tab, float scale )
 {
     uchar** ptrs = &_ptrs[0];
     const int* deltas = &_deltas[0];
@@ -1615,10 +1227,6 @@ calcBackProj_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
     int i, x;
     uchar* bproj = _ptrs[dims];
     int bpstep = _deltas[dims*2 + 1];
-    std::vector<size_t> _tab;
-
-    calcHistLookupTables_8u( hist, SparseMat(), dims, _ranges, _uniranges, uniform, false, _tab );
-    const size_t* tab = &_tab[0];
 
     if( dims == 1 )
     {
@@ -1726,6 +1334,54 @@ calcBackProj_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
     }
 }
 
+class CalcBackProj_8uInvoker : public ParallelLoopBody
+{
+public:
+    CalcBackProj_8uInvoker( const std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
+                            Size _imsize, const Mat& _hist, int _dims, const size_t* _tab,
+                            float _scale, int _nStripes )
+        : ptrs(_ptrs), deltas(_deltas), imsize(_imsize), hist(_hist), dims(_dims), tab(_tab),
+          scale(_scale), nStripes(_nStripes) {}
+
+    void operator()( const Range& range ) const
+    {
+        std::vector<uchar*> sptrs;
+        for( int k = range.start; k < range.end; k++ )
+        {
+            Size ssize = histStripe(ptrs, deltas, dims, imsize, k, nStripes, sptrs);
+            calcBackProj_8u(sptrs, deltas, ssize, hist, dims, tab, scale);
+        }
+    }
+
+private:
+    const std::vector<uchar*>& ptrs;
+    const std::vector<int>& deltas;
+    Size imsize;
+    const Mat& hist;
+    int dims;
+    const size_t* tab;
+    float scale;
+    int nStripes;
+};
+
+static void
+calcBackProj_8u( std::vector<uchar*>& _ptrs, const std::vector<int>& _deltas,
+                 Size imsize, const Mat& hist, int dims, const float** _ranges,
+                 const double* _uniranges, float scale, bool uniform )
+{
+    std::vector<size_t> _tab;
+
+    calcHistLookupTables_8u( hist, SparseMat(), dims, _ranges, _uniranges, uniform, false, _tab );
+
+    int nStripes = histNumStripes(imsize);
+    CalcBackProj_8uInvoker body(_ptrs, _deltas, imsize, hist, dims, &_tab[0], scale, nStripes);
+
+    if( nStripes > 1 )
+        parallel_for_(Range(0, nStripes), body, nStripes);
+    else
+        body(Range(0, 1));
+}
+
 }
 
 void cv::calcBackProject( const Mat* images, int nimages, const int* channels,
@@ -2986,94 +2642,23 @@ cvCalcProbDensity( const CvHistogram* hist, const CvHistogram* hist_mask,
     }
 }
 
-class EqualizeHistCalcHist_Invoker
+class EqualizeHistLut_Invoker : public cv::ParallelLoopBody
 {
 public:
-    enum {HIST_SZ = 256};
-
-#ifdef HAVE_TBB
-    typedef tbb::mutex* MutextPtr;
-#else
-    typedef void* MutextPtr;
-#endif
-
-    EqualizeHistCalcHist_Invoker(cv::Mat& src, int* histogram, MutextPtr histogramLock)
-        : src_(src), globalHistogram_(histogram), histogramLock_(histogramLock)
-    { }
-
-    void operator()( const cv::BlockedRange& rowRange ) const
-    {
-        int localHistogram[HIST_SZ] = {0, };
-
-        const size_t sstep = src_.step;
-
-        int width = src_.cols;
-        int height = rowRange.end() - rowRange.begin();
-
-        if (src_.isContinuous())
-        {
-            width *= height;
-            height = 1;
-        }
-
-        for (const uchar* ptr = src_.ptr<uchar>(rowRange.begin()); height--; ptr += sstep)
-        {
-            int x = 0;
-            for (; x <= width - 4; x += 4)
-            {
-                int t0 = ptr[x], t1 = ptr[x+1];
-                localHistogram[t0]++; localHistogram[t1]++;
-                t0 = ptr[x+2]; t1 = ptr[x+3];
-                localHistogram[t0]++; localHistogram[t1]++;
-            }
-
-            for (; x < width; ++x)
-                localHistogram[ptr[x]]++;
-        }
-
-#ifdef HAVE_TBB
-        tbb::mutex::scoped_lock lock(*histogramLock_);
-#endif
-
-        for( int i = 0; i < HIST_SZ; i++ )
-            globalHistogram_[i] += localHistogram[i];
-    }
-
-    static bool isWorthParallel( const cv::Mat& src )
-    {
-#ifdef HAVE_TBB
-        return ( src.total() >= 640*480 );
-#else
-        (void)src;
-        return false;
-#endif
-    }
-
-private:
-    EqualizeHistCalcHist_Invoker& operator=(const EqualizeHistCalcHist_Invoker&);
-
-    cv::Mat& src_;
-    int* globalHistogram_;
-    MutextPtr histogramLock_;
-};
-
-class EqualizeHistLut_Invoker
-{
-public:
-    EqualizeHistLut_Invoker( cv::Mat& src, cv::Mat& dst, int* lut )
+    EqualizeHistLut_Invoker( const cv::Mat& src, cv::Mat& dst, const int* lut )
         : src_(src),
           dst_(dst),
           lut_(lut)
     { }
 
-    void operator()( const cv::BlockedRange& rowRange ) const
+    void operator()( const cv::Range& rowRange ) const
     {
         const size_t sstep = src_.step;
         const size_t dstep = dst_.step;
 
         int width = src_.cols;
-        int height = rowRange.end() - rowRange.begin();
-        int* lut = lut_;
+        int height = rowRange.end - rowRange.start;
+        const int* lut = lut_;
 
         if (src_.isContinuous() && dst_.isContinuous())
         {
@@ -3081,8 +2666,8 @@ public:
             height = 1;
         }
 
-        const uchar* sptr = src_.ptr<uchar>(rowRange.begin());
-        uchar* dptr = dst_.ptr<uchar>(rowRange.begin());
+        const uchar* sptr = src_.ptr<uchar>(rowRange.start);
+        uchar* dptr = dst_.data + dst_.step*rowRange.start;
 
         for (; height--; sptr += sstep, dptr += dstep)
         {
@@ -3109,22 +2694,12 @@ public:
         }
     }
 
-    static bool isWorthParallel( const cv::Mat& src )
-    {
-#ifdef HAVE_TBB
-        return ( src.total() >= 640*480 );
-#else
-        (void)src;
-        return false;
-#endif
-    }
-
 private:
     EqualizeHistLut_Invoker& operator=(const EqualizeHistLut_Invoker&);
 
-    cv::Mat& src_;
+    const cv::Mat& src_;
     cv::Mat& dst_;
-    int* lut_;
+    const int* lut_;
 };
 
 CV_IMPL void cvEqualizeHist( const CvArr* srcarr, CvArr* dstarr )
@@ -3143,25 +2718,11 @@ void cv::equalizeHist( InputArray _src, OutputArray _dst )
     if(src.empty())
         return;
 
-#ifdef HAVE_TBB
-    tbb::mutex histogramLockInstance;
-    EqualizeHistCalcHist_Invoker::MutextPtr histogramLock = &histogramLockInstance;
-#else
-    EqualizeHistCalcHist_Invoker::MutextPtr histogramLock = 0;
-#endif
-
-    const int hist_sz = EqualizeHistCalcHist_Invoker::HIST_SZ;
-    int hist[hist_sz] = {0,};
+    const int hist_sz = 256;
+    int hist[hist_sz];
     int lut[hist_sz];
 
-    EqualizeHistCalcHist_Invoker calcBody(src, hist, histogramLock);
-    EqualizeHistLut_Invoker      lutBody(src, dst, lut);
-    cv::BlockedRange heightRange(0, src.rows);
-
-    if(EqualizeHistCalcHist_Invoker::isWorthParallel(src))
-        parallel_for(heightRange, calcBody);
-    else
-        calcBody(heightRange);
+    calcHist_8uC1( src, hist );
 
     int i = 0;
     while (!hist[i]) ++i;
@@ -3182,10 +2743,13 @@ void cv::equalizeHist( InputArray _src, OutputArray _dst )
         lut[i] = saturate_cast<uchar>(sum * scale);
     }
 
-    if(EqualizeHistLut_Invoker::isWorthParallel(src))
-        parallel_for(heightRange, lutBody);
+    EqualizeHistLut_Invoker lutBody(src, dst, lut);
+    int nStripes = std::min(histNumStripes(src.size()), src.rows);
+
+    if( nStripes > 1 )
+        parallel_for_(Range(0, src.rows), lutBody, nStripes);
     else
-        lutBody(heightRange);
+        lutBody(Range(0, src.rows));
 }
 
 /* Implementation of RTTI and Generic Functions for CvHistogram */
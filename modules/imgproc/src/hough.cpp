@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include <functional>
 
 namespace cv
 {
@@ -375,13 +376,85 @@ HoughLinesSDiv( const Mat& img,
 *                              Probabilistic Hough Transform                             *
 \****************************************************************************************/
 
+// Big images are scanned for the non-zero points in parallel horizontal bands.
+// The points of every band are kept separately and are concatenated in the band order.
+enum { HOUGH_PARALLEL_MIN_SIZE = 1 << 16, HOUGH_MIN_BAND_ROWS = 32 };
+
+static int houghNumStripes( Size size )
+{
+    if( (double)size.width*size.height < HOUGH_PARALLEL_MIN_SIZE )
+        return 1;
+    return std::max(std::min(getNumThreads(), size.height / HOUGH_MIN_BAND_ROWS), 1);
+}
+
+class HoughLinesCollectPoints_Invoker : public ParallelLoopBody
+{
+public:
+    HoughLinesCollectPoints_Invoker( const Mat& _image, Mat& _mask,
+                                     std::vector<std::vector<Point> >& _points )
+        : image(_image), mask(_mask), points(_points) {}
+
+    void operator()( const Range& range ) const
+    {
+        int nStripes = (int)points.size();
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int y0 = (int)((int64)k*image.rows/nStripes), y1 = (int)((int64)(k + 1)*image.rows/nStripes);
+            std::vector<Point>& nzloc = points[k];
+            Point pt;
+
+            for( pt.y = y0; pt.y < y1; pt.y++ )
+            {
+                const uchar* data = image.ptr(pt.y);
+                uchar* mdata = mask.data + mask.step*pt.y;
+                for( pt.x = 0; pt.x < image.cols; pt.x++ )
+                {
+                    if( data[pt.x] )
+                    {
+                        mdata[pt.x] = (uchar)1;
+                        nzloc.push_back(pt);
+                    }
+                    else
+                        mdata[pt.x] = 0;
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& image;
+    Mat& mask;
+    std::vector<std::vector<Point> >& points;
+};
+
+// the accumulator columns the point (x, y) votes for at every angle
+static void houghLineVotes( int x, int y, const float* tabCos, const float* tabSin,
+                            int numangle, int numrho, int* rvotes )
+{
+    int n = 0, rshift = (numrho - 1) / 2;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        __m128 v_x = _mm_set1_ps((float)x), v_y = _mm_set1_ps((float)y);
+        __m128i v_shift = _mm_set1_epi32(rshift);
+        for( ; n <= numangle - 4; n += 4 )
+        {
+            __m128 r = _mm_add_ps(_mm_mul_ps(v_x, _mm_loadu_ps(tabCos + n)),
+                                  _mm_mul_ps(v_y, _mm_loadu_ps(tabSin + n)));
+            _mm_storeu_si128((__m128i*)(rvotes + n), _mm_add_epi32(_mm_cvtps_epi32(r), v_shift));
+        }
+    }
+#endif
+    for( ; n < numangle; n++ )
+        rvotes[n] = cvRound( x * tabCos[n] + y * tabSin[n] ) + rshift;
+}
+
 static void
 HoughLinesProbabilistic( Mat& image,
                          float rho, float theta, int threshold,
                          int lineLength, int lineGap,
                          std::vector<Vec4i>& lines, int linesMax )
 {
-    Point pt;
     float irho = 1 / rho;
     RNG rng((uint64)-1);
 
@@ -396,31 +469,38 @@ HoughLinesProbabilistic( Mat& image,
     Mat accum = Mat::zeros( numangle, numrho, CV_32SC1 );
     Mat mask( height, width, CV_8UC1 );
     std::vector<float> trigtab(numangle*2);
+    std::vector<int> _rvotes(numangle);
 
     for( int n = 0; n < numangle; n++ )
     {
-        trigtab[n*2] = (float)(cos((double)n*theta) * irho);
-        trigtab[n*2+1] = (float)(sin((double)n*theta) * irho);
+        trigtab[n] = (float)(cos((double)n*theta) * irho);
+        trigtab[numangle + n] = (float)(sin((double)n*theta) * irho);
     }
-    const float* ttab = &trigtab[0];
+    const float* tabCos = &trigtab[0];
+    const float* tabSin = tabCos + numangle;
+    int* rvotes = &_rvotes[0];
     uchar* mdata0 = mask.data;
     std::vector<Point> nzloc;
 
     // stage 1. collect non-zero image points
-    for( pt.y = 0; pt.y < height; pt.y++ )
+    int nStripes = houghNumStripes(image.size());
+    std::vector<std::vector<Point> > stripePoints(nStripes);
+    HoughLinesCollectPoints_Invoker collectBody(image, mask, stripePoints);
+
+    if( nStripes > 1 )
     {
-        const uchar* data = image.ptr(pt.y);
-        uchar* mdata = mask.ptr(pt.y);
-        for( pt.x = 0; pt.x < width; pt.x++ )
-        {
-            if( data[pt.x] )
-            {
-                mdata[pt.x] = (uchar)1;
-                nzloc.push_back(pt);
-            }
-            else
-                mdata[pt.x] = 0;
-        }
+        parallel_for_(Range(0, nStripes), collectBody, nStripes);
+        size_t total = 0;
+        for( int k = 0; k < nStripes; k++ )
+            total += stripePoints[k].size();
+        nzloc.reserve(total);
+        for( int k = 0; k < nStripes; k++ )
+            nzloc.insert(nzloc.end(), stripePoints[k].begin(), stripePoints[k].end());
+    }
+    else
+    {
+        collectBody(Range(0, 1));
+        nzloc.swap(stripePoints[0]);
     }
 
     int count = (int)nzloc.size();
@@ -447,11 +527,10 @@ HoughLinesProbabilistic( Mat& image,
             continue;
 
         // update accumulator, find the most probable line
+        houghLineVotes( j, i, tabCos, tabSin, numangle, numrho, rvotes );
         for( int n = 0; n < numangle; n++, adata += numrho )
         {
-            int r = cvRound( j * ttab[n*2] + i * ttab[n*2+1] );
-            r += (numrho - 1) / 2;
-            int val = ++adata[r];
+            int val = ++adata[rvotes[n]];
             if( max_val < val )
             {
                 max_val = val;
@@ -465,8 +544,8 @@ HoughLinesProbabilistic( Mat& image,
 
         // from the current point walk in each direction
         // along the found line and extract the line segment
-        a = -ttab[max_n*2+1];
-        b = ttab[max_n*2];
+        a = -tabSin[max_n];
+        b = tabCos[max_n];
         x0 = j;
         y0 = i;
         if( fabs(a) > fabs(b) )
@@ -568,12 +647,9 @@ HoughLinesProbabilistic( Mat& image,
                     if( good_line )
                     {
                         adata = (int*)accum.data;
+                        houghLineVotes( j1, i1, tabCos, tabSin, numangle, numrho, rvotes );
                         for( int n = 0; n < numangle; n++, adata += numrho )
-                        {
-                            int r = cvRound( j1 * ttab[n*2] + i1 * ttab[n*2+1] );
-                            r += (numrho - 1) / 2;
-                            adata[r]--;
-                        }
+                            adata[rvotes[n]]--;
                     }
                     *mdata = 0;
                 }
@@ -741,217 +817,376 @@ cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
 *                                     Circle Detection                                   *
 \****************************************************************************************/
 
-static void
-icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
-                         int min_radius, int max_radius,
-                         int canny_threshold, int acc_threshold,
-                         CvSeq* circles, int circles_max )
+namespace cv
 {
-    const int SHIFT = 10, ONE = 1 << SHIFT;
-    cv::Ptr<CvMat> dx, dy;
-    cv::Ptr<CvMat> edges, accum, dist_buf;
-    std::vector<int> sort_buf;
-    cv::Ptr<CvMemStorage> storage;
-
-    int x, y, i, j, k, center_count, nz_count;
-    float min_radius2 = (float)min_radius*min_radius;
-    float max_radius2 = (float)max_radius*max_radius;
-    int rows, cols, arows, acols;
-    int astep, *adata;
-    float* ddata;
-    CvSeq *nz, *centers;
-    float idp, dr;
-    CvSeqReader reader;
-
-    edges = cvCreateMat( img->rows, img->cols, CV_8UC1 );
-    cvCanny( img, edges, MAX(canny_threshold/2,1), canny_threshold, 3 );
-
-    dx = cvCreateMat( img->rows, img->cols, CV_16SC1 );
-    dy = cvCreateMat( img->rows, img->cols, CV_16SC1 );
-    cvSobel( img, dx, 1, 0, 3 );
-    cvSobel( img, dy, 0, 1, 3 );
 
-    if( dp < 1.f )
-        dp = 1.f;
-    idp = 1.f/dp;
-    accum = cvCreateMat( cvCeil(img->rows*idp)+2, cvCeil(img->cols*idp)+2, CV_32SC1 );
-    cvZero(accum);
-
-    storage = cvCreateMemStorage();
-    nz = cvCreateSeq( CV_32SC2, sizeof(CvSeq), sizeof(CvPoint), storage );
-    centers = cvCreateSeq( CV_32SC1, sizeof(CvSeq), sizeof(int), storage );
-
-    rows = img->rows;
-    cols = img->cols;
-    arows = accum->rows - 2;
-    acols = accum->cols - 2;
-    adata = accum->data.i;
-    astep = accum->step/sizeof(adata[0]);
-    // Accumulate circle evidence for each edge pixel
-    for( y = 0; y < rows; y++ )
+// Every band of edge pixels votes into its own accumulator, the accumulators are summed up
+// at the end. The radii of the candidate centers are estimated in parallel batches.
+enum { HOUGH_CIRCLES_CENTERS_PER_THREAD = 4 };
+
+class HoughCirclesAccumulate_Invoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesAccumulate_Invoker( const Mat& _edges, const Mat& _dx, const Mat& _dy,
+                                    std::vector<Mat>& _accums, std::vector<std::vector<Point> >& _points,
+                                    float _idp, int _minRadius, int _maxRadius )
+        : edges(_edges), dx(_dx), dy(_dy), accums(_accums), points(_points),
+          idp(_idp), minRadius(_minRadius), maxRadius(_maxRadius) {}
+
+    void operator()( const Range& range ) const
     {
-        const uchar* edges_row = edges->data.ptr + y*edges->step;
-        const short* dx_row = (const short*)(dx->data.ptr + y*dx->step);
-        const short* dy_row = (const short*)(dy->data.ptr + y*dy->step);
+        const int SHIFT = 10, ONE = 1 << SHIFT;
+        int nStripes = (int)points.size();
 
-        for( x = 0; x < cols; x++ )
+        for( int k = range.start; k < range.end; k++ )
         {
-            float vx, vy;
-            int sx, sy, x0, y0, x1, y1, r;
-            CvPoint pt;
+            int ystart = (int)((int64)k*edges.rows/nStripes), yend = (int)((int64)(k + 1)*edges.rows/nStripes);
+            Mat& accum = accums[k];
+            std::vector<Point>& nz = points[k];
+            int arows = accum.rows - 2, acols = accum.cols - 2;
+            int astep = (int)(accum.step/sizeof(int));
+            int* adata = (int*)accum.data;
+
+            // accumulate circle evidence for each edge pixel
+            for( int y = ystart; y < yend; y++ )
+            {
+                const uchar* edgesRow = edges.ptr(y);
+                const short* dxRow = dx.ptr<short>(y);
+                const short* dyRow = dy.ptr<short>(y);
 
-            vx = dx_row[x];
-            vy = dy_row[x];
+                for( int x = 0; x < edges.cols; x++ )
+                {
+                    float vx = dxRow[x], vy = dyRow[x];
 
-            if( !edges_row[x] || (vx == 0 && vy == 0) )
-                continue;
+                    if( !edgesRow[x] || (vx == 0 && vy == 0) )
+                        continue;
 
-            float mag = std::sqrt(vx*vx+vy*vy);
-            assert( mag >= 1 );
-            sx = cvRound((vx*idp)*ONE/mag);
-            sy = cvRound((vy*idp)*ONE/mag);
+                    float mag = std::sqrt(vx*vx + vy*vy);
+                    int sx = cvRound((vx*idp)*ONE/mag);
+                    int sy = cvRound((vy*idp)*ONE/mag);
+                    int x0 = cvRound((x*idp)*ONE);
+                    int y0 = cvRound((y*idp)*ONE);
 
-            x0 = cvRound((x*idp)*ONE);
-            y0 = cvRound((y*idp)*ONE);
-            // Step from min_radius to max_radius in both directions of the gradient
-            for(int k1 = 0; k1 < 2; k1++ )
-            {
-                x1 = x0 + min_radius * sx;
-                y1 = y0 + min_radius * sy;
+                    // step from minRadius to maxRadius in both directions of the gradient
+                    for( int k1 = 0; k1 < 2; k1++ )
+                    {
+                        int x1 = x0 + minRadius * sx;
+                        int y1 = y0 + minRadius * sy;
 
-                for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
-                {
-                    int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
-                    if( (unsigned)x2 >= (unsigned)acols ||
-                        (unsigned)y2 >= (unsigned)arows )
-                        break;
-                    adata[y2*astep + x2]++;
-                }
+                        for( int r = minRadius; r <= maxRadius; x1 += sx, y1 += sy, r++ )
+                        {
+                            int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
+                            if( (unsigned)x2 >= (unsigned)acols ||
+                                (unsigned)y2 >= (unsigned)arows )
+                                break;
+                            adata[y2*astep + x2]++;
+                        }
 
-                sx = -sx; sy = -sy;
+                        sx = -sx; sy = -sy;
+                    }
+
+                    nz.push_back(Point(x, y));
+                }
             }
+        }
+    }
+
+private:
+    const Mat& edges;
+    const Mat& dx;
+    const Mat& dy;
+    std::vector<Mat>& accums;
+    std::vector<std::vector<Point> >& points;
+    float idp;
+    int minRadius;
+    int maxRadius;
+};
+
+// the distances from (cx, cy) to the edge points that are within [minRadius, maxRadius]
+static int houghCircleDistances( const float* nzx, const float* nzy, int count, float cx, float cy,
+                                 float minRadius2, float maxRadius2, float* dist )
+{
+    int j = 0, k = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        __m128 v_cx = _mm_set1_ps(cx), v_cy = _mm_set1_ps(cy);
+        __m128 v_min = _mm_set1_ps(minRadius2), v_max = _mm_set1_ps(maxRadius2);
+        float CV_DECL_ALIGNED(16) buf[4];
+
+        for( ; j <= count - 4; j += 4 )
+        {
+            __m128 v_dx = _mm_sub_ps(v_cx, _mm_loadu_ps(nzx + j));
+            __m128 v_dy = _mm_sub_ps(v_cy, _mm_loadu_ps(nzy + j));
+            __m128 v_r2 = _mm_add_ps(_mm_mul_ps(v_dx, v_dx), _mm_mul_ps(v_dy, v_dy));
+            int m = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(v_min, v_r2), _mm_cmple_ps(v_r2, v_max)));
+            if( m == 0 )
+                continue;
+            _mm_store_ps(buf, _mm_sqrt_ps(v_r2));
+            for( int t = 0; t < 4; t++ )
+                if( m & (1 << t) )
+                    dist[k++] = buf[t];
+        }
+    }
+#endif
+    for( ; j < count; j++ )
+    {
+        float _dx = cx - nzx[j], _dy = cy - nzy[j];
+        float _r2 = _dx*_dx + _dy*_dy;
+        if( minRadius2 <= _r2 && _r2 <= maxRadius2 )
+            dist[k++] = std::sqrt(_r2);
+    }
+    return k;
+}
 
-            pt.x = x; pt.y = y;
-            cvSeqPush( nz, &pt );
+// estimates the radius of the circle centered at (cx, cy) by the largest group of edge points
+// at about the same distance; returns the number of points in the group
+static int houghCircleRadius( const float* nzx, const float* nzy, int count, float cx, float cy,
+                              float minRadius2, float maxRadius2, int maxRadius, float dr,
+                              float* dist, float& rBest )
+{
+    int n = houghCircleDistances(nzx, nzy, count, cx, cy, minRadius2, maxRadius2, dist);
+    int maxCount = 0;
+    rBest = 0;
+    if( n == 0 )
+        return 0;
+
+    std::sort(dist, dist + n, std::greater<float>());
+
+    int startIdx = n - 1;
+    float startDist = dist[n - 1];
+    for( int j = n - 2; j >= 0; j-- )
+    {
+        float d = dist[j];
+
+        if( d > maxRadius )
+            break;
+
+        if( d - startDist > dr )
+        {
+            float rCur = dist[(j + startIdx)/2];
+            if( (startIdx - j)*rBest >= maxCount*rCur ||
+                (rBest < FLT_EPSILON && startIdx - j >= maxCount) )
+            {
+                rBest = rCur;
+                maxCount = startIdx - j;
+            }
+            startDist = d;
+            startIdx = j;
         }
     }
+    return maxCount;
+}
+
+class HoughCirclesRadius_Invoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesRadius_Invoker( const std::vector<float>& _nzx, const std::vector<float>& _nzy,
+                                const Point2f* _centers, int* _counts, float* _radii,
+                                float _minRadius2, float _maxRadius2, int _maxRadius, float _dr )
+        : nzx(_nzx), nzy(_nzy), centers(_centers), counts(_counts), radii(_radii),
+          minRadius2(_minRadius2), maxRadius2(_maxRadius2), maxRadius(_maxRadius), dr(_dr) {}
+
+    void operator()( const Range& range ) const
+    {
+        int count = (int)nzx.size();
+        AutoBuffer<float> _dist(count);
+        for( int i = range.start; i < range.end; i++ )
+            counts[i] = houghCircleRadius(&nzx[0], &nzy[0], count, centers[i].x, centers[i].y,
+                                          minRadius2, maxRadius2, maxRadius, dr, _dist, radii[i]);
+    }
+
+private:
+    const std::vector<float>& nzx;
+    const std::vector<float>& nzy;
+    const Point2f* centers;
+    int* counts;
+    float* radii;
+    float minRadius2;
+    float maxRadius2;
+    int maxRadius;
+    float dr;
+};
 
-    nz_count = nz->total;
-    if( !nz_count )
+static void
+HoughCirclesGradient( const Mat& img, float dp, float minDist,
+                      int minRadius, int maxRadius,
+                      int cannyThreshold, int accThreshold,
+                      std::vector<Vec3f>& circles, int circlesMax )
+{
+    Mat edges, dx, dy;
+    int x, y, i, j;
+    float minRadius2 = (float)minRadius*minRadius;
+    float maxRadius2 = (float)maxRadius*maxRadius;
+
+    Canny( img, edges, MAX(cannyThreshold/2,1), cannyThreshold, 3 );
+    Sobel( img, dx, CV_16S, 1, 0, 3, 1, 0, BORDER_REPLICATE );
+    Sobel( img, dy, CV_16S, 0, 1, 3, 1, 0, BORDER_REPLICATE );
+
+    if( dp < 1.f )
+        dp = 1.f;
+    float idp = 1.f/dp;
+    Size asize(cvCeil(img.cols*idp)+2, cvCeil(img.rows*idp)+2);
+
+    int nStripes = houghNumStripes(img.size());
+    std::vector<Mat> accums(nStripes);
+    std::vector<std::vector<Point> > stripePoints(nStripes);
+    for( i = 0; i < nStripes; i++ )
+        accums[i] = Mat::zeros(asize, CV_32SC1);
+
+    HoughCirclesAccumulate_Invoker accumBody(edges, dx, dy, accums, stripePoints, idp, minRadius, maxRadius);
+    if( nStripes > 1 )
+        parallel_for_(Range(0, nStripes), accumBody, nStripes);
+    else
+        accumBody(Range(0, 1));
+
+    Mat accum = accums[0];
+    for( i = 1; i < nStripes; i++ )
+        accum += accums[i];
+    accums.clear();
+
+    // keep the edge points in the original scan order, as separate arrays of coordinates
+    std::vector<float> nzx, nzy;
+    for( i = 0; i < nStripes; i++ )
+        for( j = 0; j < (int)stripePoints[i].size(); j++ )
+        {
+            nzx.push_back((float)stripePoints[i][j].x);
+            nzy.push_back((float)stripePoints[i][j].y);
+        }
+    stripePoints.clear();
+
+    if( nzx.empty() )
         return;
-    //Find possible circle centers
+
+    // find possible circle centers
+    int arows = accum.rows - 2, acols = accum.cols - 2;
+    const int* adata = (const int*)accum.data;
+    std::vector<int> centers;
+
     for( y = 1; y < arows - 1; y++ )
     {
         for( x = 1; x < acols - 1; x++ )
         {
             int base = y*(acols+2) + x;
-            if( adata[base] > acc_threshold &&
+            if( adata[base] > accThreshold &&
                 adata[base] > adata[base-1] && adata[base] > adata[base+1] &&
                 adata[base] > adata[base-acols-2] && adata[base] > adata[base+acols+2] )
-                cvSeqPush(centers, &base);
+                centers.push_back(base);
         }
     }
 
-    center_count = centers->total;
-    if( !center_count )
+    int centerCount = (int)centers.size();
+    if( !centerCount )
         return;
 
-    sort_buf.resize( MAX(center_count,nz_count) );
-    cvCvtSeqToArray( centers, &sort_buf[0] );
+    std::sort(centers.begin(), centers.end(), hough_cmp_gt(adata));
 
-    std::sort(sort_buf.begin(), sort_buf.begin() + center_count, cv::hough_cmp_gt(adata));
-    cvClearSeq( centers );
-    cvSeqPushMulti( centers, &sort_buf[0], center_count );
+    float dr = dp;
+    minDist = MAX( minDist, dp );
+    minDist *= minDist;
 
-    dist_buf = cvCreateMat( 1, nz_count, CV_32FC1 );
-    ddata = dist_buf->data.fl;
+    // The radii are estimated for batches of the centers in parallel. Some of the centers of a
+    // batch may be rejected because they are too close to a circle found earlier in the batch,
+    // so the work for them is wasted, but the result is the same as when processing them one by one.
+    int batchSize = getNumThreads() > 1 ? getNumThreads()*HOUGH_CIRCLES_CENTERS_PER_THREAD : 1;
+    std::vector<Point2f> batchCenters(batchSize);
+    std::vector<int> batchIdx(batchSize), batchCounts(batchSize);
+    std::vector<float> batchRadii(batchSize);
 
-    dr = dp;
-    min_dist = MAX( min_dist, dp );
-    min_dist *= min_dist;
-    // For each found possible center
-    // Estimate radius and check support
-    for( i = 0; i < centers->total; i++ )
+    for( int i0 = 0; i0 < centerCount; i0 += batchSize )
     {
-        int ofs = *(int*)cvGetSeqElem( centers, i );
-        y = ofs/(acols+2);
-        x = ofs - (y)*(acols+2);
-        //Calculate circle's center in pixels
-        float cx = (float)((x + 0.5f)*dp), cy = (float)(( y + 0.5f )*dp);
-        float start_dist, dist_sum;
-        float r_best = 0;
-        int max_count = 0;
-        // Check distance with previously detected circles
-        for( j = 0; j < circles->total; j++ )
-        {
-            float* c = (float*)cvGetSeqElem( circles, j );
-            if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < min_dist )
-                break;
-        }
+        int i1 = std::min(i0 + batchSize, centerCount), n = 0;
 
-        if( j < circles->total )
-            continue;
-        // Estimate best radius
-        cvStartReadSeq( nz, &reader );
-        for( j = k = 0; j < nz_count; j++ )
+        // skip the centers that are too close to the circles detected so far
+        for( i = i0; i < i1; i++ )
         {
-            CvPoint pt;
-            float _dx, _dy, _r2;
-            CV_READ_SEQ_ELEM( pt, reader );
-            _dx = cx - pt.x; _dy = cy - pt.y;
-            _r2 = _dx*_dx + _dy*_dy;
-            if(min_radius2 <= _r2 && _r2 <= max_radius2 )
+            y = centers[i]/(acols+2);
+            x = centers[i] - y*(acols+2);
+            // calculate circle's center in pixels
+            float cx = (float)((x + 0.5f)*dp), cy = (float)((y + 0.5f)*dp);
+
+            for( j = 0; j < (int)circles.size(); j++ )
             {
-                ddata[k] = _r2;
-                sort_buf[k] = k;
-                k++;
+                const Vec3f& c = circles[j];
+                if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < minDist )
+                    break;
             }
+            if( j < (int)circles.size() )
+                continue;
+
+            batchCenters[n] = Point2f(cx, cy);
+            batchIdx[n++] = i;
         }
 
-        int nz_count1 = k, start_idx = nz_count1 - 1;
-        if( nz_count1 == 0 )
+        if( n == 0 )
             continue;
-        dist_buf->cols = nz_count1;
-        cvPow( dist_buf, dist_buf, 0.5 );
-        std::sort(sort_buf.begin(), sort_buf.begin() + nz_count1, cv::hough_cmp_gt((int*)ddata));
 
-        dist_sum = start_dist = ddata[sort_buf[nz_count1-1]];
-        for( j = nz_count1 - 2; j >= 0; j-- )
+        // estimate the best radius and its support
+        HoughCirclesRadius_Invoker radiusBody(nzx, nzy, &batchCenters[0], &batchCounts[0], &batchRadii[0],
+                                              minRadius2, maxRadius2, maxRadius, dr);
+        if( n > 1 )
+            parallel_for_(Range(0, n), radiusBody, n);
+        else
+            radiusBody(Range(0, 1));
+
+        for( int t = 0; t < n; t++ )
         {
-            float d = ddata[sort_buf[j]];
+            float cx = batchCenters[t].x, cy = batchCenters[t].y;
 
-            if( d > max_radius )
-                break;
+            // the earlier centers of this batch may have been accepted in the meantime
+            for( j = 0; j < (int)circles.size(); j++ )
+            {
+                const Vec3f& c = circles[j];
+                if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < minDist )
+                    break;
+            }
+            if( j < (int)circles.size() )
+                continue;
 
-            if( d - start_dist > dr )
+            // check if the circle has enough support
+            if( batchCounts[t] > accThreshold )
             {
-                float r_cur = ddata[sort_buf[(j + start_idx)/2]];
-                if( (start_idx - j)*r_best >= max_count*r_cur ||
-                    (r_best < FLT_EPSILON && start_idx - j >= max_count) )
-                {
-                    r_best = r_cur;
-                    max_count = start_idx - j;
-                }
-                start_dist = d;
-                start_idx = j;
-                dist_sum = 0;
+                circles.push_back(Vec3f(cx, cy, batchRadii[t]));
+                if( (int)circles.size() >= circlesMax )
+                    return;
             }
-            dist_sum += d;
-        }
-        // Check if the circle has enough support
-        if( max_count > acc_threshold )
-        {
-            float c[3];
-            c[0] = cx;
-            c[1] = cy;
-            c[2] = (float)r_best;
-            cvSeqPush( circles, c );
-            if( circles->total > circles_max )
-                return;
         }
     }
 }
 
+static void
+HoughCircles_( const Mat& img, int method, double dp, double minDist,
+               double param1, double param2, int minRadius, int maxRadius,
+               std::vector<Vec3f>& circles, int circlesMax )
+{
+    int cannyThreshold = cvRound(param1);
+    int accThreshold = cvRound(param2);
+
+    if( img.type() != CV_8UC1 )
+        CV_Error( CV_StsBadArg, "The source image must be 8-bit, single-channel" );
+
+    if( dp <= 0 || minDist <= 0 || cannyThreshold <= 0 || accThreshold <= 0 )
+        CV_Error( CV_StsOutOfRange, "dp, min_dist, canny_threshold and acc_threshold must be all positive numbers" );
+
+    minRadius = MAX( minRadius, 0 );
+    if( maxRadius <= 0 )
+        maxRadius = MAX( img.rows, img.cols );
+    else if( maxRadius <= minRadius )
+        maxRadius = minRadius + 2;
+
+    switch( method )
+    {
+    case CV_HOUGH_GRADIENT:
+        HoughCirclesGradient( img, (float)dp, (float)minDist, minRadius, maxRadius,
+                              cannyThreshold, accThreshold, circles, circlesMax );
+        break;
+    default:
+        CV_Error( CV_StsBadArg, "Unrecognized method id" );
+    }
+}
+
+}
+
 CV_IMPL CvSeq*
 cvHoughCircles( CvArr* src_image, void* circle_storage,
                 int method, double dp, double min_dist,
@@ -966,8 +1201,7 @@ cvHoughCircles( CvArr* src_image, void* circle_storage,
     CvSeq circles_header;
     CvSeqBlock circles_block;
     int circles_max = INT_MAX;
-    int canny_threshold = cvRound(param1);
-    int acc_threshold = cvRound(param2);
+    std::vector<cv::Vec3f> _circles;
 
     img = cvGetMat( img, &stub );
 
@@ -977,15 +1211,6 @@ cvHoughCircles( CvArr* src_image, void* circle_storage,
     if( !circle_storage )
         CV_Error( CV_StsNullPtr, "NULL destination" );
 
-    if( dp <= 0 || min_dist <= 0 || canny_threshold <= 0 || acc_threshold <= 0 )
-        CV_Error( CV_StsOutOfRange, "dp, min_dist, canny_threshold and acc_threshold must be all positive numbers" );
-
-    min_radius = MAX( min_radius, 0 );
-    if( max_radius <= 0 )
-        max_radius = MAX( img->rows, img->cols );
-    else if( max_radius <= min_radius )
-        max_radius = min_radius + 2;
-
     if( CV_IS_STORAGE( circle_storage ))
     {
         circles = cvCreateSeq( CV_32FC3, sizeof(CvSeq),
@@ -1008,16 +1233,10 @@ cvHoughCircles( CvArr* src_image, void* circle_storage,
     else
         CV_Error( CV_StsBadArg, "Destination is not CvMemStorage* nor CvMat*" );
 
-    switch( method )
-    {
-    case CV_HOUGH_GRADIENT:
-        icvHoughCirclesGradient( img, (float)dp, (float)min_dist,
-                                min_radius, max_radius, canny_threshold,
-                                acc_threshold, circles, circles_max );
-          break;
-    default:
-        CV_Error( CV_StsBadArg, "Unrecognized method id" );
-    }
+    cv::HoughCircles_( cv::cvarrToMat(img), method, dp, min_dist, param1, param2,
+                       min_radius, max_radius, _circles, circles_max );
+    if( !_circles.empty() )
+        cvSeqPushMulti( circles, &_circles[0], (int)_circles.size() );
 
     if( mat )
     {
@@ -1033,36 +1252,20 @@ cvHoughCircles( CvArr* src_image, void* circle_storage,
 }
 
 
-namespace cv
-{
-
-const int STORAGE_SIZE = 1 << 12;
-
-static void seqToMat(const CvSeq* seq, OutputArray _arr)
-{
-    if( seq && seq->total > 0 )
-    {
-        _arr.create(1, seq->total, seq->flags, -1, true);
-        Mat arr = _arr.getMat();
-        cvCvtSeqToArray(seq, arr.data);
-    }
-    else
-        _arr.release();
-}
-
-}
-
 void cv::HoughCircles( InputArray _image, OutputArray _circles,
                        int method, double dp, double min_dist,
                        double param1, double param2,
                        int minRadius, int maxRadius )
 {
-    Ptr<CvMemStorage> storage = cvCreateMemStorage(STORAGE_SIZE);
     Mat image = _image.getMat();
-    CvMat c_image = image;
-    CvSeq* seq = cvHoughCircles( &c_image, storage, method,
-                    dp, min_dist, param1, param2, minRadius, maxRadius );
-    seqToMat(seq, _circles);
+    std::vector<Vec3f> circles;
+
+    HoughCircles_( image, method, dp, min_dist, param1, param2, minRadius, maxRadius, circles, INT_MAX );
+
+    if( !circles.empty() )
+        Mat(1, (int)circles.size(), CV_32FC3, &circles[0]).copyTo(_circles);
+    else
+        _circles.release();
 }
 
 /* End of file. */
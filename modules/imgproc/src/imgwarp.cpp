@@ -2463,6 +2463,197 @@ typedef RemapNoVec RemapVec_8u;
 #endif
 
 
+#if CV_AVX2_DISPATCH
+
+// GCC contracts a*b + c into an FMA instruction inside the avx2,fma target functions; the product
+// would not be rounded then, and the result would differ from the scalar code
+#if defined __GNUC__ && !defined __clang__
+#pragma GCC push_options
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+// A group of 8 consecutive output values holds all the channels of 8/cn pixels; lane l of the k-th
+// group of an 8-pixel block belongs to pixel remapGatherPixel[cn-1][k][l] and channel (k*8 + l) % cn
+static const int CV_DECL_ALIGNED(32) remapGatherPixel[4][4][8] =
+{
+    { { 0, 1, 2, 3, 4, 5, 6, 7 } },
+    { { 0, 0, 1, 1, 2, 2, 3, 3 }, { 4, 4, 5, 5, 6, 6, 7, 7 } },
+    { { 0, 0, 0, 1, 1, 1, 2, 2 }, { 2, 3, 3, 3, 4, 4, 4, 5 }, { 5, 5, 6, 6, 6, 7, 7, 7 } },
+    { { 0, 0, 0, 0, 1, 1, 1, 1 }, { 2, 2, 2, 2, 3, 3, 3, 3 }, { 4, 4, 4, 4, 5, 5, 5, 5 }, { 6, 6, 6, 6, 7, 7, 7, 7 } }
+};
+
+// computes the source offsets of 8 destination pixels; returns false if any of the ksize x ksize
+// neighborhoods is not entirely inside the image
+static CV_AVX2_TARGET inline bool remapGatherOffsets_AVX2( const short* XY, const ushort* FXY, __m256i v_o,
+                                                           __m256i v_width1, __m256i v_height1,
+                                                           __m256i v_sstep, __m256i v_pixsize,
+                                                           __m256i& v_ofs, __m256i& v_fxy )
+{
+    __m256i v_xy = _mm256_loadu_si256((const __m256i*)XY), v_minus1 = _mm256_set1_epi32(-1);
+    __m256i v_sx = _mm256_sub_epi32(_mm256_srai_epi32(_mm256_slli_epi32(v_xy, 16), 16), v_o);
+    __m256i v_sy = _mm256_sub_epi32(_mm256_srai_epi32(v_xy, 16), v_o);
+    __m256i v_inside = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(v_sx, v_minus1),
+                                                         _mm256_cmpgt_epi32(v_width1, v_sx)),
+                                        _mm256_and_si256(_mm256_cmpgt_epi32(v_sy, v_minus1),
+                                                         _mm256_cmpgt_epi32(v_height1, v_sy)));
+    if( _mm256_movemask_epi8(v_inside) != -1 )
+        return false;
+
+    v_ofs = _mm256_add_epi32(_mm256_mullo_epi32(v_sy, v_sstep), _mm256_mullo_epi32(v_sx, v_pixsize));
+    v_fxy = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)FXY));
+    return true;
+}
+
+// The 16-bit taps are gathered as the 32-bit words that contain them. To stay within the row segment
+// of the sampled pixels, the last value of the segment is taken from the word that ends with it
+static CV_AVX2_TARGET inline __m256 remapGatherTap_AVX2( const float* S, __m256i v_ofs, __m256i v_start, __m256i )
+{
+    return _mm256_i32gather_ps(S, _mm256_add_epi32(v_ofs, v_start), 1);
+}
+
+static CV_AVX2_TARGET inline __m256 remapGatherTap_AVX2( const ushort* S, __m256i v_ofs, __m256i v_start, __m256i v_shift )
+{
+    __m256i v = _mm256_i32gather_epi32((const int*)S, _mm256_add_epi32(v_ofs, v_start), 1);
+    v = _mm256_and_si256(_mm256_srlv_epi32(v, v_shift), _mm256_set1_epi32(0xffff));
+    return _mm256_cvtepi32_ps(v);
+}
+
+static CV_AVX2_TARGET inline __m256 remapGatherTap_AVX2( const short* S, __m256i v_ofs, __m256i v_start, __m256i v_shift )
+{
+    __m256i v = _mm256_i32gather_epi32((const int*)S, _mm256_add_epi32(v_ofs, v_start), 1);
+    v = _mm256_srai_epi32(_mm256_slli_epi32(_mm256_srlv_epi32(v, v_shift), 16), 16);
+    return _mm256_cvtepi32_ps(v);
+}
+
+// the stores round to nearest even and saturate, as saturate_cast does
+static CV_AVX2_TARGET inline void remapGatherStore_AVX2( float* D, __m256 v )
+{
+    _mm256_storeu_ps(D, v);
+}
+
+static CV_AVX2_TARGET inline void remapGatherStore_AVX2( ushort* D, __m256 v )
+{
+    __m256i iv = _mm256_cvtps_epi32(v);
+    iv = _mm256_permute4x64_epi64(_mm256_packus_epi32(iv, iv), 0x08);
+    _mm_storeu_si128((__m128i*)D, _mm256_castsi256_si128(iv));
+}
+
+static CV_AVX2_TARGET inline void remapGatherStore_AVX2( short* D, __m256 v )
+{
+    __m256i iv = _mm256_cvtps_epi32(v);
+    iv = _mm256_permute4x64_epi64(_mm256_packs_epi32(iv, iv), 0x08);
+    _mm_storeu_si128((__m128i*)D, _mm256_castsi256_si128(iv));
+}
+
+// 16-bit and floating-point images. Each pixel takes its ksize*ksize weights from the same 2D table
+// as the scalar code, and the products are added in the same order: one by one over the whole
+// bilinear neighborhood, row by row for the bicubic one, and row by row starting from 0 for
+// Lanczos4. So the result does not depend on which of the two paths has processed the pixel
+template<int ksize, typename T>
+static CV_AVX2_TARGET int remapGather_AVX2( const Mat& _src, T* D, const short* XY, const ushort* FXY,
+                                            const float* wtab, int width )
+{
+    int cn = _src.channels(), x = 0, esz = (int)sizeof(T);
+    if( width < 8 || cn > 4 || _src.step*_src.rows >= (size_t)INT_MAX )
+        return 0;
+
+    const T* S0 = (const T*)_src.data;
+    __m256i v_o = _mm256_set1_epi32(ksize/2 - 1), v_sstep = _mm256_set1_epi32((int)_src.step);
+    __m256i v_width1 = _mm256_set1_epi32(_src.cols - ksize + 1), v_height1 = _mm256_set1_epi32(_src.rows - ksize + 1);
+    __m256i v_pixsize = _mm256_set1_epi32(cn*esz), v_ksize2 = _mm256_set1_epi32(ksize*ksize);
+    __m256i v_lastword = _mm256_set1_epi32(ksize*cn*esz - 4);
+    __m256i v_lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for( ; x <= width - 8; x += 8, D += cn*8 )
+    {
+        __m256i v_ofs, v_fxy;
+        if( !remapGatherOffsets_AVX2(XY + x*2, FXY + x, v_o, v_width1, v_height1,
+                                     v_sstep, v_pixsize, v_ofs, v_fxy) )
+            break;
+
+        __m256i v_wofs = _mm256_mullo_epi32(v_fxy, v_ksize2);
+        __m256 v_w[ksize*ksize];
+        for( int i = 0; i < ksize*ksize; i++ )
+            v_w[i] = _mm256_i32gather_ps(wtab + i, v_wofs, 4);
+
+        for( int k = 0; k < cn; k++ )
+        {
+            __m256i v_pix = _mm256_load_si256((const __m256i*)remapGatherPixel[cn-1][k]);
+            __m256i v_rofs = _mm256_permutevar8x32_epi32(v_ofs, v_pix);
+            // byte offsets of the taps within the row segment, and the shifts of the 16-bit ones
+            __m256i v_t = _mm256_sub_epi32(_mm256_add_epi32(v_lane, _mm256_set1_epi32(k*8)),
+                                           _mm256_mullo_epi32(v_pix, _mm256_set1_epi32(cn)));
+            __m256i v_start[ksize], v_shift[ksize];
+            v_t = _mm256_mullo_epi32(v_t, _mm256_set1_epi32(esz));
+            for( int kx = 0; kx < ksize; kx++, v_t = _mm256_add_epi32(v_t, v_pixsize) )
+            {
+                v_start[kx] = _mm256_min_epi32(v_t, v_lastword);
+                v_shift[kx] = _mm256_slli_epi32(_mm256_sub_epi32(v_t, v_start[kx]), 3);
+            }
+
+            __m256 v_sum = _mm256_setzero_ps();
+            for( int ky = 0; ky < ksize; ky++, v_rofs = _mm256_add_epi32(v_rofs, v_sstep) )
+            {
+                __m256 v_row = _mm256_setzero_ps();
+                for( int kx = 0; kx < ksize; kx++ )
+                {
+                    __m256 v_s = remapGatherTap_AVX2(S0, v_rofs, v_start[kx], v_shift[kx]);
+                    __m256 v_wk = v_w[ky*ksize + kx];
+                    if( cn > 1 )
+                        v_wk = _mm256_permutevar8x32_ps(v_wk, v_pix);
+                    v_s = _mm256_mul_ps(v_s, v_wk);
+                    if( kx > 0 )
+                        v_row = _mm256_add_ps(v_row, v_s);
+                    else if( ksize == 2 && ky > 0 )
+                        v_row = _mm256_add_ps(v_sum, v_s);
+                    else
+                        v_row = v_s;
+                }
+                v_sum = ksize == 2 || (ksize == 4 && ky == 0) ? v_row : _mm256_add_ps(v_sum, v_row);
+            }
+
+            remapGatherStore_AVX2(D + k*8, v_sum);
+        }
+    }
+
+    return x;
+}
+
+#if defined __GNUC__ && !defined __clang__
+#pragma GCC pop_options
+#endif
+
+#endif
+
+// the vectorized interpolation over the ksize x ksize neighborhood with AVX2 gathers
+template<typename T, int ksize>
+struct RemapGatherVec
+{
+    RemapGatherVec()
+    {
+#if CV_AVX2_DISPATCH
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3);
+#endif
+    }
+
+    int operator()( const Mat& _src, void* _dst, const short* XY,
+                    const ushort* FXY, const void* _wtab, int width ) const
+    {
+#if CV_AVX2_DISPATCH
+        if( haveAVX2 )
+            return remapGather_AVX2<ksize>(_src, (T*)_dst, XY, FXY, (const float*)_wtab, width);
+#else
+        (void)_src; (void)_dst; (void)XY; (void)FXY; (void)_wtab; (void)width;
+#endif
+        return 0;
+    }
+
+#if CV_AVX2_DISPATCH
+    bool haveAVX2;
+#endif
+};
+
+
 template<class CastOp, class VecOp, typename AT>
 static void remapBilinear( const Mat& _src, Mat& _dst, const Mat& _xy,
                            const Mat& _fxy, const void* _wtab,
@@ -2663,7 +2854,7 @@ static void remapBilinear( const Mat& _src, Mat& _dst, const Mat& _xy,
 }
 
 
-template<class CastOp, typename AT, int ONE>
+template<class CastOp, class VecOp, typename AT, int ONE>
 static void remapBicubic( const Mat& _src, Mat& _dst, const Mat& _xy,
                           const Mat& _fxy, const void* _wtab,
                           int borderType, const Scalar& _borderValue )
@@ -2681,6 +2872,7 @@ static void remapBicubic( const Mat& _src, Mat& _dst, const Mat& _xy,
         saturate_cast<T>(_borderValue[3]));
     int dx, dy;
     CastOp castOp;
+    VecOp vecOp;
     int borderType1 = borderType != BORDER_TRANSPARENT ? borderType : BORDER_REFLECT_101;
 
     unsigned width1 = std::max(ssize.width-3, 0), height1 = std::max(ssize.height-3, 0);
@@ -2696,9 +2888,22 @@ static void remapBicubic( const Mat& _src, Mat& _dst, const Mat& _xy,
         T* D = (T*)(_dst.data + _dst.step*dy);
         const short* XY = (const short*)(_xy.data + _xy.step*dy);
         const ushort* FXY = (const ushort*)(_fxy.data + _fxy.step*dy);
+        int vecEnd = 0;
 
         for( dx = 0; dx < dsize.width; dx++, D += cn )
         {
+            if( dx >= vecEnd )
+            {
+                // the vectorized code stops at the first block of 8 pixels that has samples outside
+                // of the image; such pixels are processed here, one block before the next attempt
+                int len = vecOp( _src, D, XY + dx*2, FXY + dx, wtab, dsize.width - dx );
+                D += len*cn;
+                dx += len;
+                vecEnd = dx + 8;
+                if( dx >= dsize.width )
+                    break;
+            }
+
             int sx = XY[dx*2]-1, sy = XY[dx*2+1]-1;
             const AT* w = wtab + FXY[dx]*16;
             int i, k;
@@ -2768,7 +2973,7 @@ static void remapBicubic( const Mat& _src, Mat& _dst, const Mat& _xy,
 }
 
 
-template<class CastOp, typename AT, int ONE>
+template<class CastOp, class VecOp, typename AT, int ONE>
 static void remapLanczos4( const Mat& _src, Mat& _dst, const Mat& _xy,
                            const Mat& _fxy, const void* _wtab,
                            int borderType, const Scalar& _borderValue )
@@ -2786,6 +2991,7 @@ static void remapLanczos4( const Mat& _src, Mat& _dst, const Mat& _xy,
         saturate_cast<T>(_borderValue[3]));
     int dx, dy;
     CastOp castOp;
+    VecOp vecOp;
     int borderType1 = borderType != BORDER_TRANSPARENT ? borderType : BORDER_REFLECT_101;
 
     unsigned width1 = std::max(ssize.width-7, 0), height1 = std::max(ssize.height-7, 0);
@@ -2801,9 +3007,21 @@ static void remapLanczos4( const Mat& _src, Mat& _dst, const Mat& _xy,
         T* D = (T*)(_dst.data + _dst.step*dy);
         const short* XY = (const short*)(_xy.data + _xy.step*dy);
         const ushort* FXY = (const ushort*)(_fxy.data + _fxy.step*dy);
+        int vecEnd = 0;
 
         for( dx = 0; dx < dsize.width; dx++, D += cn )
         {
+            if( dx >= vecEnd )
+            {
+                // the blocks that touch the border are left to the code below, as in remapBicubic
+                int len = vecOp( _src, D, XY + dx*2, FXY + dx, wtab, dsize.width - dx );
+                D += len*cn;
+                dx += len;
+                vecEnd = dx + 8;
+                if( dx >= dsize.width )
+                    break;
+            }
+
             int sx = XY[dx*2]-3, sy = XY[dx*2+1]-3;
             const AT* w = wtab + FXY[dx]*64;
             const T* S = S0 + sy*sstep + sx*cn;
@@ -3100,28 +3318,28 @@ void cv::remap( InputArray _src, OutputArray _dst,
     static RemapFunc linear_tab[] =
     {
         remapBilinear<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapVec_8u, short>, 0,
-        remapBilinear<Cast<float, ushort>, RemapNoVec, float>,
-        remapBilinear<Cast<float, short>, RemapNoVec, float>, 0,
+        remapBilinear<Cast<float, ushort>, RemapGatherVec<ushort, 2>, float>,
+        remapBilinear<Cast<float, short>, RemapGatherVec<short, 2>, float>, 0,
         remapBilinear<Cast<float, float>, RemapNoVec, float>,
         remapBilinear<Cast<double, double>, RemapNoVec, float>, 0
     };
 
     static RemapFunc cubic_tab[] =
     {
-        remapBicubic<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE>, 0,
-        remapBicubic<Cast<float, ushort>, float, 1>,
-        remapBicubic<Cast<float, short>, float, 1>, 0,
-        remapBicubic<Cast<float, float>, float, 1>,
-        remapBicubic<Cast<double, double>, float, 1>, 0
+        remapBicubic<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapNoVec, short, INTER_REMAP_COEF_SCALE>, 0,
+        remapBicubic<Cast<float, ushort>, RemapGatherVec<ushort, 4>, float, 1>,
+        remapBicubic<Cast<float, short>, RemapGatherVec<short, 4>, float, 1>, 0,
+        remapBicubic<Cast<float, float>, RemapGatherVec<float, 4>, float, 1>,
+        remapBicubic<Cast<double, double>, RemapNoVec, float, 1>, 0
     };
 
     static RemapFunc lanczos4_tab[] =
     {
-        remapLanczos4<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, short, INTER_REMAP_COEF_SCALE>, 0,
-        remapLanczos4<Cast<float, ushort>, float, 1>,
-        remapLanczos4<Cast<float, short>, float, 1>, 0,
-        remapLanczos4<Cast<float, float>, float, 1>,
-        remapLanczos4<Cast<double, double>, float, 1>, 0
+        remapLanczos4<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapNoVec, short, INTER_REMAP_COEF_SCALE>, 0,
+        remapLanczos4<Cast<float, ushort>, RemapGatherVec<ushort, 8>, float, 1>,
+        remapLanczos4<Cast<float, short>, RemapGatherVec<short, 8>, float, 1>, 0,
+        remapLanczos4<Cast<float, float>, RemapGatherVec<float, 8>, float, 1>,
+        remapLanczos4<Cast<double, double>, RemapNoVec, float, 1>, 0
     };
 
     Mat src = _src.getMat(), map1 = _map1.getMat(), map2 = _map2.getMat();
@@ -3327,6 +3545,106 @@ void cv::convertMaps( InputArray _map1, InputArray _map2,
 namespace cv
 {
 
+// computes the source coordinates of the pixels [x, x + bw) of the destination row y in the format of
+// remap(): integer coordinates in xy and, unless interpolation is INTER_NEAREST, the fractional parts
+// in alpha; adelta and bdelta hold M[0]*x and M[3]*x of every destination column in fixed point
+static void warpAffineRow( const double* M, const int* adelta, const int* bdelta, int interpolation,
+                           int y, int x, int bw, short* xy, short* alpha, bool useSIMD )
+{
+    const int AB_BITS = MAX(10, (int)INTER_BITS);
+    const int AB_SCALE = 1 << AB_BITS;
+    int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2, x1 = 0;
+    int X0 = saturate_cast<int>((M[1]*y + M[2])*AB_SCALE) + round_delta;
+    int Y0 = saturate_cast<int>((M[4]*y + M[5])*AB_SCALE) + round_delta;
+
+    if( interpolation == INTER_NEAREST )
+    {
+        for( ; x1 < bw; x1++ )
+        {
+            int X = (X0 + adelta[x+x1]) >> AB_BITS;
+            int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
+            xy[x1*2] = saturate_cast<short>(X);
+            xy[x1*2+1] = saturate_cast<short>(Y);
+        }
+        return;
+    }
+
+#if CV_SSE2
+    if( useSIMD )
+    {
+        __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
+        __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
+        for( ; x1 <= bw - 8; x1 += 8 )
+        {
+            __m128i tx0, tx1, ty0, ty1;
+            tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
+            ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
+            tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
+            ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
+
+            tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
+            ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
+            tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
+            ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
+
+            __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
+                                        _mm_and_si128(tx1, fxy_mask));
+            __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
+                                        _mm_and_si128(ty1, fxy_mask));
+            tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
+                                        _mm_srai_epi32(tx1, INTER_BITS));
+            ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
+                                _mm_srai_epi32(ty1, INTER_BITS));
+            fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
+
+            _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
+            _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
+            _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
+        }
+    }
+#else
+    (void)useSIMD;
+#endif
+    for( ; x1 < bw; x1++ )
+    {
+        int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
+        int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
+        xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+        xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+        alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                (X & (INTER_TAB_SIZE-1)));
+    }
+}
+
+// converts the user matrix into the inverse transformation and fills the per-column fixed-point terms
+static void initWarpAffine( const Mat& M0, int flags, int width, double* M, int* adelta, int* bdelta )
+{
+    Mat matM(2, 3, CV_64F, M);
+    CV_Assert( (M0.type() == CV_32F || M0.type() == CV_64F) && M0.rows == 2 && M0.cols == 3 );
+    M0.convertTo(matM, matM.type());
+
+    if( !(flags & WARP_INVERSE_MAP) )
+    {
+        double D = M[0]*M[4] - M[1]*M[3];
+        D = D != 0 ? 1./D : 0;
+        double A11 = M[4]*D, A22=M[0]*D;
+        M[0] = A11; M[1] *= -D;
+        M[3] *= -D; M[4] = A22;
+        double b1 = -M[0]*M[2] - M[1]*M[5];
+        double b2 = -M[3]*M[2] - M[4]*M[5];
+        M[2] = b1; M[5] = b2;
+    }
+
+    const int AB_BITS = MAX(10, (int)INTER_BITS);
+    const int AB_SCALE = 1 << AB_BITS;
+
+    for( int x = 0; x < width; x++ )
+    {
+        adelta[x] = saturate_cast<int>(M[0]*x*AB_SCALE);
+        bdelta[x] = saturate_cast<int>(M[3]*x*AB_SCALE);
+    }
+}
+
 class warpAffineInvoker :
     public ParallelLoopBody
 {
@@ -3343,11 +3661,10 @@ public:
     {
         const int BLOCK_SZ = 64;
         short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
-        const int AB_BITS = MAX(10, (int)INTER_BITS);
-        const int AB_SCALE = 1 << AB_BITS;
-        int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2, x, y, x1, y1;
+        int x, y, y1;
+        bool useSIMD = false;
     #if CV_SSE2
-        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+        useSIMD = checkHardwareSupport(CV_CPU_SSE2);
     #endif
 
         int bh0 = std::min(BLOCK_SZ/2, dst.rows);
@@ -3365,68 +3682,8 @@ public:
                 Mat dpart(dst, Rect(x, y, bw, bh));
 
                 for( y1 = 0; y1 < bh; y1++ )
-                {
-                    short* xy = XY + y1*bw*2;
-                    int X0 = saturate_cast<int>((M[1]*(y + y1) + M[2])*AB_SCALE) + round_delta;
-                    int Y0 = saturate_cast<int>((M[4]*(y + y1) + M[5])*AB_SCALE) + round_delta;
-
-                    if( interpolation == INTER_NEAREST )
-                        for( x1 = 0; x1 < bw; x1++ )
-                        {
-                            int X = (X0 + adelta[x+x1]) >> AB_BITS;
-                            int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
-                            xy[x1*2] = saturate_cast<short>(X);
-                            xy[x1*2+1] = saturate_cast<short>(Y);
-                        }
-                    else
-                    {
-                        short* alpha = A + y1*bw;
-                        x1 = 0;
-                    #if CV_SSE2
-                        if( useSIMD )
-                        {
-                            __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
-                            __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
-                            for( ; x1 <= bw - 8; x1 += 8 )
-                            {
-                                __m128i tx0, tx1, ty0, ty1;
-                                tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
-                                ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
-                                tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
-                                ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
-
-                                tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
-                                ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
-                                tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
-                                ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
-
-                                __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
-                                                            _mm_and_si128(tx1, fxy_mask));
-                                __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
-                                                            _mm_and_si128(ty1, fxy_mask));
-                                tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
-                                                            _mm_srai_epi32(tx1, INTER_BITS));
-                                ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
-                                                    _mm_srai_epi32(ty1, INTER_BITS));
-                                fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
-
-                                _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
-                                _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
-                                _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
-                            }
-                        }
-                    #endif
-                        for( ; x1 < bw; x1++ )
-                        {
-                            int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                            int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                    (X & (INTER_TAB_SIZE-1)));
-                        }
-                    }
-                }
+                    warpAffineRow(M, adelta, bdelta, interpolation, y + y1, x, bw,
+                                  XY + y1*bw*2, A + y1*bw, useSIMD);
 
                 if( interpolation == INTER_NEAREST )
                     remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
@@ -3463,42 +3720,23 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
         src = src.clone();
 
     double M[6];
-    Mat matM(2, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
     if( interpolation == INTER_AREA )
         interpolation = INTER_LINEAR;
 
-    CV_Assert( (M0.type() == CV_32F || M0.type() == CV_64F) && M0.rows == 2 && M0.cols == 3 );
-    M0.convertTo(matM, matM.type());
-
 #ifdef HAVE_TEGRA_OPTIMIZATION
-    if( tegra::warpAffine(src, dst, M, flags, borderType, borderValue) )
-        return;
-#endif
-
-    if( !(flags & WARP_INVERSE_MAP) )
     {
-        double D = M[0]*M[4] - M[1]*M[3];
-        D = D != 0 ? 1./D : 0;
-        double A11 = M[4]*D, A22=M[0]*D;
-        M[0] = A11; M[1] *= -D;
-        M[3] *= -D; M[4] = A22;
-        double b1 = -M[0]*M[2] - M[1]*M[5];
-        double b2 = -M[3]*M[2] - M[4]*M[5];
-        M[2] = b1; M[5] = b2;
+        Mat matM(2, 3, CV_64F, M);
+        CV_Assert( (M0.type() == CV_32F || M0.type() == CV_64F) && M0.rows == 2 && M0.cols == 3 );
+        M0.convertTo(matM, matM.type());
+        if( tegra::warpAffine(src, dst, M, flags, borderType, borderValue) )
+            return;
     }
+#endif
 
-    int x;
     AutoBuffer<int> _abdelta(dst.cols*2);
     int* adelta = &_abdelta[0], *bdelta = adelta + dst.cols;
-    const int AB_BITS = MAX(10, (int)INTER_BITS);
-    const int AB_SCALE = 1 << AB_BITS;
-
-    for( x = 0; x < dst.cols; x++ )
-    {
-        adelta[x] = saturate_cast<int>(M[0]*x*AB_SCALE);
-        bdelta[x] = saturate_cast<int>(M[3]*x*AB_SCALE);
-    }
+    initWarpAffine(M0, flags, dst.cols, M, adelta, bdelta);
 
     Range range(0, dst.rows);
     warpAffineInvoker invoker(src, dst, interpolation, borderType,
@@ -3510,6 +3748,68 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
 namespace cv
 {
 
+enum { WARP_PERSPECTIVE_BLOCK_SZ = 32 };
+
+// the width of the blocks that warpPerspective() processes; the coordinates are accumulated from the left
+// edge of a block, so the same blocks have to be used to reproduce them exactly
+static int warpPerspectiveBlockWidth( Size dsize )
+{
+    const int BLOCK_SZ = WARP_PERSPECTIVE_BLOCK_SZ;
+    int bh0 = std::min(BLOCK_SZ/2, dsize.height);
+    return std::min(BLOCK_SZ*BLOCK_SZ/bh0, dsize.width);
+}
+
+// the same as warpAffineRow() for the perspective transformation; x is the left edge of a block
+static void warpPerspectiveRow( const double* M, int interpolation, int y, int x, int bw,
+                                short* xy, short* alpha )
+{
+    double X0 = M[0]*x + M[1]*y + M[2];
+    double Y0 = M[3]*x + M[4]*y + M[5];
+    double W0 = M[6]*x + M[7]*y + M[8];
+    int x1;
+
+    if( interpolation == INTER_NEAREST )
+        for( x1 = 0; x1 < bw; x1++ )
+        {
+            double W = W0 + M[6]*x1;
+            W = W ? 1./W : 0;
+            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+            int X = saturate_cast<int>(fX);
+            int Y = saturate_cast<int>(fY);
+
+            xy[x1*2] = saturate_cast<short>(X);
+            xy[x1*2+1] = saturate_cast<short>(Y);
+        }
+    else
+    {
+        for( x1 = 0; x1 < bw; x1++ )
+        {
+            double W = W0 + M[6]*x1;
+            W = W ? INTER_TAB_SIZE/W : 0;
+            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+            int X = saturate_cast<int>(fX);
+            int Y = saturate_cast<int>(fY);
+
+            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                                (X & (INTER_TAB_SIZE-1)));
+        }
+    }
+}
+
+static void initWarpPerspective( const Mat& M0, int flags, double* M )
+{
+    Mat matM(3, 3, CV_64F, M);
+    CV_Assert( (M0.type() == CV_32F || M0.type() == CV_64F) && M0.rows == 3 && M0.cols == 3 );
+    M0.convertTo(matM, matM.type());
+
+    if( !(flags & WARP_INVERSE_MAP) )
+         invert(matM, matM);
+}
+
 class warpPerspectiveInvoker :
     public ParallelLoopBody
 {
@@ -3524,13 +3824,12 @@ public:
 
     virtual void operator() (const Range& range) const
     {
-        const int BLOCK_SZ = 32;
+        const int BLOCK_SZ = WARP_PERSPECTIVE_BLOCK_SZ;
         short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
-        int x, y, x1, y1, width = dst.cols, height = dst.rows;
+        int x, y, y1, width = dst.cols, height = dst.rows;
 
-        int bh0 = std::min(BLOCK_SZ/2, height);
-        int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
-        bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
+        int bw0 = warpPerspectiveBlockWidth(dst.size());
+        int bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
 
         for( y = range.start; y < range.end; y += bh0 )
         {
@@ -3543,44 +3842,7 @@ public:
                 Mat dpart(dst, Rect(x, y, bw, bh));
 
                 for( y1 = 0; y1 < bh; y1++ )
-                {
-                    short* xy = XY + y1*bw*2;
-                    double X0 = M[0]*x + M[1]*(y + y1) + M[2];
-                    double Y0 = M[3]*x + M[4]*(y + y1) + M[5];
-                    double W0 = M[6]*x + M[7]*(y + y1) + M[8];
-
-                    if( interpolation == INTER_NEAREST )
-                        for( x1 = 0; x1 < bw; x1++ )
-                        {
-                            double W = W0 + M[6]*x1;
-                            W = W ? 1./W : 0;
-                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                            int X = saturate_cast<int>(fX);
-                            int Y = saturate_cast<int>(fY);
-
-                            xy[x1*2] = saturate_cast<short>(X);
-                            xy[x1*2+1] = saturate_cast<short>(Y);
-                        }
-                    else
-                    {
-                        short* alpha = A + y1*bw;
-                        for( x1 = 0; x1 < bw; x1++ )
-                        {
-                            double W = W0 + M[6]*x1;
-                            W = W ? INTER_TAB_SIZE/W : 0;
-                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                            int X = saturate_cast<int>(fX);
-                            int Y = saturate_cast<int>(fY);
-
-                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                                (X & (INTER_TAB_SIZE-1)));
-                        }
-                    }
-                }
+                    warpPerspectiveRow(M, interpolation, y + y1, x, bw, XY + y1*bw*2, A + y1*bw);
 
                 if( interpolation == INTER_NEAREST )
                     remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
@@ -3615,21 +3877,21 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
         src = src.clone();
 
     double M[9];
-    Mat matM(3, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
     if( interpolation == INTER_AREA )
         interpolation = INTER_LINEAR;
 
-    CV_Assert( (M0.type() == CV_32F || M0.type() == CV_64F) && M0.rows == 3 && M0.cols == 3 );
-    M0.convertTo(matM, matM.type());
-
 #ifdef HAVE_TEGRA_OPTIMIZATION
-    if( tegra::warpPerspective(src, dst, M, flags, borderType, borderValue) )
-        return;
+    {
+        Mat matM(3, 3, CV_64F, M);
+        CV_Assert( (M0.type() == CV_32F || M0.type() == CV_64F) && M0.rows == 3 && M0.cols == 3 );
+        M0.convertTo(matM, matM.type());
+        if( tegra::warpPerspective(src, dst, M, flags, borderType, borderValue) )
+            return;
+    }
 #endif
 
-    if( !(flags & WARP_INVERSE_MAP) )
-         invert(matM, matM);
+    initWarpPerspective(M0, flags, M);
 
     Range range(0, dst.rows);
     warpPerspectiveInvoker invoker(src, dst, M, interpolation, borderType, borderValue);
@@ -3637,6 +3899,178 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
 }
 
 
+//////////////////////////////////// WarpPlan ////////////////////////////////////
+
+namespace cv
+{
+
+class WarpPlanMapInvoker :
+    public ParallelLoopBody
+{
+public:
+    WarpPlanMapInvoker(Mat& _map1, Mat& _map2, const double* _M, bool _perspective, int _interpolation,
+                       const int* _adelta, const int* _bdelta) :
+        ParallelLoopBody(), map1(_map1), map2(_map2), M(_M), perspective(_perspective),
+        interpolation(_interpolation), adelta(_adelta), bdelta(_bdelta)
+    {
+    }
+
+    virtual void operator() (const Range& range) const
+    {
+        int width = map1.cols;
+        int bw0 = perspective ? warpPerspectiveBlockWidth(map1.size()) : width;
+        bool useSIMD = false;
+    #if CV_SSE2
+        useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+    #endif
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            short* xy = map1.ptr<short>(y);
+            short* alpha = map2.data ? map2.ptr<short>(y) : 0;
+
+            for( int x = 0; x < width; x += bw0 )
+            {
+                int bw = std::min(bw0, width - x);
+                if( perspective )
+                    warpPerspectiveRow(M, interpolation, y, x, bw, xy + x*2, alpha ? alpha + x : 0);
+                else
+                    warpAffineRow(M, adelta, bdelta, interpolation, y, x, bw,
+                                  xy + x*2, alpha ? alpha + x : 0, useSIMD);
+            }
+        }
+    }
+
+private:
+    Mat& map1;
+    Mat& map2;
+    const double* M;
+    bool perspective;
+    int interpolation;
+    const int* adelta;
+    const int* bdelta;
+};
+
+// warps a horizontal band of one image of the batch
+class WarpPlanBatchInvoker :
+    public ParallelLoopBody
+{
+public:
+    WarpPlanBatchInvoker(const WarpPlan& _plan, const std::vector<Mat>& _src, std::vector<Mat>& _dst,
+                         int _nbands, int _borderMode, const Scalar& _borderValue) :
+        ParallelLoopBody(), plan(_plan), src(_src), dst(_dst), nbands(_nbands),
+        borderMode(_borderMode), borderValue(_borderValue)
+    {
+    }
+
+    virtual void operator() (const Range& range) const
+    {
+        int rows = plan.map1.rows;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int k = i / nbands, band = i % nbands;
+            Range r(band*rows/nbands, (band + 1)*rows/nbands);
+            Mat dpart = dst[k].rowRange(r);
+            remap(src[k], dpart, plan.map1.rowRange(r), plan.map2.data ? plan.map2.rowRange(r) : Mat(),
+                  plan.interpolation, borderMode, borderValue);
+        }
+    }
+
+private:
+    const WarpPlan& plan;
+    const std::vector<Mat>& src;
+    std::vector<Mat>& dst;
+    int nbands, borderMode;
+    Scalar borderValue;
+};
+
+}
+
+cv::WarpPlan::WarpPlan() : interpolation(INTER_LINEAR)
+{
+}
+
+void cv::WarpPlan::initAffine( InputArray _M, Size _dsize, int flags )
+{
+    init(_M, _dsize, flags, false);
+}
+
+void cv::WarpPlan::initPerspective( InputArray _M, Size _dsize, int flags )
+{
+    init(_M, _dsize, flags, true);
+}
+
+void cv::WarpPlan::init( InputArray _M, Size _dsize, int flags, bool perspective )
+{
+    Mat M0 = _M.getMat();
+    CV_Assert( _dsize.width > 0 && _dsize.height > 0 );
+
+    interpolation = flags & INTER_MAX;
+    if( interpolation == INTER_AREA )
+        interpolation = INTER_LINEAR;
+    if( interpolation != INTER_NEAREST && interpolation != INTER_LINEAR &&
+        interpolation != INTER_CUBIC && interpolation != INTER_LANCZOS4 )
+        CV_Error( CV_StsBadArg, "Unknown interpolation method" );
+
+    double M[9];
+    AutoBuffer<int> _abdelta(perspective ? 1 : _dsize.width*2);
+    int* adelta = &_abdelta[0], *bdelta = adelta + _dsize.width;
+    if( perspective )
+        initWarpPerspective(M0, flags, M);
+    else
+        initWarpAffine(M0, flags, _dsize.width, M, adelta, bdelta);
+
+    map1.create(_dsize, CV_16SC2);
+    if( interpolation == INTER_NEAREST )
+        map2.release();
+    else
+        map2.create(_dsize, CV_16UC1);
+
+    WarpPlanMapInvoker invoker(map1, map2, M, perspective, interpolation, adelta, bdelta);
+    parallel_for_(Range(0, _dsize.height), invoker, _dsize.area()/(double)(1<<16));
+}
+
+bool cv::WarpPlan::empty() const
+{
+    return map1.empty();
+}
+
+cv::Size cv::WarpPlan::size() const
+{
+    return map1.size();
+}
+
+void cv::WarpPlan::apply( InputArray _src, OutputArray _dst, int borderMode, const Scalar& borderValue ) const
+{
+    CV_Assert( !empty() );
+    remap(_src, _dst, map1, map2, interpolation, borderMode, borderValue);
+}
+
+void cv::WarpPlan::apply( const std::vector<Mat>& src, std::vector<Mat>& dst,
+                          int borderMode, const Scalar& borderValue ) const
+{
+    CV_Assert( !empty() );
+
+    size_t n = src.size();
+    dst.resize(n);
+    for( size_t k = 0; k < n; k++ )
+    {
+        CV_Assert( !src[k].empty() && src[k].data != dst[k].data );
+        dst[k].create(map1.size(), src[k].type());
+    }
+    if( n == 0 )
+        return;
+
+    // small images, like mosaic tiles, are processed one per thread;
+    // large ones are additionally split into horizontal bands
+    int nbands = std::max((int)(map1.total() >> 16), 1);
+    nbands = std::min(nbands, std::max(map1.rows/16, 1));
+
+    WarpPlanBatchInvoker invoker(*this, src, dst, nbands, borderMode, borderValue);
+    parallel_for_(Range(0, (int)n*nbands), invoker);
+}
+
+
 cv::Mat cv::getRotationMatrix2D( Point2f center, double angle, double scale )
 {
     angle *= CV_PI/180;
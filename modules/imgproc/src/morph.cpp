@@ -1081,6 +1081,10 @@ cv::Mat cv::getStructuringElement(int shape, Size ksize, Point anchor)
 namespace cv
 {
 
+// images smaller than MORPH_PARALLEL_MIN_SIZE bytes (src and dst together) are processed
+// in the calling thread; every stripe re-filters the kernel.rows-1 rows around its borders
+enum { MORPH_PARALLEL_MIN_SIZE = 1 << 16, MORPH_MIN_STRIPE_ROWS = 16 };
+
 class MorphologyRunner
 {
 public:
@@ -1173,12 +1177,14 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
     }
 
     int nStripes = 1;
-#if defined HAVE_TBB && defined HAVE_TEGRA_OPTIMIZATION
-    if (src.data != dst.data && iterations == 1 &&  //NOTE: threads are not used for inplace processing
+    bool overlap = src.datastart < dst.dataend && dst.datastart < src.dataend;
+    if (!overlap && iterations == 1 &&  //NOTE: threads are not used for inplace processing
         (borderType & BORDER_ISOLATED) == 0 && //TODO: check border types
-        src.rows >= 64 ) //NOTE: just heuristics
-        nStripes = 4;
-#endif
+        src.total()*src.elemSize()*2 >= (size_t)MORPH_PARALLEL_MIN_SIZE )
+    {
+        int minStripeRows = std::max((kernel.rows - 1)*4, (int)MORPH_MIN_STRIPE_ROWS);
+        nStripes = std::max(std::min(getNumThreads(), src.rows/minStripeRows), 1);
+    }
 
     parallel_for(BlockedRange(0, nStripes),
                  MorphologyRunner(src, dst, nStripes, iterations, op, kernel, anchor, borderType, borderType, borderValue));
@@ -97,6 +97,25 @@ void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Point anchor=Point(0,0), double delta=0,
                 int borderType=BORDER_REFLECT_101 );
 
+// FilterEngine and the filters inside it keep state between the rows they process,
+// so every thread of the parallel filter driver creates its own engine
+class FilterEngineFactory
+{
+public:
+    virtual ~FilterEngineFactory() {}
+    virtual Ptr<FilterEngine> operator()() const = 0;
+    // the height of the kernel the engine will have; it decides how the image is split
+    virtual int kernelHeight() const = 0;
+};
+
+// does the same as factory()->apply(src, dst, Rect(0,0,-1,-1), Point(), isolated),
+// but splits dst into horizontal bands that are filtered in parallel when the image is large enough
+void applyFilterEngine( const FilterEngineFactory& factory, const Mat& src, Mat& dst,
+                        bool isolated=false );
+
+// the 256-bin histogram of a single-channel 8-bit image or ROI; big images are counted in parallel stripes
+void calcHist_8uC1( const Mat& src, int* hist );
+
 }
 
 typedef struct CvPyramid
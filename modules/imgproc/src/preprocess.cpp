@@ -0,0 +1,381 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                          License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+namespace cv
+{
+
+// The output rows are split into horizontal bands processed in parallel. Every band keeps the two
+// horizontally resampled and color-converted source rows it needs, so the whole conversion
+// reads the source and writes the destination once, without intermediate images.
+enum { RESIZE_PLANAR_PARALLEL_MIN_SIZE = 1 << 16, RESIZE_PLANAR_MIN_BAND_ROWS = 16 };
+
+// how the source pixels are turned into the output channels
+enum { PLANAR_SRC_COPY = 0, PLANAR_SRC_GRAY = 1, PLANAR_SRC_NV = 2 };
+
+// the fixed-point YUV->RGB coefficients of cvtColor(), as floats
+static const float YUV2RGB_CY = 1220542.f/(1 << 20), YUV2RGB_CVR = 1673527.f/(1 << 20),
+    YUV2RGB_CVG = -852492.f/(1 << 20), YUV2RGB_CUG = -409993.f/(1 << 20), YUV2RGB_CUB = 2116026.f/(1 << 20);
+
+// the sampled source positions and weights of the second one along one axis,
+// computed the same way as in resize()
+static void computeResampleTab( int ssize, int dsize, bool linear, int* ofs, float* alpha )
+{
+    double scale = 1./((double)dsize/ssize);
+
+    for( int d = 0; d < dsize; d++ )
+    {
+        int s;
+        float f = 0.f;
+        if( linear )
+        {
+            f = (float)((d + 0.5)*scale - 0.5);
+            s = cvFloor(f);
+            f -= s;
+            if( s < 0 )
+                s = 0, f = 0.f;
+            if( s >= ssize - 1 )
+                s = ssize - 1, f = 0.f;
+        }
+        else
+            s = std::min(cvFloor(d*scale), ssize - 1);
+
+        ofs[d*2] = s;
+        ofs[d*2+1] = std::min(s + 1, ssize - 1);
+        alpha[d] = f;
+    }
+}
+
+class ResizeToPlanarInvoker : public ParallelLoopBody
+{
+public:
+    ResizeToPlanarInvoker( const Mat& _src, Mat& _dst, Size _ssize, Size _dsize, int _mode, int _dcn,
+                           const int* _cidx, int _bIdx, int _uIdx, const int* _xofs, const float* _xalpha,
+                           const int* _yofs, const float* _yalpha, const float* _scale, const float* _shift )
+        : src(_src), dst(_dst), ssize(_ssize), dsize(_dsize), mode(_mode), dcn(_dcn), cidx(_cidx),
+          bIdx(_bIdx), uIdx(_uIdx), xofs(_xofs), xalpha(_xalpha), yofs(_yofs), yalpha(_yalpha),
+          scale(_scale), shift(_shift)
+    {
+#if CV_SSE2
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int dw = dsize.width, dh = dsize.height;
+        // the resampled rows are stored as dcn planes of dw values each
+        AutoBuffer<float> _buf(dw*dcn*2);
+        float* rows[] = { _buf, _buf + dw*dcn };
+        int rowIdx[] = { -1, -1 };
+
+        for( int dy = range.start; dy < range.end; dy++ )
+        {
+            int sy0 = yofs[dy*2], sy1 = yofs[dy*2+1];
+
+            if( rowIdx[0] != sy0 )
+            {
+                if( rowIdx[1] == sy0 )
+                {
+                    std::swap(rows[0], rows[1]);
+                    std::swap(rowIdx[0], rowIdx[1]);
+                }
+                else
+                {
+                    resampleRow(sy0, rows[0]);
+                    rowIdx[0] = sy0;
+                }
+            }
+            if( sy1 != sy0 && rowIdx[1] != sy1 )
+            {
+                resampleRow(sy1, rows[1]);
+                rowIdx[1] = sy1;
+            }
+
+            float b1 = yalpha[dy], b0 = 1.f - b1;
+            const float* r0 = rows[0];
+            const float* r1 = sy1 != sy0 ? rows[1] : rows[0];
+
+            for( int c = 0; c < dcn; c++ )
+            {
+                const float* S0 = r0 + c*dw;
+                const float* S1 = r1 + c*dw;
+                float* D = dst.ptr<float>(c*dh + dy);
+                float s0 = b0*scale[c], s1 = b1*scale[c], delta = shift[c];
+                int x = 0;
+
+#if CV_SSE2
+                if( haveSSE2 )
+                {
+                    __m128 v_s0 = _mm_set1_ps(s0), v_s1 = _mm_set1_ps(s1), v_delta = _mm_set1_ps(delta);
+                    for( ; x <= dw - 8; x += 8 )
+                    {
+                        __m128 v_d0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(S0 + x), v_s0),
+                                                            _mm_mul_ps(_mm_loadu_ps(S1 + x), v_s1)), v_delta);
+                        __m128 v_d1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(S0 + x + 4), v_s0),
+                                                            _mm_mul_ps(_mm_loadu_ps(S1 + x + 4), v_s1)), v_delta);
+                        _mm_storeu_ps(D + x, v_d0);
+                        _mm_storeu_ps(D + x + 4, v_d1);
+                    }
+                }
+#endif
+                for( ; x < dw; x++ )
+                    D[x] = S0[x]*s0 + S1[x]*s1 + delta;
+            }
+        }
+    }
+
+private:
+    void resampleRow( int sy, float* D ) const
+    {
+        if( mode == PLANAR_SRC_NV )
+            resampleRowNV(sy, D);
+        else if( src.depth() == CV_8U )
+            resampleRow_(src.ptr<uchar>(sy), D);
+        else
+            resampleRow_(src.ptr<float>(sy), D);
+    }
+
+    template<typename T> void resampleRow_( const T* S, float* D ) const
+    {
+        int dw = dsize.width;
+
+        if( mode == PLANAR_SRC_GRAY )
+        {
+            float w[3];
+            w[bIdx] = 0.114f; w[1] = 0.587f; w[bIdx^2] = 0.299f;
+
+            for( int x = 0; x < dw; x++ )
+            {
+                const T* p0 = S + xofs[x*2];
+                const T* p1 = S + xofs[x*2+1];
+                float a1 = xalpha[x], a0 = 1.f - a1;
+                D[x] = (p0[0]*w[0] + p0[1]*w[1] + p0[2]*w[2])*a0 + (p1[0]*w[0] + p1[1]*w[1] + p1[2]*w[2])*a1;
+            }
+            return;
+        }
+
+        for( int c = 0; c < dcn; c++ )
+        {
+            const T* Sc = S + cidx[c];
+            float* Dc = D + c*dw;
+            for( int x = 0; x < dw; x++ )
+            {
+                float a1 = xalpha[x];
+                Dc[x] = Sc[xofs[x*2]]*(1.f - a1) + Sc[xofs[x*2+1]]*a1;
+            }
+        }
+    }
+
+    // converts the pixel (y, u, v) with the coefficients of cvtColor(), without rounding
+    static inline void YUV2RGB( int y, int u, int v, float* rgb )
+    {
+        float fy = std::max(y - 16, 0)*YUV2RGB_CY;
+        u -= 128; v -= 128;
+        rgb[0] = saturate_255(fy + YUV2RGB_CVR*v);
+        rgb[1] = saturate_255(fy + YUV2RGB_CVG*v + YUV2RGB_CUG*u);
+        rgb[2] = saturate_255(fy + YUV2RGB_CUB*u);
+    }
+
+    static inline float saturate_255( float v )
+    {
+        v = v > 0.f ? v : 0.f;
+        return v < 255.f ? v : 255.f;
+    }
+
+    void resampleRowNV( int sy, float* D ) const
+    {
+        int dw = dsize.width, x = 0;
+        const uchar* Y = src.ptr<uchar>(sy);
+        const uchar* UV = src.ptr<uchar>(ssize.height + sy/2);
+        float* R = D + (2 - bIdx)*dw;
+        float* G = D + dw;
+        float* B = D + bIdx*dw;
+
+#if CV_SSE2
+        // both taps of a pixel are converted at once, the lanes hold (R, G, B, 0);
+        // the scalar clipping compiles to branches that mispredict on noisy chroma
+        if( haveSSE2 )
+        {
+            __m128 v_cy = _mm_set1_ps(YUV2RGB_CY), v_zero = _mm_setzero_ps(), v_255 = _mm_set1_ps(255.f);
+            __m128 v_cu = _mm_setr_ps(0.f, YUV2RGB_CUG, YUV2RGB_CUB, 0.f);
+            __m128 v_cv = _mm_setr_ps(YUV2RGB_CVR, YUV2RGB_CVG, 0.f, 0.f);
+            float CV_DECL_ALIGNED(16) buf[4];
+
+            for( ; x < dw; x++ )
+            {
+                int x0 = xofs[x*2], x1 = xofs[x*2+1];
+                const uchar* uv0 = UV + (x0 & ~1);
+                const uchar* uv1 = UV + (x1 & ~1);
+                __m128 v_a1 = _mm_set1_ps(xalpha[x]);
+                __m128 v_p0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps((float)std::max(Y[x0] - 16, 0)), v_cy),
+                                                    _mm_mul_ps(_mm_set1_ps((float)(uv0[uIdx] - 128)), v_cu)),
+                                         _mm_mul_ps(_mm_set1_ps((float)(uv0[1 - uIdx] - 128)), v_cv));
+                __m128 v_p1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps((float)std::max(Y[x1] - 16, 0)), v_cy),
+                                                    _mm_mul_ps(_mm_set1_ps((float)(uv1[uIdx] - 128)), v_cu)),
+                                         _mm_mul_ps(_mm_set1_ps((float)(uv1[1 - uIdx] - 128)), v_cv));
+                v_p0 = _mm_min_ps(_mm_max_ps(v_p0, v_zero), v_255);
+                v_p1 = _mm_min_ps(_mm_max_ps(v_p1, v_zero), v_255);
+                _mm_store_ps(buf, _mm_add_ps(v_p0, _mm_mul_ps(_mm_sub_ps(v_p1, v_p0), v_a1)));
+                R[x] = buf[0]; G[x] = buf[1]; B[x] = buf[2];
+            }
+        }
+#endif
+        for( ; x < dw; x++ )
+        {
+            int x0 = xofs[x*2], x1 = xofs[x*2+1];
+            float a1 = xalpha[x], a0 = 1.f - a1;
+            float p0[3], p1[3];
+            const uchar* uv0 = UV + (x0 & ~1);
+            const uchar* uv1 = UV + (x1 & ~1);
+            YUV2RGB(Y[x0], uv0[uIdx], uv0[1 - uIdx], p0);
+            YUV2RGB(Y[x1], uv1[uIdx], uv1[1 - uIdx], p1);
+            R[x] = p0[0]*a0 + p1[0]*a1;
+            G[x] = p0[1]*a0 + p1[1]*a1;
+            B[x] = p0[2]*a0 + p1[2]*a1;
+        }
+    }
+
+    const Mat& src;
+    Mat& dst;
+    Size ssize, dsize;
+    int mode, dcn;
+    const int* cidx;
+    int bIdx, uIdx;
+    const int* xofs;
+    const float* xalpha;
+    const int* yofs;
+    const float* yalpha;
+    const float* scale;
+    const float* shift;
+#if CV_SSE2
+    bool haveSSE2;
+#endif
+};
+
+}
+
+void cv::resizeToPlanar( InputArray _src, OutputArray _dst, Size dsize, int code,
+                         double scale, const Scalar& shift, int interpolation )
+{
+    Mat src = _src.getMat();
+    int depth = src.depth(), scn = src.channels(), dcn = scn;
+    int mode = PLANAR_SRC_COPY, bIdx = 0, uIdx = 0;
+    int cidx[] = { 0, 1, 2, 3 };
+    Size ssize = src.size();
+
+    CV_Assert( !src.empty() );
+    CV_Assert( depth == CV_8U || depth == CV_32F );
+    CV_Assert( dsize.width > 0 && dsize.height > 0 );
+
+    switch( code )
+    {
+    case -1:
+        CV_Assert( scn <= 4 );
+        break;
+    case CV_BGR2RGB: case CV_RGBA2BGR: case CV_BGRA2BGR:
+        CV_Assert( code == CV_BGRA2BGR ? scn == 4 : scn == 3 || scn == 4 );
+        dcn = 3;
+        if( code != CV_BGRA2BGR )
+            std::swap(cidx[0], cidx[2]);
+        break;
+    case CV_BGRA2RGBA:
+        CV_Assert( scn == 4 );
+        std::swap(cidx[0], cidx[2]);
+        break;
+    case CV_BGR2GRAY: case CV_RGB2GRAY: case CV_BGRA2GRAY: case CV_RGBA2GRAY:
+        CV_Assert( scn == 3 || scn == 4 );
+        mode = PLANAR_SRC_GRAY;
+        dcn = 1;
+        bIdx = code == CV_BGR2GRAY || code == CV_BGRA2GRAY ? 0 : 2;
+        break;
+    case CV_YUV2BGR_NV12: case CV_YUV2RGB_NV12: case CV_YUV2BGR_NV21: case CV_YUV2RGB_NV21:
+        CV_Assert( depth == CV_8U && scn == 1 && ssize.width % 2 == 0 && ssize.height % 3 == 0 );
+        mode = PLANAR_SRC_NV;
+        dcn = 3;
+        bIdx = code == CV_YUV2BGR_NV12 || code == CV_YUV2BGR_NV21 ? 0 : 2;
+        uIdx = code == CV_YUV2BGR_NV21 || code == CV_YUV2RGB_NV21 ? 1 : 0;
+        ssize.height = ssize.height*2/3;
+        break;
+    default:
+        CV_Error( CV_StsBadFlag, "Unknown/unsupported color conversion code" );
+    }
+
+    if( interpolation != INTER_NEAREST && interpolation != INTER_LINEAR )
+        CV_Error( CV_StsBadArg, "Unknown interpolation method" );
+
+    _dst.create(dsize.height*dcn, dsize.width, CV_32F);
+    Mat dst = _dst.getMat();
+
+    AutoBuffer<int> _ofs((dsize.width + dsize.height)*2);
+    AutoBuffer<float> _alpha(dsize.width + dsize.height);
+    int* xofs = _ofs, *yofs = xofs + dsize.width*2;
+    float* xalpha = _alpha, *yalpha = xalpha + dsize.width;
+
+    bool linear = interpolation == INTER_LINEAR;
+    computeResampleTab(ssize.width, dsize.width, linear, xofs, xalpha);
+    computeResampleTab(ssize.height, dsize.height, linear, yofs, yalpha);
+    for( int x = 0; x < dsize.width*2; x++ )
+        xofs[x] *= scn;
+
+    float fscale[4], fshift[4];
+    for( int c = 0; c < 4; c++ )
+    {
+        fscale[c] = (float)scale;
+        fshift[c] = (float)shift[c];
+    }
+
+    ResizeToPlanarInvoker body(src, dst, ssize, dsize, mode, dcn, cidx, bIdx, uIdx,
+                               xofs, xalpha, yofs, yalpha, fscale, fshift);
+
+    int nStripes = 1;
+    if( (size_t)dsize.area() >= (size_t)RESIZE_PLANAR_PARALLEL_MIN_SIZE )
+        nStripes = std::max(std::min(getNumThreads(), dsize.height / RESIZE_PLANAR_MIN_BAND_ROWS), 1);
+
+    if( nStripes > 1 )
+        parallel_for_(Range(0, dsize.height), body, nStripes);
+    else
+        body(Range(0, dsize.height));
+}
+
+/* End of file. */
@@ -708,6 +708,36 @@ cv::Ptr<cv::FilterEngine> cv::createBoxFilter( int srcType, int dstType, Size ks
 }
 
 
+namespace cv
+{
+
+class BoxFilterFactory : public FilterEngineFactory
+{
+public:
+    BoxFilterFactory(int _srcType, int _dstType, Size _ksize, Point _anchor,
+                     bool _normalize, int _borderType) :
+        srcType(_srcType), dstType(_dstType), ksize(_ksize), anchor(_anchor),
+        normalize(_normalize), borderType(_borderType)
+    {
+    }
+
+    Ptr<FilterEngine> operator()() const
+    {
+        return createBoxFilter(srcType, dstType, ksize, anchor, normalize, borderType);
+    }
+
+    int kernelHeight() const { return ksize.height; }
+
+private:
+    int srcType, dstType;
+    Size ksize;
+    Point anchor;
+    bool normalize;
+    int borderType;
+};
+
+}
+
 void cv::boxFilter( InputArray _src, OutputArray _dst, int ddepth,
                 Size ksize, Point anchor,
                 bool normalize, int borderType )
@@ -730,9 +760,8 @@ void cv::boxFilter( InputArray _src, OutputArray _dst, int ddepth,
         return;
 #endif
 
-    Ptr<FilterEngine> f = createBoxFilter( src.type(), dst.type(),
-                        ksize, anchor, normalize, borderType );
-    f->apply( src, dst );
+    applyFilterEngine( BoxFilterFactory(src.type(), dst.type(), ksize, anchor,
+                                        normalize, borderType), src, dst );
 }
 
 void cv::blur( InputArray src, OutputArray dst,
@@ -798,6 +827,23 @@ cv::Mat cv::getGaussianKernel( int n, double sigma, int ktype )
 }
 
 
+namespace cv
+{
+
+// automatic detection of kernel size from sigma; sigma2 <= 0 means sigma2 = sigma1
+static Size getGaussianKernelSize( int depth, Size ksize, double sigma1, double sigma2 )
+{
+    if( sigma2 <= 0 )
+        sigma2 = sigma1;
+    if( ksize.width <= 0 && sigma1 > 0 )
+        ksize.width = cvRound(sigma1*(depth == CV_8U ? 3 : 4)*2 + 1)|1;
+    if( ksize.height <= 0 && sigma2 > 0 )
+        ksize.height = cvRound(sigma2*(depth == CV_8U ? 3 : 4)*2 + 1)|1;
+    return ksize;
+}
+
+}
+
 cv::Ptr<cv::FilterEngine> cv::createGaussianFilter( int type, Size ksize,
                                         double sigma1, double sigma2,
                                         int borderType )
@@ -806,11 +852,7 @@ cv::Ptr<cv::FilterEngine> cv::createGaussianFilter( int type, Size ksize,
     if( sigma2 <= 0 )
         sigma2 = sigma1;
 
-    // automatic detection of kernel size from sigma
-    if( ksize.width <= 0 && sigma1 > 0 )
-        ksize.width = cvRound(sigma1*(depth == CV_8U ? 3 : 4)*2 + 1)|1;
-    if( ksize.height <= 0 && sigma2 > 0 )
-        ksize.height = cvRound(sigma2*(depth == CV_8U ? 3 : 4)*2 + 1)|1;
+    ksize = getGaussianKernelSize( depth, ksize, sigma1, sigma2 );
 
     CV_Assert( ksize.width > 0 && ksize.width % 2 == 1 &&
         ksize.height > 0 && ksize.height % 2 == 1 );
@@ -829,6 +871,36 @@ cv::Ptr<cv::FilterEngine> cv::createGaussianFilter( int type, Size ksize,
 }
 
 
+namespace cv
+{
+
+class GaussianFilterFactory : public FilterEngineFactory
+{
+public:
+    GaussianFilterFactory(int _type, Size _ksize, double _sigma1, double _sigma2, int _borderType) :
+        type(_type), ksize(_ksize), sigma1(_sigma1), sigma2(_sigma2), borderType(_borderType)
+    {
+    }
+
+    Ptr<FilterEngine> operator()() const
+    {
+        return createGaussianFilter(type, ksize, sigma1, sigma2, borderType);
+    }
+
+    int kernelHeight() const
+    {
+        return getGaussianKernelSize( CV_MAT_DEPTH(type), ksize, sigma1, sigma2 ).height;
+    }
+
+private:
+    int type;
+    Size ksize;
+    double sigma1, sigma2;
+    int borderType;
+};
+
+}
+
 void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
                    double sigma1, double sigma2,
                    int borderType )
@@ -856,8 +928,8 @@ void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
         return;
 #endif
 
-    Ptr<FilterEngine> f = createGaussianFilter( src.type(), ksize, sigma1, sigma2, borderType );
-    f->apply( src, dst );
+    applyFilterEngine( GaussianFilterFactory(src.type(), ksize, sigma1, sigma2, borderType),
+                       src, dst );
 }
 
 
@@ -936,7 +1008,7 @@ static inline void histogram_muladd( int a, const HT x[16],
 }
 
 static void
-medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize )
+medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize, const Range& rows )
 {
 /**
  * HOP is short for Histogram OPeration. This macro makes an operation \a op on
@@ -974,21 +1046,19 @@ medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize )
         memset( h_coarse, 0, 16*n*cn*sizeof(h_coarse[0]) );
         memset( h_fine, 0, 16*16*n*cn*sizeof(h_fine[0]) );
 
-        // First row initialization
+        // First row initialization: the column histograms of the window
+        // centered at the row above the first one, without the row that is removed next
         for( c = 0; c < cn; c++ )
         {
-            for( j = 0; j < n; j++ )
-                COP( c, j, src[cn*j+c], += (cv::HT)(r+2) );
-
-            for( i = 1; i < r; i++ )
+            for( i = rows.start - r - 1; i < rows.start + r; i++ )
             {
-                const uchar* p = src + sstep*std::min(i, m-1);
+                const uchar* p = src + sstep*std::min(std::max(i, 0), m-1);
                 for ( j = 0; j < n; j++ )
                     COP( c, j, p[cn*j+c], ++ );
             }
         }
 
-        for( i = 0; i < m; i++ )
+        for( i = rows.start; i < rows.end; i++ )
         {
             const uchar* p0 = src + sstep * std::max( 0, i-r-1 );
             const uchar* p1 = src + sstep * std::min( m-1, i+r );
@@ -1143,19 +1213,19 @@ medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize )
 }
 
 static void
-medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m )
+medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m, const Range& rows )
 {
     #define N  16
     int     zone0[4][N];
     int     zone1[4][N*N];
-    int     x, y;
-    int     n2 = m*m/2;
+    int     x, y, i;
+    int     n2 = m*m/2, r = m/2;
     Size    size = _dst.size();
     const uchar* src = _src.data;
     uchar*  dst = _dst.data;
     int     src_step = (int)_src.step, dst_step = (int)_dst.step;
     int     cn = _src.channels();
-    const uchar*  src_max = src + size.height*src_step;
+    int     len = rows.end - rows.start;
 
     #define UPDATE_ACC01( pix, cn, op ) \
     {                                   \
@@ -1164,49 +1234,32 @@ medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m )
         zone0[cn][p >> 4] op;           \
     }
 
-    //CV_Assert( size.height >= nx && size.width >= nx );
+    #define ROW_PTR( y ) (src + src_step*std::min(std::max((y), 0), size.height-1))
+
     for( x = 0; x < size.width; x++, src += cn, dst += cn )
     {
-        uchar* dst_cur = dst;
-        const uchar* src_top = src;
-        const uchar* src_bottom = src;
+        // odd columns are processed bottom-up
+        int dy = x % 2 != 0 ? -1 : 1;
+        int y0 = dy > 0 ? rows.start : rows.end - 1;
+        uchar* dst_cur = dst + dst_step*y0;
         int k, c;
-        int src_step1 = src_step, dst_step1 = dst_step;
-
-        if( x % 2 != 0 )
-        {
-            src_bottom = src_top += src_step*(size.height-1);
-            dst_cur += dst_step*(size.height-1);
-            src_step1 = -src_step1;
-            dst_step1 = -dst_step1;
-        }
+        int dst_step1 = dst_step*dy;
 
         // init accumulator
         memset( zone0, 0, sizeof(zone0[0])*cn );
         memset( zone1, 0, sizeof(zone1[0])*cn );
 
-        for( y = 0; y <= m/2; y++ )
+        for( y = y0 - r; y <= y0 + r; y++ )
         {
+            const uchar* src_row = ROW_PTR(y);
             for( c = 0; c < cn; c++ )
             {
-                if( y > 0 )
-                {
-                    for( k = 0; k < m*cn; k += cn )
-                        UPDATE_ACC01( src_bottom[k+c], c, ++ );
-                }
-                else
-                {
-                    for( k = 0; k < m*cn; k += cn )
-                        UPDATE_ACC01( src_bottom[k+c], c, += m/2+1 );
-                }
+                for( k = 0; k < m*cn; k += cn )
+                    UPDATE_ACC01( src_row[k+c], c, ++ );
             }
-
-            if( (src_step1 > 0 && y < size.height-1) ||
-                (src_step1 < 0 && size.height-y-1 > 0) )
-                src_bottom += src_step1;
         }
 
-        for( y = 0; y < size.height; y++, dst_cur += dst_step1 )
+        for( i = 0, y = y0; i < len; i++, y += dy, dst_cur += dst_step1 )
         {
             // find median
             for( c = 0; c < cn; c++ )
@@ -1228,9 +1281,11 @@ medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m )
                 dst_cur[c] = (uchar)k;
             }
 
-            if( y+1 == size.height )
+            if( i+1 == len )
                 break;
 
+            const uchar* src_top = ROW_PTR(y - r*dy);
+            const uchar* src_bottom = ROW_PTR(y + (r+1)*dy);
             if( cn == 1 )
             {
                 for( k = 0; k < m; k++ )
@@ -1272,17 +1327,106 @@ medianBlur_8u_Om( const Mat& _src, Mat& _dst, int m )
                     UPDATE_ACC01( src_bottom[k+3], 3, ++ );
                 }
             }
+        }
+    }
+#undef N
+#undef UPDATE_ACC01
+#undef ROW_PTR
+}
 
-            if( (src_step1 > 0 && src_bottom + src_step1 < src_max) ||
-                (src_step1 < 0 && src_bottom + src_step1 >= src) )
-                src_bottom += src_step1;
+// Huang's running histogram for 16-bit images. The histogram has four levels of 16, 256, 4096
+// and 65536 bins, so the median is found after looking at no more than 64 bins. The window
+// moves down one column and up the next one, and every move updates 2*ksize pixels.
+enum { MEDIAN16_L1 = 16, MEDIAN16_L2 = MEDIAN16_L1 + 256, MEDIAN16_L3 = MEDIAN16_L2 + 4096,
+       MEDIAN16_HIST_SIZE = MEDIAN16_L3 + 65536 };
 
-            if( y >= m/2 )
-                src_top += src_step1;
+template<typename T> static inline void
+medianHist16Update( ushort* hist, const T* p, int cn, int bias, int delta )
+{
+    for( int c = 0; c < cn; c++, hist += MEDIAN16_HIST_SIZE )
+    {
+        int v = p[c] + bias;
+        hist[v >> 12] = (ushort)(hist[v >> 12] + delta);
+        hist[MEDIAN16_L1 + (v >> 8)] = (ushort)(hist[MEDIAN16_L1 + (v >> 8)] + delta);
+        hist[MEDIAN16_L2 + (v >> 4)] = (ushort)(hist[MEDIAN16_L2 + (v >> 4)] + delta);
+        hist[MEDIAN16_L3 + v] = (ushort)(hist[MEDIAN16_L3 + v] + delta);
+    }
+}
+
+static inline int medianHist16Find( const ushort* hist, int n2 )
+{
+    static const int levelOfs[] = { 0, MEDIAN16_L1, MEDIAN16_L2, MEDIAN16_L3 };
+    int s = 0, k = 0;
+    for( int l = 0; l < 4; l++ )
+    {
+        const ushort* h = hist + levelOfs[l] + k*16;
+        int b = 0;
+        for( ; ; b++ )
+        {
+            int t = s + h[b];
+            if( t > n2 ) break;
+            s = t;
         }
+        k = k*16 + b;
     }
-#undef N
-#undef UPDATE_ACC
+    return k;
+}
+
+template<typename T> static void
+medianBlur_16u_Om( const Mat& _src, Mat& _dst, int m, const Range& rows )
+{
+    Size size = _dst.size();
+    int cn = _src.channels(), r = m/2, n2 = m*m/2;
+    int bias = DataType<T>::depth == CV_16S ? 32768 : 0;
+    size_t sstep = _src.step/sizeof(T);
+    AutoBuffer<ushort> _hist(MEDIAN16_HIST_SIZE*cn);
+    ushort* hist = _hist;
+    const T* src = (const T*)_src.data;
+    int x = 0, y = rows.start, dy = 1, i, k;
+
+    #define ROW_PTR( y ) (src + sstep*std::min(std::max((y), 0), size.height-1))
+
+    memset( hist, 0, MEDIAN16_HIST_SIZE*cn*sizeof(hist[0]) );
+    for( i = y - r; i <= y + r; i++ )
+    {
+        const T* p = ROW_PTR(i);
+        for( k = 0; k < m*cn; k += cn )
+            medianHist16Update( hist, p + k, cn, bias, 1 );
+    }
+
+    for( ;; )
+    {
+        T* d = (T*)(_dst.data + _dst.step*y) + x*cn;
+        for( int c = 0; c < cn; c++ )
+            d[c] = (T)(medianHist16Find( hist + MEDIAN16_HIST_SIZE*c, n2 ) - bias);
+
+        if( y + dy >= rows.start && y + dy < rows.end )
+        {
+            const T* p0 = ROW_PTR(y - r*dy) + x*cn;
+            const T* p1 = ROW_PTR(y + (r+1)*dy) + x*cn;
+            for( k = 0; k < m*cn; k += cn )
+            {
+                medianHist16Update( hist, p0 + k, cn, bias, -1 );
+                medianHist16Update( hist, p1 + k, cn, bias, 1 );
+            }
+            y += dy;
+        }
+        else
+        {
+            // the source has ksize/2 extra columns on each side, so the window moves
+            // from the columns [x, x+ksize) to [x+1, x+ksize+1)
+            if( ++x >= size.width )
+                break;
+            for( i = y - r; i <= y + r; i++ )
+            {
+                const T* p = ROW_PTR(i) + (x - 1)*cn;
+                medianHist16Update( hist, p, cn, bias, -1 );
+                medianHist16Update( hist, p + m*cn, cn, bias, 1 );
+            }
+            dy = -dy;
+        }
+    }
+#undef ROW_PTR
 }
 
 
@@ -1422,7 +1566,7 @@ typedef MinMax32f MinMaxVec32f;
 
 template<class Op, class VecOp>
 static void
-medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
+medianBlur_SortNet( const Mat& _src, Mat& _dst, int m, const Range& rows )
 {
     typedef typename Op::value_type T;
     typedef typename Op::arg_type WT;
@@ -1461,7 +1605,8 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
         }
 
         size.width *= cn;
-        for( i = 0; i < size.height; i++, dst += dstep )
+        dst += dstep*rows.start;
+        for( i = rows.start; i < rows.end; i++, dst += dstep )
         {
             const T* row0 = src + std::max(i - 1, 0)*sstep;
             const T* row1 = src + i*sstep;
@@ -1533,7 +1678,8 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
         }
 
         size.width *= cn;
-        for( i = 0; i < size.height; i++, dst += dstep )
+        dst += dstep*rows.start;
+        for( i = rows.start; i < rows.end; i++, dst += dstep )
         {
             const T* row[5];
             row[0] = src + std::max(i - 2, 0)*sstep;
@@ -1632,6 +1778,52 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
     }
 }
 
+
+// images with fewer bytes are filtered as a single band; the bands are at least
+// MEDIAN_MIN_BAND_ROWS and 2*ksize rows tall, since every band starts with a full window
+enum { MEDIAN_PARALLEL_MIN_SIZE = 1 << 16, MEDIAN_MIN_BAND_ROWS = 32 };
+
+typedef void (*MedianBlurFunc)( const Mat& src, Mat& dst, int ksize, const Range& rows );
+
+class MedianBlurInvoker : public ParallelLoopBody
+{
+public:
+    MedianBlurInvoker( MedianBlurFunc _func, const Mat& _src, Mat& _dst, int _ksize, int _nStripes )
+        : func(_func), src(_src), dst(_dst), ksize(_ksize), nStripes(_nStripes) {}
+
+    void operator()( const Range& range ) const
+    {
+        Mat d = dst;
+        for( int k = range.start; k < range.end; k++ )
+            func( src, d, ksize, Range(bandStart(k), bandStart(k + 1)) );
+    }
+
+    int bandStart( int k ) const
+    {
+        return (int)((int64)k*dst.rows/nStripes);
+    }
+
+protected:
+    MedianBlurFunc func;
+    Mat src, dst;
+    int ksize, nStripes;
+};
+
+static void medianBlurBands( MedianBlurFunc func, const Mat& src, Mat& dst, int ksize )
+{
+    int nStripes = 1;
+    // the sorting networks handle single-column images as a whole
+    if( dst.cols > 1 && dst.total()*dst.elemSize() >= (size_t)MEDIAN_PARALLEL_MIN_SIZE )
+        nStripes = std::max(std::min(getNumThreads(),
+                                     dst.rows/std::max((int)MEDIAN_MIN_BAND_ROWS, ksize*2)), 1);
+
+    MedianBlurInvoker invoker(func, src, dst, ksize, nStripes);
+    if( nStripes > 1 )
+        parallel_for_(Range(0, nStripes), invoker, nStripes);
+    else
+        invoker(Range(0, 1));
+}
+
 }
 
 void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
@@ -1667,31 +1859,70 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
         else
             src0.copyTo(src);
 
+        MedianBlurFunc func = 0;
         if( src.depth() == CV_8U )
-            medianBlur_SortNet<MinMax8u, MinMaxVec8u>( src, dst, ksize );
+            func = medianBlur_SortNet<MinMax8u, MinMaxVec8u>;
         else if( src.depth() == CV_16U )
-            medianBlur_SortNet<MinMax16u, MinMaxVec16u>( src, dst, ksize );
+            func = medianBlur_SortNet<MinMax16u, MinMaxVec16u>;
         else if( src.depth() == CV_16S )
-            medianBlur_SortNet<MinMax16s, MinMaxVec16s>( src, dst, ksize );
+            func = medianBlur_SortNet<MinMax16s, MinMaxVec16s>;
         else if( src.depth() == CV_32F )
-            medianBlur_SortNet<MinMax32f, MinMaxVec32f>( src, dst, ksize );
+            func = medianBlur_SortNet<MinMax32f, MinMaxVec32f>;
         else
             CV_Error(CV_StsUnsupportedFormat, "");
 
+        medianBlurBands( func, src, dst, ksize );
         return;
     }
+    else if( src0.depth() == CV_32F )
+    {
+        // the values are quantized to 16 bits within the range of the image,
+        // so the result is accurate up to (max-min)/65535. There is no such range
+        // with NaNs or infinities, and minMaxLoc would not even see the NaNs
+        if( !checkRange( src0 ) )
+            CV_Error( CV_StsOutOfRange, "medianBlur: ksize > 5 needs a floating-point image without NaNs and infinities" );
+
+        double minVal = 0, maxVal = 0;
+        minMaxLoc( src0.reshape(1), &minVal, &maxVal );
+        if( minVal == maxVal )
+        {
+            src0.copyTo(dst);
+            return;
+        }
+
+        double scale = (maxVal - minVal)/65535;
+        Mat q;
+        src0.convertTo( q, CV_16U, 1./scale, -minVal/scale );
+        medianBlur( q, q, ksize );
+        q.convertTo( dst, CV_32F, scale, minVal );
+    }
     else
     {
         cv::copyMakeBorder( src0, src, 0, 0, ksize/2, ksize/2, BORDER_REPLICATE );
 
         int cn = src0.channels();
-        CV_Assert( src.depth() == CV_8U && (cn == 1 || cn == 3 || cn == 4) );
+        MedianBlurFunc func = 0;
 
-        double img_size_mp = (double)(src0.total())/(1 << 20);
-        if( ksize <= 3 + (img_size_mp < 1 ? 12 : img_size_mp < 4 ? 6 : 2)*(MEDIAN_HAVE_SIMD && checkHardwareSupport(CV_CPU_SSE2) ? 1 : 3))
-            medianBlur_8u_Om( src, dst, ksize );
+        if( src.depth() == CV_8U )
+        {
+            CV_Assert( cn == 1 || cn == 3 || cn == 4 );
+
+            double img_size_mp = (double)(src0.total())/(1 << 20);
+            if( ksize <= 3 + (img_size_mp < 1 ? 12 : img_size_mp < 4 ? 6 : 2)*(MEDIAN_HAVE_SIMD && checkHardwareSupport(CV_CPU_SSE2) ? 1 : 3))
+                func = medianBlur_8u_Om;
+            else
+                func = medianBlur_8u_O1;
+        }
+        else if( src.depth() == CV_16U || src.depth() == CV_16S )
+        {
+            // the histogram bins are 16-bit
+            CV_Assert( cn <= 4 && ksize <= 255 );
+            func = src.depth() == CV_16U ? medianBlur_16u_Om<ushort> : medianBlur_16u_Om<short>;
+        }
         else
-            medianBlur_8u_O1( src, dst, ksize );
+            CV_Error(CV_StsUnsupportedFormat, "");
+
+        medianBlurBands( func, src, dst, ksize );
     }
 }
 
@@ -2200,6 +2431,258 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
     parallel_for_(Range(0, size.height), body, dst.total()/(double)(1<<16));
 }
 
+
+/*
+   The bilateral grid, see S. Paris and F. Durand, "A Fast Approximation of the Bilateral Filter
+   using a Signal Processing Approach", and J. Chen, S. Paris and F. Durand, "Real-time Edge-Aware
+   Image Processing with the Bilateral Grid". The pixels are accumulated into a 3D grid with cells
+   of sigmaSpace x sigmaSpace x sigmaColor, the grid is blurred with the [1 4 6 4 1]/16 kernel
+   along every axis, and the result is read back with trilinear interpolation. Every grid cell
+   keeps the sums of the channels and the number of pixels; the range axis is the image itself
+   for single-channel images and its luminance for 3-channel ones.
+*/
+
+// the kernel is 5 cells wide, so the grid has 2 empty cells around the image data.
+// A grid of more than BILATERAL_GRID_MAX_SIZE floats (64MB) is not built; the sigmas
+// that need it are small enough for bilateralFilter, which is then used instead.
+enum { BILATERAL_GRID_PAD = 2, BILATERAL_GRID_MAX_SIZE = 1 << 24 };
+
+struct BilateralGridParams
+{
+    int rows, cols, depth, nc;
+    size_t rowStep, colStep;
+    float scaleSpace, scaleColor, minColor;
+};
+
+// computes the color of the pixel from the guide value
+template<typename T> static inline float
+bilateralGridRange( const BilateralGridParams& p, T v )
+{
+    return (v - p.minColor)*p.scaleColor + BILATERAL_GRID_PAD;
+}
+
+template<typename T>
+class BilateralGridSplatInvoker : public ParallelLoopBody
+{
+public:
+    BilateralGridSplatInvoker( const Mat& _src, const Mat& _guide, float* _grid,
+                               const BilateralGridParams& _p, int _nStripes )
+        : src(_src), guide(_guide), grid(_grid), p(_p), nStripes(_nStripes) {}
+
+    void operator()( const Range& range ) const
+    {
+        // every image row is accumulated into a single grid row,
+        // so the stripes of grid rows are processed independently
+        int g0 = (int)((int64)range.start*p.rows/nStripes);
+        int g1 = (int)((int64)range.end*p.rows/nStripes);
+        int cn = src.channels(), nc = p.nc;
+
+        for( int y = 0; y < src.rows; y++ )
+        {
+            int gy = cvRound(y*p.scaleSpace) + BILATERAL_GRID_PAD;
+            if( gy < g0 )
+                continue;
+            if( gy >= g1 )
+                break;
+
+            const T* sptr = src.ptr<T>(y);
+            const T* gptr = guide.ptr<T>(y);
+            float* grow = grid + gy*p.rowStep;
+
+            for( int x = 0; x < src.cols; x++, sptr += cn )
+            {
+                int gx = cvRound(x*p.scaleSpace) + BILATERAL_GRID_PAD;
+                int gz = cvRound(bilateralGridRange(p, gptr[x]));
+                float* cell = grow + gx*p.colStep + gz*nc;
+                for( int c = 0; c < cn; c++ )
+                    cell[c] += sptr[c];
+                cell[cn] += 1.f;
+            }
+        }
+    }
+
+protected:
+    Mat src, guide;
+    float* grid;
+    BilateralGridParams p;
+    int nStripes;
+};
+
+// blurs n cells of cellSize values, step values apart; the cells outside are zeros
+static void bilateralGridBlur1D( float* data, int n, size_t step, int cellSize, float* buf )
+{
+    const float scale = 1.f/16;
+    int i, k;
+
+    memset( buf, 0, cellSize*2*sizeof(buf[0]) );
+    memset( buf + (n + 2)*cellSize, 0, cellSize*2*sizeof(buf[0]) );
+    for( i = 0; i < n; i++ )
+        memcpy( buf + (i + 2)*cellSize, data + i*step, cellSize*sizeof(buf[0]) );
+
+    for( i = 0; i < n; i++ )
+    {
+        const float* b = buf + i*cellSize;
+        float* d = data + i*step;
+        for( k = 0; k < cellSize; k++ )
+            d[k] = (b[k] + b[k + cellSize*4] + (b[k + cellSize] + b[k + cellSize*3])*4 +
+                    b[k + cellSize*2]*6)*scale;
+    }
+}
+
+class BilateralGridBlurInvoker : public ParallelLoopBody
+{
+public:
+    BilateralGridBlurInvoker( float* _grid, const BilateralGridParams& _p, bool _vertical )
+        : grid(_grid), p(_p), vertical(_vertical) {}
+
+    void operator()( const Range& range ) const
+    {
+        int nc = p.nc, colSize = p.depth*nc;
+        AutoBuffer<float> _buf((std::max(std::max(p.rows, p.cols), p.depth) + 4)*colSize);
+        float* buf = _buf;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            if( vertical )
+            {
+                // the range is a grid column
+                bilateralGridBlur1D( grid + i*p.colStep, p.rows, p.rowStep, colSize, buf );
+            }
+            else
+            {
+                // the range is a grid row
+                float* row = grid + i*p.rowStep;
+                for( int gx = 0; gx < p.cols; gx++ )
+                    bilateralGridBlur1D( row + gx*p.colStep, p.depth, nc, nc, buf );
+                bilateralGridBlur1D( row, p.cols, p.colStep, colSize, buf );
+            }
+        }
+    }
+
+protected:
+    float* grid;
+    BilateralGridParams p;
+    bool vertical;
+};
+
+template<typename T>
+class BilateralGridSliceInvoker : public ParallelLoopBody
+{
+public:
+    BilateralGridSliceInvoker( const Mat& _src, const Mat& _guide, Mat& _dst,
+                               const float* _grid, const BilateralGridParams& _p )
+        : src(_src), guide(_guide), dst(_dst), grid(_grid), p(_p) {}
+
+    void operator()( const Range& range ) const
+    {
+        int cn = src.channels(), nc = p.nc;
+        AutoBuffer<int> _xofs(src.cols);
+        AutoBuffer<float> _xalpha(src.cols);
+        int* xofs = _xofs;
+        float* xalpha = _xalpha;
+        int x, c;
+
+        for( x = 0; x < src.cols; x++ )
+        {
+            float fx = x*p.scaleSpace + BILATERAL_GRID_PAD;
+            int ix = cvFloor(fx);
+            xofs[x] = (int)(ix*p.colStep);
+            xalpha[x] = fx - ix;
+        }
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            float fy = y*p.scaleSpace + BILATERAL_GRID_PAD;
+            int iy = cvFloor(fy);
+            float ay = fy - iy;
+            const float* grow = grid + iy*p.rowStep;
+            const T* sptr = src.ptr<T>(y);
+            const T* gptr = guide.ptr<T>(y);
+            T* dptr = (T*)(dst.data + dst.step*y);
+
+            for( x = 0; x < src.cols; x++, sptr += cn, dptr += cn )
+            {
+                float fz = bilateralGridRange(p, gptr[x]);
+                int iz = cvFloor(fz);
+                float az = fz - iz, ax = xalpha[x];
+                const float* c000 = grow + xofs[x] + iz*nc;
+                const float* c010 = c000 + p.colStep;
+                const float* c100 = c000 + p.rowStep;
+                const float* c110 = c100 + p.colStep;
+                float w00 = (1 - ay)*(1 - ax), w01 = (1 - ay)*ax, w10 = ay*(1 - ax), w11 = ay*ax;
+                float v[5];
+
+                for( c = 0; c <= cn; c++ )
+                {
+                    float v0 = c000[c]*w00 + c010[c]*w01 + c100[c]*w10 + c110[c]*w11;
+                    float v1 = c000[c + nc]*w00 + c010[c + nc]*w01 + c100[c + nc]*w10 + c110[c + nc]*w11;
+                    v[c] = v0 + (v1 - v0)*az;
+                }
+
+                if( v[cn] > FLT_EPSILON )
+                {
+                    float scale = 1.f/v[cn];
+                    for( c = 0; c < cn; c++ )
+                        dptr[c] = saturate_cast<T>(v[c]*scale);
+                }
+                else
+                    for( c = 0; c < cn; c++ )
+                        dptr[c] = sptr[c];
+            }
+        }
+    }
+
+protected:
+    Mat src, guide, dst;
+    const float* grid;
+    BilateralGridParams p;
+};
+
+template<typename T> static void
+bilateralGridFilter_( const Mat& src, Mat& dst, double sigma_color, double sigma_space )
+{
+    int cn = src.channels();
+    Mat guide;
+
+    if( cn == 1 )
+        guide = src;
+    else
+        cvtColor( src, guide, COLOR_BGR2GRAY );
+
+    double minVal = 0, maxVal = 0;
+    minMaxLoc( guide, &minVal, &maxVal );
+
+    // a non-finite range gives NaN or Inf here, which is not below the limit either
+    double gridSize = ((src.rows - 1)/sigma_space + BILATERAL_GRID_PAD*2 + 2)*
+                      ((src.cols - 1)/sigma_space + BILATERAL_GRID_PAD*2 + 2)*
+                      ((maxVal - minVal)/sigma_color + BILATERAL_GRID_PAD*2 + 2)*(cn + 1);
+    if( !(gridSize <= (double)BILATERAL_GRID_MAX_SIZE) )
+    {
+        bilateralFilter( src, dst, -1, sigma_color, sigma_space );
+        return;
+    }
+
+    BilateralGridParams p;
+    p.scaleSpace = (float)(1./sigma_space);
+    p.scaleColor = (float)(1./sigma_color);
+    p.minColor = (float)minVal;
+    p.rows = (int)((src.rows - 1)*p.scaleSpace) + BILATERAL_GRID_PAD*2 + 2;
+    p.cols = (int)((src.cols - 1)*p.scaleSpace) + BILATERAL_GRID_PAD*2 + 2;
+    p.depth = (int)((maxVal - minVal)*p.scaleColor) + BILATERAL_GRID_PAD*2 + 2;
+    p.nc = cn + 1;
+    p.colStep = (size_t)p.depth*p.nc;
+    p.rowStep = p.colStep*p.cols;
+
+    std::vector<float> _grid(p.rowStep*p.rows, 0.f);
+    float* grid = &_grid[0];
+    int nStripes = std::max(std::min(getNumThreads(), p.rows/BILATERAL_GRID_PAD), 1);
+
+    parallel_for_(Range(0, nStripes), BilateralGridSplatInvoker<T>(src, guide, grid, p, nStripes), nStripes);
+    parallel_for_(Range(0, p.rows), BilateralGridBlurInvoker(grid, p, false));
+    parallel_for_(Range(0, p.cols), BilateralGridBlurInvoker(grid, p, true));
+    parallel_for_(Range(0, src.rows), BilateralGridSliceInvoker<T>(src, guide, dst, grid, p),
+                  dst.total()/(double)(1<<16));
+}
 }
 
 void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
@@ -2219,6 +2702,33 @@ void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
         "Bilateral filtering is only implemented for 8u and 32f images" );
 }
 
+void cv::bilateralGridFilter( InputArray _src, OutputArray _dst,
+                              double sigmaColor, double sigmaSpace )
+{
+    Mat src = _src.getMat();
+    int cn = src.channels();
+    CV_Assert( cn == 1 || cn == 3 );
+
+    if( sigmaColor <= 0 )
+        sigmaColor = 1;
+    if( sigmaSpace <= 0 )
+        sigmaSpace = 1;
+
+    // the grid is read while the result is written, so the source must stay intact
+    _dst.create( src.size(), src.type() );
+    Mat dst = _dst.getMat();
+    if( dst.data == src.data )
+        src = src.clone();
+
+    if( src.depth() == CV_8U )
+        bilateralGridFilter_<uchar>( src, dst, sigmaColor, sigmaSpace );
+    else if( src.depth() == CV_32F )
+        bilateralGridFilter_<float>( src, dst, sigmaColor, sigmaSpace );
+    else
+        CV_Error( CV_StsUnsupportedFormat,
+        "Bilateral grid filtering is only implemented for 8u and 32f images" );
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 
 CV_IMPL void
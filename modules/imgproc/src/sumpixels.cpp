@@ -222,6 +222,374 @@ typedef void (*IntegralFunc)(const uchar* src, size_t srcstep, uchar* sum, size_
                              uchar* sqsum, size_t sqsumstep, uchar* tilted, size_t tstep,
                              Size size, int cn );
 
+// images with fewer elements are integrated as a single band;
+// the bands are at least INTEGRAL_MIN_BAND_ROWS rows tall
+enum { INTEGRAL_PARALLEL_MIN_SIZE = 1 << 16, INTEGRAL_MIN_BAND_ROWS = 64 };
+
+// computes one row of the sum (and the optional sqsum) from the row above it;
+// width is the number of elements in the source row, the first cn elements of the sums are zeros
+template<typename T, typename ST, typename QT>
+static void integralRow_( const T* src, const ST* psum, ST* sum,
+                          const QT* psqsum, QT* sqsum, int width, int cn )
+{
+    int x, k;
+
+    for( k = 0; k < cn; k++ )
+        sum[k] = 0;
+    psum += cn;
+    sum += cn;
+
+    if( sqsum )
+    {
+        for( k = 0; k < cn; k++ )
+            sqsum[k] = 0;
+        psqsum += cn;
+        sqsum += cn;
+    }
+
+    for( k = 0; k < cn; k++ )
+    {
+        ST s = 0;
+        QT sq = 0;
+
+        if( !sqsum )
+        {
+            for( x = k; x < width; x += cn )
+            {
+                s += src[x];
+                sum[x] = psum[x] + s;
+            }
+        }
+        else
+        {
+            for( x = k; x < width; x += cn )
+            {
+                T it = src[x];
+                s += it;
+                sq += (QT)it*it;
+                sum[x] = psum[x] + s;
+                sqsum[x] = psqsum[x] + sq;
+            }
+        }
+    }
+}
+
+// accumulates the column sums (and the sums of squares) of a band of rows
+template<typename T, typename ST, typename QT>
+static void integralColSums_( const T* src, size_t srcstep, int rows,
+                              ST* colsum, QT* colsqsum, int width )
+{
+    int x;
+
+    for( x = 0; x < width; x++ )
+        colsum[x] = 0;
+    if( colsqsum )
+        for( x = 0; x < width; x++ )
+            colsqsum[x] = 0;
+
+    for( ; rows > 0; rows--, src += srcstep )
+    {
+        for( x = 0; x < width; x++ )
+            colsum[x] += src[x];
+        if( colsqsum )
+            for( x = 0; x < width; x++ )
+                colsqsum[x] += (QT)src[x]*src[x];
+    }
+}
+
+#if CV_SSE2
+
+// inclusive prefix sums of 8 pixels, widened to 16 bits, as two vectors of 32-bit integers
+static inline void prefixSum8u( __m128i v, __m128i& s0, __m128i& s1 )
+{
+    __m128i z = _mm_setzero_si128();
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+    s0 = _mm_unpacklo_epi16(v, z);
+    s1 = _mm_unpackhi_epi16(v, z);
+}
+
+// the same for the squares of the pixels
+static inline void prefixSqr8u( __m128i v, __m128i& q0, __m128i& q1 )
+{
+    __m128i z = _mm_setzero_si128();
+    v = _mm_mullo_epi16(v, v);
+    q0 = _mm_unpacklo_epi16(v, z);
+    q1 = _mm_unpackhi_epi16(v, z);
+    q0 = _mm_add_epi32(q0, _mm_slli_si128(q0, 4));
+    q1 = _mm_add_epi32(q1, _mm_slli_si128(q1, 4));
+    q0 = _mm_add_epi32(q0, _mm_slli_si128(q0, 8));
+    q1 = _mm_add_epi32(q1, _mm_slli_si128(q1, 8));
+    q1 = _mm_add_epi32(q1, _mm_shuffle_epi32(q0, _MM_SHUFFLE(3,3,3,3)));
+}
+
+static inline void storeSums8( const int* psum, int* sum, __m128i s0, __m128i s1 )
+{
+    _mm_storeu_si128((__m128i*)sum, _mm_add_epi32(s0, _mm_loadu_si128((const __m128i*)psum)));
+    _mm_storeu_si128((__m128i*)(sum + 4), _mm_add_epi32(s1, _mm_loadu_si128((const __m128i*)(psum + 4))));
+}
+
+// the integer prefix sums are exact in double precision, so adding the running sum
+// and the row above rounds the same way as the scalar code
+static inline void storeSums8( const double* psum, double* sum, __m128d base, __m128i s0, __m128i s1 )
+{
+    _mm_storeu_pd(sum, _mm_add_pd(_mm_loadu_pd(psum), _mm_add_pd(_mm_cvtepi32_pd(s0), base)));
+    _mm_storeu_pd(sum + 2, _mm_add_pd(_mm_loadu_pd(psum + 2),
+                  _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(s0, 8)), base)));
+    _mm_storeu_pd(sum + 4, _mm_add_pd(_mm_loadu_pd(psum + 4), _mm_add_pd(_mm_cvtepi32_pd(s1), base)));
+    _mm_storeu_pd(sum + 6, _mm_add_pd(_mm_loadu_pd(psum + 6),
+                  _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(s1, 8)), base)));
+}
+
+static inline void storeSums8( const double* psum, double* sum, __m128i s0, __m128i s1 )
+{
+    storeSums8(psum, sum, _mm_setzero_pd(), s0, s1);
+}
+
+// single-channel 8-bit row; the pointers skip the zero first column
+template<typename ST>
+static void integralRow8u_SSE2( const uchar* src, const ST* psum, ST* sum,
+                                const double* psqsum, double* sqsum, int width )
+{
+    __m128i z = _mm_setzero_si128(), vs = z;
+    __m128d vsq = _mm_setzero_pd();
+    int x = 0;
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z), s0, s1;
+        if( sqsum )
+        {
+            __m128i q0, q1;
+            prefixSqr8u(v, q0, q1);
+            storeSums8(psqsum + x, sqsum + x, vsq, q0, q1);
+            vsq = _mm_add_pd(vsq, _mm_cvtepi32_pd(_mm_shuffle_epi32(q1, _MM_SHUFFLE(3,3,3,3))));
+        }
+        prefixSum8u(v, s0, s1);
+        s0 = _mm_add_epi32(s0, vs);
+        s1 = _mm_add_epi32(s1, vs);
+        vs = _mm_shuffle_epi32(s1, _MM_SHUFFLE(3,3,3,3));
+        storeSums8(psum + x, sum + x, s0, s1);
+    }
+
+    int s = _mm_cvtsi128_si32(vs);
+    double sq = _mm_cvtsd_f64(vsq);
+    for( ; x < width; x++ )
+    {
+        int it = src[x];
+        s += it;
+        sum[x] = psum[x] + s;
+        if( sqsum )
+        {
+            sq += (double)it*it;
+            sqsum[x] = psqsum[x] + sq;
+        }
+    }
+}
+
+#endif
+
+static void integralRow_( const uchar* src, const int* psum, int* sum,
+                          const double* psqsum, double* sqsum, int width, int cn )
+{
+#if CV_SSE2
+    if( cn == 1 && checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        sum[0] = 0;
+        if( sqsum )
+            sqsum[0] = 0;
+        integralRow8u_SSE2(src, psum + 1, sum + 1, sqsum ? psqsum + 1 : 0, sqsum ? sqsum + 1 : 0, width);
+        return;
+    }
+#endif
+    integralRow_<uchar, int, double>(src, psum, sum, psqsum, sqsum, width, cn);
+}
+
+static void integralRow_( const uchar* src, const double* psum, double* sum,
+                          const double* psqsum, double* sqsum, int width, int cn )
+{
+#if CV_SSE2
+    if( cn == 1 && checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        sum[0] = 0;
+        if( sqsum )
+            sqsum[0] = 0;
+        integralRow8u_SSE2(src, psum + 1, sum + 1, sqsum ? psqsum + 1 : 0, sqsum ? sqsum + 1 : 0, width);
+        return;
+    }
+#endif
+    integralRow_<uchar, double, double>(src, psum, sum, psqsum, sqsum, width, cn);
+}
+
+static void integralColSums_( const uchar* src, size_t srcstep, int rows,
+                              int* colsum, double* colsqsum, int width )
+{
+#if CV_SSE2
+    if( !colsqsum && checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        __m128i z = _mm_setzero_si128();
+        int x;
+
+        memset(colsum, 0, width*sizeof(colsum[0]));
+        for( ; rows > 0; rows--, src += srcstep )
+        {
+            for( x = 0; x <= width - 16; x += 16 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i*)(src + x));
+                __m128i v0 = _mm_unpacklo_epi8(v, z), v1 = _mm_unpackhi_epi8(v, z);
+                int* c = colsum + x;
+                _mm_storeu_si128((__m128i*)c, _mm_add_epi32(_mm_loadu_si128((const __m128i*)c),
+                                                            _mm_unpacklo_epi16(v0, z)));
+                _mm_storeu_si128((__m128i*)(c + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(c + 4)),
+                                                                  _mm_unpackhi_epi16(v0, z)));
+                _mm_storeu_si128((__m128i*)(c + 8), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(c + 8)),
+                                                                  _mm_unpacklo_epi16(v1, z)));
+                _mm_storeu_si128((__m128i*)(c + 12), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(c + 12)),
+                                                                   _mm_unpackhi_epi16(v1, z)));
+            }
+            for( ; x < width; x++ )
+                colsum[x] += src[x];
+        }
+        return;
+    }
+#endif
+    integralColSums_<uchar, int, double>(src, srcstep, rows, colsum, colsqsum, width);
+}
+
+// the first phase of the parallel scan: the column sums of every band but the last one
+template<typename T, typename ST, typename QT>
+class IntegralColSumsInvoker : public ParallelLoopBody
+{
+public:
+    IntegralColSumsInvoker( const Mat& _src, Mat& _colsum, Mat& _colsqsum, int _nStripes )
+        : src(_src), colsum(_colsum), colsqsum(_colsqsum), nStripes(_nStripes) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int y0 = bandStart(src.rows, nStripes, k), y1 = bandStart(src.rows, nStripes, k + 1);
+            integralColSums_(src.ptr<T>(y0), src.step/sizeof(T), y1 - y0,
+                             (ST*)(colsum.data + colsum.step*k),
+                             colsqsum.data ? (QT*)(colsqsum.data + colsqsum.step*k) : 0,
+                             src.cols*src.channels());
+        }
+    }
+
+    static int bandStart( int rows, int nStripes, int k )
+    {
+        return (int)((int64)k*rows/nStripes);
+    }
+
+protected:
+    Mat src, colsum, colsqsum;
+    int nStripes;
+};
+
+// the second phase: every band is integrated starting from the sums right above it
+template<typename T, typename ST, typename QT>
+class IntegralRowsInvoker : public ParallelLoopBody
+{
+public:
+    IntegralRowsInvoker( const Mat& _src, Mat& _sum, Mat& _sqsum,
+                         const Mat& _carry, const Mat& _sqcarry, int _nStripes )
+        : src(_src), sum(_sum), sqsum(_sqsum), carry(_carry), sqcarry(_sqcarry), nStripes(_nStripes) {}
+
+    void operator()( const Range& range ) const
+    {
+        int cn = src.channels(), width = src.cols*cn;
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int y0 = IntegralColSumsInvoker<T, ST, QT>::bandStart(src.rows, nStripes, k);
+            int y1 = IntegralColSumsInvoker<T, ST, QT>::bandStart(src.rows, nStripes, k + 1);
+            const ST* psum = carry.data ? carry.ptr<ST>(k) : sum.ptr<ST>(0);
+            const QT* psqsum = !sqsum.data ? 0 : sqcarry.data ? sqcarry.ptr<QT>(k) : sqsum.ptr<QT>(0);
+
+            for( int y = y0; y < y1; y++ )
+            {
+                ST* s = (ST*)(sum.data + sum.step*(y + 1));
+                QT* sq = sqsum.data ? (QT*)(sqsum.data + sqsum.step*(y + 1)) : 0;
+                integralRow_(src.ptr<T>(y), psum, s, psqsum, sq, width, cn);
+                psum = s;
+                psqsum = sq;
+            }
+        }
+    }
+
+protected:
+    Mat src, sum, sqsum, carry, sqcarry;
+    int nStripes;
+};
+
+// the integral image without the tilted sum, computed in nStripes horizontal bands
+template<typename T, typename ST, typename QT>
+static void integralBands_( const Mat& src, Mat& sum, Mat& sqsum, int nStripes )
+{
+    int cn = src.channels(), width = src.cols*cn;
+    Mat carry, sqcarry;
+
+    memset(sum.data, 0, (width + cn)*sizeof(ST));
+    if( sqsum.data )
+        memset(sqsum.data, 0, (width + cn)*sizeof(QT));
+
+    if( nStripes > 1 )
+    {
+        Mat colsum(nStripes - 1, width, DataType<ST>::type), colsqsum;
+        if( sqsum.data )
+            colsqsum.create(nStripes - 1, width, DataType<QT>::type);
+        parallel_for_(Range(0, nStripes - 1),
+                      IntegralColSumsInvoker<T, ST, QT>(src, colsum, colsqsum, nStripes), nStripes - 1);
+
+        // the carry row of a band is the integral of all the rows above it,
+        // i.e. the horizontal prefix sum of the accumulated column sums
+        carry = Mat::zeros(nStripes, width + cn, DataType<ST>::type);
+        if( sqsum.data )
+            sqcarry = Mat::zeros(nStripes, width + cn, DataType<QT>::type);
+        for( int k = 1; k < nStripes; k++ )
+        {
+            ST* cs = colsum.ptr<ST>(k - 1);
+            ST* c = carry.ptr<ST>(k);
+            if( k > 1 )
+                for( int x = 0; x < width; x++ )
+                    cs[x] += colsum.ptr<ST>(k - 2)[x];
+            for( int x = 0; x < width; x++ )
+                c[x + cn] = c[x] + cs[x];
+
+            if( sqsum.data )
+            {
+                QT* csq = colsqsum.ptr<QT>(k - 1);
+                QT* sqc = sqcarry.ptr<QT>(k);
+                if( k > 1 )
+                    for( int x = 0; x < width; x++ )
+                        csq[x] += colsqsum.ptr<QT>(k - 2)[x];
+                for( int x = 0; x < width; x++ )
+                    sqc[x + cn] = sqc[x] + csq[x];
+            }
+        }
+    }
+
+    IntegralRowsInvoker<T, ST, QT> invoker(src, sum, sqsum, carry, sqcarry, nStripes);
+    if( nStripes > 1 )
+        parallel_for_(Range(0, nStripes), invoker, nStripes);
+    else
+        invoker(Range(0, 1));
+}
+
+#define DEF_INTEGRAL_BANDS_FUNC(suffix, T, ST, QT) \
+static void integralBands_##suffix( const Mat& src, Mat& sum, Mat& sqsum, int nStripes ) \
+{ integralBands_<T, ST, QT>(src, sum, sqsum, nStripes); }
+
+DEF_INTEGRAL_BANDS_FUNC(8u32s, uchar, int, double)
+DEF_INTEGRAL_BANDS_FUNC(8u32f, uchar, float, double)
+DEF_INTEGRAL_BANDS_FUNC(8u64f, uchar, double, double)
+DEF_INTEGRAL_BANDS_FUNC(32f, float, float, double)
+DEF_INTEGRAL_BANDS_FUNC(32f64f, float, double, double)
+DEF_INTEGRAL_BANDS_FUNC(64f, double, double, double)
+
+typedef void (*IntegralBandsFunc)( const Mat& src, Mat& sum, Mat& sqsum, int nStripes );
+
 }
 
 
@@ -249,6 +617,34 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
         sqsum = _sqsum.getMat();
     }
 
+    if( !tilted.data )
+    {
+        IntegralBandsFunc bfunc = 0;
+        if( depth == CV_8U && sdepth == CV_32S )
+            bfunc = integralBands_8u32s;
+        else if( depth == CV_8U && sdepth == CV_32F )
+            bfunc = integralBands_8u32f;
+        else if( depth == CV_8U && sdepth == CV_64F )
+            bfunc = integralBands_8u64f;
+        else if( depth == CV_32F && sdepth == CV_32F )
+            bfunc = integralBands_32f;
+        else if( depth == CV_32F && sdepth == CV_64F )
+            bfunc = integralBands_32f64f;
+        else if( depth == CV_64F && sdepth == CV_64F )
+            bfunc = integralBands_64f;
+        else
+            CV_Error( CV_StsUnsupportedFormat, "" );
+
+        // the sums of 8-bit pixels are integers, so they do not depend on the order of
+        // the additions, unless they are accumulated in single precision
+        int nStripes = 1;
+        if( depth == CV_8U && sdepth != CV_32F && src.total()*cn >= (size_t)INTEGRAL_PARALLEL_MIN_SIZE )
+            nStripes = std::max(std::min(getNumThreads(), src.rows/INTEGRAL_MIN_BAND_ROWS), 1);
+
+        bfunc( src, sum, sqsum, nStripes );
+        return;
+    }
+
     IntegralFunc func = 0;
 
     if( depth == CV_8U && sdepth == CV_32S )
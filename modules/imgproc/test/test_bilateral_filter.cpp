@@ -287,4 +287,70 @@ namespace cvtest
         test.safe_run();
     }
 
+    TEST(Imgproc_BilateralGridFilter, accuracy)
+    {
+        // flat regions with noise, whose luminance differs by several sigmaColor
+        Mat img(300, 400, CV_8UC3, Scalar(40, 60, 80)), noise(img.size(), CV_16SC3), img16;
+        rectangle(img, Rect(120, 60, 200, 180), Scalar(200, 180, 160), -1);
+        circle(img, Point(80, 230), 50, Scalar(90, 200, 120), -1);
+        img.convertTo(img16, CV_16S);
+        randn(noise, 0, 8);
+        img16 += noise;
+        img16.convertTo(img, CV_8U);
+
+        for( int t = 0; t < 4; t++ )
+        {
+            Mat src = img, exact, approx, diff;
+            if( t % 2 )
+                cvtColor(img, src, COLOR_BGR2GRAY);
+            if( t >= 2 )
+                src.convertTo(src, CV_32F);
+
+            const double sigmaSpaces[] = { 4, 12 };
+            for( int i = 0; i < 2; i++ )
+            {
+                bilateralFilter(src, exact, -1, 30, sigmaSpaces[i]);
+                bilateralGridFilter(src, approx, 30, sigmaSpaces[i]);
+                ASSERT_EQ(src.type(), approx.type());
+                absdiff(exact, approx, diff);
+                EXPECT_LT(mean(diff)[0], 1.5) << "type=" << src.type() << ", sigmaSpace=" << sigmaSpaces[i];
+            }
+        }
+
+        Mat flat(100, 150, CV_8UC3, Scalar(10, 20, 30)), dst;
+        bilateralGridFilter(flat, dst, 10, 5);
+        EXPECT_EQ(0, norm(flat, dst, NORM_INF));
+    }
+
+    TEST(Imgproc_BilateralGridFilter, parallel)
+    {
+        Mat src(1000, 700, CV_8UC3), dst[2];
+        randu(src, 0, 256);
+        GaussianBlur(src, src, Size(9, 9), 3);
+
+        for( int k = 0; k < 2; k++ )
+        {
+            ParallelScope scope(k == 0 ? 1 : 4);
+            bilateralGridFilter(src, dst[k], 20, 6);
+        }
+        EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF));
+    }
+
+    TEST(Imgproc_BilateralGridFilter, smallSigmasFallBack)
+    {
+        // the grid for these sigmas would take gigabytes, so the exact filter is used
+        Mat src(480, 640, CV_8UC3), dst, ref;
+        randu(src, 0, 256);
+        bilateralGridFilter(src, dst, 0, 0);
+        bilateralFilter(src, ref, -1, 1, 1);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+
+        // the range of the values does not fit into int cells
+        Mat src32f(64, 80, CV_32FC1), dst32f, ref32f;
+        randu(src32f, -1e30, 1e30);
+        bilateralGridFilter(src32f, dst32f, 10, 10);
+        bilateralFilter(src32f, ref32f, -1, 10, 10);
+        EXPECT_EQ(0, norm(ref32f, dst32f, NORM_INF));
+    }
+
 } // end of namespace cvtest
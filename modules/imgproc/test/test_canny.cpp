@@ -284,4 +284,38 @@ int CV_CannyTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_Canny, accuracy) { CV_CannyTest test; test.safe_run(); }
 
+TEST(Imgproc_Canny, parallel)
+{
+    // blurred noise has plenty of edges that cross the boundaries of the bands
+    Mat src(1037, 911, CV_8UC3), blurred;
+    randu(src, 0, 256);
+    GaussianBlur(src, blurred, Size(7, 7), 2);
+
+    for( int cn = 1; cn <= 3; cn += 2 )
+    {
+        Mat img;
+        if( cn == 1 )
+            cvtColor(blurred, img, COLOR_BGR2GRAY);
+        else
+            img = blurred;
+
+        for( int aperture = 3; aperture <= 5; aperture += 2 )
+            for( int L2 = 0; L2 <= 1; L2++ )
+            {
+                Mat ref, dst;
+                double low = aperture == 3 ? 20 : 200, high = low*3;
+                {
+                    ParallelScope scope(1);
+                    Canny(img, ref, low, high, aperture, L2 != 0);
+                }
+                {
+                    ParallelScope scope(7);
+                    Canny(img, dst, low, high, aperture, L2 != 0);
+                }
+                ASSERT_GT(countNonZero(ref), 0);
+                EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "cn=" << cn << ", aperture=" << aperture << ", L2=" << L2;
+            }
+    }
+}
+
 /* End of file. */
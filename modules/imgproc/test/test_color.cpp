@@ -2188,3 +2188,68 @@ TEST(ImgProc_Bayer2RGBA, accuracy)
         }
     }
 }
+
+TEST(Imgproc_ColorVectorized, accuracy)
+{
+    // the vectorized (SSE2 or AVX2) conversions are compared with the plain code;
+    // the row width is not a multiple of the SIMD block, so the scalar tails are covered too
+    static const int codes[] =
+    {
+        CV_BGR2GRAY, CV_RGB2GRAY, CV_BGR2YCrCb, CV_RGB2YCrCb, CV_BGR2YUV, CV_BGR2HSV, CV_RGB2HSV_FULL,
+        CV_BGR2Lab, CV_LRGB2Lab, CV_BGR2Luv, CV_LBGR2Luv
+    };
+    const Size sz(997, 21);
+    RNG& rng = theRNG();
+    bool prevOptimized = useOptimized();
+
+    for( size_t k = 0; k < sizeof(codes)/sizeof(codes[0]); k++ )
+        for( int depth = CV_8U; depth <= CV_32F; depth += CV_32F - CV_8U )
+            for( int scn = 3; scn <= 4; scn++ )
+            {
+                int code = codes[k];
+                Mat src(sz, CV_MAKETYPE(depth, scn)), dst0, dst;
+                if( depth == CV_8U )
+                    rng.fill(src, RNG::UNIFORM, 0, 256);
+                else
+                    rng.fill(src, RNG::UNIFORM, 0, 1);
+
+                setUseOptimized(false);
+                cvtColor(src, dst0, code);
+                setUseOptimized(true);
+                cvtColor(src, dst, code);
+
+                // the 8-bit L*u*v* goes through floats, which AVX2 computes with fused multiply-adds
+                bool luv = code == CV_BGR2Luv || code == CV_LBGR2Luv;
+                bool lab = code == CV_BGR2Lab || code == CV_LRGB2Lab;
+                double maxDiff = depth == CV_8U ? (luv ? 1 : 0) : luv || lab ? 1e-3 : 1e-6;
+                EXPECT_LE(cvtest::norm(dst0, dst, NORM_INF), maxDiff)
+                    << "code=" << code << " depth=" << depth << " scn=" << scn;
+            }
+
+    setUseOptimized(prevOptimized);
+}
+
+TEST(Imgproc_ColorYUV420Vectorized, accuracy)
+{
+    static const int codes[] =
+    {
+        CV_YUV2BGR_NV12, CV_YUV2RGB_NV21, CV_YUV2BGRA_NV21, CV_YUV2RGBA_NV12,
+        CV_YUV2BGR_YV12, CV_YUV2RGB_IYUV, CV_YUV2BGRA_IYUV, CV_YUV2RGBA_YV12
+    };
+    // the width is not a multiple of 32 pixels
+    Mat src(64*3/2, 998, CV_8UC1);
+    theRNG().fill(src, RNG::UNIFORM, 0, 256);
+    bool prevOptimized = useOptimized();
+
+    for( size_t k = 0; k < sizeof(codes)/sizeof(codes[0]); k++ )
+    {
+        Mat dst0, dst;
+        setUseOptimized(false);
+        cvtColor(src, dst0, codes[k]);
+        setUseOptimized(true);
+        cvtColor(src, dst, codes[k]);
+        EXPECT_EQ(0, cvtest::norm(dst0, dst, NORM_INF)) << "code=" << codes[k];
+    }
+
+    setUseOptimized(prevOptimized);
+}
@@ -106,3 +106,49 @@ void CV_ConnectedComponentsTest::run( int /* start_from */)
 
 TEST(Imgproc_ConnectedComponents, regression) { CV_ConnectedComponentsTest test; test.safe_run(); }
 
+
+TEST(Imgproc_ConnectedComponents, parallel)
+{
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 8; iter++ )
+    {
+        int connectivity = iter % 2 ? 4 : 8;
+        int ltype = iter % 4 < 2 ? CV_32S : CV_16U;
+        Mat noise(rng.uniform(300, 700), rng.uniform(300, 700), CV_8U), img;
+        rng.fill(noise, RNG::UNIFORM, 0, 256);
+        // large blobs that cross many strips, and small ones
+        GaussianBlur(noise, img, Size(iter < 4 ? 15 : 3, iter < 4 ? 15 : 3), 0);
+        img = img > 128;
+
+        Mat labels0, labels1, stats0, stats1, centroids0, centroids1;
+        int n0, n1;
+        {
+            ParallelScope scope(1);
+            n0 = connectedComponentsWithStats(img, labels0, stats0, centroids0, connectivity, ltype);
+        }
+        {
+            ParallelScope scope(5);
+            n1 = connectedComponentsWithStats(img, labels1, stats1, centroids1, connectivity, ltype);
+        }
+        ASSERT_EQ(n0, n1);
+        EXPECT_EQ(0, norm(labels0, labels1, NORM_INF));
+        EXPECT_EQ(0, norm(stats0, stats1, NORM_INF));
+        EXPECT_EQ(0, norm(centroids0, centroids1, NORM_INF));
+
+        Mat labels2;
+        {
+            ParallelScope scope(5);
+            n1 = connectedComponents(img, labels2, connectivity, ltype);
+        }
+        ASSERT_EQ(n0, n1);
+        EXPECT_EQ(0, norm(labels0, labels2, NORM_INF));
+    }
+
+    // isolated pixels on a grid give the largest possible number of labels
+    Mat grid = Mat::zeros(301, 301, CV_8U);
+    for( int y = 0; y < grid.rows; y += 2 )
+        for( int x = 0; x < grid.cols; x += 2 )
+            grid.at<uchar>(y, x) = 255;
+    Mat labels;
+    EXPECT_EQ(151*151 + 1, connectedComponents(grid, labels, 8, CV_32S));
+}
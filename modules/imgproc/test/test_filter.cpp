@@ -1784,6 +1784,135 @@ TEST(Imgproc_EigenValsVecs, accuracy) { CV_EigenValVecTest test; test.safe_run()
 TEST(Imgproc_PreCornerDetect, accuracy) { CV_PreCornerDetectTest test; test.safe_run(); }
 TEST(Imgproc_Integral, accuracy) { CV_IntegralTest test; test.safe_run(); }
 
+template<typename T> static void
+refMedianBlur( const Mat& src, Mat& dst, int ksize )
+{
+    int r = ksize/2, cn = src.channels();
+    vector<T> buf;
+    dst.create(src.size(), src.type());
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols; x++ )
+            for( int c = 0; c < cn; c++ )
+            {
+                buf.clear();
+                for( int dy = -r; dy <= r; dy++ )
+                {
+                    const T* row = src.ptr<T>(std::min(std::max(y + dy, 0), src.rows - 1));
+                    for( int dx = -r; dx <= r; dx++ )
+                        buf.push_back(row[std::min(std::max(x + dx, 0), src.cols - 1)*cn + c]);
+                }
+                std::nth_element(buf.begin(), buf.begin() + buf.size()/2, buf.end());
+                dst.ptr<T>(y)[x*cn + c] = buf[buf.size()/2];
+            }
+}
+
+TEST(Imgproc_MedianBlur, large_16bit)
+{
+    RNG& rng = theRNG();
+    const int ksizes[] = { 7, 9, 17 };
+
+    for( int iter = 0; iter < 6; iter++ )
+    {
+        int ksize = ksizes[iter % 3];
+        int cn = iter < 3 ? 1 : 3;
+        Size sz(rng.uniform(1, 60), rng.uniform(1, 60));
+        Mat src16u(sz, CV_MAKETYPE(CV_16U, cn)), src16s, src32f, dst, ref;
+        // a narrow range of values makes the medians depend on the finest histogram level
+        rng.fill(src16u, RNG::UNIFORM, 1000, iter % 2 ? 1100 : 65536);
+        src16u.convertTo(src16s, CV_16S, 1, -32768);
+        src16u.convertTo(src32f, CV_32F, 1./65535, -0.5);
+
+        refMedianBlur<ushort>(src16u, ref, ksize);
+        medianBlur(src16u, dst, ksize);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "16U, ksize=" << ksize << ", cn=" << cn;
+
+        refMedianBlur<short>(src16s, ref, ksize);
+        medianBlur(src16s, dst, ksize);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "16S, ksize=" << ksize << ", cn=" << cn;
+
+        double minVal = 0, maxVal = 0;
+        minMaxLoc(src32f.reshape(1), &minVal, &maxVal);
+        refMedianBlur<float>(src32f, ref, ksize);
+        medianBlur(src32f, dst, ksize);
+        double maxErr = (maxVal - minVal)/65535 + std::max(fabs(minVal), fabs(maxVal))*FLT_EPSILON;
+        EXPECT_LE(norm(ref, dst, NORM_INF), maxErr) << "32F, ksize=" << ksize << ", cn=" << cn;
+    }
+}
+
+TEST(Imgproc_MedianBlur, large_32f_nonFinite)
+{
+    Mat src(20, 30, CV_32F), dst;
+    randu(src, 0, 1);
+    medianBlur(src, dst, 7);
+
+    // the quantization range is not defined; the small apertures still compare the values
+    src.at<float>(5, 7) = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_THROW(medianBlur(src, dst, 7), cv::Exception);
+    src.at<float>(5, 7) = std::numeric_limits<float>::infinity();
+    EXPECT_THROW(medianBlur(src, dst, 7), cv::Exception);
+    EXPECT_NO_THROW(medianBlur(src, dst, 5));
+}
+
+TEST(Imgproc_MedianBlur, parallel)
+{
+    const int ksizes[] = { 3, 5, 7, 15, 25 };
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC3, CV_32FC1 };
+    Mat big(1100, 600, CV_8UC3);
+    randu(big, 0, 256);
+    GaussianBlur(big, big, Size(5, 5), 1.5);
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat src;
+        big(Rect(7, 3, 513, 1061)).convertTo(src, CV_MAT_DEPTH(types[t]), 211.3, -100);
+        if( CV_MAT_CN(types[t]) == 1 )
+            extractChannel(src, src, 0);
+
+        for( int i = 0; i < (int)(sizeof(ksizes)/sizeof(ksizes[0])); i++ )
+        {
+            Mat dst[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                ParallelScope scope(k == 0 ? 1 : 4);
+                medianBlur(src, dst[k], ksizes[i]);
+            }
+            EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "type=" << types[t] << ", ksize=" << ksizes[i];
+        }
+    }
+}
+
+TEST(Imgproc_Integral, parallel)
+{
+    const int sdepths[] = { CV_32S, CV_32F, CV_64F };
+    Mat big(1300, 700, CV_8UC3);
+    randu(big, 0, 256);
+
+    for( int cn = 1; cn <= 3; cn += 2 )
+    {
+        Mat src = big(Rect(3, 5, 641, 1283));
+        if( cn == 1 )
+            extractChannel(src, src, 1);
+
+        for( int i = 0; i < (int)(sizeof(sdepths)/sizeof(sdepths[0])); i++ )
+        {
+            int sdepth = sdepths[i];
+            Mat sum[2], sqsum[2], ref, sqref, tilted;
+            for( int k = 0; k < 2; k++ )
+            {
+                ParallelScope scope(k == 0 ? 1 : 5);
+                integral(src, sum[k], sqsum[k], sdepth);
+            }
+            // the sums that come with the tilted sum are computed by a separate scalar code
+            integral(src, ref, sqref, tilted, sdepth);
+
+            EXPECT_EQ(0, norm(ref, sum[0], NORM_INF)) << "cn=" << cn << ", sdepth=" << sdepth;
+            EXPECT_EQ(0, norm(sqref, sqsum[0], NORM_INF)) << "cn=" << cn << ", sdepth=" << sdepth;
+            EXPECT_EQ(0, norm(ref, sum[1], NORM_INF)) << "cn=" << cn << ", sdepth=" << sdepth;
+            EXPECT_EQ(0, norm(sqref, sqsum[1], NORM_INF)) << "cn=" << cn << ", sdepth=" << sdepth;
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 
 class CV_FilterSupportedFormatsTest : public cvtest::BaseTest
@@ -1887,3 +2016,141 @@ protected:
 
 TEST(Imgproc_Filtering, supportedFormats) { CV_FilterSupportedFormatsTest test; test.safe_run(); }
 
+
+TEST(Imgproc_Filtering, parallel)
+{
+    const int borderTypes[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101,
+                                BORDER_REFLECT_101 | BORDER_ISOLATED };
+    RNG& rng = theRNG();
+    Mat big(1100, 700, CV_8UC3);
+    randu(big, 0, 256);
+    // the filters take the rows above and below a ROI as its border, unless it is isolated
+    Mat src = big(Rect(10, 37, 640, 1030));
+
+    for( int i = 0; i < (int)(sizeof(borderTypes)/sizeof(borderTypes[0])); i++ )
+    {
+        int borderType = borderTypes[i];
+        Mat kernel(5, 7, CV_32F), kernelX(1, 9, CV_32F), kernelY(1, 3, CV_32F);
+        rng.fill(kernel, RNG::UNIFORM, -1, 1);
+        rng.fill(kernelX, RNG::UNIFORM, -1, 1);
+        rng.fill(kernelY, RNG::UNIFORM, -1, 1);
+
+        for( int fidx = 0; fidx < 6; fidx++ )
+        {
+            Mat dst[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                ParallelScope scope(k == 0 ? 1 : 4);
+                switch( fidx )
+                {
+                case 0:
+                    filter2D(src, dst[k], CV_16S, kernel, Point(-1, -1), 3, borderType);
+                    break;
+                case 1:
+                    sepFilter2D(src, dst[k], CV_32F, kernelX, kernelY, Point(2, 1), 0, borderType);
+                    break;
+                case 2:
+                    Sobel(src, dst[k], CV_16S, 1, 1, 5, 1, 0, borderType);
+                    break;
+                case 3:
+                    Scharr(src, dst[k], CV_32F, 0, 1, 1, 0, borderType);
+                    break;
+                case 4:
+                    GaussianBlur(src, dst[k], Size(9, 9), 2, 2, borderType);
+                    break;
+                default:
+                    boxFilter(src, dst[k], CV_32S, Size(15, 13), Point(-1, -1), false, borderType);
+                }
+            }
+            EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "filter " << fidx << ", border " << borderType;
+        }
+    }
+
+    // in-place filtering has to give the same result as well
+    Mat ref, img = src.clone();
+    GaussianBlur(img, ref, Size(7, 7), 0, 0);
+    {
+        ParallelScope scope(4);
+        GaussianBlur(img, img, Size(7, 7), 0, 0);
+    }
+    EXPECT_EQ(0, norm(ref, img, NORM_INF));
+}
+
+TEST(Imgproc_Morphology, parallel)
+{
+    const int borderTypes[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101 };
+    const int types[] = { CV_8UC1, CV_32FC3 };
+    Mat big(1100, 700, CV_8UC3);
+    randu(big, 0, 256);
+    Mat kernel = getStructuringElement(MORPH_ELLIPSE, Size(7, 9));
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat src;
+        big(Rect(10, 37, 640, 1030)).convertTo(src, CV_MAT_DEPTH(types[t]));
+        if( CV_MAT_CN(types[t]) == 1 )
+            extractChannel(src, src, 0);
+
+        for( int i = 0; i < (int)(sizeof(borderTypes)/sizeof(borderTypes[0])); i++ )
+        {
+            for( int op = MORPH_ERODE; op <= MORPH_BLACKHAT; op++ )
+            {
+                Mat dst[2];
+                for( int k = 0; k < 2; k++ )
+                {
+                    ParallelScope scope(k == 0 ? 1 : 4);
+                    morphologyEx(src, dst[k], op, kernel, Point(-1, -1), 1, borderTypes[i]);
+                }
+                EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF))
+                    << "type=" << types[t] << ", op=" << op << ", border=" << borderTypes[i];
+            }
+        }
+    }
+}
+
+TEST(Imgproc_FilterPipeline, accuracy)
+{
+    Mat big(600, 800, CV_8U);
+    randu(big, 0, 256);
+    Mat src = big(Rect(30, 50, 701, 480));
+
+    Mat blurred, dx, dy, mag, ref;
+    GaussianBlur(src, blurred, Size(5, 5), 1.5);
+    Sobel(blurred, dx, CV_32F, 1, 0, 3);
+    Sobel(blurred, dy, CV_32F, 0, 1, 5, 1, 0, BORDER_REPLICATE);
+    magnitude(dx, dy, mag);
+    threshold(mag, ref, 100, 255, THRESH_BINARY);
+
+    FilterPipeline p;
+    int b = p.addFilter(createGaussianFilter(CV_8U, Size(5, 5), 1.5));
+    int x = p.addFilter(createDerivFilter(CV_8U, CV_32F, 1, 0, 3), b);
+    int y = p.addFilter(createDerivFilter(CV_8U, CV_32F, 0, 1, 5, BORDER_REPLICATE), b);
+    // the stage that the output does not depend on is skipped
+    p.addOp(getPhaseOp(), CV_32F, x, y);
+    int m = p.addOp(getMagnitudeOp(), CV_32F, x, y);
+    p.addOp(getThresholdOp(100, 255, THRESH_BINARY), CV_32F, m);
+
+    Mat dst;
+    p.apply(src, dst);
+    ASSERT_EQ(ref.size(), dst.size());
+    ASSERT_EQ(ref.type(), dst.type());
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+
+    Mat part(src.size(), CV_32F, Scalar::all(-1));
+    p.apply(src, part, Range(101, 237));
+    EXPECT_EQ(0, norm(ref.rowRange(101, 237), part.rowRange(101, 237), NORM_INF));
+    EXPECT_EQ(-1, part.at<float>(100, 0));
+    EXPECT_EQ(-1, part.at<float>(237, 0));
+
+    // element-wise stages may be applied to the source, and filters may follow them
+    Mat src32f, ref2, dst2;
+    src.convertTo(src32f, CV_32F, 1./255);
+    boxFilter(src32f, ref2, -1, Size(7, 3), Point(-1, -1), true, BORDER_CONSTANT);
+    FilterPipeline p2;
+    int c = p2.addOp(getConvertOp(1./255), CV_32F);
+    p2.addFilter(createBoxFilter(CV_32F, CV_32F, Size(7, 3), Point(-1, -1), true, BORDER_CONSTANT), c);
+    p2.apply(src, dst2);
+    EXPECT_EQ(0, norm(ref2, dst2, NORM_INF));
+
+    EXPECT_THROW(p2.addFilter(createGaussianFilter(CV_8U, Size(3, 3), 0), c), cv::Exception);
+}
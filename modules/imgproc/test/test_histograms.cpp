@@ -1834,4 +1834,254 @@ TEST(Imgproc_Hist_CalcBackProject, accuracy) { CV_CalcBackProjectTest test; test
 TEST(Imgproc_Hist_CalcBackProjectPatch, accuracy) { CV_CalcBackProjectPatchTest test; test.safe_run(); }
 TEST(Imgproc_Hist_BayesianProb, accuracy) { CV_BayesianProbTest test; test.safe_run(); }
 
+TEST(Imgproc_Hist_Calc, parallel_8u)
+{
+    Mat big(1100, 900, CV_8UC3), bigMask(1100, 900, CV_8U);
+    RNG& rng = theRNG();
+    rng.fill(big, RNG::UNIFORM, 0, 256);
+    rng.fill(bigMask, RNG::UNIFORM, 0, 2);
+
+    // a continuous plane is merged into a single row, a ROI is split by rows
+    Mat plane, roi = big(Rect(7, 3, 833, 1051)), mask = bigMask(Rect(7, 3, 833, 1051));
+    extractChannel(big, plane, 2);
+
+    for( int t = 0; t < 3; t++ )
+    {
+        const Mat& src = t == 0 ? plane : roi;
+        Mat m = t == 2 ? mask : Mat();
+        int channel = t == 0 ? 0 : 1;
+        int histSize = 64;
+        float range[] = { 0, 256 };
+        const float* ranges[] = { range };
+
+        Mat ref = Mat::zeros(histSize, 1, CV_32F);
+        for( int y = 0; y < src.rows; y++ )
+            for( int x = 0; x < src.cols; x++ )
+                if( m.empty() || m.at<uchar>(y, x) )
+                    ref.at<float>(src.ptr(y)[x*src.channels() + channel]/4)++;
+
+        for( int k = 0; k < 2; k++ )
+        {
+            ParallelScope scope(k == 0 ? 1 : 4);
+            Mat hist;
+            calcHist(&src, 1, &channel, m, hist, 1, &histSize, ranges);
+            EXPECT_EQ(0, norm(ref, hist, NORM_INF)) << "t=" << t << ", k=" << k;
+        }
+    }
+}
+
+TEST(Imgproc_Hist_Calc, parallel)
+{
+    Mat big8u(1100, 900, CV_8UC3), bigMask(1100, 900, CV_8U), big16u, big32f;
+    RNG& rng = theRNG();
+    rng.fill(big8u, RNG::UNIFORM, 0, 256);
+    rng.fill(bigMask, RNG::UNIFORM, 0, 2);
+    big8u.convertTo(big16u, CV_16U, 200);
+    big8u.convertTo(big32f, CV_32F, 1./255);
+
+    int channels[] = { 0, 1, 2 };
+    int histSizes[] = { 16, 20, 12 };
+    float range8u[] = { 0, 256 }, range16u[] = { 0, 65536 }, range32f[] = { 0, 1.f };
+    float edges[] = { 0, 0.1f, 0.15f, 0.5f, 0.6f, 0.9f, 1.f };
+    const float* ranges[3][3] = { { range8u, range8u, range8u },
+                                  { range16u, range16u, range16u },
+                                  { range32f, range32f, range32f } };
+    const float* nonUniform[] = { edges, edges };
+    int prevThreads = getNumThreads();
+
+    for( int t = 0; t < 12; t++ )
+    {
+        int d = t % 3, dims = t/3 % 3 + 1;
+        bool useRoi = t >= 6, nonUniformRanges = d == 2 && dims == 2;
+        const Mat& img = d == 0 ? big8u : d == 1 ? big16u : big32f;
+        // a continuous image is merged into a single row, a ROI is split by rows
+        Mat src = useRoi ? img(Rect(5, 3, 871, 1053)) : img;
+        Mat m = useRoi ? bigMask(Rect(5, 3, 871, 1053)) : Mat();
+        int sizes[] = { nonUniformRanges ? 6 : histSizes[0], nonUniformRanges ? 6 : histSizes[1], histSizes[2] };
+
+        Mat hist[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            setNumThreads(k == 0 ? 1 : 4);
+            calcHist(&src, 1, channels, m, hist[k], dims, sizes,
+                     nonUniformRanges ? nonUniform : ranges[d], !nonUniformRanges);
+            // the partial histograms are added to the accumulated one
+            calcHist(&src, 1, channels, m, hist[k], dims, sizes,
+                     nonUniformRanges ? nonUniform : ranges[d], !nonUniformRanges, true);
+        }
+        EXPECT_EQ(0, norm(hist[0], hist[1], NORM_INF)) << "depth=" << src.depth() << ", dims=" << dims << ", roi=" << useRoi;
+        // all the 8- and 16-bit values are within the ranges, 1.f is outside of the 32F ones
+        if( d < 2 )
+        {
+            EXPECT_EQ(2.*(m.empty() ? src.total() : countNonZero(m)), sum(hist[1])[0]) << "depth=" << src.depth() << ", dims=" << dims;
+        }
+    }
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Imgproc_Hist_CalcBackProject, parallel_8u)
+{
+    Mat big(1100, 900, CV_8UC3);
+    theRNG().fill(big, RNG::UNIFORM, 0, 256);
+    Mat src = big(Rect(5, 9, 871, 1033));
+
+    int channels[] = { 0, 2 };
+    int histSize[] = { 30, 32 };
+    float range[] = { 0, 256 };
+    const float* ranges[] = { range, range };
+    Mat hist;
+    calcHist(&src, 1, channels, Mat(), hist, 2, histSize, ranges);
+
+    for( int dims = 1; dims <= 2; dims++ )
+    {
+        Mat h = dims == 1 ? hist.col(3).clone() : hist, bproj[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            ParallelScope scope(k == 0 ? 1 : 4);
+            calcBackProject(&src, 1, channels, h, bproj[k], ranges, 0.5);
+        }
+        EXPECT_EQ(0, norm(bproj[0], bproj[1], NORM_INF)) << "dims=" << dims;
+
+        int mismatches = 0;
+        for( int y = 0; y < src.rows; y++ )
+            for( int x = 0; x < src.cols; x++ )
+            {
+                const uchar* p = src.ptr(y) + x*3;
+                int i0 = p[0]*histSize[0]/256, i1 = p[2]*histSize[1]/256;
+                float v = dims == 1 ? h.at<float>(i0) : h.at<float>(i0, i1);
+                mismatches += bproj[1].at<uchar>(y, x) != saturate_cast<uchar>(v*0.5f);
+            }
+        EXPECT_EQ(0, mismatches) << "dims=" << dims;
+    }
+}
+
+TEST(Imgproc_EqualizeHist, parallel)
+{
+    Mat big(1100, 900, CV_8U);
+    theRNG().fill(big, RNG::NORMAL, 100, 30);
+
+    for( int t = 0; t < 2; t++ )
+    {
+        Mat src = t == 0 ? big : big(Rect(1, 2, 877, 1061)), dst[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            ParallelScope scope(k == 0 ? 1 : 4);
+            equalizeHist(src, dst[k]);
+        }
+        EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "t=" << t;
+
+        double minVal, maxVal;
+        minMaxLoc(dst[1], &minVal, &maxVal);
+        EXPECT_EQ(0, minVal);
+        EXPECT_EQ(255, maxVal);
+    }
+}
+
+static void refCLAHE( const Mat& src, Mat& dst, double clipLimit, Size grid )
+{
+    Mat ext;
+    copyMakeBorder(src, ext, 0, (grid.height - src.rows % grid.height) % grid.height,
+                   0, (grid.width - src.cols % grid.width) % grid.width, BORDER_REFLECT_101);
+    Size tile(ext.cols / grid.width, ext.rows / grid.height);
+    int area = tile.area(), limit = clipLimit > 0 ? std::max(cvRound(clipLimit*area/256), 1) : 0;
+    Mat lut(grid.area(), 256, CV_8U);
+
+    for( int k = 0; k < grid.area(); k++ )
+    {
+        Mat t = ext(Rect(k % grid.width * tile.width, k / grid.width * tile.height, tile.width, tile.height));
+        vector<int> h(256, 0);
+        for( int y = 0; y < t.rows; y++ )
+            for( int x = 0; x < t.cols; x++ )
+                h[t.at<uchar>(y, x)]++;
+        if( limit > 0 )
+        {
+            int clipped = 0;
+            for( int i = 0; i < 256; i++ )
+                if( h[i] > limit )
+                    clipped += h[i] - limit, h[i] = limit;
+            for( int i = 0; i < 256; i++ )
+                h[i] += clipped / 256;
+            int residual = clipped % 256, step = residual > 0 ? std::max(256 / residual, 1) : 1;
+            for( int i = 0; i < 256 && residual > 0; i += step, residual-- )
+                h[i]++;
+        }
+        for( int i = 0, sum = 0; i < 256; i++ )
+        {
+            sum += h[i];
+            lut.at<uchar>(k, i) = saturate_cast<uchar>(sum*255./area);
+        }
+    }
+
+    dst.create(src.size(), CV_8U);
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols; x++ )
+        {
+            double tyf = (double)y / tile.height - 0.5, txf = (double)x / tile.width - 0.5;
+            int ty1 = cvFloor(tyf), tx1 = cvFloor(txf);
+            double ya = tyf - ty1, xa = txf - tx1;
+            int ty2 = std::min(ty1 + 1, grid.height - 1), tx2 = std::min(tx1 + 1, grid.width - 1);
+            ty1 = std::max(ty1, 0);
+            tx1 = std::max(tx1, 0);
+            int v = src.at<uchar>(y, x);
+            double r1 = lut.at<uchar>(ty1*grid.width + tx1, v)*(1 - xa) + lut.at<uchar>(ty1*grid.width + tx2, v)*xa;
+            double r2 = lut.at<uchar>(ty2*grid.width + tx1, v)*(1 - xa) + lut.at<uchar>(ty2*grid.width + tx2, v)*xa;
+            dst.at<uchar>(y, x) = saturate_cast<uchar>(r1*(1 - ya) + r2*ya);
+        }
+}
+
+TEST(Imgproc_CLAHE, accuracy)
+{
+    RNG& rng = theRNG();
+    const double clipLimits[] = { 0, 2, 40 };
+
+    for( int iter = 0; iter < 12; iter++ )
+    {
+        Mat src(rng.uniform(20, 300), rng.uniform(20, 300), CV_8U);
+        rng.fill(src, RNG::NORMAL, rng.uniform(50, 200), rng.uniform(5, 40));
+        GaussianBlur(src, src, Size(5, 5), 0);
+
+        Size grid(rng.uniform(1, 10), rng.uniform(1, 10));
+        double clipLimit = clipLimits[iter % 3];
+        Ptr<CLAHE> clahe = createCLAHE(clipLimit, grid);
+        Mat dst, ref;
+
+        clahe->apply(src, dst);
+        refCLAHE(src, ref, clipLimit, grid);
+
+        ASSERT_EQ(src.size(), dst.size());
+        EXPECT_LE(norm(ref, dst, NORM_INF), 1) << "size=" << src.size() << ", grid=" << grid
+                                               << ", clipLimit=" << clipLimit;
+    }
+}
+
+TEST(Imgproc_CLAHE, parallel)
+{
+    Mat big(1100, 900, CV_8U);
+    theRNG().fill(big, RNG::NORMAL, 100, 30);
+    GaussianBlur(big, big, Size(9, 9), 0);
+
+    Ptr<CLAHE> clahe = createCLAHE(3.0, Size(7, 9));
+    Mat dst[2], dst2;
+
+    for( int k = 0; k < 2; k++ )
+    {
+        ParallelScope scope(k == 0 ? 1 : 4);
+        clahe->apply(big, dst[k]);
+    }
+    EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF));
+
+    // the buffers kept from the previous frames do not affect the result
+    Mat roi = big(Rect(5, 3, 611, 705));
+    clahe->apply(roi, dst2);
+    createCLAHE(3.0, Size(7, 9))->apply(roi, dst[0]);
+    EXPECT_EQ(0, norm(dst[0], dst2, NORM_INF));
+
+    clahe->apply(big, dst2);
+    EXPECT_EQ(0, norm(dst[1], dst2, NORM_INF));
+
+    EXPECT_EQ(3.0, clahe->getClipLimit());
+    EXPECT_EQ(Size(7, 9), clahe->getTilesGridSize());
+}
+
 /* End Of File */
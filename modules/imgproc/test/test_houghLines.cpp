@@ -149,3 +149,76 @@ void CV_HoughLinesTest::run_test(int type)
 TEST(Imgproc_HoughLines, regression) { CV_StandartHoughLinesTest test; test.safe_run(); }
 
 TEST(Imgproc_HoughLinesP, regression) { CV_ProbabilisticHoughLinesTest test; test.safe_run(); }
+
+TEST(Imgproc_HoughLinesP, parallel)
+{
+    Mat img(900, 1200, CV_8U, Scalar(0));
+    RNG rng(0x12345);
+    for( int i = 0; i < 40; i++ )
+        line(img, Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)),
+             Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)), Scalar(255));
+    for( int i = 0; i < 3000; i++ )
+        img.at<uchar>(rng.uniform(0, img.rows), rng.uniform(0, img.cols)) = 255;
+    line(img, Point(100, 50), Point(700, 50), Scalar(255));
+
+    Mat lines[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        ParallelScope scope(k == 0 ? 1 : 4);
+        HoughLinesP(img, lines[k], 1, CV_PI/180, 50, 30, 5);
+    }
+
+    ASSERT_FALSE(lines[0].empty());
+    ASSERT_EQ(lines[0].total(), lines[1].total());
+    EXPECT_EQ(0, norm(lines[0], lines[1], NORM_INF));
+
+    bool found = false;
+    for( size_t i = 0; i < lines[0].total(); i++ )
+    {
+        Vec4i l = lines[0].at<Vec4i>((int)i);
+        found = found || (l[1] == 50 && l[3] == 50 && std::abs(l[2] - l[0]) == 600);
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(Imgproc_HoughCircles, parallel)
+{
+    Mat img(720, 1280, CV_8U, Scalar(30));
+    const Point3i refCircles[] = { Point3i(200, 200, 80), Point3i(640, 360, 120),
+                                   Point3i(1000, 250, 60), Point3i(900, 550, 100) };
+    const int nref = (int)(sizeof(refCircles)/sizeof(refCircles[0]));
+    for( int i = 0; i < nref; i++ )
+        circle(img, Point(refCircles[i].x, refCircles[i].y), refCircles[i].z, Scalar(200), -1);
+    GaussianBlur(img, img, Size(9, 9), 2);
+
+    Mat circles[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        ParallelScope scope(k == 0 ? 1 : 4);
+        HoughCircles(img, circles[k], CV_HOUGH_GRADIENT, 1, 50, 100, 30, 40, 150);
+    }
+
+    ASSERT_FALSE(circles[0].empty());
+    ASSERT_EQ(circles[0].total(), circles[1].total());
+    EXPECT_EQ(0, norm(circles[0], circles[1], NORM_INF));
+
+    for( int i = 0; i < nref; i++ )
+    {
+        bool found = false;
+        for( size_t j = 0; j < circles[0].total(); j++ )
+        {
+            Vec3f c = circles[0].at<Vec3f>((int)j);
+            found = found || (std::abs(c[0] - refCircles[i].x) <= 3 && std::abs(c[1] - refCircles[i].y) <= 3 &&
+                              std::abs(c[2] - refCircles[i].z) <= 3);
+        }
+        EXPECT_TRUE(found) << "circle " << i;
+    }
+
+    // the C API returns the same circles
+    Ptr<CvMemStorage> storage = cvCreateMemStorage();
+    CvMat c_img = img;
+    CvSeq* seq = cvHoughCircles(&c_img, storage, CV_HOUGH_GRADIENT, 1, 50, 100, 30, 40, 150);
+    Mat seqCircles(1, seq->total, CV_32FC3);
+    cvCvtSeqToArray(seq, seqCircles.data);
+    EXPECT_EQ(0, norm(circles[0], seqCircles, NORM_INF));
+}
@@ -1534,6 +1534,184 @@ TEST(Imgproc_resize_area, regression)
 }
 
 
+TEST(Imgproc_ResizeToPlanar, accuracy)
+{
+    static const int codes[][2] =
+    {
+        { -1, 3 }, { -1, 1 }, { CV_BGR2RGB, 3 }, { CV_BGR2RGB, 4 }, { CV_BGRA2BGR, 4 },
+        { CV_RGBA2BGR, 4 }, { CV_BGRA2RGBA, 4 }, { CV_BGR2GRAY, 3 }, { CV_RGBA2GRAY, 4 },
+        { CV_YUV2BGR_NV12, 1 }, { CV_YUV2RGB_NV21, 1 }
+    };
+    static const int depths[] = { CV_8U, CV_32F };
+    static const int interpolations[] = { INTER_NEAREST, INTER_LINEAR };
+    static const Size dsizes[] = { Size(224, 224), Size(93, 61), Size(640, 480) };
+
+    int prevThreads = getNumThreads();
+    bool prevOptimized = useOptimized();
+    setNumThreads(4);
+    RNG& rng = theRNG();
+
+    for( int k = 0; k < (int)(sizeof(codes)/sizeof(codes[0])); k++ )
+        for( int d = 0; d < 2; d++ )
+            for( int i = 0; i < 2; i++ )
+                for( int j = 0; j < 3; j++ )
+                {
+                    int code = codes[k][0], scn = codes[k][1], depth = depths[d];
+                    bool yuv = code == CV_YUV2BGR_NV12 || code == CV_YUV2RGB_NV21;
+                    if( yuv && depth != CV_8U )
+                        continue;
+
+                    // smooth data, so that rounding of the intermediate images does not matter much
+                    Size ssize(rng.uniform(1, 400)*2, rng.uniform(1, 300)*2);
+                    Mat src(yuv ? ssize.height*3/2 : ssize.height, ssize.width, CV_MAKETYPE(depth, scn));
+                    Mat small(8, 8, src.type());
+                    randu(small, 0, depth == CV_8U ? 255 : 1);
+                    resize(small, src, src.size(), 0, 0, INTER_LINEAR);
+
+                    double scale = depth == CV_8U ? 1./255 : 1.;
+                    Scalar shift(-0.485, -0.456, -0.406, -0.5);
+                    Mat dst;
+                    setUseOptimized((k + j) % 2 != 0);
+                    resizeToPlanar(src, dst, dsizes[j], code, scale, shift, interpolations[i]);
+                    setUseOptimized(prevOptimized);
+
+                    Mat converted = src, resized, ref;
+                    if( code >= 0 )
+                        cvtColor(src, converted, code);
+                    resize(converted, resized, dsizes[j], 0, 0, interpolations[i]);
+                    resized.convertTo(resized, CV_32F, scale);
+                    std::vector<Mat> planes;
+                    split(resized, planes);
+                    for( size_t c = 0; c < planes.size(); c++ )
+                        planes[c] += Scalar::all(shift[(int)c]);
+                    vconcat(planes, ref);
+
+                    ASSERT_EQ(CV_32FC1, dst.type());
+                    ASSERT_EQ(ref.size(), dst.size());
+                    // the reference rounds the color conversion and resize results to 8 bits
+                    double maxErr = depth == CV_8U ? (yuv ? 3 : 2)*scale : 1e-4;
+                    EXPECT_LE(norm(dst, ref, NORM_INF), maxErr)
+                        << "code=" << code << " scn=" << scn << " depth=" << depth << " optimized=" << ((k + j) % 2)
+                        << " interpolation=" << interpolations[i] << " dsize=" << dsizes[j];
+                }
+
+    // writes into a buffer provided by the caller
+    Mat src(120, 160, CV_8UC3);
+    randu(src, 0, 256);
+    std::vector<float> buf(3*64*64);
+    Mat dst(3*64, 64, CV_32F, &buf[0]);
+    resizeToPlanar(src, dst, Size(64, 64), CV_BGR2RGB);
+    EXPECT_EQ((void*)&buf[0], (void*)dst.data);
+
+    // the sizes are checked the same way as in resize
+    Mat empty, out;
+    EXPECT_THROW(resizeToPlanar(empty, out, Size(64, 64)), cv::Exception);
+    EXPECT_THROW(resizeToPlanar(src, out, Size(0, 64)), cv::Exception);
+    EXPECT_THROW(resizeToPlanar(src, out, Size(64, -1)), cv::Exception);
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Imgproc_WarpPlan, accuracy)
+{
+    static const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_32FC3 };
+    static const int interpolations[] = { INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4 };
+    static const int borders[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101 };
+    RNG& rng = theRNG();
+
+    for( int iter = 0; iter < 24; iter++ )
+    {
+        int type = types[iter % 4], interpolation = interpolations[(iter / 4) % 4];
+        int border = borders[iter % 3], flags = interpolation | (iter % 5 == 0 ? WARP_INVERSE_MAP : 0);
+        bool perspective = iter % 2 != 0;
+        Size ssize(rng.uniform(16, 300), rng.uniform(16, 300)), dsize(rng.uniform(16, 300), rng.uniform(16, 300));
+        Scalar borderValue = Scalar::all(rng.uniform(0, 100));
+
+        Mat src(ssize, type);
+        randu(src, 0, 256);
+
+        Mat M = getRotationMatrix2D(Point2f(ssize.width/2.f, ssize.height/2.f),
+                                    rng.uniform(-180., 180.), rng.uniform(0.5, 2.));
+        if( perspective )
+        {
+            Mat M3 = Mat::eye(3, 3, CV_64F);
+            M.copyTo(M3.rowRange(0, 2));
+            M3.at<double>(2, 0) = rng.uniform(-0.5, 0.5)/dsize.width;
+            M3.at<double>(2, 1) = rng.uniform(-0.5, 0.5)/dsize.height;
+            M = M3;
+        }
+
+        WarpPlan plan;
+        Mat ref, dst;
+        if( perspective )
+        {
+            plan.initPerspective(M, dsize, flags);
+            warpPerspective(src, ref, M, dsize, flags, border, borderValue);
+        }
+        else
+        {
+            plan.initAffine(M, dsize, flags);
+            warpAffine(src, ref, M, dsize, flags, border, borderValue);
+        }
+
+        ASSERT_EQ(dsize, plan.size());
+        plan.apply(src, dst, border, borderValue);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "type=" << type << " flags=" << flags << " perspective=" << perspective;
+
+        // the batch gives the same result for every image
+        std::vector<Mat> srcs(3, src), dsts;
+        srcs[1] = src.clone();
+        plan.apply(srcs, dsts, border, borderValue);
+        ASSERT_EQ(3u, dsts.size());
+        for( size_t k = 0; k < dsts.size(); k++ )
+            EXPECT_EQ(0, norm(ref, dsts[k], NORM_INF)) << "batch image " << k;
+    }
+}
+
+TEST(Imgproc_Remap, optimized)
+{
+    static const int depths[] = { CV_8U, CV_16U, CV_16S, CV_32F };
+    static const int interpolations[] = { INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4 };
+    static const int borders[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101, BORDER_TRANSPARENT };
+    bool prevOptimized = useOptimized();
+    RNG& rng = theRNG();
+
+    for( int d = 0; d < 4; d++ )
+        for( int cn = 1; cn <= 4; cn++ )
+            for( int i = 0; i < 3; i++ )
+            {
+                int type = CV_MAKETYPE(depths[d], cn), border = borders[(d + cn + i) % 4];
+                Size ssize(rng.uniform(8, 200), rng.uniform(8, 200)), dsize(rng.uniform(1, 200), rng.uniform(1, 200));
+                Mat src(ssize, type), mapx(dsize, CV_32F), mapy(dsize, CV_32F);
+                randu(src, depths[d] == CV_16S || depths[d] == CV_32F ? -10000 : 0, depths[d] == CV_8U ? 256 : 10000);
+                // mostly inside of the source image, with some of the samples near or beyond its borders
+                randu(mapx, -5, ssize.width + 5);
+                randu(mapy, -5, ssize.height + 5);
+                for( int y = 0; y < dsize.height; y += 2 )
+                {
+                    float a = (float)rng.uniform(0.9, 1.1);
+                    for( int x = 0; x < dsize.width; x++ )
+                    {
+                        mapx.at<float>(y, x) = a*x*ssize.width/dsize.width;
+                        mapy.at<float>(y, x) = a*y*ssize.height/dsize.height;
+                    }
+                }
+                Scalar borderValue = Scalar::all(rng.uniform(0, 100));
+                Mat ref(dsize, type, Scalar::all(3)), dst(dsize, type, Scalar::all(3));
+
+                setUseOptimized(false);
+                remap(src, ref, mapx, mapy, interpolations[i], border, borderValue);
+                setUseOptimized(true);
+                remap(src, dst, mapx, mapy, interpolations[i], border, borderValue);
+
+                // every pixel is computed the same way whichever path processes it
+                EXPECT_EQ(0, norm(ref, dst, NORM_INF))
+                    << "type=" << type << " interpolation=" << interpolations[i] << " border=" << border;
+            }
+
+    setUseOptimized(prevOptimized);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 TEST(Imgproc_Resize, accuracy) { CV_ResizeTest test; test.safe_run(); }
@@ -40,10 +40,6 @@
 
 #include "precomp.hpp"
 
-#ifdef HAVE_TBB
-#include <tbb/tbb.h>
-#endif
-
 CvANN_MLP_TrainParams::CvANN_MLP_TrainParams()
 {
     term_crit = cvTermCriteria( CV_TERMCRIT_ITER + CV_TERMCRIT_EPS, 1000, 0.01 );
@@ -1136,6 +1132,7 @@ struct rprop_loop {
         grad2->data.db = buf_ptr + max_count*dcount;
 
         // calculate error
+        double localE = 0;
         if( u->type == CV_32F )
             for(int i = 0; i < dcount; i++ )
             {
@@ -1150,7 +1147,7 @@ struct rprop_loop {
                     gdata[j] = t*sweight;
                     E1 += t*t;
                 }
-                *E += sweight*E1;
+                localE += sweight*E1;
             }
         else
             for(int i = 0; i < dcount; i++ )
@@ -1166,22 +1163,22 @@ struct rprop_loop {
                     gdata[j] = t*sweight;
                     E1 += t*t;
                 }
-                *E += sweight*E1;
+                localE += sweight*E1;
             }
 
+        // the error and dEdw are shared by all the sample batches
+        static cv::Mutex mutex;
+        mutex.lock();
+        *E += localE;
+        mutex.unlock();
+
         // backward pass, update dEdw
-        #ifdef HAVE_TBB
-        static tbb::spin_mutex mutex;
-        tbb::spin_mutex::scoped_lock lock;
-        #endif
         for(int i = l_count-1; i > 0; i-- )
         {
             n1 = layer_sizes->data.i[i-1]; n2 = layer_sizes->data.i[i];
             cvInitMatHeader( &_df, dcount, n2, CV_64F, df[i] );
             cvMul( grad1, &_df, grad1 );
-            #ifdef HAVE_TBB
-            lock.acquire(mutex);
-            #endif
+            mutex.lock();
             cvInitMatHeader( &_dEdw, n1, n2, CV_64F, dEdw->data.db+(weights[i]-weights[0]) );
             cvInitMatHeader( x1, dcount, n1, CV_64F, x[i-1] );
             cvGEMM( x1, grad1, 1, &_dEdw, 1, &_dEdw, CV_GEMM_A_T );
@@ -1197,9 +1194,7 @@ struct rprop_loop {
 
            if (i > 1)
                cvInitMatHeader( &_w, n1, n2, CV_64F, weights[i] );
-           #ifdef HAVE_TBB
-           lock.release();
-           #endif
+           mutex.unlock();
            cvInitMatHeader( grad2, dcount, n1, CV_64F, grad2->data.db );
            if( i > 1 )
                cvGEMM( grad1, &_w, 1, 0, 0, grad2, CV_GEMM_B_T );
@@ -897,9 +897,7 @@ private:
     const CvMat* missing;
     const float shrinkage;
 
-#ifdef HAVE_TBB
-    static tbb::spin_mutex SumMutex;
-#endif
+    static cv::Mutex SumMutex;
 
 
 public:
@@ -920,9 +918,6 @@ public:
 
     virtual void operator()(const cv::BlockedRange& range) const
     {
-#ifdef HAVE_TBB
-        tbb::spin_mutex::scoped_lock lock;
-#endif
         CvSeqReader reader;
         int begin = range.begin();
         int end = range.end();
@@ -943,13 +938,8 @@ public:
                     tmp_sum += shrinkage*(float)(tree->predict(sample, missing)->value);
                 }
             }
-#ifdef HAVE_TBB
-            lock.acquire(SumMutex);
+            cv::AutoLock lock(SumMutex);
             sum[i] += tmp_sum;
-            lock.release();
-#else
-            sum[i] += tmp_sum;
-#endif
         }
     } // Tree_predictor::operator()
 
@@ -958,9 +948,7 @@ public:
 }; // class Tree_predictor
 
 
-#ifdef HAVE_TBB
-tbb::spin_mutex Tree_predictor::SumMutex;
-#endif
+cv::Mutex Tree_predictor::SumMutex;
 
 
 
@@ -136,6 +136,7 @@ typedef Ptr<flann::IndexParams> Ptr_flann_IndexParams;
 typedef Ptr<flann::SearchParams> Ptr_flann_SearchParams;
 
 typedef Ptr<FaceRecognizer> Ptr_FaceRecognizer;
+typedef Ptr<CLAHE> Ptr_CLAHE;
 typedef std::vector<Scalar> vector_Scalar;
 
 static PyObject* failmsgp(const char *fmt, ...)